@@ -0,0 +1,172 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/bench/CMakeLists.txt"
+  "/root/repo/bench/benchdata.h.in"
+  "/root/repo/cmake/config.h.cmake"
+  "/root/repo/doc/Doxyfile.cmake"
+  "/root/repo/src/CMakeLists.txt"
+  "/root/repo/tests/CMakeLists.txt"
+  "/root/repo/tests/testdata.h.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CTest.cmake"
+  "/usr/share/cmake-3.25/Modules/CTestTargets.cmake"
+  "/usr/share/cmake-3.25/Modules/CTestUseLaunchers.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/DartConfiguration.tcl.in"
+  "/usr/share/cmake-3.25/Modules/FindDoxygen.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/FindZLIB.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/SelectLibraryConfigurations.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "DartConfiguration.tcl"
+  "include/psf/config.h"
+  "doc/Doxyfile"
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "/root/repo/tests/testdata.h"
+  "tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "bench/benchdata.h"
+  "bench/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/Experimental.dir/DependInfo.cmake"
+  "CMakeFiles/Nightly.dir/DependInfo.cmake"
+  "CMakeFiles/Continuous.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyMemoryCheck.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyStart.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyUpdate.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyConfigure.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyBuild.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyTest.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyCoverage.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyMemCheck.dir/DependInfo.cmake"
+  "CMakeFiles/NightlySubmit.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalStart.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalUpdate.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalConfigure.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalBuild.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalTest.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalCoverage.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalMemCheck.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalSubmit.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousStart.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousUpdate.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousConfigure.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousBuild.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousTest.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousCoverage.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousMemCheck.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousSubmit.dir/DependInfo.cmake"
+  "CMakeFiles/doc.dir/DependInfo.cmake"
+  "src/CMakeFiles/psf.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_arena.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_arena.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_asyncfilereader.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_asyncfilereader.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_calibrationcache.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_calibrationcache.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_centroid.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_centroid.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_chromatogram.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_chromatogram.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_convolution.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_convolution.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_lcmsrun.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_lcmsrun.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_localmaxima.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_localmaxima.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_mzml.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_mzml.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_noisethreshold.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_noisethreshold.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_numpress.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_numpress.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_peakparameter.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_peakparameter.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_peakshape.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_peakshape.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_peakshapefunction.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_peakshapefunction.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_pipeline.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_pipeline.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_regression.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_regression.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_render.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_render.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_resample.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_resample.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_saxparser.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_saxparser.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_scancache.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_scancache.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_scanindex.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_scanindex.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_sparsespectrum.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_sparsespectrum.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_spectrumalgorithm.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_spectrumalgorithm.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_spectrumbatch.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_spectrumbatch.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_spectrumview.dir/DependInfo.cmake"
+  "tests/CMakeFiles/unit_spectrumview.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_asyncfilereader.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_calibration.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_centroid.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_chromatogram.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_convolution.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_lcmsrun.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_measurefullwidths.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_mzml.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_numpress.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_peakshapefunction.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_pipeline.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_render.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_scancache.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_spectrumbatch.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_spectrumview.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_warp.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench_workspace.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_asyncfilereader.dir/AsyncFileReader-bench.cpp.o"
+  "CMakeFiles/bench_asyncfilereader.dir/AsyncFileReader-bench.cpp.o.d"
+  "bench_asyncfilereader"
+  "bench_asyncfilereader.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_asyncfilereader.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
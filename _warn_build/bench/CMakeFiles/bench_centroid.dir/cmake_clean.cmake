@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_centroid.dir/Centroid-bench.cpp.o"
+  "CMakeFiles/bench_centroid.dir/Centroid-bench.cpp.o.d"
+  "bench_centroid"
+  "bench_centroid.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_centroid.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
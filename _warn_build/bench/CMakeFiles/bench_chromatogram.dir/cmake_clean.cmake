@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_chromatogram.dir/Chromatogram-bench.cpp.o"
+  "CMakeFiles/bench_chromatogram.dir/Chromatogram-bench.cpp.o.d"
+  "bench_chromatogram"
+  "bench_chromatogram.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_chromatogram.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_convolution.dir/Convolution-bench.cpp.o"
+  "CMakeFiles/bench_convolution.dir/Convolution-bench.cpp.o.d"
+  "bench_convolution"
+  "bench_convolution.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_convolution.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_lcmsrun.dir/LcmsRun-bench.cpp.o"
+  "CMakeFiles/bench_lcmsrun.dir/LcmsRun-bench.cpp.o.d"
+  "bench_lcmsrun"
+  "bench_lcmsrun.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_lcmsrun.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_measurefullwidths.dir/MeasureFullWidths-bench.cpp.o"
+  "CMakeFiles/bench_measurefullwidths.dir/MeasureFullWidths-bench.cpp.o.d"
+  "bench_measurefullwidths"
+  "bench_measurefullwidths.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_measurefullwidths.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_mzml.dir/MzML-bench.cpp.o"
+  "CMakeFiles/bench_mzml.dir/MzML-bench.cpp.o.d"
+  "bench_mzml"
+  "bench_mzml.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_mzml.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
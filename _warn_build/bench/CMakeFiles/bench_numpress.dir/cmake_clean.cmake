@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_numpress.dir/Numpress-bench.cpp.o"
+  "CMakeFiles/bench_numpress.dir/Numpress-bench.cpp.o.d"
+  "bench_numpress"
+  "bench_numpress.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_numpress.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_peakshapefunction.dir/PeakShapeFunction-bench.cpp.o"
+  "CMakeFiles/bench_peakshapefunction.dir/PeakShapeFunction-bench.cpp.o.d"
+  "bench_peakshapefunction"
+  "bench_peakshapefunction.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_peakshapefunction.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_scancache.dir/ScanCache-bench.cpp.o"
+  "CMakeFiles/bench_scancache.dir/ScanCache-bench.cpp.o.d"
+  "bench_scancache"
+  "bench_scancache.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_scancache.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
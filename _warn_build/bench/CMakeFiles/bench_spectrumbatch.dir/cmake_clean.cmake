@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_spectrumbatch.dir/SpectrumBatch-bench.cpp.o"
+  "CMakeFiles/bench_spectrumbatch.dir/SpectrumBatch-bench.cpp.o.d"
+  "bench_spectrumbatch"
+  "bench_spectrumbatch.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_spectrumbatch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_spectrumview.dir/SpectrumView-bench.cpp.o"
+  "CMakeFiles/bench_spectrumview.dir/SpectrumView-bench.cpp.o.d"
+  "bench_spectrumview"
+  "bench_spectrumview.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_spectrumview.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
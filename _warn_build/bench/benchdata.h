@@ -0,0 +1,2 @@
+#include <string>
+static const std::string dirTestdata = "/root/repo/tests/testdata";
@@ -0,0 +1,41 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/Arena.cpp" "src/CMakeFiles/psf.dir/Arena.cpp.o" "gcc" "src/CMakeFiles/psf.dir/Arena.cpp.o.d"
+  "/root/repo/src/AsyncFileReader.cpp" "src/CMakeFiles/psf.dir/AsyncFileReader.cpp.o" "gcc" "src/CMakeFiles/psf.dir/AsyncFileReader.cpp.o.d"
+  "/root/repo/src/BoxPeakShape.cpp" "src/CMakeFiles/psf.dir/BoxPeakShape.cpp.o" "gcc" "src/CMakeFiles/psf.dir/BoxPeakShape.cpp.o.d"
+  "/root/repo/src/CalibrationCache.cpp" "src/CMakeFiles/psf.dir/CalibrationCache.cpp.o" "gcc" "src/CMakeFiles/psf.dir/CalibrationCache.cpp.o.d"
+  "/root/repo/src/Chromatogram.cpp" "src/CMakeFiles/psf.dir/Chromatogram.cpp.o" "gcc" "src/CMakeFiles/psf.dir/Chromatogram.cpp.o.d"
+  "/root/repo/src/ConstantModel.cpp" "src/CMakeFiles/psf.dir/ConstantModel.cpp.o" "gcc" "src/CMakeFiles/psf.dir/ConstantModel.cpp.o.d"
+  "/root/repo/src/Fft.cpp" "src/CMakeFiles/psf.dir/Fft.cpp.o" "gcc" "src/CMakeFiles/psf.dir/Fft.cpp.o.d"
+  "/root/repo/src/GaussianPeakShape.cpp" "src/CMakeFiles/psf.dir/GaussianPeakShape.cpp.o" "gcc" "src/CMakeFiles/psf.dir/GaussianPeakShape.cpp.o.d"
+  "/root/repo/src/LcmsRun.cpp" "src/CMakeFiles/psf.dir/LcmsRun.cpp.o" "gcc" "src/CMakeFiles/psf.dir/LcmsRun.cpp.o.d"
+  "/root/repo/src/LinearSqrtModel.cpp" "src/CMakeFiles/psf.dir/LinearSqrtModel.cpp.o" "gcc" "src/CMakeFiles/psf.dir/LinearSqrtModel.cpp.o.d"
+  "/root/repo/src/LocalMaxima.cpp" "src/CMakeFiles/psf.dir/LocalMaxima.cpp.o" "gcc" "src/CMakeFiles/psf.dir/LocalMaxima.cpp.o.d"
+  "/root/repo/src/LorentzianPeakShape.cpp" "src/CMakeFiles/psf.dir/LorentzianPeakShape.cpp.o" "gcc" "src/CMakeFiles/psf.dir/LorentzianPeakShape.cpp.o.d"
+  "/root/repo/src/MzML.cpp" "src/CMakeFiles/psf.dir/MzML.cpp.o" "gcc" "src/CMakeFiles/psf.dir/MzML.cpp.o.d"
+  "/root/repo/src/NoiseThreshold.cpp" "src/CMakeFiles/psf.dir/NoiseThreshold.cpp.o" "gcc" "src/CMakeFiles/psf.dir/NoiseThreshold.cpp.o.d"
+  "/root/repo/src/Numpress.cpp" "src/CMakeFiles/psf.dir/Numpress.cpp.o" "gcc" "src/CMakeFiles/psf.dir/Numpress.cpp.o.d"
+  "/root/repo/src/PeakShapeFunction.cpp" "src/CMakeFiles/psf.dir/PeakShapeFunction.cpp.o" "gcc" "src/CMakeFiles/psf.dir/PeakShapeFunction.cpp.o.d"
+  "/root/repo/src/QuadraticModel.cpp" "src/CMakeFiles/psf.dir/QuadraticModel.cpp.o" "gcc" "src/CMakeFiles/psf.dir/QuadraticModel.cpp.o.d"
+  "/root/repo/src/Regression.cpp" "src/CMakeFiles/psf.dir/Regression.cpp.o" "gcc" "src/CMakeFiles/psf.dir/Regression.cpp.o.d"
+  "/root/repo/src/SaxParser.cpp" "src/CMakeFiles/psf.dir/SaxParser.cpp.o" "gcc" "src/CMakeFiles/psf.dir/SaxParser.cpp.o.d"
+  "/root/repo/src/ScanCache.cpp" "src/CMakeFiles/psf.dir/ScanCache.cpp.o" "gcc" "src/CMakeFiles/psf.dir/ScanCache.cpp.o.d"
+  "/root/repo/src/ScanIndex.cpp" "src/CMakeFiles/psf.dir/ScanIndex.cpp.o" "gcc" "src/CMakeFiles/psf.dir/ScanIndex.cpp.o.d"
+  "/root/repo/src/SpectrumBatch.cpp" "src/CMakeFiles/psf.dir/SpectrumBatch.cpp.o" "gcc" "src/CMakeFiles/psf.dir/SpectrumBatch.cpp.o.d"
+  "/root/repo/src/SqrtModel.cpp" "src/CMakeFiles/psf.dir/SqrtModel.cpp.o" "gcc" "src/CMakeFiles/psf.dir/SqrtModel.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
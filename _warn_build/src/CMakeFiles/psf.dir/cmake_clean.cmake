@@ -0,0 +1,55 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/psf.dir/Arena.cpp.o"
+  "CMakeFiles/psf.dir/Arena.cpp.o.d"
+  "CMakeFiles/psf.dir/AsyncFileReader.cpp.o"
+  "CMakeFiles/psf.dir/AsyncFileReader.cpp.o.d"
+  "CMakeFiles/psf.dir/BoxPeakShape.cpp.o"
+  "CMakeFiles/psf.dir/BoxPeakShape.cpp.o.d"
+  "CMakeFiles/psf.dir/CalibrationCache.cpp.o"
+  "CMakeFiles/psf.dir/CalibrationCache.cpp.o.d"
+  "CMakeFiles/psf.dir/Chromatogram.cpp.o"
+  "CMakeFiles/psf.dir/Chromatogram.cpp.o.d"
+  "CMakeFiles/psf.dir/ConstantModel.cpp.o"
+  "CMakeFiles/psf.dir/ConstantModel.cpp.o.d"
+  "CMakeFiles/psf.dir/Fft.cpp.o"
+  "CMakeFiles/psf.dir/Fft.cpp.o.d"
+  "CMakeFiles/psf.dir/GaussianPeakShape.cpp.o"
+  "CMakeFiles/psf.dir/GaussianPeakShape.cpp.o.d"
+  "CMakeFiles/psf.dir/LcmsRun.cpp.o"
+  "CMakeFiles/psf.dir/LcmsRun.cpp.o.d"
+  "CMakeFiles/psf.dir/LinearSqrtModel.cpp.o"
+  "CMakeFiles/psf.dir/LinearSqrtModel.cpp.o.d"
+  "CMakeFiles/psf.dir/LocalMaxima.cpp.o"
+  "CMakeFiles/psf.dir/LocalMaxima.cpp.o.d"
+  "CMakeFiles/psf.dir/LorentzianPeakShape.cpp.o"
+  "CMakeFiles/psf.dir/LorentzianPeakShape.cpp.o.d"
+  "CMakeFiles/psf.dir/MzML.cpp.o"
+  "CMakeFiles/psf.dir/MzML.cpp.o.d"
+  "CMakeFiles/psf.dir/NoiseThreshold.cpp.o"
+  "CMakeFiles/psf.dir/NoiseThreshold.cpp.o.d"
+  "CMakeFiles/psf.dir/Numpress.cpp.o"
+  "CMakeFiles/psf.dir/Numpress.cpp.o.d"
+  "CMakeFiles/psf.dir/PeakShapeFunction.cpp.o"
+  "CMakeFiles/psf.dir/PeakShapeFunction.cpp.o.d"
+  "CMakeFiles/psf.dir/QuadraticModel.cpp.o"
+  "CMakeFiles/psf.dir/QuadraticModel.cpp.o.d"
+  "CMakeFiles/psf.dir/Regression.cpp.o"
+  "CMakeFiles/psf.dir/Regression.cpp.o.d"
+  "CMakeFiles/psf.dir/SaxParser.cpp.o"
+  "CMakeFiles/psf.dir/SaxParser.cpp.o.d"
+  "CMakeFiles/psf.dir/ScanCache.cpp.o"
+  "CMakeFiles/psf.dir/ScanCache.cpp.o.d"
+  "CMakeFiles/psf.dir/ScanIndex.cpp.o"
+  "CMakeFiles/psf.dir/ScanIndex.cpp.o.d"
+  "CMakeFiles/psf.dir/SpectrumBatch.cpp.o"
+  "CMakeFiles/psf.dir/SpectrumBatch.cpp.o.d"
+  "CMakeFiles/psf.dir/SqrtModel.cpp.o"
+  "CMakeFiles/psf.dir/SqrtModel.cpp.o.d"
+  "libpsf.pdb"
+  "libpsf.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/psf.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
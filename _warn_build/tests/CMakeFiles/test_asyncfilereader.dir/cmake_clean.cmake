@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_asyncfilereader.dir/AsyncFileReader-test.cpp.o"
+  "CMakeFiles/test_asyncfilereader.dir/AsyncFileReader-test.cpp.o.d"
+  "test_asyncfilereader"
+  "test_asyncfilereader.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_asyncfilereader.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_calibrationcache.dir/CalibrationCache-test.cpp.o"
+  "CMakeFiles/test_calibrationcache.dir/CalibrationCache-test.cpp.o.d"
+  "test_calibrationcache"
+  "test_calibrationcache.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_calibrationcache.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
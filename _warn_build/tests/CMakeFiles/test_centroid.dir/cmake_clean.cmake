@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_centroid.dir/Centroid-test.cpp.o"
+  "CMakeFiles/test_centroid.dir/Centroid-test.cpp.o.d"
+  "test_centroid"
+  "test_centroid.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_centroid.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_chromatogram.dir/Chromatogram-test.cpp.o"
+  "CMakeFiles/test_chromatogram.dir/Chromatogram-test.cpp.o.d"
+  "test_chromatogram"
+  "test_chromatogram.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_chromatogram.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_convolution.dir/Convolution-test.cpp.o"
+  "CMakeFiles/test_convolution.dir/Convolution-test.cpp.o.d"
+  "test_convolution"
+  "test_convolution.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_convolution.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
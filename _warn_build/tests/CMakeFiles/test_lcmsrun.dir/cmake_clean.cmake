@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_lcmsrun.dir/LcmsRun-test.cpp.o"
+  "CMakeFiles/test_lcmsrun.dir/LcmsRun-test.cpp.o.d"
+  "test_lcmsrun"
+  "test_lcmsrun.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_lcmsrun.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
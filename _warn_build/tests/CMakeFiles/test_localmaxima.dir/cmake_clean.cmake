@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_localmaxima.dir/LocalMaxima-test.cpp.o"
+  "CMakeFiles/test_localmaxima.dir/LocalMaxima-test.cpp.o.d"
+  "test_localmaxima"
+  "test_localmaxima.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_localmaxima.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
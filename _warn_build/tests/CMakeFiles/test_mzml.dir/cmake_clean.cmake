@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_mzml.dir/MzML-test.cpp.o"
+  "CMakeFiles/test_mzml.dir/MzML-test.cpp.o.d"
+  "test_mzml"
+  "test_mzml.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_mzml.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
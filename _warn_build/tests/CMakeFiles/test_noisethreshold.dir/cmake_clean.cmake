@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_noisethreshold.dir/NoiseThreshold-test.cpp.o"
+  "CMakeFiles/test_noisethreshold.dir/NoiseThreshold-test.cpp.o.d"
+  "test_noisethreshold"
+  "test_noisethreshold.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_noisethreshold.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_numpress.dir/Numpress-test.cpp.o"
+  "CMakeFiles/test_numpress.dir/Numpress-test.cpp.o.d"
+  "test_numpress"
+  "test_numpress.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_numpress.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
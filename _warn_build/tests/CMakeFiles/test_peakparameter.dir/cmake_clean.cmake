@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_peakparameter.dir/PeakParameter-test.cpp.o"
+  "CMakeFiles/test_peakparameter.dir/PeakParameter-test.cpp.o.d"
+  "test_peakparameter"
+  "test_peakparameter.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_peakparameter.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
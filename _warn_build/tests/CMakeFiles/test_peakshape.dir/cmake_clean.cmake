@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_peakshape.dir/PeakShape-test.cpp.o"
+  "CMakeFiles/test_peakshape.dir/PeakShape-test.cpp.o.d"
+  "test_peakshape"
+  "test_peakshape.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_peakshape.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
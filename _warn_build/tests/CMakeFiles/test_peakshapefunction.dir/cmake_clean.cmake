@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_peakshapefunction.dir/PeakShapeFunction-test.cpp.o"
+  "CMakeFiles/test_peakshapefunction.dir/PeakShapeFunction-test.cpp.o.d"
+  "test_peakshapefunction"
+  "test_peakshapefunction.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_peakshapefunction.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_resample.dir/Resample-test.cpp.o"
+  "CMakeFiles/test_resample.dir/Resample-test.cpp.o.d"
+  "test_resample"
+  "test_resample.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_resample.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
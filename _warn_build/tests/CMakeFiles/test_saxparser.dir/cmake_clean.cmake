@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_saxparser.dir/SaxParser-test.cpp.o"
+  "CMakeFiles/test_saxparser.dir/SaxParser-test.cpp.o.d"
+  "test_saxparser"
+  "test_saxparser.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_saxparser.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_scancache.dir/ScanCache-test.cpp.o"
+  "CMakeFiles/test_scancache.dir/ScanCache-test.cpp.o.d"
+  "test_scancache"
+  "test_scancache.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_scancache.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_scanindex.dir/ScanIndex-test.cpp.o"
+  "CMakeFiles/test_scanindex.dir/ScanIndex-test.cpp.o.d"
+  "test_scanindex"
+  "test_scanindex.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_scanindex.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_sparsespectrum.dir/SparseSpectrum-test.cpp.o"
+  "CMakeFiles/test_sparsespectrum.dir/SparseSpectrum-test.cpp.o.d"
+  "test_sparsespectrum"
+  "test_sparsespectrum.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_sparsespectrum.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_spectrumalgorithm.dir/SpectrumAlgorithm-test.cpp.o"
+  "CMakeFiles/test_spectrumalgorithm.dir/SpectrumAlgorithm-test.cpp.o.d"
+  "test_spectrumalgorithm"
+  "test_spectrumalgorithm.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_spectrumalgorithm.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
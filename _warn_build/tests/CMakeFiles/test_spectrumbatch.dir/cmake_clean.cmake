@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_spectrumbatch.dir/SpectrumBatch-test.cpp.o"
+  "CMakeFiles/test_spectrumbatch.dir/SpectrumBatch-test.cpp.o.d"
+  "test_spectrumbatch"
+  "test_spectrumbatch.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_spectrumbatch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_spectrumview.dir/SpectrumView-test.cpp.o"
+  "CMakeFiles/test_spectrumview.dir/SpectrumView-test.cpp.o.d"
+  "test_spectrumview"
+  "test_spectrumview.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_spectrumview.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/unit_spectrumview"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/unit_spectrumview.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,56 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests
+# Build directory: /root/repo/_warn_build/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(Arena "test_arena")
+set_tests_properties(Arena PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;58;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(AsyncFileReader "test_asyncfilereader")
+set_tests_properties(AsyncFileReader PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;59;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(CalibrationCache "test_calibrationcache")
+set_tests_properties(CalibrationCache PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;60;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(Centroid "test_centroid")
+set_tests_properties(Centroid PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;61;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(Chromatogram "test_chromatogram")
+set_tests_properties(Chromatogram PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;62;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(Convolution "test_convolution")
+set_tests_properties(Convolution PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;63;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(LcmsRun "test_lcmsrun")
+set_tests_properties(LcmsRun PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;64;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(LocalMaxima "test_localmaxima")
+set_tests_properties(LocalMaxima PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;65;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(MzML "test_mzml")
+set_tests_properties(MzML PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;66;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NoiseThreshold "test_noisethreshold")
+set_tests_properties(NoiseThreshold PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;67;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(Numpress "test_numpress")
+set_tests_properties(Numpress PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;68;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(PeakParameter "test_peakparameter")
+set_tests_properties(PeakParameter PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;69;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(PeakShape "test_peakshape")
+set_tests_properties(PeakShape PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;70;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(PeakShapeFunction "test_peakshapefunction")
+set_tests_properties(PeakShapeFunction PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;71;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(Pipeline "test_pipeline")
+set_tests_properties(Pipeline PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;72;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(Regression "test_regression")
+set_tests_properties(Regression PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;73;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(Render "test_render")
+set_tests_properties(Render PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;74;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(Resample "test_resample")
+set_tests_properties(Resample PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;75;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SaxParser "test_saxparser")
+set_tests_properties(SaxParser PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;76;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ScanCache "test_scancache")
+set_tests_properties(ScanCache PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;77;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ScanIndex "test_scanindex")
+set_tests_properties(ScanIndex PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;78;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SparseSpectrum "test_sparsespectrum")
+set_tests_properties(SparseSpectrum PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;79;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpectrumAlgorithm "test_spectrumalgorithm")
+set_tests_properties(SpectrumAlgorithm PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;80;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpectrumBatch "test_spectrumbatch")
+set_tests_properties(SpectrumBatch PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;81;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpectrumView "test_spectrumview")
+set_tests_properties(SpectrumView PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;49;ADD_TEST;/root/repo/tests/CMakeLists.txt;82;ADD_PSF_TEST;/root/repo/tests/CMakeLists.txt;0;")
@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <psf/AsyncFileReader.h>
+#include <psf/Spectrum.h>
+
+#include "benchdata.h"
+#include "benchmark.hxx"
+
+using namespace psf;
+
+namespace
+{
+    // Asks the kernel to drop the files from the page cache, so that they are read from
+    // the disk again. Without permission or support the cache stays warm.
+    void evict(const std::vector<std::string>& files) {
+        for(std::size_t f = 0; f < files.size(); ++f) {
+            const int fd = ::open(files[f].c_str(), O_RDONLY);
+            if(fd >= 0) {
+                ::fdatasync(fd);
+                ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                ::close(fd);
+            }
+        }
+    }
+}
+
+// Writes copies of orbi_ms1.wsv and loads them with psf::SpectrumLoader, which reads and
+// parses in turn, and with a psf::AsyncFileReader, which keeps reads in flight while
+// parsing, from a cold and from a warm page cache. The throughput is reported in MB of
+// .wsv per second.
+int main()
+{
+    psfbench::silenceLogging();
+    const std::string wsv = dirTestdata + "/shared_data/orbi_ms1.wsv";
+    const int nFiles = 300;
+
+    std::string text;
+    {
+        std::ifstream ifs(wsv.c_str(), std::ios::binary);
+        text.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    std::vector<std::string> files;
+    for(int f = 0; f < nFiles; ++f) {
+        files.push_back("AsyncFileReader-bench-" + std::to_string(f) + ".wsv");
+        std::ofstream ofs(files.back().c_str(), std::ios::binary);
+        ofs << text;
+    }
+    const double megabytes = nFiles * text.size() / 1e6;
+    std::cout << nFiles << " copies of orbi_ms1.wsv, " << megabytes << " MB, io_uring "
+              << (AsyncFileReader::ioUringAvailable() ? "available" : "not available") << std::endl;
+
+    const char* caches[] = {"cold", "warm"};
+    for(int warm = 0; warm < 2; ++warm) {
+        Spectrum spectrum;
+        if(!warm) {
+            evict(files);
+        }
+        {
+            SpectrumLoader loader;
+            psfbench::Stopwatch watch;
+            for(int f = 0; f < nFiles; ++f) {
+                loader.load(files[f], spectrum);
+            }
+            psfbench::report(std::string("  ") + caches[warm] + ", SpectrumLoader", watch.seconds(), megabytes, "MB");
+        }
+
+        const AsyncFileReader::Backend backends[] = {AsyncFileReader::threadBackend, AsyncFileReader::ioUringBackend};
+        const char* names[] = {"threads", "io_uring"};
+        const unsigned depths[] = {4, 16};
+        for(int b = 0; b < 2; ++b) {
+            if(b == 1 && !AsyncFileReader::ioUringAvailable()) {
+                break;
+            }
+            for(int d = 0; d < 2; ++d) {
+                if(!warm) {
+                    evict(files);
+                }
+                AsyncFileReader reader(files, depths[d], backends[b]);
+                psfbench::Stopwatch watch;
+                while(reader.next(spectrum)) {
+                }
+                psfbench::report(std::string("  ") + caches[warm] + ", AsyncFileReader, " + names[b] + ", depth " + std::to_string(depths[d]),
+                                 watch.seconds(), megabytes, "MB");
+            }
+        }
+    }
+
+    for(int f = 0; f < nFiles; ++f) {
+        std::remove(files[f].c_str());
+    }
+
+    return 0;
+}
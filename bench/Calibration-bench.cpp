@@ -0,0 +1,73 @@
+#include <cmath>
+#include <iostream>
+
+#include <psf/PeakParameter.h>
+#include <psf/Regression.h>
+#include <psf/Spectrum.h>
+
+#include "benchmark.hxx"
+#include "synthetic.hxx"
+#include "benchdata.h"
+
+using namespace psf;
+
+// Calibrates an Orbitrap FWHM on noisy synthetic spectra with overlapping peaks using
+// ordinary least squares and the robust regression methods, and compares the calibration
+// from every peak with the calibration from a sample of peaks.
+int main()
+{
+    psfbench::silenceLogging();
+    const double a = 1.19781e-05;
+    const double overlapFractions[] = {0., 0.1, 0.3};
+    const char* names[] = {"least squares", "huber", "tukey"};
+    const RegressionMethod methods[] = {leastSquaresRegression, huberRegression, tukeyRegression};
+    MzExtractor get_mz;
+    IntensityExtractor get_int;
+
+    for(int o = 0; o < 3; ++o) {
+        Spectrum spectrum = psfbench::syntheticSpectrum(a, 3000, 300., 2000., overlapFractions[o], 0.005);
+        std::cout << "Synthetic spectrum: " << spectrum.size() << " elements, " << 100 * overlapFractions[o] << "% overlapping peaks, 0.5% noise" << std::endl;
+        const std::size_t nPairs = measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 0.).size();
+
+        for(int m = 0; m < 3; ++m) {
+            OrbitrapWithOriginFwhm fwhm;
+            fwhm.setRegressionMethod(methods[m]);
+            psfbench::Stopwatch watch;
+            fwhm.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+            const double seconds = watch.seconds();
+            psfbench::report(std::string("  ") + names[m], seconds, nPairs, "pairs");
+            std::cout << "    relative error of a: " << std::abs(fwhm.getA() - a) / a << std::endl;
+        }
+    }
+
+    // subsampled calibration with statistical early termination
+    const double tolerances[] = {0.02, 0.01, 0.005};
+    Spectrum synthetic = psfbench::syntheticSpectrum(a, 1000, 300., 2000., 0., 0.005);
+    Spectrum orbi;
+    loadSpectrumElements(orbi, dirTestdata + "/shared_data/orbi_ms1.wsv");
+    const Spectrum* spectra[] = {&synthetic, &orbi};
+    const char* spectrumNames[] = {"sparse synthetic spectrum", "orbi_ms1.wsv"};
+    for(int sp = 0; sp < 2; ++sp) {
+        const Spectrum& spectrum = *spectra[sp];
+        for(int m = 0; m < 3; m += 2) {
+            std::cout << "Sampled calibration (" << names[m] << ") on " << spectrumNames[sp] << ", " << spectrum.size() << " elements" << std::endl;
+            OrbitrapWithOriginFwhm full;
+            full.setRegressionMethod(methods[m]);
+            psfbench::Stopwatch watch;
+            full.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+            psfbench::report("  every peak", watch.seconds(), spectrum.size(), "elements");
+
+            for(int t = 0; t < 3; ++t) {
+                OrbitrapWithOriginFwhm sampled;
+                sampled.setRegressionMethod(methods[m]);
+                watch.restart();
+                const std::size_t used = sampled.learnFromSample(get_mz, get_int, spectrum.begin(), spectrum.end(), tolerances[t]);
+                const double seconds = watch.seconds();
+                std::cout << "  tolerance " << tolerances[t] << ", " << used << " peaks";
+                psfbench::report("", seconds, spectrum.size(), "elements");
+                std::cout << "    deviation from every peak: " << std::abs(sampled.getA() - full.getA()) / full.getA() << std::endl;
+            }
+        }
+    }
+    return 0;
+}
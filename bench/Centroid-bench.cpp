@@ -0,0 +1,49 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <psf/Centroid.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/Spectrum.h>
+
+#include "benchdata.h"
+#include "benchmark.hxx"
+#include "synthetic.hxx"
+
+using namespace psf;
+
+// Centroids orbi_ms1.wsv and a synthetic profile spectrum with about a million elements
+// into a preallocated peak list and reports the throughput in elements per second.
+int main()
+{
+    psfbench::silenceLogging();
+    MzExtractor get_mz;
+    IntensityExtractor get_int;
+    OrbitrapPeakShapeFunction orbi(1.19781e-06);
+
+    Spectrum measured;
+    loadSpectrumElements(measured, dirTestdata + "/shared_data/orbi_ms1.wsv");
+    const Spectrum synthetic = psfbench::syntheticSpectrum(1.19781e-06, 12000, 300., 2000., 0.1, 0.005);
+    const Spectrum* spectra[] = {&measured, &synthetic};
+    const char* names[] = {"orbi_ms1.wsv", "synthetic spectrum"};
+    const int repetitions[] = {2000, 10};
+
+    const ApexInterpolation interpolations[] = {gaussianThreePoint, peakShapeFit};
+    const char* interpolationNames[] = {"  gaussian three point", "  peak shape fit"};
+    for(int s = 0; s < 2; ++s) {
+        const Spectrum& spectrum = *spectra[s];
+        std::cout << "Centroiding " << names[s] << ", " << spectrum.size() << " elements, " << repetitions[s] << " times" << std::endl;
+        std::vector<Centroid> centroids(maximalNumberOfCentroids(spectrum.size()));
+        for(int m = 0; m < 2; ++m) {
+            std::vector<Centroid>::iterator end = centroids.begin();
+            psfbench::Stopwatch watch;
+            for(int r = 0; r < repetitions[s]; ++r) {
+                end = centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.end(), centroids.begin(), interpolations[m]);
+            }
+            psfbench::report(std::string(interpolationNames[m]) + ", " + std::to_string(end - centroids.begin()) + " centroids",
+                             watch.seconds(), static_cast<double>(spectrum.size()) * repetitions[s], "elements");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <psf/Chromatogram.h>
+#include <psf/LcmsRun.h>
+#include <psf/Parallel.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/Spectrum.h>
+
+#include "benchmark.hxx"
+
+using namespace psf;
+
+namespace
+{
+    struct MzLess {
+        bool operator()(const SpectrumElement& e, const double mz) const { return e.mz < mz; }
+    };
+}
+
+// Extracts the chromatograms of 10^4 targets from a synthetic run of 10^4 centroided
+// scans with the windows of an Orbitrap peak shape function: with a binary search per
+// target and scan, and with psf::IonChromatograms, which merges the sorted windows with
+// every scan. Reported are the (target, scan) pairs per second.
+int main()
+{
+    psfbench::silenceLogging();
+    const std::size_t nScans = 10000;
+    const std::size_t nElements = 2000;
+    const std::size_t nTargets = 10000;
+
+    std::srand(42);
+    LcmsRun run;
+    run.reserve(nScans, nScans * nElements);
+    Spectrum scan(nElements, SpectrumElement(0., 0.));
+    for(std::size_t i = 0; i < nScans; ++i) {
+        double mz = 300.;
+        for(std::size_t j = 0; j < nElements; ++j) {
+            mz += 1.7 * std::rand() / RAND_MAX;
+            scan[j] = SpectrumElement(mz, 1 + std::rand() % 10000);
+        }
+        run.add(i, scan.begin(), scan.end());
+    }
+    std::vector<double> targets(nTargets);
+    for(std::size_t t = 0; t < nTargets; ++t) {
+        targets[t] = 300. + 1700. * std::rand() / RAND_MAX;
+    }
+    OrbitrapPeakShapeFunction orbi(1.19781e-05);
+    const double pairs = static_cast<double>(nScans) * nTargets;
+    std::cout << nTargets << " targets, " << nScans << " scans of " << nElements << " elements, " << hardwareConcurrency() << " hardware threads" << std::endl;
+
+    double checksum = 0.;
+    {
+        IonChromatograms xics(orbi, targets);
+        std::vector<double> row(nTargets);
+        psfbench::Stopwatch watch;
+        for(std::size_t i = 0; i < nScans; ++i) {
+            for(std::size_t t = 0; t < nTargets; ++t) {
+                const SpectrumElement* element = std::lower_bound(run.begin(i), run.end(i), xics.lowerMz(t), MzLess());
+                double sum = 0.;
+                for(; element != run.end(i) && element->mz <= xics.upperMz(t); ++element) {
+                    sum += element->intensity;
+                }
+                row[t] = sum;
+            }
+            checksum += row[i % nTargets];
+        }
+        psfbench::report("  binary search per target", watch.seconds(), pairs, "pairs");
+    }
+
+    IonChromatograms xics(orbi, targets);
+    const unsigned threads[] = {1, 0};
+    for(int n = 0; n < 2; ++n) {
+        psfbench::Stopwatch watch;
+        xics.extract(MzExtractor(), IntensityExtractor(), run, threads[n]);
+        psfbench::report(std::string("  sorted merge, ") + (threads[n] ? "1 thread" : "all threads"), watch.seconds(), pairs, "pairs");
+    }
+    for(std::size_t i = 0; i < nScans; ++i) {
+        checksum -= xics.intensity(i % nTargets, i);
+    }
+    std::cout << "  difference of the checksums: " << checksum << std::endl;
+
+    return 0;
+}
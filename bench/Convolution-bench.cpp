@@ -0,0 +1,57 @@
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <psf/Convolution.h>
+#include <psf/PeakShapeFunction.h>
+
+#include "benchmark.hxx"
+
+using namespace psf;
+
+// Compares direct summation and FFT convolution on a uniform grid for Gaussian PSFs of
+// growing width, and the piecewise-constant FFT path for a mass-dependent Orbitrap PSF.
+int main()
+{
+    psfbench::silenceLogging();
+    const std::size_t nPoints = 1 << 18;
+    const double firstMz = 300.;
+    const double mzStep = 0.001;
+
+    std::srand(42);
+    std::vector<double> profile(nPoints, 0.);
+    for(std::size_t i = 0; i < nPoints; ++i) {
+        if(std::rand() % 4 == 0) {
+            profile[i] = std::rand() % 1000;
+        }
+    }
+    std::vector<double> result(nPoints);
+
+    std::cout << "Convolving " << nPoints << " grid points." << std::endl;
+    const double fwhms[] = {0.005, 0.02, 0.08, 0.3};
+    for(int w = 0; w < 4; ++w) {
+        GaussianPeakShapeFunction gauss(fwhms[w]);
+        const std::size_t kernelLength = 2 * static_cast<std::size_t>(gauss.getSupportThreshold(400.) / mzStep) + 1;
+        std::cout << "Gaussian, fwhm " << fwhms[w] << " (kernel length " << kernelLength << ")" << std::endl;
+
+        psfbench::Stopwatch watch;
+        convolveOnUniformGrid(gauss, profile.begin(), profile.end(), firstMz, mzStep, result.begin(), directConvolution);
+        psfbench::report("  direct", watch.seconds(), nPoints, "points");
+
+        watch.restart();
+        convolveOnUniformGrid(gauss, profile.begin(), profile.end(), firstMz, mzStep, result.begin(), fftConvolution);
+        psfbench::report("  fft", watch.seconds(), nPoints, "points");
+    }
+
+    OrbitrapPeakShapeFunction orbi(1.19781e-05);
+    std::cout << "Orbitrap, mass-dependent width" << std::endl;
+    psfbench::Stopwatch watch;
+    convolveOnUniformGrid(orbi, profile.begin(), profile.end(), firstMz, mzStep, result.begin(), directConvolution);
+    psfbench::report("  direct", watch.seconds(), nPoints, "points");
+
+    watch.restart();
+    convolveOnUniformGrid(orbi, profile.begin(), profile.end(), firstMz, mzStep, result.begin(), fftConvolution);
+    psfbench::report("  fft, piecewise-constant width", watch.seconds(), nPoints, "points");
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <psf/LcmsRun.h>
+#include <psf/PeakParameter.h>
+#include <psf/Spectrum.h>
+
+#include "benchmark.hxx"
+#include "synthetic.hxx"
+
+using namespace psf;
+
+namespace
+{
+    // The Orbitrap parameter a over a one hour gradient: a slow rise and a bump.
+    double truth(const double rt) {
+        return 1.2e-5 * (1. + 0.2 * rt / 3600. + 0.05 * std::sin(rt / 600.));
+    }
+
+    double median(std::vector<double> v) {
+        std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+        return v[v.size() / 2];
+    }
+}
+
+// Calibrates every scan of a synthetic run with drifting peak widths on its own and
+// compares it with a psf::FwhmDrift fitted to a sparse subset of the scans. Reported are
+// the scans per second (including the sparse calibrations for the drift) and the median
+// relative error of the parameter a over all scans.
+int main()
+{
+    psfbench::silenceLogging();
+    const std::size_t nScans = 1000;
+    LcmsRun run;
+    for(std::size_t i = 0; i < nScans; ++i) {
+        const double rt = 3600. * i / nScans;
+        const Spectrum s = psfbench::syntheticSpectrum(truth(rt), 12, 300., 2000., 0.3, 0.03, static_cast<unsigned>(i));
+        run.add(rt, s.begin(), s.end(), static_cast<int>(i + 1), 1);
+    }
+    std::cout << "Synthetic run: " << nScans << " scans, " << run.numberOfElements() << " elements, 12 peaks per scan, 30% overlapping, 3% noise" << std::endl;
+    MzExtractor get_mz;
+    IntensityExtractor get_int;
+    std::vector<double> errors(nScans);
+
+    {
+        CalibrationWorkspace workspace;
+        OrbitrapWithOriginFwhm fwhm;
+        fwhm.setRegressionMethod(huberRegression);
+        psfbench::Stopwatch watch;
+        for(std::size_t i = 0; i < nScans; ++i) {
+            try {
+                fwhm.learnFrom(get_mz, get_int, run.begin(i), run.end(i), workspace);
+            } catch(const Starvation&) {
+                // keep the parameters of the previous scan
+            }
+            errors[i] = std::abs(fwhm.getA() / truth(run.retentionTime(i)) - 1.);
+        }
+        psfbench::report("  every scan on its own", watch.seconds(), nScans, "scans");
+        std::cout << "    median relative error of a: " << median(errors) << std::endl;
+    }
+
+    const std::size_t sparse[] = {25, 50, 100};
+    for(int s = 0; s < 3; ++s) {
+        OrbitrapWithOriginFwhm prototype;
+        prototype.setRegressionMethod(huberRegression);
+        FwhmDrift<LinearSqrtOriginModel> drift(prototype);
+        drift.setSpan(0.2);
+        OrbitrapWithOriginFwhm fwhm;
+        psfbench::Stopwatch watch;
+        drift.calibrate(get_mz, get_int, run, sparse[s], 1, 1);
+        for(std::size_t i = 0; i < nScans; ++i) {
+            drift.at(run.retentionTime(i), fwhm);
+            errors[i] = std::abs(fwhm.getA() / truth(run.retentionTime(i)) - 1.);
+        }
+        psfbench::report("  drift from " + std::to_string(sparse[s]) + " scans", watch.seconds(), nScans, "scans");
+        std::cout << "    median relative error of a: " << median(errors) << std::endl;
+    }
+
+    {
+        FwhmDrift<LinearSqrtOriginModel> drift;
+        drift.calibrate(get_mz, get_int, run, 50, 1, 1);
+        OrbitrapWithOriginFwhm fwhm;
+        const int repetitions = 1000;
+        double sum = 0.;
+        psfbench::Stopwatch watch;
+        for(int r = 0; r < repetitions; ++r) {
+            for(std::size_t i = 0; i < nScans; ++i) {
+                drift.at(run.retentionTime(i), fwhm);
+                sum += fwhm.getA();
+            }
+        }
+        psfbench::report("  interpolating the parameters", watch.seconds(), static_cast<double>(nScans) * repetitions, "scans");
+        if(sum < 0.) {
+            std::cout << sum << std::endl;
+        }
+    }
+
+    return 0;
+}
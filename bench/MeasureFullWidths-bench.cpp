@@ -0,0 +1,56 @@
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <psf/LocalMaxima.h>
+#include <psf/Parallel.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumAlgorithm.h>
+
+#include "benchmark.hxx"
+#include "synthetic.hxx"
+
+using namespace psf;
+
+// Measures the peak widths in a synthetic profile spectrum with about a million elements
+// sequentially, with the chunked parallel scan for several thread counts and with the
+// local maxima prepass. The results are checked against the sequential one.
+int main()
+{
+    psfbench::silenceLogging();
+    const Spectrum spectrum = psfbench::syntheticSpectrum(1.19781e-06, 12000, 300., 2000., 0.1, 0.005);
+    MzExtractor get_mz;
+    IntensityExtractor get_int;
+    typedef std::vector<std::pair<MzExtractor::result_type, MzExtractor::result_type> > MzWidthPairs;
+
+    std::cout << "Measuring full widths in " << spectrum.size() << " elements." << std::endl;
+    psfbench::Stopwatch watch;
+    const MzWidthPairs expected = measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5);
+    const double sequential = watch.seconds();
+    psfbench::report("sequential", sequential, spectrum.size(), "elements");
+
+    for(unsigned nThreads = 1; nThreads <= hardwareConcurrency(); nThreads *= 2) {
+        watch.restart();
+        const MzWidthPairs pairs = measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 0., nThreads);
+        const double seconds = watch.seconds();
+        std::cout << nThreads << " thread(s)";
+        psfbench::report("", seconds, spectrum.size(), "elements");
+        std::cout << "  speedup " << sequential / seconds << (pairs == expected ? ", identical result" : ", DIFFERENT RESULT") << std::endl;
+    }
+
+    // the mask and its buffer are reused for every spectrum in practice
+    LocalMaximaMask mask;
+    mask.assign(get_int, spectrum.begin(), spectrum.end());
+    watch.restart();
+    mask.assign(get_int, spectrum.begin(), spectrum.end());
+    const double prepass = watch.seconds();
+    psfbench::report("local maxima prepass", prepass, spectrum.size(), "elements");
+    watch.restart();
+    const MzWidthPairs pairs = measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 0., mask);
+    const double seconds = watch.seconds();
+    psfbench::report("  bumps around " + std::to_string(mask.count()) + " maxima", seconds, spectrum.size(), "elements");
+    std::cout << "  speedup " << sequential / (prepass + seconds) << " including the prepass" << (pairs == expected ? ", identical result" : ", DIFFERENT RESULT") << std::endl;
+
+    return 0;
+}
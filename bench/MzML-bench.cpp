@@ -0,0 +1,95 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <psf/MzML.h>
+#include <psf/Parallel.h>
+#include <psf/Spectrum.h>
+
+#include "benchdata.h"
+#include "benchmark.hxx"
+
+using namespace psf;
+
+namespace
+{
+    double fileSize(const std::string& filename) {
+        std::ifstream ifs(filename.c_str(), std::ios::binary | std::ios::ate);
+        return static_cast<double>(ifs.tellg());
+    }
+}
+
+// Writes a run of scans derived from orbi_ms1.wsv as mzML, uncompressed and zlib
+// compressed, with 64 bit floats and numpress encoded, and reads it back with different
+// numbers of threads. The throughput is
+// reported in MB of mzML per second; loading orbi_ms1.wsv itself is the reference.
+int main()
+{
+    psfbench::silenceLogging();
+    const std::string wsv = dirTestdata + "/shared_data/orbi_ms1.wsv";
+    const int scans = 300;
+
+    Spectrum orbi;
+    loadSpectrumElements(orbi, wsv);
+    {
+        SpectrumLoader loader;
+        Spectrum spectrum;
+        psfbench::Stopwatch watch;
+        for(int scan = 0; scan < scans; ++scan) {
+            loader.load(wsv, spectrum);
+        }
+        psfbench::report("Loading orbi_ms1.wsv (" + std::to_string(orbi.size()) + " elements), " + std::to_string(scans) + " times",
+                         watch.seconds(), scans * fileSize(wsv) / 1e6, "MB");
+    }
+
+#ifdef PSF_HAVE_ZLIB
+    const int nCompressions = 2;
+#else
+    const int nCompressions = 1;
+#endif
+    const std::string filename = "MzML-bench.mzML";
+    for(int mode = 0; mode < 4; ++mode) {
+        const bool compress = mode % 2 == 1;
+        const bool numpress = mode >= 2;
+        if(mode % 2 >= nCompressions) {
+            continue;
+        }
+        {
+            std::ofstream ofs(filename.c_str(), std::ios::binary);
+            MzMLWriter writer(ofs, scans, compress, numpress);
+            Spectrum spectrum(orbi);
+            psfbench::Stopwatch watch;
+            for(int scan = 0; scan < scans; ++scan) {
+                for(std::size_t i = 0; i < spectrum.size(); ++i) {
+                    spectrum[i].intensity = orbi[i].intensity * (1. + 0.001 * scan);
+                }
+                writer.write(spectrum, scan * 0.5);
+            }
+            writer.close();
+            ofs.close();
+            std::cout << "Writing " << scans << " scans, " << (numpress ? "numpress, " : "64 bit floats, ") << (compress ? "zlib compressed" : "uncompressed") << ", " << fileSize(filename) / 1e6 << " MB: " << watch.seconds() << " s" << std::endl;
+        }
+
+        const double megabytes = fileSize(filename) / 1e6;
+        const unsigned threads[] = {1, 2, 4, hardwareConcurrency()};
+        for(int t = 0; t < 4; ++t) {
+            if(t == 3 && threads[3] <= 4) {
+                break;
+            }
+            MzMLReader reader(filename, threads[t]);
+            MzMLScan scan;
+            std::size_t elements = 0;
+            psfbench::Stopwatch watch;
+            while(reader.next(scan)) {
+                elements += scan.spectrum.size();
+            }
+            psfbench::report("  reading, " + std::to_string(threads[t]) + " threads, " + std::to_string(elements) + " elements",
+                             watch.seconds(), megabytes, "MB");
+        }
+    }
+    std::remove(filename.c_str());
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <psf/Numpress.h>
+#include <psf/Spectrum.h>
+
+#include "benchdata.h"
+#include "benchmark.hxx"
+
+using namespace psf;
+
+// Encodes and decodes the m/z values and intensities of orbi_ms1.wsv with the numpress
+// codecs. Reported are the bytes per value (8 for doubles) and the throughput in values
+// per second; copying the doubles is the reference for the decoders.
+int main()
+{
+    psfbench::silenceLogging();
+    Spectrum orbi;
+    loadSpectrumElements(orbi, dirTestdata + "/shared_data/orbi_ms1.wsv");
+    std::vector<double> mz, intensity;
+    for(std::size_t i = 0; i < orbi.size(); ++i) {
+        mz.push_back(orbi[i].mz);
+        intensity.push_back(orbi[i].intensity);
+    }
+    const std::size_t n = mz.size();
+    const int repetitions = 2000;
+    const double values = static_cast<double>(n) * repetitions;
+    std::cout << "orbi_ms1.wsv, " << n << " values, " << repetitions << " times" << std::endl;
+
+    std::vector<double> decoded(n);
+    {
+        psfbench::Stopwatch watch;
+        for(int r = 0; r < repetitions; ++r) {
+            std::memcpy(&decoded[0], &mz[0], n * sizeof(double));
+        }
+        psfbench::report("  copying doubles", watch.seconds(), values, "values");
+    }
+
+    std::string bytes;
+    const char* names[] = {"linear prediction, m/z", "short logged float, intensity", "positive integer, intensity"};
+    for(int codec = 0; codec < 3; ++codec) {
+        psfbench::Stopwatch watch;
+        for(int r = 0; r < repetitions; ++r) {
+            if(codec == 0) {
+                encodeNumpressLinear(&mz[0], n, optimalNumpressLinearFixedPoint(&mz[0], n), bytes);
+            }
+            else if(codec == 1) {
+                encodeNumpressSlof(&intensity[0], n, optimalNumpressSlofFixedPoint(&intensity[0], n), bytes);
+            }
+            else {
+                encodeNumpressPic(&intensity[0], n, bytes);
+            }
+        }
+        const double encodeSeconds = watch.seconds();
+        watch.restart();
+        for(int r = 0; r < repetitions; ++r) {
+            if(codec == 0) {
+                decodeNumpressLinear(bytes, decoded);
+            }
+            else if(codec == 1) {
+                decodeNumpressSlof(bytes, decoded);
+            }
+            else {
+                decodeNumpressPic(bytes, decoded);
+            }
+        }
+        const double decodeSeconds = watch.seconds();
+        std::cout << "  " << names[codec] << ": " << static_cast<double>(bytes.size()) / n << " bytes per value" << std::endl;
+        psfbench::report("    encoding", encodeSeconds, values, "values");
+        psfbench::report("    decoding", decodeSeconds, values, "values");
+    }
+
+    return 0;
+}
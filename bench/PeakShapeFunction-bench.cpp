@@ -0,0 +1,81 @@
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <psf/PeakShapeFunction.h>
+
+#include "benchmark.hxx"
+
+using namespace psf;
+
+// Evaluates an Orbitrap PSF around many reference masses on a fine m/z grid.
+//
+// Compares
+//  - the former per-sample evaluation: fwhm -> sigma conversion and a division in the
+//    exponent for every observed mass,
+//  - the scalar operator(), which now uses the precomputed exponent factor,
+//  - the batch evaluate(), which additionally sets the width only once per reference mass.
+int main()
+{
+    psfbench::silenceLogging();
+    const int nReferences = 20000;
+    const int nObserved = 64;
+    const double spacing = 0.0005;
+
+    OrbitrapPeakShapeFunction orbi(1.19781e-06);
+    OrbitrapWithOriginFwhm fwhm;
+    fwhm.setA(1.19781e-06);
+
+    std::vector<double> observed(nObserved);
+    std::vector<double> values(nObserved);
+    const double evaluations = static_cast<double>(nReferences) * nObserved;
+    const double sigmaToFwhm = 2 * std::sqrt(2 * std::log(2.));
+
+    std::cout << "Evaluating " << nReferences << " x " << nObserved << " PSF values." << std::endl;
+
+    // reference: division-based evaluation as done before
+    double checksum = 0;
+    psfbench::Stopwatch watch;
+    for(int r = 0; r < nReferences; ++r) {
+        const double reference = 400. + r * 0.05;
+        for(int i = 0; i < nObserved; ++i) {
+            const double sigma = fwhm.at(reference) / sigmaToFwhm;
+            const double d = (i - nObserved / 2) * spacing;
+            if(std::fabs(d) <= 3 * sigma) {
+                checksum += std::exp(-(d * d) / (2 * sigma * sigma));
+            }
+        }
+    }
+    psfbench::report("division per sample", watch.seconds(), evaluations, "evaluations");
+    std::cout << "  checksum " << checksum << std::endl;
+
+    // scalar operator()
+    checksum = 0;
+    watch.restart();
+    for(int r = 0; r < nReferences; ++r) {
+        const double reference = 400. + r * 0.05;
+        for(int i = 0; i < nObserved; ++i) {
+            checksum += orbi(reference, reference + (i - nObserved / 2) * spacing);
+        }
+    }
+    psfbench::report("operator()", watch.seconds(), evaluations, "evaluations");
+    std::cout << "  checksum " << checksum << std::endl;
+
+    // batch evaluate()
+    checksum = 0;
+    watch.restart();
+    for(int r = 0; r < nReferences; ++r) {
+        const double reference = 400. + r * 0.05;
+        for(int i = 0; i < nObserved; ++i) {
+            observed[i] = reference + (i - nObserved / 2) * spacing;
+        }
+        orbi.evaluate(reference, observed.begin(), observed.end(), values.begin());
+        for(int i = 0; i < nObserved; ++i) {
+            checksum += values[i];
+        }
+    }
+    psfbench::report("evaluate()", watch.seconds(), evaluations, "evaluations");
+    std::cout << "  checksum " << checksum << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <psf/Centroid.h>
+#include <psf/Parallel.h>
+#include <psf/PeakParameter.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/Pipeline.h>
+#include <psf/Spectrum.h>
+
+#include "benchdata.h"
+#include "benchmark.hxx"
+
+using namespace psf;
+
+namespace
+{
+    struct Job
+    {
+        Spectrum spectrum;
+        std::vector<Centroid> centroids;
+        std::size_t nCentroids;
+    };
+
+    // The stages of the run.
+    struct Stages
+    {
+        Stages(const std::string& f) : filename(f), orbi(1.19781e-06), written(0) {}
+
+        void read(Job& job) {
+            loader.load(filename, job.spectrum);
+        }
+
+        void calibrate(Job& job) {
+            fwhm.learnFrom(get_mz, get_int, job.spectrum.begin(), job.spectrum.end(), workspace);
+        }
+
+        void process(Job& job) const {
+            job.centroids.resize(maximalNumberOfCentroids(job.spectrum.size()));
+            job.nCentroids = centroid(orbi, get_mz, get_int, job.spectrum.begin(), job.spectrum.end(), job.centroids.begin(), peakShapeFit) - job.centroids.begin();
+        }
+
+        void write(const Job& job) {
+            char line[64];
+            for(std::size_t i = 0; i < job.nCentroids; ++i) {
+                written += std::snprintf(line, sizeof(line), "%.10g %.10g\n", job.centroids[i].mz, job.centroids[i].intensity);
+            }
+        }
+
+        std::string filename;
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        SpectrumLoader loader;
+        OrbitrapFwhm fwhm;
+        CalibrationWorkspace workspace;
+        OrbitrapPeakShapeFunction orbi;
+        std::size_t written;
+    };
+}
+
+// Reads, calibrates, centroids and formats orbi_ms1.wsv scan after scan, first in a plain
+// loop with the time of every stage, then as a psf::Pipeline with a growing number of
+// threads for the centroiding. The pipeline approaches the time of the slowest stage
+// instead of the sum of all, given enough cores. Last, the source is slowed down to see
+// the processor time the waiting threads take.
+int main()
+{
+    psfbench::silenceLogging();
+    const std::string filename = dirTestdata + "/shared_data/orbi_ms1.wsv";
+    const int scans = 200;
+
+    Stages stages(filename);
+    Job job;
+    double stageSeconds[4] = {0., 0., 0., 0.};
+    psfbench::Stopwatch total;
+    for(int scan = 0; scan < scans; ++scan) {
+        psfbench::Stopwatch watch;
+        stages.read(job);
+        stageSeconds[0] += watch.seconds();
+        watch.restart();
+        stages.calibrate(job);
+        stageSeconds[1] += watch.seconds();
+        watch.restart();
+        stages.process(job);
+        stageSeconds[2] += watch.seconds();
+        watch.restart();
+        stages.write(job);
+        stageSeconds[3] += watch.seconds();
+    }
+    std::cout << "Read, calibrate, centroid and write orbi_ms1.wsv, " << scans << " scans, " << hardwareConcurrency() << " cores" << std::endl;
+    psfbench::report("  sequential loop", total.seconds(), scans, "scans");
+    const char* names[] = {"read", "calibrate", "centroid", "write"};
+    for(int s = 0; s < 4; ++s) {
+        psfbench::report(std::string("    stage ") + names[s], stageSeconds[s], scans, "scans");
+    }
+
+    // concurrent with 1, 2 and 4 centroiding threads, last the default with 4
+    const unsigned threads[] = {1, 2, 4, 4};
+    for(int t = 0; t < 4; ++t) {
+        Pipeline<Job> pipeline;
+        if(t < 3) {
+            pipeline.setConcurrent(true);
+        }
+        pipeline.addStage([&stages](Job& job) { stages.calibrate(job); })
+                .addStage([&stages](Job& job) { stages.process(job); }, threads[t]);
+        int read = 0;
+        psfbench::Stopwatch watch;
+        pipeline.run([&](Job& job) {
+                         if(read++ == scans) {
+                             return false;
+                         }
+                         stages.read(job);
+                         return true;
+                     },
+                     [&stages](Job& job) { stages.write(job); });
+        const std::string mode = t < 3 ? "" : (pipeline.isConcurrent() ? "default (concurrent), " : "default (sequential), ");
+        psfbench::report("  pipeline, " + mode + std::to_string(threads[t]) + " centroiding threads", watch.seconds(), scans, "scans");
+    }
+
+    // a source waiting on a slow disk: the other threads wait, too, and should leave the
+    // cores to the rest of the machine meanwhile; then the same with the default, which is
+    // the plain loop on a single core
+    for(int concurrent = 1; concurrent >= 0; --concurrent) {
+        Pipeline<Job> pipeline;
+        if(concurrent) {
+            pipeline.setConcurrent(true);
+        }
+        pipeline.addStage([&stages](Job& job) { stages.calibrate(job); })
+                .addStage([&stages](Job& job) { stages.process(job); }, 4);
+        int read = 0;
+        psfbench::Stopwatch watch;
+        const std::clock_t cpuStart = std::clock();
+        pipeline.run([&](Job& job) {
+                         if(read++ == scans) {
+                             return false;
+                         }
+                         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                         stages.read(job);
+                         return true;
+                     },
+                     [&stages](Job& job) { stages.write(job); });
+        const double seconds = watch.seconds();
+        psfbench::report(std::string("  pipeline, ") + (concurrent ? "concurrent" : (pipeline.isConcurrent() ? "default (concurrent)" : "default (sequential)"))
+                         + ", source waiting 10 ms per scan", seconds, scans, "scans");
+        std::cout << "    cpu time: " << static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC << " s" << std::endl;
+    }
+
+    return 0;
+}
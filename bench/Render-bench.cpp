@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <psf/Parallel.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/Render.h>
+#include <psf/Spectrum.h>
+
+#include "benchmark.hxx"
+
+using namespace psf;
+
+// Renders a random stick spectrum with an Orbitrap PSF onto a fine uniform and an equivalent
+// sorted grid and reports the throughput in sticks per second for several thread counts.
+int main()
+{
+    psfbench::silenceLogging();
+    const std::size_t nSticks = 200000;
+    const double firstMz = 300.;
+    const double lastMz = 2000.;
+    const double mzStep = 0.001;
+    const std::size_t nPoints = static_cast<std::size_t>((lastMz - firstMz) / mzStep);
+
+    std::srand(42);
+    std::vector<double> stickMzs;
+    for(std::size_t s = 0; s < nSticks; ++s) {
+        stickMzs.push_back(firstMz + (lastMz - firstMz) * std::rand() / (RAND_MAX + 1.));
+    }
+    std::sort(stickMzs.begin(), stickMzs.end());
+    Spectrum sticks;
+    for(std::size_t s = 0; s < nSticks; ++s) {
+        sticks.push_back(SpectrumElement(stickMzs[s], 1. + std::rand() % 1000));
+    }
+
+    std::vector<double> grid(nPoints);
+    for(std::size_t i = 0; i < nPoints; ++i) {
+        grid[i] = firstMz + i * mzStep;
+    }
+    std::vector<double> profile(nPoints);
+
+    OrbitrapPeakShapeFunction orbi(1.19781e-06);
+    MzExtractor get_mz;
+    IntensityExtractor get_int;
+
+    std::cout << "Rendering " << nSticks << " sticks onto " << nPoints << " grid points." << std::endl;
+    for(unsigned nThreads = 1; nThreads <= hardwareConcurrency(); nThreads *= 2) {
+        std::cout << nThreads << " thread(s)" << std::endl;
+
+        psfbench::Stopwatch watch;
+        renderProfileOnUniformGrid(orbi, get_mz, get_int, sticks.begin(), sticks.end(), firstMz, mzStep, nPoints, profile.begin(), nThreads);
+        psfbench::report("  uniform grid", watch.seconds(), nSticks, "sticks");
+
+        watch.restart();
+        renderProfile(orbi, get_mz, get_int, sticks.begin(), sticks.end(), grid.begin(), grid.end(), profile.begin(), nThreads);
+        psfbench::report("  sorted grid", watch.seconds(), nSticks, "sticks");
+    }
+
+    return 0;
+}
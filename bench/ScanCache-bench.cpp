@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <psf/Centroid.h>
+#include <psf/PeakParameter.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/ScanCache.h>
+#include <psf/ScanIndex.h>
+#include <psf/Spectrum.h>
+
+#include "benchdata.h"
+#include "benchmark.hxx"
+
+using namespace psf;
+
+namespace
+{
+    // Calibrates and centroids a scan like a whole run processing would.
+    struct Processing
+    {
+        Processing() : orbi(1.19781e-06), nCentroids(0) {}
+
+        void operator()(const Spectrum& scan) {
+            fwhm.learnFrom(get_mz, get_int, scan.begin(), scan.end(), workspace);
+            centroids.resize(maximalNumberOfCentroids(scan.size()));
+            nCentroids += centroid(orbi, get_mz, get_int, scan.begin(), scan.end(), centroids.begin()) - centroids.begin();
+        }
+
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        OrbitrapWithOriginFwhm fwhm;
+        CalibrationWorkspace workspace;
+        OrbitrapPeakShapeFunction orbi;
+        std::vector<Centroid> centroids;
+        std::size_t nCentroids;
+    };
+}
+
+// Writes a run of copies of orbi_ms1.wsv and calibrates and centroids every scan: reading
+// the scans in turn through a psf::IndexedRun, and through psf::ScanCache with small
+// memory budgets, which reads ahead in a background thread. Reported are the scans per
+// second and the largest number of bytes cached.
+int main()
+{
+    psfbench::silenceLogging();
+    const std::string run = "ScanCache-bench.wsv";
+    const int nScans = 400;
+    {
+        std::ifstream ifs((dirTestdata + "/shared_data/orbi_ms1.wsv").c_str(), std::ios::binary);
+        const std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        std::ofstream ofs(run.c_str(), std::ios::binary);
+        for(int i = 0; i < nScans; ++i) {
+            ofs << "# scan=" << i + 1 << " rt=" << i << " level=1\n" << text;
+        }
+    }
+    ScanIndex::open(run);
+    std::cout << nScans << " scans of orbi_ms1.wsv" << std::endl;
+
+    {
+        IndexedRun indexed(run);
+        Processing processing;
+        Spectrum scan;
+        psfbench::Stopwatch watch;
+        for(int i = 0; i < nScans; ++i) {
+            indexed.read(i, scan);
+            processing(scan);
+        }
+        psfbench::report("  IndexedRun", watch.seconds(), nScans, "scans");
+    }
+
+    const std::size_t budgets[] = {std::size_t(1) << 20, std::size_t(8) << 20};
+    for(int b = 0; b < 2; ++b) {
+        ScanCache cache(run, budgets[b]);
+        Processing processing;
+        std::size_t maximalBytes = 0;
+        psfbench::Stopwatch watch;
+        for(int i = 0; i < nScans; ++i) {
+            processing(*cache.scan(i));
+            maximalBytes = std::max(maximalBytes, cache.bytesCached());
+        }
+        psfbench::report("  ScanCache, budget " + std::to_string(budgets[b] >> 20) + " MB", watch.seconds(), nScans, "scans");
+        std::cout << "    at most " << maximalBytes << " bytes cached, " << cache.hits() << " hits, " << cache.misses() << " misses" << std::endl;
+    }
+
+    std::remove(run.c_str());
+    std::remove(ScanIndex::sidecarFilename(run).c_str());
+
+    return 0;
+}
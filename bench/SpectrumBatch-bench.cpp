@@ -0,0 +1,88 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <psf/Parallel.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumBatch.h>
+
+#include "benchdata.h"
+#include "benchmark.hxx"
+
+using namespace psf;
+
+// Copies orbi_ms1.wsv into a batch of files and into one huge file and loads them
+// sequentially with loadSpectrumElements() and with a psf::SpectrumBatch with a growing
+// number of threads. The throughput is reported in MB of .wsv per second.
+int main()
+{
+    psfbench::silenceLogging();
+    const std::string wsv = dirTestdata + "/shared_data/orbi_ms1.wsv";
+    const int nFiles = 200;
+
+    std::string text;
+    {
+        std::ifstream ifs(wsv.c_str(), std::ios::binary);
+        text.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    std::vector<std::string> files;
+    const std::string huge = "SpectrumBatch-bench-huge.wsv";
+    {
+        std::ofstream hugeStream(huge.c_str(), std::ios::binary);
+        for(int f = 0; f < nFiles; ++f) {
+            files.push_back("SpectrumBatch-bench-" + std::to_string(f) + ".wsv");
+            std::ofstream ofs(files.back().c_str(), std::ios::binary);
+            ofs << text;
+            hugeStream << text;
+        }
+    }
+    const double megabytes = nFiles * text.size() / 1e6;
+    const unsigned threads[] = {1, 2, 4, hardwareConcurrency()};
+
+    std::cout << nFiles << " copies of orbi_ms1.wsv, " << megabytes << " MB, " << hardwareConcurrency() << " cores" << std::endl;
+    {
+        std::vector<Spectrum> spectra(nFiles);
+        psfbench::Stopwatch watch;
+        for(int f = 0; f < nFiles; ++f) {
+            loadSpectrumElements(spectra[f], files[f]);
+        }
+        psfbench::report("  loadSpectrumElements, sequential", watch.seconds(), megabytes, "MB");
+    }
+    SpectrumBatch batch;
+    for(int t = 0; t < 4; ++t) {
+        if(t == 3 && threads[3] <= 4) {
+            break;
+        }
+        psfbench::Stopwatch watch;
+        batch.load(files, threads[t]);
+        const double seconds = watch.seconds();
+        psfbench::report("  batch, " + std::to_string(threads[t]) + " threads", seconds, megabytes, "MB");
+        psfbench::report("  batch, " + std::to_string(threads[t]) + " threads", seconds, nFiles, "spectra");
+    }
+
+    std::cout << "One file of " << megabytes << " MB" << std::endl;
+    {
+        Spectrum spectrum;
+        psfbench::Stopwatch watch;
+        loadSpectrumElements(spectrum, huge);
+        psfbench::report("  loadSpectrumElements, " + std::to_string(spectrum.size()) + " elements", watch.seconds(), megabytes, "MB");
+    }
+    for(int t = 0; t < 4; ++t) {
+        if(t == 3 && threads[3] <= 4) {
+            break;
+        }
+        psfbench::Stopwatch watch;
+        batch.load(std::vector<std::string>(1, huge), threads[t], 1 << 20);
+        psfbench::report("  batch in 1 MB chunks, " + std::to_string(threads[t]) + " threads", watch.seconds(), megabytes, "MB");
+    }
+
+    for(int f = 0; f < nFiles; ++f) {
+        std::remove(files[f].c_str());
+    }
+    std::remove(huge.c_str());
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <cstddef>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <psf/PeakShapeFunction.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumAlgorithm.h>
+#include <psf/SpectrumView.h>
+
+#include "benchmark.hxx"
+#include "synthetic.hxx"
+
+using namespace psf;
+
+namespace
+{
+    // like the records of a vendor library
+    struct VendorPeak
+    {
+        double mz;
+        float intensity;
+        int flags;
+    };
+}
+
+// Measures the full widths of and calibrates for a large synthetic spectrum held in
+// vendor records with float intensities: copying the records into a psf::Spectrum first,
+// and working on a psf::BasicSpectrumView of the records. Reported are the elements per
+// second.
+int main()
+{
+    psfbench::silenceLogging();
+    const Spectrum s = psfbench::syntheticSpectrum(1.19781e-06, 20000, 300., 2000., 0.2, 0.01);
+    std::vector<VendorPeak> records;
+    for(std::size_t i = 0; i < s.size(); ++i) {
+        VendorPeak peak = {s[i].mz, static_cast<float>(s[i].intensity), 0};
+        records.push_back(peak);
+    }
+    const int nRepetitions = 10;
+    std::cout << s.size() << " elements" << std::endl;
+
+    MzExtractor get_mz;
+    IntensityExtractor get_int;
+    std::vector<std::pair<double, double> > widths;
+    {
+        psfbench::Stopwatch watch;
+        for(int r = 0; r < nRepetitions; ++r) {
+            Spectrum copy;
+            copy.reserve(records.size());
+            for(std::size_t i = 0; i < records.size(); ++i) {
+                copy.push_back(SpectrumElement(records[i].mz, records[i].intensity));
+            }
+            measureFullWidths(get_mz, get_int, copy.begin(), copy.end(), 0.5, 0., widths);
+        }
+        psfbench::report("  measureFullWidths, copy", watch.seconds(), nRepetitions * records.size(), "elements");
+    }
+    {
+        psfbench::Stopwatch watch;
+        for(int r = 0; r < nRepetitions; ++r) {
+            const BasicSpectrumView<double, float> view(&records[0].mz, &records[0].intensity, records.size(), sizeof(VendorPeak), sizeof(VendorPeak));
+            measureFullWidths(view, 0.5, 0., widths);
+        }
+        psfbench::report("  measureFullWidths, view", watch.seconds(), nRepetitions * records.size(), "elements");
+    }
+
+    double a = 0.;
+    {
+        psfbench::Stopwatch watch;
+        for(int r = 0; r < nRepetitions; ++r) {
+            Spectrum copy;
+            copy.reserve(records.size());
+            for(std::size_t i = 0; i < records.size(); ++i) {
+                copy.push_back(SpectrumElement(records[i].mz, records[i].intensity));
+            }
+            OrbitrapPeakShapeFunction orbi;
+            orbi.calibrateFor(get_mz, get_int, copy.begin(), copy.end());
+            a = orbi.getA();
+        }
+        psfbench::report("  calibrateFor, copy", watch.seconds(), nRepetitions * records.size(), "elements");
+    }
+    {
+        psfbench::Stopwatch watch;
+        for(int r = 0; r < nRepetitions; ++r) {
+            const BasicSpectrumView<double, float> view(&records[0].mz, &records[0].intensity, records.size(), sizeof(VendorPeak), sizeof(VendorPeak));
+            OrbitrapPeakShapeFunction orbi;
+            orbi.calibrateFor(view);
+            a = orbi.getA();
+        }
+        psfbench::report("  calibrateFor, view", watch.seconds(), nRepetitions * records.size(), "elements");
+    }
+    std::cout << "    a = " << a << std::endl;
+
+    return 0;
+}
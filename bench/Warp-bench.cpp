@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <psf/Convolution.h>
+#include <psf/Fft.h>
+#include <psf/PeakParameter.h>
+#include <psf/PeakShape.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/Resample.h>
+#include <psf/Spectrum.h>
+
+#include "benchmark.hxx"
+
+using namespace psf;
+
+// Convolves a profile spectrum with the mass-dependent Orbitrap PSF, once by evaluating
+// the width at every grid point and once by warping the spectrum into the coordinate with
+// constant FWHM, convolving with one fixed Gaussian kernel via FFT, and warping back.
+int main()
+{
+    psfbench::silenceLogging();
+    const std::size_t nPoints = 1 << 18;
+    const double firstMz = 300.;
+    const double mzStep = 0.001;
+    const double pointsPerFwhm = 8.;
+
+    OrbitrapWithOriginFwhm fwhm;
+    fwhm.setA(1.19781e-05);
+    OrbitrapPeakShapeFunction orbi(fwhm.getA());
+
+    // a profile made of peaks with the instrument's width
+    std::srand(42);
+    std::vector<double> profile(nPoints, 0.);
+    for(int peak = 0; peak < 2000; ++peak) {
+        const double center = firstMz + (std::rand() % nPoints) * mzStep;
+        const double height = std::rand() % 1000 + 1;
+        const double sigma = fwhm.at(center) / 2.3548;
+        for(std::size_t i = 0; i < nPoints; ++i) {
+            const double d = firstMz + i * mzStep - center;
+            if(std::abs(d) < 5 * sigma) {
+                profile[i] += height * std::exp(-d * d / (2 * sigma * sigma));
+            }
+        }
+    }
+    Spectrum spectrum;
+    std::vector<double> mzs(nPoints);
+    for(std::size_t i = 0; i < nPoints; ++i) {
+        mzs[i] = firstMz + i * mzStep;
+        spectrum.push_back(SpectrumElement(mzs[i], profile[i]));
+    }
+    std::cout << "Convolving " << nPoints << " grid points with the Orbitrap PSF." << std::endl;
+
+    // per-point width evaluation
+    std::vector<double> direct(nPoints);
+    psfbench::Stopwatch watch;
+    convolveOnUniformGrid(orbi, profile.begin(), profile.end(), firstMz, mzStep, direct.begin(), directConvolution);
+    psfbench::report("  direct, per-point width", watch.seconds(), nPoints, "points");
+
+    // warped coordinates and a single fixed kernel
+    watch.restart();
+    MzExtractor get_mz;
+    IntensityExtractor get_int;
+    ResamplingGrid<WarpedScale<OrbitrapWithOriginFwhm> > grid = makeResamplingGrid(WarpedScale<OrbitrapWithOriginFwhm>(fwhm), fwhm, mzs.front(), mzs.back(), pointsPerFwhm);
+    std::vector<double> warped(grid.size());
+    resampleOnGrid(fwhm, grid, get_mz, get_int, spectrum.begin(), spectrum.end(), warped.begin());
+    const double warpTime = watch.seconds();
+
+    watch.restart();
+    // the fwhm is one in warped coordinates, i.e. 1/step grid points
+    GaussianPeakShape gauss;
+    gauss.setFwhm(1. / grid.getStep());
+    const std::size_t halfKernel = static_cast<std::size_t>(gauss.getSupportThreshold()) + 1;
+    std::vector<double> kernel(2 * halfKernel + 1);
+    for(std::size_t k = 0; k < kernel.size(); ++k) {
+        kernel[k] = gauss.at(static_cast<double>(k) - halfKernel);
+    }
+    std::vector<double> convolved;
+    convolve(warped, kernel, convolved);
+    const double convolveTime = watch.seconds();
+
+    watch.restart();
+    std::vector<double> restored(nPoints);
+    resampleFromGrid(grid, convolved.begin() + halfKernel, mzs.begin(), mzs.end(), restored.begin());
+    // the kernel sums over grid points instead of m/z channels
+    for(std::size_t i = 0; i < nPoints; ++i) {
+        restored[i] *= grid.getStep() * fwhm.at(mzs[i]) / mzStep;
+    }
+    const double unwarpTime = watch.seconds();
+
+    std::cout << "  warped grid: " << grid.size() << " points, kernel length " << kernel.size() << std::endl;
+    psfbench::report("  warp", warpTime, nPoints, "points");
+    psfbench::report("  fixed kernel fft", convolveTime, nPoints, "points");
+    psfbench::report("  unwarp", unwarpTime, nPoints, "points");
+    psfbench::report("  warped total", warpTime + convolveTime + unwarpTime, nPoints, "points");
+
+    double maximum = 0., deviation = 0.;
+    for(std::size_t i = 0; i < nPoints; ++i) {
+        maximum = std::max(maximum, direct[i]);
+        deviation = std::max(deviation, std::abs(direct[i] - restored[i]));
+    }
+    std::cout << "  maximal deviation relative to maximum: " << deviation / maximum << std::endl;
+
+    return 0;
+}
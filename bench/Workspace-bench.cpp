@@ -0,0 +1,141 @@
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <psf/Arena.h>
+#include <psf/Centroid.h>
+#include <psf/PeakParameter.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumAlgorithm.h>
+
+#include "benchdata.h"
+#include "benchmark.hxx"
+
+using namespace psf;
+
+// Every allocation of the program goes through these replacements and is counted.
+namespace
+{
+    std::size_t allocations_ = 0;
+}
+
+void* operator new(std::size_t size) {
+    ++allocations_;
+    void* p = std::malloc(size ? size : 1);
+    if(!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+// Loads, measures and calibrates orbi_ms1.wsv over and over again, once with the
+// allocating functions and once with reused workspaces, and reports the time and the
+// number of heap allocations per scan. After the first scan, the workspace versions
+// don't allocate at all. Then the same for per-scan containers taken from an arena,
+// which is reset between the scans.
+int main()
+{
+    psfbench::silenceLogging();
+    MzExtractor get_mz;
+    IntensityExtractor get_int;
+    const std::string filename = dirTestdata + "/shared_data/orbi_ms1.wsv";
+    const int scans = 200;
+
+    const RegressionMethod methods[] = {leastSquaresRegression, tukeyRegression};
+    const char* methodNames[] = {"least squares", "tukey"};
+    const double noiseFactors[] = {0., 3.};
+    for(int m = 0; m < 2; ++m) {
+        for(int n = 0; n < 2; ++n) {
+            OrbitrapFwhm fwhm;
+            fwhm.setRegressionMethod(methods[m]);
+            fwhm.setNoiseFactorToLearnFrom(noiseFactors[n]);
+            std::cout << "Load, measure and calibrate (" << methodNames[m] << ", noise factor " << noiseFactors[n] << "), " << scans << " scans" << std::endl;
+
+            std::size_t before = allocations_;
+            psfbench::Stopwatch watch;
+            for(int scan = 0; scan < scans; ++scan) {
+                Spectrum spectrum;
+                loadSpectrumElements(spectrum, filename);
+                const std::vector<std::pair<double, double> > widths = measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5);
+                fwhm.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+            }
+            double seconds = watch.seconds();
+            psfbench::report("  allocating, " + std::to_string((allocations_ - before) / scans) + " allocations per scan", seconds, scans, "scans");
+
+            SpectrumLoader loader;
+            Spectrum spectrum;
+            std::vector<std::pair<double, double> > widths;
+            CalibrationWorkspace workspace;
+            // the first scan sizes the buffers
+            loader.load(filename, spectrum);
+            measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 0., widths);
+            fwhm.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end(), workspace);
+
+            before = allocations_;
+            watch.restart();
+            for(int scan = 0; scan < scans; ++scan) {
+                loader.load(filename, spectrum);
+                measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 0., widths);
+                fwhm.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end(), workspace);
+            }
+            seconds = watch.seconds();
+            const std::size_t steadyState = allocations_ - before;
+            psfbench::report("  workspaces, " + std::to_string(steadyState) + " allocations in " + std::to_string(scans) + " scans", seconds, scans, "scans");
+        }
+    }
+
+    typedef std::pair<double, double> MzWidthPair;
+    OrbitrapPeakShapeFunction orbi(1.19781e-06);
+    std::cout << "Load, measure and centroid with per-scan arena containers, " << scans << " scans" << std::endl;
+    for(int a = 0; a < 2; ++a) {
+        Arena arena;
+        SpectrumLoader loader;
+        std::size_t before = allocations_;
+        psfbench::Stopwatch watch;
+        for(int scan = -2; scan < scans; ++scan) {
+            if(scan == 0) {
+                // the first scan sizes the arena, the first reset merges its blocks
+                before = allocations_;
+                watch.restart();
+            }
+            if(a == 0) {
+                Spectrum spectrum;
+                loader.load(filename, spectrum);
+                std::vector<MzWidthPair> widths;
+                measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 0., widths);
+                std::vector<Centroid> centroids(maximalNumberOfCentroids(spectrum.size()));
+                centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.end(), centroids.begin());
+            }
+            else {
+                arena.reset();
+                std::vector<SpectrumElement, ArenaAllocator<SpectrumElement> > spectrum((ArenaAllocator<SpectrumElement>(arena)));
+                loader.load(filename, spectrum);
+                std::vector<MzWidthPair, ArenaAllocator<MzWidthPair> > widths((ArenaAllocator<MzWidthPair>(arena)));
+                measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 0., widths);
+                std::vector<Centroid, ArenaAllocator<Centroid> > centroids(maximalNumberOfCentroids(spectrum.size()), Centroid(), ArenaAllocator<Centroid>(arena));
+                centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.end(), centroids.begin());
+            }
+        }
+        const double seconds = watch.seconds();
+        psfbench::report(std::string(a == 0 ? "  std::allocator, " : "  arena, ") + std::to_string(allocations_ - before) + " allocations in " + std::to_string(scans) + " scans", seconds, scans, "scans");
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#ifndef __BENCHMARK_HXX__
+#define __BENCHMARK_HXX__
+
+#include <iostream>
+#include <string>
+
+#include <psf/Log.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    #include <windows.h>
+#else
+    #include <sys/time.h>
+#endif
+
+/**
+ * Minimal helpers shared by the psf benchmark executables.
+ *
+ * The benchmarks are not unit tests: they print wall clock timings and throughputs to
+ * stdout and always return zero.
+ */
+namespace psfbench
+{
+
+// class Stopwatch
+/**
+ * Measures elapsed wall clock time in seconds.
+ */
+class Stopwatch
+{
+public:
+    Stopwatch() { restart(); }
+
+    void restart() { start_ = now(); }
+
+    double seconds() const { return now() - start_; }
+
+private:
+    static double now() {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return static_cast<double>(counter.QuadPart) / static_cast<double>(frequency.QuadPart);
+#else
+        struct timeval tv;
+        gettimeofday(&tv, 0);
+        return tv.tv_sec + tv.tv_usec * 1e-6;
+#endif
+    }
+
+    double start_;
+};
+
+// silenceLogging()
+/**
+ * Only report warnings and errors, so that the debug logging of the library doesn't
+ * dominate the measured times.
+ */
+inline void silenceLogging() {
+    psf::FILELog::getReportingLevel() = psf::logWARNING;
+}
+
+// report()
+/**
+ * Prints a line like 'name: 0.123 s, 4.5e+06 items/s'.
+ */
+inline void report(const std::string& name, const double seconds, const double items, const std::string& unit) {
+    std::cout << name << ": " << seconds << " s";
+    if(seconds > 0) {
+        std::cout << ", " << items / seconds << " " << unit << "/s";
+    }
+    std::cout << std::endl;
+}
+
+} /* namespace psfbench */
+
+#endif /*__BENCHMARK_HXX__*/
@@ -0,0 +1,71 @@
+#ifndef __SYNTHETIC_HXX__
+#define __SYNTHETIC_HXX__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include <psf/PeakParameter.h>
+#include <psf/Spectrum.h>
+
+/**
+ * Synthetic profile spectra for the psf benchmarks.
+ */
+namespace psfbench
+{
+
+// syntheticSpectrum()
+/**
+ * Gaussian peaks with Orbitrap widths (fwhm = a * mz^1.5) between firstMz and lastMz.
+ *
+ * A fraction of the peaks gets a close neighbour, so that both merge into one wide bump,
+ * and every element gets multiplicative noise of the given relative size. Elements are
+ * sampled with 20 points per FWHM; zero intensities are dropped like psf::operator>>()
+ * does.
+ */
+inline psf::Spectrum syntheticSpectrum(const double a, const std::size_t nPeaks, const double firstMz, const double lastMz,
+                                       const double overlapFraction, const double noise, const unsigned seed = 42) {
+    psf::OrbitrapWithOriginFwhm truth;
+    truth.setA(a);
+    std::srand(seed);
+
+    std::vector<std::pair<double, double> > peaks;
+    for(std::size_t i = 0; i < nPeaks; ++i) {
+        const double mz = firstMz + (lastMz - firstMz) * std::rand() / (RAND_MAX + 1.);
+        const double height = 100. + std::rand() % 10000;
+        peaks.push_back(std::make_pair(mz, height));
+        if(std::rand() < overlapFraction * RAND_MAX) {
+            peaks.push_back(std::make_pair(mz + (0.5 + 0.3 * std::rand() / RAND_MAX) * truth.at(mz), height * (0.5 + 0.5 * std::rand() / RAND_MAX)));
+        }
+    }
+    std::sort(peaks.begin(), peaks.end());
+
+    psf::Spectrum spectrum;
+    double mz = peaks.front().first - 4 * truth.at(peaks.front().first);
+    std::size_t firstPeak = 0;
+    while(firstPeak < peaks.size()) {
+        // skip the empty space in front of the next peak
+        mz = std::max(mz, peaks[firstPeak].first - 4 * truth.at(peaks[firstPeak].first));
+        double intensity = 0.;
+        for(std::size_t p = firstPeak; p < peaks.size() && peaks[p].first < mz + 4 * truth.at(mz); ++p) {
+            const double sigma = truth.at(peaks[p].first) / 2.3548;
+            const double d = mz - peaks[p].first;
+            intensity += peaks[p].second * std::exp(-d * d / (2 * sigma * sigma));
+        }
+        intensity *= 1. + noise * (2. * std::rand() / RAND_MAX - 1.);
+        if(intensity > 0) {
+            spectrum.push_back(psf::SpectrumElement(mz, intensity));
+        }
+        mz += truth.at(mz) / 20.;
+        while(firstPeak < peaks.size() && peaks[firstPeak].first + 4 * truth.at(peaks[firstPeak].first) < mz) {
+            ++firstPeak;
+        }
+    }
+    return spectrum;
+}
+
+} /* namespace psfbench */
+
+#endif /*__SYNTHETIC_HXX__*/
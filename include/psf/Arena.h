@@ -0,0 +1,237 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+#include <psf/config.h>
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * @page arena Arena Allocation
+ *
+ * Processing a scan creates a handful of short lived containers: the loaded elements, the
+ * measured widths, the peak list. With std::allocator, every one of them goes through the
+ * general purpose heap, once per scan and often several times while growing.
+ *
+ * A psf::Arena hands out memory from large blocks by bumping an offset and frees nothing
+ * until it is reset, which releases everything at once. psf::ArenaAllocator plugs an arena
+ * into the standard containers, so a per-scan driver writes
+ *
+ * @code
+ * psf::Arena arena;
+ * for(...) {
+ *     arena.reset();
+ *     std::vector<psf::SpectrumElement, psf::ArenaAllocator<psf::SpectrumElement> > spectrum((psf::ArenaAllocator<psf::SpectrumElement>(arena)));
+ *     psf::loadSpectrumElements(spectrum, filename);
+ *     ...
+ * }
+ * @endcode
+ *
+ * The spectrum containers and loaders (psf::Spectrum.h), the measureFullWidths()
+ * versions filling a vector and psf::centroid() accept containers with any allocator.
+ *
+ * An arena is not synchronized. Multi-threaded drivers lease one arena per running task
+ * from a psf::ArenaPool.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class Arena
+/**
+ * A monotonic memory arena.
+ *
+ * Memory is taken from blocks of at least the block size. Deallocation is a no-op, except
+ * for the most recent allocation, which is taken back (a temporary buffer released right
+ * away doesn't consume memory). A vector growing element by element leaves its previous
+ * buffers behind, about as much memory again as its final capacity; reserve() avoids
+ * that. reset() makes all memory available again.
+ * If the allocations since the last reset spilled into several blocks, they are replaced
+ * by a single block large enough for all of them; so a driver reaches a steady state
+ * without any allocation from the heap after the largest scan.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT Arena
+{
+public:
+    /**
+     * @param blockSize Minimal size of a block in bytes; the first block is allocated on
+     *      the first allocation.
+     */
+    explicit Arena(std::size_t blockSize = 1 << 16);
+    ~Arena();
+
+    // allocate()
+    /**
+     * Memory for bytes bytes at a multiple of alignment.
+     *
+     * @param alignment Has to be a power of two.
+     * @throw std::bad_alloc A new block couldn't be allocated.
+     */
+    void* allocate(std::size_t bytes, std::size_t alignment);
+
+    // deallocate()
+    /**
+     * Takes the memory back, if it is the most recent allocation; does nothing else.
+     */
+    void deallocate(void* p, std::size_t bytes);
+
+    // reset()
+    /**
+     * Makes all memory of the arena available again. Everything allocated before is
+     * invalidated.
+     */
+    void reset();
+
+    /**
+     * Bytes consumed since the last reset, including alignment padding and the unused
+     * ends of full blocks.
+     */
+    std::size_t bytesUsed() const;
+
+    /**
+     * Total size of the blocks.
+     */
+    std::size_t capacity() const;
+
+    std::size_t numberOfBlocks() const;
+
+private:
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+    struct Block
+    {
+        char* data;
+        std::size_t size;
+    };
+
+    void addBlock_(std::size_t minimalSize);
+    void release_();
+
+    std::vector<Block> blocks_;
+    std::size_t current_; // index of the block allocations are taken from
+    std::size_t offset_; // into the current block
+    std::size_t used_; // in the blocks before the current one
+    std::size_t blockSize_;
+};
+
+// class ArenaAllocator
+/**
+ * A standard allocator taking its memory from a psf::Arena.
+ *
+ * Copies (also rebound ones) share the arena and compare equal. The arena has to outlive
+ * every container using it; a reset of the arena invalidates the containers.
+ */
+template< typename T >
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    template< typename U >
+    struct rebind
+    {
+        typedef ArenaAllocator<U> other;
+    };
+
+    explicit ArenaAllocator(Arena& arena) : arena_(&arena) {}
+
+    template< typename U >
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(&other.arena()) {}
+
+    T* allocate(const std::size_t n) {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, const std::size_t n) {
+        arena_->deallocate(p, n * sizeof(T));
+    }
+
+    Arena& arena() const { return *arena_; }
+
+private:
+    Arena* arena_;
+};
+
+template< typename T, typename U >
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return &a.arena() == &b.arena();
+}
+
+template< typename T, typename U >
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return !(a == b);
+}
+
+// class ArenaPool
+/**
+ * Arenas for the tasks of a multi-threaded driver.
+ *
+ * A task leases an arena with a psf::ArenaLease; at the end of the lease the arena is
+ * reset and returned to the pool. The pool creates a new arena only if all are leased,
+ * so it holds at most as many arenas as tasks ran concurrently, each warmed up by the
+ * previous tasks. Leasing and returning are synchronized; the arenas themselves are used
+ * by one task at a time.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT ArenaPool
+{
+public:
+    /**
+     * @param blockSize Block size of the arenas created by the pool.
+     */
+    explicit ArenaPool(std::size_t blockSize = 1 << 16);
+
+    /**
+     * Every lease has to end before the pool is destroyed.
+     */
+    ~ArenaPool();
+
+    /**
+     * Number of arenas created so far.
+     */
+    std::size_t size() const;
+
+private:
+    friend class ArenaLease;
+
+    ArenaPool(const ArenaPool&);
+    ArenaPool& operator=(const ArenaPool&);
+
+    Arena* acquire_();
+    void release_(Arena* arena);
+
+    mutable std::mutex mutex_;
+    std::vector<Arena*> arenas_;
+    std::vector<Arena*> free_;
+    std::size_t blockSize_;
+};
+
+// class ArenaLease
+/**
+ * Exclusive use of an arena of a psf::ArenaPool for the lifetime of the lease.
+ */
+class PSF_EXPORT ArenaLease
+{
+public:
+    explicit ArenaLease(ArenaPool& pool);
+    ~ArenaLease();
+
+    Arena& arena() const;
+
+private:
+    ArenaLease(const ArenaLease&);
+    ArenaLease& operator=(const ArenaLease&);
+
+    ArenaPool& pool_;
+    Arena* arena_;
+};
+
+} /* namespace psf */
+
+#endif /*__ARENA_H__*/
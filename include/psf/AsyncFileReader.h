@@ -0,0 +1,131 @@
+#ifndef __ASYNCFILEREADER_H__
+#define __ASYNCFILEREADER_H__
+#include <psf/config.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <psf/Spectrum.h>
+
+/**
+ * @page asyncfilereader Overlapping Reading and Parsing
+ *
+ * psf::SpectrumLoader reads a file and then parses it, so the parser waits for the disk
+ * and the disk for the parser. A psf::AsyncFileReader keeps the reads of the next files
+ * in flight while the current one is parsed:
+ *
+ * @code
+ * psf::AsyncFileReader reader(psf::SpectrumBatch::listDirectory("archive/run42"), 16);
+ * psf::Spectrum spectrum;
+ * while(reader.next(spectrum)) {
+ *     ... process spectrum of reader.filename() ...
+ * }
+ * @endcode
+ *
+ * On Linux the reads are submitted to the kernel with io_uring, if the kernel supports it;
+ * a single thread drives the ring. Otherwise a pool of threads reads the files with
+ * pread(). Either way the files are delivered in order and the buffers are recycled, so
+ * that steady state reading doesn't allocate memory.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class AsyncFileReader
+/**
+ * Reads a list of files ahead of the consumer with a number of reads in flight.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT AsyncFileReader
+{
+public:
+    enum Backend { anyBackend, ioUringBackend, threadBackend };
+
+    /**
+     * @param depth Maximal number of files read ahead.
+     * @param backend anyBackend prefers io_uring and falls back to threads.
+     * @throw psf::RuntimeError The io_uring backend was requested but isn't available.
+     */
+    AsyncFileReader(const std::vector<std::string>& filenames, unsigned depth = 8, Backend backend = anyBackend);
+    ~AsyncFileReader();
+
+    // next()
+    /**
+     * Waits for the next file and swaps its content into text, followed by a nul.
+     *
+     * The previous content of text is reused for a later read.
+     *
+     * @return false, if all files have been read.
+     * @throw psf::RuntimeError The file couldn't be read, or its read couldn't be
+     *      submitted to io_uring. The reader continues with the following file. If
+     *      waiting on io_uring failed, the file is still being read and the next call
+     *      waits for it again.
+     */
+    bool next(std::vector<char>& text);
+
+    /**
+     * Parses the next file like psf::SpectrumLoader::load().
+     */
+    template< typename Allocator >
+    bool next(std::vector<SpectrumElement, Allocator>& s) {
+        if(!next(text_)) {
+            return false;
+        }
+        s.clear();
+        SpectrumLoader::parse(&text_[0], s);
+        return true;
+    }
+
+    /**
+     * Name of the file returned by the last call of next().
+     */
+    const std::string& filename() const { return filename_; }
+
+    std::size_t numberOfFiles() const { return filenames_.size(); }
+
+    Backend backend() const { return backend_; }
+
+    /**
+     * Whether the kernel supports io_uring (and the library was built with it).
+     */
+    static bool ioUringAvailable();
+
+    // injectIoUringFaults()
+    /**
+     * Only for unit testing: the io_uring backend of readers constructed afterwards reads
+     * at most readSize bytes at a time (zero means the rest of the file), and its
+     * failingSubmission-th submission (counted from one, zero means none) fails as if
+     * io_uring_enter had failed.
+     */
+    static void injectIoUringFaults(std::size_t readSize, std::size_t failingSubmission);
+
+private:
+    AsyncFileReader(const AsyncFileReader&);
+    AsyncFileReader& operator=(const AsyncFileReader&);
+
+    struct Slot_;
+    class Engine_;
+    class IoUring_;
+    class ThreadPool_;
+
+    void start_(std::size_t file);
+
+    std::vector<std::string> filenames_;
+    std::unique_ptr<Slot_[]> slots_;
+    std::size_t depth_;
+    std::unique_ptr<Engine_> engine_;
+    Backend backend_;
+    std::size_t next_;    // file returned by the next call of next()
+    std::size_t started_; // files whose reading started
+    std::string filename_;
+    std::vector<char> text_;
+};
+
+} /* namespace psf */
+
+#endif /*__ASYNCFILEREADER_H__*/
@@ -0,0 +1,132 @@
+#ifndef __BOUNDEDQUEUE_H__
+#define __BOUNDEDQUEUE_H__
+#include <psf/config.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace psf
+{
+
+// class BoundedQueue
+/**
+ * A lock-free first-in first-out queue of fixed capacity for any number of producer and
+ * consumer threads.
+ *
+ * Every slot of the ring buffer carries a sequence number, which tells producers and
+ * consumers whether the slot is free or filled for their turn (D. Vyukov's bounded MPMC
+ * queue). Pushing and popping take one compare-and-swap each and never block: tryPush()
+ * fails if the queue is full, tryPop() if it is empty. Waiting is left to the caller.
+ *
+ * T has to be default constructible and copy assignable; the values are copied into and
+ * out of the preallocated slots, so small types like indices work best.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+template< typename T >
+class BoundedQueue
+{
+public:
+    /**
+     * @param capacity Rounded up to a power of two, at least two.
+     */
+    explicit BoundedQueue(std::size_t capacity) : mask_(0) {
+        std::size_t size = 2;
+        while(size < capacity) {
+            size *= 2;
+        }
+        mask_ = size - 1;
+        cells_.reset(new Cell_[size]);
+        for(std::size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePosition_.store(0, std::memory_order_relaxed);
+        dequeuePosition_.store(0, std::memory_order_relaxed);
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    // tryPush()
+    /**
+     * @return false, if the queue is full.
+     */
+    bool tryPush(const T& value) {
+        Cell_* cell;
+        std::size_t position = enqueuePosition_.load(std::memory_order_relaxed);
+        while(true) {
+            cell = &cells_[position & mask_];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if(difference == 0) {
+                if(enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if(difference < 0) {
+                return false;
+            }
+            else {
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // tryPop()
+    /**
+     * @return false, if the queue is empty.
+     */
+    bool tryPop(T& value) {
+        Cell_* cell;
+        std::size_t position = dequeuePosition_.load(std::memory_order_relaxed);
+        while(true) {
+            cell = &cells_[position & mask_];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+            if(difference == 0) {
+                if(dequeuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if(difference < 0) {
+                return false;
+            }
+            else {
+                position = dequeuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+        value = cell->value;
+        cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    BoundedQueue(const BoundedQueue&);
+    BoundedQueue& operator=(const BoundedQueue&);
+
+    struct Cell_
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    // size of a cache line
+    static const std::size_t lineSize_ = 64;
+
+    std::unique_ptr<Cell_[]> cells_;
+    std::size_t mask_;
+    // on their own cache lines, so that producers and consumers don't contend; padded
+    // instead of aligned, since new doesn't align beyond the fundamental alignment
+    char padding0_[lineSize_];
+    std::atomic<std::size_t> enqueuePosition_;
+    char padding1_[lineSize_ - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> dequeuePosition_;
+    char padding2_[lineSize_ - sizeof(std::atomic<std::size_t>)];
+};
+
+} /* namespace psf */
+
+#endif /*__BOUNDEDQUEUE_H__*/
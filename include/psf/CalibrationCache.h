@@ -0,0 +1,344 @@
+#ifndef __CALIBRATIONCACHE_H__
+#define __CALIBRATIONCACHE_H__
+#include <psf/config.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/Log.h>
+#include <psf/NoiseThreshold.h>
+#include <psf/PeakParameter.h>
+#include <psf/Regression.h>
+#include <psf/SpectrumAlgorithm.h>
+
+/**
+ * @page calibrationcache Caching Calibrations
+ *
+ * The same instrument method yields nearly the same FWHM parameters in every run. A
+ * psf::CalibrationCache stores learned psf::PeakParameterFwhm parameters together with the
+ * model type, the m/z range and quality statistics of the calibration in a small text
+ * file. The records are keyed by a fingerprint chosen by the user, for example the
+ * instrument serial number and the name of the acquisition method.
+ *
+ * psf::calibrateWithCache() validates a cached record against a small sample of the peaks
+ * of a new spectrum and only calibrates from scratch, if the sample doesn't fit the cached
+ * model.
+ *
+ * @code
+ * psf::CalibrationCache cache("calibrations.txt");
+ * psf::OrbitrapFwhm fwhm;
+ * psf::calibrateWithCache(cache, "orbitrap-01/top10", fwhm, get_mz, get_int, s.begin(), s.end());
+ * @endcode
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// struct CalibrationRecord
+/**
+ * A learned peak parameter model and the quality of the calibration.
+ *
+ * The residuals are relative to the modelled FWHM: (width - fwhm(mz)) / fwhm(mz).
+ */
+struct PSF_EXPORT CalibrationRecord
+{
+    CalibrationRecord();
+
+    /**
+     * Name of the ParameterModel; see psf::ParameterModelName.
+     */
+    std::string model;
+    RegressionMethod regressionMethod;
+    std::vector<double> parameters;
+
+    /**
+     * m/z range of the calibration spectrum.
+     */
+    double firstMz, lastMz;
+
+    /**
+     * Number of measured peaks the model was learned from.
+     */
+    std::size_t numberOfPeaks;
+
+    /**
+     * Median of the relative residuals; the bias of the model.
+     */
+    double medianRelativeResidual;
+
+    /**
+     * Median of the absolute relative residuals; the spread around the model.
+     */
+    double medianAbsoluteRelativeResidual;
+};
+
+// class CalibrationCache
+/**
+ * Calibration records on disk keyed by a fingerprint.
+ *
+ * The whole store is read on construction and rewritten on every change. A new file is
+ * written and renamed over the old one, so that a crash never leaves a truncated store.
+ * The file is a text file with one tab separated record per line.
+ *
+ * @attention A CalibrationCache is not synchronized. Don't share it (or its file) between
+ *      concurrently writing threads or processes.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT CalibrationCache
+{
+public:
+    /**
+     * Opens the store in the given file.
+     *
+     * A missing file is an empty store; it is created on the first store().
+     *
+     * @throw psf::RuntimeError The file exists, but is not a valid calibration store.
+     */
+    explicit CalibrationCache(const std::string& filename);
+
+    // find()
+    /**
+     * @param record Left unchanged, if there is no record for the fingerprint.
+     * @return True, if a record for the fingerprint was found.
+     */
+    bool find(const std::string& fingerprint, CalibrationRecord& record) const;
+
+    // store()
+    /**
+     * Adds or replaces the record for a fingerprint and writes the store to disk.
+     *
+     * @param fingerprint Non-empty and without tabs or line breaks.
+     * @throw psf::PreconditionViolation Invalid fingerprint or record without parameters.
+     * @throw psf::RuntimeError The store couldn't be written.
+     */
+    void store(const std::string& fingerprint, const CalibrationRecord& record);
+
+    // erase()
+    /**
+     * Removes the record for a fingerprint and writes the store to disk.
+     *
+     * @return True, if there was a record for the fingerprint.
+     * @throw psf::RuntimeError The store couldn't be written.
+     */
+    bool erase(const std::string& fingerprint);
+
+    std::size_t size() const;
+    const std::string& getFilename() const;
+
+private:
+    void load_();
+    void save_() const;
+
+    std::string filename_;
+    std::map<std::string, CalibrationRecord> records_;
+};
+
+// struct ParameterModelName
+/**
+ * The name of a ParameterModel as stored in a psf::CalibrationRecord.
+ *
+ * Specialize it for your own models to use them with the psf::CalibrationCache.
+ */
+template< typename ParameterModel >
+struct ParameterModelName;
+
+template<> struct ParameterModelName<ConstantModel> {
+    static const char* name() { return "ConstantModel"; }
+};
+template<> struct ParameterModelName<LinearSqrtModel> {
+    static const char* name() { return "LinearSqrtModel"; }
+};
+template<> struct ParameterModelName<LinearSqrtOriginModel> {
+    static const char* name() { return "LinearSqrtOriginModel"; }
+};
+template<> struct ParameterModelName<SqrtModel> {
+    static const char* name() { return "SqrtModel"; }
+};
+template<> struct ParameterModelName<QuadraticModel> {
+    static const char* name() { return "QuadraticModel"; }
+};
+
+// makeCalibrationRecord()
+/**
+ * Records the current parameters of fwhm and the quality of the calibration.
+ *
+ * @param pairs The measured (m/z | width) pairs, fwhm was learned from.
+ * @param firstMz m/z range of the calibration spectrum.
+ * @param lastMz m/z range of the calibration spectrum.
+ * @throw psf::PreconditionViolation Parameter pairs is empty.
+ */
+template< typename ParameterModel, typename MzWidthPairs >
+CalibrationRecord makeCalibrationRecord(PeakParameterFwhm<ParameterModel>& fwhm, const MzWidthPairs& pairs, double firstMz, double lastMz);
+
+// applyCalibrationRecord()
+/**
+ * Sets the parameters of fwhm to the recorded ones.
+ *
+ * The regression method of fwhm is left unchanged.
+ *
+ * @throw psf::PreconditionViolation The record is for a different ParameterModel.
+ */
+template< typename ParameterModel >
+void applyCalibrationRecord(const CalibrationRecord& record, PeakParameterFwhm<ParameterModel>& fwhm);
+
+// enum CalibrationOutcome
+/**
+ * What psf::calibrateWithCache() did.
+ *
+ * calibrationLearned: There was no usable record; the model was learned and stored.
+ * calibrationReused: The cached record fitted the spectrum and was applied.
+ * calibrationRelearned: The spectrum didn't fit the cached record; the model was learned
+ *                       and the record replaced.
+ */
+enum PSF_EXPORT CalibrationOutcome {calibrationLearned, calibrationReused, calibrationRelearned};
+
+// calibrateWithCache()
+/**
+ * Calibrates fwhm for a spectrum, reusing a cached calibration if it still fits.
+ *
+ * The widths of about sampleSize peaks, taken from blocks spread evenly over the spectrum,
+ * are compared with the cached model. The record is reused, if
+ * - it is for the same ParameterModel,
+ * - every sampled peak is inside the cached m/z range widened by 10% on both sides,
+ * - the median relative residual of the sample deviates from the cached one by at most
+ *   relativeTolerance and
+ * - the median absolute relative residual of the sample exceeds the cached one by at most
+ *   relativeTolerance.
+ *
+ * Else, fwhm learns from the whole spectrum with psf::PeakParameterFwhm::learnFrom() and
+ * the new record, made from the widths measured while learning, replaces the cached one.
+ * The minimal peak height, noise factor and regression method of fwhm are respected in
+ * both cases; the sample is measured above psf::PeakParameterFwhm::thresholdToLearnFrom()
+ * like the peaks learned from. With a noise factor, estimating the threshold takes a pass
+ * over the spectrum. The extractors have to return double values.
+ *
+ * @param relativeTolerance Has to be positive.
+ * @param sampleSize Number of peaks to validate the cached record with; at least 10.
+ * @throw psf::PreconditionViolation Invalid relativeTolerance or sampleSize.
+ * @throw psf::Starvation The spectrum had to be learned from, but it is too small.
+ * @throw psf::RuntimeError The store couldn't be written.
+ */
+template< typename ParameterModel, typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor >
+CalibrationOutcome calibrateWithCache(CalibrationCache& cache, const std::string& fingerprint, PeakParameterFwhm<ParameterModel>& fwhm, const MzExtractor& get_mz, const IntensityExtractor& get_int, RandomAccessIter first, RandomAccessIter last, double relativeTolerance = 0.05, std::size_t sampleSize = 64);
+
+
+
+/******************/
+/* implementation */
+/******************/
+
+namespace {
+    // The median of the relative residuals (signed or absolute) of the pairs.
+    template< typename ParameterModel, typename MzWidthPairs >
+    double medianRelativeResidual_(const PeakParameterFwhm<ParameterModel>& fwhm, const MzWidthPairs& pairs, const bool absolute) {
+        std::vector<double> residuals;
+        residuals.reserve(pairs.size());
+        for(typename MzWidthPairs::const_iterator pair = pairs.begin(); pair != pairs.end(); ++pair) {
+            const double model = fwhm.at(pair->first);
+            const double residual = (pair->second - model) / model;
+            residuals.push_back(absolute ? std::abs(residual) : residual);
+        }
+        const std::vector<double>::iterator middle = residuals.begin() + residuals.size() / 2;
+        std::nth_element(residuals.begin(), middle, residuals.end());
+        return *middle;
+    }
+} /* anonymous namespace */
+
+// makeCalibrationRecord()
+template< typename ParameterModel, typename MzWidthPairs >
+CalibrationRecord makeCalibrationRecord(PeakParameterFwhm<ParameterModel>& fwhm, const MzWidthPairs& pairs, const double firstMz, const double lastMz) {
+    psf_precondition(!pairs.empty(), "makeCalibrationRecord(): Parameter pairs is empty.");
+    CalibrationRecord record;
+    record.model = ParameterModelName<ParameterModel>::name();
+    record.regressionMethod = fwhm.getRegressionMethod();
+    for(unsigned i = 0; i < fwhm.numberOfParameters(); ++i) {
+        record.parameters.push_back(fwhm.getParameter(i));
+    }
+    record.firstMz = firstMz;
+    record.lastMz = lastMz;
+    record.numberOfPeaks = pairs.size();
+    record.medianRelativeResidual = medianRelativeResidual_(fwhm, pairs, false);
+    record.medianAbsoluteRelativeResidual = medianRelativeResidual_(fwhm, pairs, true);
+    return record;
+}
+
+// applyCalibrationRecord()
+template< typename ParameterModel >
+void applyCalibrationRecord(const CalibrationRecord& record, PeakParameterFwhm<ParameterModel>& fwhm) {
+    psf_precondition(record.model == ParameterModelName<ParameterModel>::name(), "applyCalibrationRecord(): Record is for a different parameter model.");
+    psf_precondition(record.parameters.size() == fwhm.numberOfParameters(), "applyCalibrationRecord(): Wrong number of parameters in record.");
+    for(unsigned i = 0; i < fwhm.numberOfParameters(); ++i) {
+        fwhm.setParameter(i, record.parameters[i]);
+    }
+}
+
+// calibrateWithCache()
+template< typename ParameterModel, typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor >
+CalibrationOutcome calibrateWithCache(CalibrationCache& cache, const std::string& fingerprint, PeakParameterFwhm<ParameterModel>& fwhm, const MzExtractor& get_mz, const IntensityExtractor& get_int, RandomAccessIter first, RandomAccessIter last, const double relativeTolerance, const std::size_t sampleSize) {
+    typedef std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> > MzWidthPairs_;
+    psf_precondition(relativeTolerance > 0, "calibrateWithCache(): Parameter relativeTolerance has to be positive.");
+    psf_precondition(sampleSize >= 10, "calibrateWithCache(): Parameter sampleSize has to be at least 10.");
+
+    CalibrationRecord record;
+    const bool cached = cache.find(fingerprint, record) && record.model == ParameterModelName<ParameterModel>::name() && record.parameters.size() == fwhm.numberOfParameters();
+    if(cached) {
+        // Sample the blocks in bit reversed order (0, 1/2, 1/4, 3/4, ...): every prefix of
+        // the sequence is spread evenly over the spectrum.
+        const std::size_t nBlocks = 64;
+        const std::ptrdiff_t size = last - first;
+        // the peaks learnFrom() would use, so that the sample matches the record
+        const NoiseThreshold threshold = fwhm.thresholdToLearnFrom(get_mz, get_int, first, last);
+        MzWidthPairs_ sample;
+        for(std::size_t i = 0; i < nBlocks && sample.size() < sampleSize; ++i) {
+            std::size_t block = 0;
+            for(std::size_t bit = 1, reversed = nBlocks / 2; bit < nBlocks; bit <<= 1, reversed >>= 1) {
+                if(i & bit) {
+                    block |= reversed;
+                }
+            }
+            const RandomAccessIter blockFirst = first + static_cast<std::ptrdiff_t>(block * size / nBlocks);
+            const RandomAccessIter blockLast = first + static_cast<std::ptrdiff_t>((block + 1) * size / nBlocks);
+            measureBumps_(get_mz, get_int, first, blockFirst, blockLast, last, fwhm.getFractionOfMaximum(), AboveThreshold_(threshold), sample);
+        }
+
+        if(sample.size() >= 10) {
+            PeakParameterFwhm<ParameterModel> cachedFwhm;
+            applyCalibrationRecord(record, cachedFwhm);
+            const double margin = 0.1 * (record.lastMz - record.firstMz);
+            bool fits = true;
+            for(typename MzWidthPairs_::const_iterator pair = sample.begin(); pair != sample.end(); ++pair) {
+                if(pair->first < record.firstMz - margin || pair->first > record.lastMz + margin) {
+                    fits = false;
+                    break;
+                }
+            }
+            fits = fits && std::abs(medianRelativeResidual_(cachedFwhm, sample, false) - record.medianRelativeResidual) <= relativeTolerance;
+            fits = fits && medianRelativeResidual_(cachedFwhm, sample, true) - record.medianAbsoluteRelativeResidual <= relativeTolerance;
+            if(fits) {
+                applyCalibrationRecord(record, fwhm);
+                PSF_LOG(logDEBUG) << "calibrateWithCache(): Reused calibration '" << fingerprint << "' validated with " << sample.size() << " peaks.";
+                return calibrationReused;
+            }
+        }
+        PSF_LOG(logINFO) << "calibrateWithCache(): Cached calibration '" << fingerprint << "' doesn't fit the spectrum; relearning.";
+    }
+
+    // the record is made from the pairs learned from, so the spectrum is measured once
+    CalibrationWorkspace workspace;
+    fwhm.learnFrom(get_mz, get_int, first, last, workspace);
+    cache.store(fingerprint, makeCalibrationRecord(fwhm, workspace.widthPairs(), get_mz(*first), get_mz(*(last - 1))));
+    return cached ? calibrationRelearned : calibrationLearned;
+}
+
+} /* namespace psf */
+
+#endif /*__CALIBRATIONCACHE_H__*/
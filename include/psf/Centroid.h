@@ -0,0 +1,304 @@
+#ifndef __CENTROID_H__
+#define __CENTROID_H__
+#include <psf/config.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+#include <psf/Error.h>
+#include <psf/SpectrumAlgorithm.h>
+
+/**
+ * @page centroid Centroiding
+ *
+ * Centroiding turns a profile spectrum into a peak list: one psf::Centroid with an apex
+ * position, an apex intensity and an area per peak.
+ *
+ * psf::centroid() walks the spectrum once. Every strict local maximum is the top of a
+ * bump (see psf::findBump()); the apex is interpolated from the elements around the top
+ * and the bump is integrated within the support of the peak shape function at the apex.
+ * Two apex interpolations are available:
+ *
+ * @li psf::gaussianThreePoint fits a parabola to the logarithms of the intensities of the
+ *     top and its two neighbours. This is exact for noise free Gaussian peaks and needs
+ *     no peak shape function evaluations.
+ * @li psf::peakShapeFit fits the calibrated peak shape function (scaled to the best
+ *     height in the least squares sense) to the bump elements within its support, by a
+ *     golden section search for the apex between the neighbours of the top. More
+ *     robust against noise and non-Gaussian shapes, but slower.
+ *
+ * The throughput depends on the density of the peaks and on the machine. On one core,
+ * bench_centroid measures 0.75 to 1.3e8 elements per second for psf::gaussianThreePoint on
+ * orbi_ms1.wsv (a peak every 6 elements), where the upper end needs an otherwise idle
+ * machine; the sparser synthetic spectrum reaches about 1.5e8. psf::peakShapeFit is 20 to
+ * 50 times slower.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// struct Centroid
+/**
+ * A peak of a profile spectrum reduced to a single point.
+ */
+struct PSF_EXPORT Centroid
+{
+    Centroid() : mz(0.), intensity(0.), area(0.) {}
+    Centroid(const double m, const double i, const double a) : mz(m), intensity(i), area(a) {}
+
+    /**
+     * Interpolated apex position.
+     */
+    double mz;
+
+    /**
+     * Interpolated apex intensity.
+     */
+    double intensity;
+
+    /**
+     * Trapezoidal integral of the profile in intensity times m/z units.
+     */
+    double area;
+};
+
+// enum ApexInterpolation
+/**
+ * How psf::centroid() interpolates the apex of a peak.
+ *
+ * gaussianThreePoint: Parabola through the logarithms of the intensities of the top and
+ *                     its two neighbours.
+ * peakShapeFit: Least squares fit of the peak shape function.
+ */
+enum PSF_EXPORT ApexInterpolation {gaussianThreePoint, peakShapeFit};
+
+// maximalNumberOfCentroids()
+/**
+ * An upper bound of the number of centroids psf::centroid() writes for a sequence of
+ * nElements elements: every second element at most is a strict local maximum.
+ */
+inline std::size_t maximalNumberOfCentroids(const std::size_t nElements) {
+    return (nElements < 3) ? 0 : (nElements - 1) / 2;
+}
+
+// centroid()
+/**
+ * Centroids a profile spectrum.
+ *
+ * Every strict local maximum at least as high as minimalPeakHeight yields one centroid,
+ * in ascending order of m/z. The bump around the maximum (the strictly increasing and
+ * decreasing slopes, see psf::findBump()) is integrated within +/- psf.getSupportThreshold()
+ * of the apex.
+ *
+ * The spectrum is processed in one pass without allocating memory. The caller
+ * provides the output; psf::maximalNumberOfCentroids(last - first) elements are always
+ * sufficient.
+ *
+ * @param psf A calibrated peak shape function like psf::OrbitrapPeakShapeFunction.
+ * @param first Points to the first element of a profile spectrum in ascending m/z order.
+ * @param last Points to one past the last element.
+ * @param result Receives psf::Centroid objects.
+ * @param interpolation Apex interpolation method.
+ * @param minimalPeakHeight Maxima below this intensity are skipped.
+ * @return One past the last written centroid.
+ */
+template< typename PeakShapeFunction, typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor, typename OutIter >
+OutIter centroid(const PeakShapeFunction& psf, const MzExtractor&, const IntensityExtractor&, RandomAccessIter first, RandomAccessIter last, OutIter result, ApexInterpolation interpolation = gaussianThreePoint, typename IntensityExtractor::result_type minimalPeakHeight = 0);
+
+
+
+/******************/
+/* implementation */
+/******************/
+
+namespace
+{
+    // Maximal number of elements a peak shape fit considers; more elements of a peak are
+    // far from the apex and add little to its position.
+    const std::ptrdiff_t maximalFitWindow_ = 64;
+
+    // Number of peaks found before their apexes and supports are computed: the logarithms
+    // and widths of the peaks of a block are independent of each other and overlap.
+    const std::size_t peakBlock_ = 32;
+
+    // threePointApex_()
+    // Vertex (position, value) of the parabola through the logarithms of three intensities.
+    // The middle intensity has to be the largest. Without positive neighbours, the parabola
+    // goes through the intensities themselves.
+    inline std::pair<double, double> threePointApex_(const double x0, const double y0, const double x1, const double y1, const double x2, const double y2) {
+        const bool logarithmic = y0 > 0 && y2 > 0;
+        // relative to the middle, so that two logarithms suffice
+        const double l0 = logarithmic ? std::log(y0 / y1) : y0 - y1;
+        const double l2 = logarithmic ? std::log(y2 / y1) : y2 - y1;
+        const double d0 = x0 - x1;
+        const double d2 = x2 - x1;
+        const double s0 = l0 / d0;
+        const double s2 = l2 / d2;
+        // l(x) = a(x - x1)^2 + b(x - x1) with a < 0
+        const double a = (s0 - s2) / (d0 - d2);
+        const double b = s0 - a * d0;
+        const double value = -b * b / (4. * a);
+        return std::make_pair(x1 - b / (2. * a), logarithmic ? y1 * std::exp(value) : y1 + value);
+    }
+
+    // peakShapeFitQuality_()
+    // Squared correlation (sum y p)^2 / sum p^2 of the intensities with the peak shape at
+    // apex; the scale (sum y p) / (sum p^2) is returned in height.
+    template< typename PeakShapeFunction >
+    double peakShapeFitQuality_(const PeakShapeFunction& psf, const double apex, const double* mzs, const double* intensities, const std::ptrdiff_t n, double* shape, double& height) {
+        psf.evaluate(apex, mzs, mzs + n, shape);
+        double yp = 0., pp = 0.;
+        for(std::ptrdiff_t i = 0; i < n; ++i) {
+            yp += intensities[i] * shape[i];
+            pp += shape[i] * shape[i];
+        }
+        if(!(pp > 0)) {
+            height = 0.;
+            return 0.;
+        }
+        height = yp / pp;
+        return yp * yp / pp;
+    }
+
+    // peakShapeFitApex_()
+    // Golden section search for the apex in [lower, upper] maximizing the fit quality.
+    // Returns (position, intensity) or (guess, -1) if the peak shape vanishes everywhere.
+    template< typename PeakShapeFunction >
+    std::pair<double, double> peakShapeFitApex_(const PeakShapeFunction& psf, const double* mzs, const double* intensities, const std::ptrdiff_t n, double lower, double upper, const double guess) {
+        const double goldenRatio = 0.6180339887498949;
+        const int iterations = 25;
+        double shape[maximalFitWindow_];
+        double height = 0.;
+
+        double x1 = upper - goldenRatio * (upper - lower);
+        double x2 = lower + goldenRatio * (upper - lower);
+        double f1 = peakShapeFitQuality_(psf, x1, mzs, intensities, n, shape, height);
+        double f2 = peakShapeFitQuality_(psf, x2, mzs, intensities, n, shape, height);
+        for(int i = 0; i < iterations; ++i) {
+            if(f1 < f2) {
+                lower = x1;
+                x1 = x2;
+                f1 = f2;
+                x2 = lower + goldenRatio * (upper - lower);
+                f2 = peakShapeFitQuality_(psf, x2, mzs, intensities, n, shape, height);
+            }
+            else {
+                upper = x2;
+                x2 = x1;
+                f2 = f1;
+                x1 = upper - goldenRatio * (upper - lower);
+                f1 = peakShapeFitQuality_(psf, x1, mzs, intensities, n, shape, height);
+            }
+        }
+        const double apex = 0.5 * (lower + upper);
+        if(!(peakShapeFitQuality_(psf, apex, mzs, intensities, n, shape, height) > 0)) {
+            return std::make_pair(guess, -1.);
+        }
+        return std::make_pair(apex, height * psf(apex, apex));
+    }
+} /* anonymous namespace */
+
+// centroid()
+template< typename PeakShapeFunction, typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor, typename OutIter >
+OutIter centroid(const PeakShapeFunction& psf, const MzExtractor& get_mz, const IntensityExtractor& get_int, RandomAccessIter first, RandomAccessIter last, OutIter result, const ApexInterpolation interpolation, const typename IntensityExtractor::result_type minimalPeakHeight) {
+    LessByExtractor< typename IntensityExtractor::element_type, IntensityExtractor > comp(get_int);
+    // the support is proportional to the FWHM; the factor is taken from the first peak
+    double supportPerFwhm = 0.;
+
+    std::ptrdiff_t lefts[peakBlock_], tops[peakBlock_], rights[peakBlock_];
+    double apexMzs[peakBlock_], apexIntensities[peakBlock_], supports[peakBlock_];
+    RandomAccessIter start = first;
+    bool done = false;
+    while(!done) {
+        // the bumps of the next block, as offsets from first
+        std::size_t nPeaks = 0;
+        while(nPeaks < peakBlock_) {
+            RandomAccessIter topIter;
+            const std::pair<RandomAccessIter, RandomAccessIter> bump = findBumpWithTop_(start, last, comp, topIter);
+            if(topIter == last) {
+                done = true;
+                break;
+            }
+            start = bump.second;
+            if(get_int(*topIter) < minimalPeakHeight) {
+                continue;
+            }
+            lefts[nPeaks] = bump.first - first;
+            tops[nPeaks] = topIter - first;
+            rights[nPeaks] = bump.second - first;
+            ++nPeaks;
+        }
+        if(nPeaks == 0) {
+            break;
+        }
+
+        for(std::size_t k = 0; k < nPeaks; ++k) {
+            // the top is a strict maximum, so both neighbours are within the bump
+            const std::ptrdiff_t i = tops[k];
+            const std::pair<double, double> apex = threePointApex_(get_mz(first[i - 1]), get_int(first[i - 1]), get_mz(first[i]), get_int(first[i]), get_mz(first[i + 1]), get_int(first[i + 1]));
+            apexMzs[k] = apex.first;
+            apexIntensities[k] = apex.second;
+        }
+        std::size_t k0 = 0;
+        if(!(supportPerFwhm > 0)) {
+            supports[0] = psf.getSupportThreshold(apexMzs[0]);
+            supportPerFwhm = supports[0] / psf.getFwhm(apexMzs[0]);
+            k0 = 1;
+        }
+        for(std::size_t k = k0; k < nPeaks; ++k) {
+            supports[k] = supportPerFwhm * psf.getFwhm(apexMzs[k]);
+        }
+
+        for(std::size_t k = 0; k < nPeaks; ++k) {
+            const std::ptrdiff_t left = lefts[k], i = tops[k], right = rights[k];
+            std::pair<double, double> apex(apexMzs[k], apexIntensities[k]);
+            // the part of the bump within the support of the peak shape; mostly the whole bump
+            const double support = supports[k];
+            std::ptrdiff_t windowFirst = left;
+            if(get_mz(first[left]) < apex.first - support) {
+                windowFirst = i;
+                while(windowFirst > left && get_mz(first[windowFirst - 1]) >= apex.first - support) {
+                    --windowFirst;
+                }
+            }
+            std::ptrdiff_t windowLast = right;
+            if(get_mz(first[right]) > apex.first + support) {
+                windowLast = i;
+                while(windowLast < right && get_mz(first[windowLast + 1]) <= apex.first + support) {
+                    ++windowLast;
+                }
+            }
+
+            if(interpolation == peakShapeFit) {
+                const std::ptrdiff_t fitFirst = std::max(windowFirst, std::min(i - maximalFitWindow_ / 2, windowLast + 1 - maximalFitWindow_));
+                const std::ptrdiff_t fitLast = std::min(windowLast, fitFirst + maximalFitWindow_ - 1);
+                double mzs[maximalFitWindow_];
+                double intensities[maximalFitWindow_];
+                for(std::ptrdiff_t j = fitFirst; j <= fitLast; ++j) {
+                    mzs[j - fitFirst] = get_mz(first[j]);
+                    intensities[j - fitFirst] = get_int(first[j]);
+                }
+                const std::pair<double, double> fitted = peakShapeFitApex_(psf, mzs, intensities, fitLast - fitFirst + 1, get_mz(first[i - 1]), get_mz(first[i + 1]), apex.first);
+                if(fitted.second >= 0) {
+                    apex = fitted;
+                }
+            }
+
+            double area = 0.;
+            for(std::ptrdiff_t j = windowFirst; j < windowLast; ++j) {
+                area += 0.5 * (get_int(first[j]) + get_int(first[j + 1])) * (get_mz(first[j + 1]) - get_mz(first[j]));
+            }
+            *result = Centroid(apex.first, apex.second, area);
+            ++result;
+        }
+    }
+    return result;
+}
+
+} /* namespace psf */
+
+#endif /*__CENTROID_H__*/
@@ -0,0 +1,181 @@
+#ifndef __CHROMATOGRAM_H__
+#define __CHROMATOGRAM_H__
+#include <psf/config.h>
+
+#include <cstddef>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/Parallel.h>
+
+/**
+ * @page chromatogram Extracted Ion Chromatograms
+ *
+ * An extracted ion chromatogram (XIC) is the intensity of an ion in every scan of a run:
+ * the sum of the intensities within a mass tolerance around the target m/z. A fixed ppm
+ * tolerance is too narrow where the peaks are wide and collects neighbouring ions where
+ * they are narrow. psf::IonChromatograms takes the tolerance from a calibrated peak shape
+ * function instead: the window of a target is +/- psf.getSupportThreshold(mz), the m/z
+ * range where the peak of the ion is non-zero.
+ *
+ * All targets are extracted in one sweep per scan. The windows are sorted by their lower
+ * bound once; a scan is then merged with them, advancing a single position through the
+ * scan. That takes O(n + m) time for n elements and m targets with non-overlapping
+ * windows, instead of O(m log n) for a binary search per target. The scans are processed
+ * in parallel.
+ *
+ * @code
+ * psf::OrbitrapPeakShapeFunction psf;
+ * psf.calibrateFor(get_mz, get_int, s.begin(), s.end());
+ * psf::IonChromatograms xics(psf, targets);
+ * xics.extract(get_mz, get_int, run);
+ * std::vector<double> xic;
+ * xics.chromatogram(0, xic);
+ * @endcode
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class IonChromatograms
+/**
+ * The extracted ion chromatograms of many target m/z values over the scans of a run.
+ *
+ * The intensities are stored scan by scan: one row of numberOfTargets() values per scan,
+ * the targets in the given order.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT IonChromatograms
+{
+public:
+    // IonChromatograms()
+    /**
+     * Windows of +/- psf.getSupportThreshold(mz) around the target m/z values.
+     *
+     * @param psf A calibrated peak shape function like psf::OrbitrapPeakShapeFunction.
+     * @param targets Positive m/z values in any order.
+     * @throw psf::PreconditionViolation A target is not positive.
+     */
+    template< typename PeakShapeFunction >
+    IonChromatograms(const PeakShapeFunction& psf, const std::vector<double>& targets);
+
+    /**
+     * Windows of +/- tolerances[i] around targets[i].
+     *
+     * @throw psf::PreconditionViolation Different number of targets and tolerances or a
+     *      negative tolerance.
+     */
+    IonChromatograms(const std::vector<double>& targets, const std::vector<double>& tolerances);
+
+    // extract()
+    /**
+     * Replaces the chromatograms by those of the scans of a run.
+     *
+     * @param run Provides size() scans as ranges [begin(i), end(i)) of elements in
+     *      ascending m/z order, like psf::LcmsRun.
+     * @param nThreads Maximal number of threads including the calling one. Zero means
+     *      psf::hardwareConcurrency().
+     */
+    template< typename Run, typename MzExtractor, typename IntensityExtractor >
+    void extract(const MzExtractor&, const IntensityExtractor&, const Run& run, unsigned nThreads = 0);
+
+    // extractScan()
+    /**
+     * Writes the intensities of all targets in one scan to row, in the given order of the
+     * targets.
+     *
+     * @param first Points to the first element of a scan in ascending m/z order.
+     * @param last Points to one past the last element.
+     * @param row numberOfTargets() values.
+     */
+    template< typename FwdIter, typename MzExtractor, typename IntensityExtractor >
+    void extractScan(const MzExtractor&, const IntensityExtractor&, FwdIter first, FwdIter last, double* row) const;
+
+    std::size_t numberOfTargets() const { return targets_.size(); }
+    std::size_t numberOfScans() const { return nScans_; }
+
+    double target(const std::size_t t) const { return targets_[t]; }
+    double lowerMz(const std::size_t t) const { return lower_[rank_[t]]; }
+    double upperMz(const std::size_t t) const { return upper_[rank_[t]]; }
+
+    double intensity(const std::size_t t, const std::size_t scan) const { return intensities_[scan * targets_.size() + t]; }
+
+    /**
+     * The intensities of all targets in a scan.
+     */
+    const double* scan(const std::size_t scan) const { return intensities_.data() + scan * targets_.size(); }
+
+    // chromatogram()
+    /**
+     * Replaces xic by the intensities of target t in every scan.
+     */
+    void chromatogram(std::size_t t, std::vector<double>& xic) const;
+
+private:
+    void sortWindows_(const std::vector<double>& tolerances);
+
+    std::vector<double> targets_;
+    // the windows in ascending order of their lower bound and the target of each
+    std::vector<double> lower_;
+    std::vector<double> upper_;
+    std::vector<std::size_t> targetOf_;
+    // position of the window of each target
+    std::vector<std::size_t> rank_;
+    std::size_t nScans_;
+    std::vector<double> intensities_;
+};
+
+
+
+////////////////////
+/* implementation */
+////////////////////
+
+template< typename PeakShapeFunction >
+IonChromatograms::IonChromatograms(const PeakShapeFunction& psf, const std::vector<double>& targets) : targets_(targets), nScans_(0) {
+    std::vector<double> tolerances(targets.size());
+    for(std::size_t t = 0; t < targets.size(); ++t) {
+        psf_precondition(targets[t] > 0, "IonChromatograms::IonChromatograms(): Targets have to be positive.");
+        tolerances[t] = psf.getSupportThreshold(targets[t]);
+    }
+    sortWindows_(tolerances);
+}
+
+template< typename Run, typename MzExtractor, typename IntensityExtractor >
+void IonChromatograms::extract(const MzExtractor& get_mz, const IntensityExtractor& get_int, const Run& run, const unsigned nThreads) {
+    nScans_ = run.size();
+    intensities_.assign(nScans_ * targets_.size(), 0.);
+    if(targets_.empty()) {
+        return;
+    }
+    parallelFor(nScans_, nThreads, [&](const std::size_t i) {
+        extractScan(get_mz, get_int, run.begin(i), run.end(i), &intensities_[i * targets_.size()]);
+    });
+}
+
+template< typename FwdIter, typename MzExtractor, typename IntensityExtractor >
+void IonChromatograms::extractScan(const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter first, FwdIter last, double* row) const {
+    const std::size_t m = lower_.size();
+    std::size_t k = 0;
+    for(; k < m && first != last; ++k) {
+        // the lower bounds ascend, so the first element of a window never moves back
+        while(first != last && get_mz(*first) < lower_[k]) {
+            ++first;
+        }
+        double sum = 0.;
+        for(FwdIter element = first; element != last && get_mz(*element) <= upper_[k]; ++element) {
+            sum += get_int(*element);
+        }
+        row[targetOf_[k]] = sum;
+    }
+    for(; k < m; ++k) {
+        row[targetOf_[k]] = 0.;
+    }
+}
+
+} /* namespace psf */
+
+#endif /*__CHROMATOGRAM_H__*/
@@ -0,0 +1,259 @@
+#ifndef __CONVOLUTION_H__
+#define __CONVOLUTION_H__
+#include <psf/config.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/Fft.h>
+#include <psf/Log.h>
+
+/**
+ * @page convolution Convolution with Peak Shape Functions
+ *
+ *
+ *
+ * @section convolutionintroduction Convolution and correlation on uniform grids
+ *
+ * On a uniform m/z grid a peak shape function with a constant width is a fixed kernel, so
+ * blurring a spectrum with it (psf::convolveOnUniformGrid()) or matching it against a spectrum
+ * (psf::correlateOnUniformGrid()) is a plain discrete convolution. Direct summation costs
+ * O(n k) for n grid points and a kernel of k points. For wide kernels, the FFT with its
+ * O(n log n) is much cheaper.
+ *
+ * With psf::automaticConvolution, the direct summation is used for kernels shorter than a
+ * threshold (default: 128 points) and the FFT for longer ones.
+ *
+ *
+ * @section convolutionblocks Mass-dependent widths
+ *
+ * For Orbitrap or TOF peak shape functions the width depends on the m/z value. The grid is
+ * then split into blocks, in which the support threshold changes by at most a given relative
+ * tolerance. Within each block the FFT path uses the kernel at the center of the block, i.e.
+ * the width is piecewise constant. The direct path always uses the exact width at every grid
+ * point.
+ *
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+/**
+ * How to compute a convolution with a peak shape function.
+ *
+ * automaticConvolution: directConvolution for short kernels, fftConvolution for long ones.
+ */
+enum PSF_EXPORT ConvolutionMethod {automaticConvolution, directConvolution, fftConvolution};
+
+// convolveOnUniformGrid()
+/**
+ * Blurs a profile on a uniform m/z grid with a peak shape function.
+ *
+ * Every grid point j is treated as a stick of its intensity and blurred by the peak shape
+ * function centered there:
+ * @f$ \mathrm{result}_i = \sum_j \mathrm{intensity}_j \cdot \mathrm{psf}(m_j, m_i) @f$ with
+ * @f$ m_i = \mathrm{firstMz} + i\cdot\mathrm{mzStep} @f$.
+ *
+ * Stick spectra can be rendered this way after binning the sticks onto the grid.
+ *
+ * @param psf The peak shape function.
+ * @param firstIntensity Points to the intensity at firstMz.
+ * @param lastIntensity Points to one past the last intensity.
+ * @param firstMz m/z value of the first grid point; has to be positive.
+ * @param mzStep Distance between two grid points; has to be positive.
+ * @param result Receives one value per grid point. May not overlap the input.
+ * @param method Direct summation, FFT or automatic choice.
+ * @param fftThreshold Kernel length in grid points, from which on automaticConvolution uses the FFT.
+ * @param widthTolerance Maximal relative change of the support threshold within a block
+ *                       of constant kernel width (only relevant for the FFT path).
+ *
+ * @throw psf::PreconditionViolation firstMz, mzStep or widthTolerance are out of range.
+ */
+template< typename PeakShapeFunction, typename InIter, typename OutIter >
+void convolveOnUniformGrid(const PeakShapeFunction& psf, InIter firstIntensity, InIter lastIntensity, double firstMz, double mzStep, OutIter result, ConvolutionMethod method = automaticConvolution, std::size_t fftThreshold = 128, double widthTolerance = 0.01);
+
+// correlateOnUniformGrid()
+/**
+ * Matches a peak shape function against a profile on a uniform m/z grid.
+ *
+ * The peak shape function is centered on every grid point i and the overlap with the profile
+ * is computed:
+ * @f$ \mathrm{result}_i = \sum_j \mathrm{intensity}_j \cdot \mathrm{psf}(m_i, m_j) @f$.
+ *
+ * The parameters are the same as for psf::convolveOnUniformGrid().
+ *
+ * @throw psf::PreconditionViolation firstMz, mzStep or widthTolerance are out of range.
+ */
+template< typename PeakShapeFunction, typename InIter, typename OutIter >
+void correlateOnUniformGrid(const PeakShapeFunction& psf, InIter firstIntensity, InIter lastIntensity, double firstMz, double mzStep, OutIter result, ConvolutionMethod method = automaticConvolution, std::size_t fftThreshold = 128, double widthTolerance = 0.01);
+
+
+
+
+
+
+/******************/
+/* implementation */
+/******************/
+
+// convolveOnUniformGrid(): private implementation details
+namespace
+{
+// constantWidthBlocks_()
+/**
+ * Splits the grid into blocks, in which the support threshold of the peak shape function
+ * deviates at most by widthTolerance from the one at the first point of the block.
+ *
+ * @return The block boundaries, starting with 0 and ending with nPoints.
+ */
+template< typename PeakShapeFunction >
+std::vector<std::size_t> constantWidthBlocks_(const PeakShapeFunction& psf, double firstMz, double mzStep, std::size_t nPoints, double widthTolerance) {
+    std::vector<std::size_t> boundaries(1, 0);
+    if(nPoints == 0) {
+        return boundaries;
+    }
+    double blockSupport = psf.getSupportThreshold(firstMz);
+    for(std::size_t i = 1; i < nPoints; ++i) {
+        const double support = psf.getSupportThreshold(firstMz + i * mzStep);
+        if(std::fabs(support - blockSupport) > widthTolerance * blockSupport) {
+            boundaries.push_back(i);
+            blockSupport = support;
+        }
+    }
+    boundaries.push_back(nPoints);
+    return boundaries;
+}
+
+// halfWidthInPoints_()
+/**
+ * Number of grid points covered by the support threshold on each side of the center.
+ */
+inline std::size_t halfWidthInPoints_(double supportThreshold, double mzStep) {
+    return static_cast<std::size_t>(std::ceil(supportThreshold / mzStep));
+}
+
+// filterOnUniformGrid_()
+/**
+ * Common implementation of convolveOnUniformGrid() and correlateOnUniformGrid().
+ *
+ * @param correlate If false, the width at the source point j is used (convolution). Else,
+ *                  the width at the target point i (correlation).
+ */
+template< typename PeakShapeFunction >
+void filterOnUniformGrid_(const PeakShapeFunction& psf, const std::vector<double>& x, double firstMz, double mzStep, std::vector<double>& y, ConvolutionMethod method, std::size_t fftThreshold, double widthTolerance, bool correlate) {
+    psf_precondition(firstMz > 0, "filterOnUniformGrid_(): Parameter firstMz has to be positive.");
+    psf_precondition(mzStep > 0, "filterOnUniformGrid_(): Parameter mzStep has to be positive.");
+    psf_precondition(widthTolerance >= 0, "filterOnUniformGrid_(): Parameter widthTolerance may not be negative.");
+
+    const std::size_t n = x.size();
+    y.assign(n, 0.);
+    if(n == 0) {
+        return;
+    }
+
+    // the peak shape function caches its width, so we work on a copy
+    PeakShapeFunction localPsf(psf);
+    const std::vector<std::size_t> boundaries = constantWidthBlocks_(localPsf, firstMz, mzStep, n, widthTolerance);
+    std::vector<double> observed, values, segment, kernel, filtered;
+
+    for(std::size_t blockIndex = 0; blockIndex + 1 < boundaries.size(); ++blockIndex) {
+        const std::size_t b = boundaries[blockIndex];
+        const std::size_t e = boundaries[blockIndex + 1];
+        const double center = firstMz + 0.5 * (b + e - 1) * mzStep;
+        const std::size_t h = halfWidthInPoints_(localPsf.getSupportThreshold(center), mzStep);
+        const bool useFft = (method == fftConvolution) || (method == automaticConvolution && 2 * h + 1 >= fftThreshold);
+
+        if(useFft) {
+            PSF_LOG(logDEBUG1) << "filterOnUniformGrid_(): FFT for block [" << b << ", " << e << ") with kernel length " << 2 * h + 1;
+            // kernel[t] = psf(center, center + (t - h) * mzStep)
+            observed.resize(2 * h + 1);
+            for(std::size_t t = 0; t < observed.size(); ++t) {
+                observed[t] = center + (static_cast<double>(t) - static_cast<double>(h)) * mzStep;
+            }
+            kernel.resize(observed.size());
+            localPsf.evaluate(center, observed.begin(), observed.end(), kernel.begin());
+
+            if(!correlate) {
+                // sources in the block spread into [b - h, e + h)
+                segment.assign(x.begin() + b, x.begin() + e);
+                convolve(segment, kernel, filtered);
+                for(std::size_t v = 0; v < filtered.size(); ++v) {
+                    if(b + v >= h && b + v - h < n) {
+                        y[b + v - h] += filtered[v];
+                    }
+                }
+            }
+            else {
+                // targets in the block gather from [b - h, e + h); correlation is a convolution
+                // with the reversed kernel
+                segment.assign(e - b + 2 * h, 0.);
+                for(std::size_t u = 0; u < segment.size(); ++u) {
+                    if(b + u >= h && b + u - h < n) {
+                        segment[u] = x[b + u - h];
+                    }
+                }
+                std::reverse(kernel.begin(), kernel.end());
+                convolve(segment, kernel, filtered);
+                for(std::size_t i = b; i < e; ++i) {
+                    y[i] = filtered[i - b + 2 * h];
+                }
+            }
+        }
+        else {
+            for(std::size_t j = b; j < e; ++j) {
+                // zero intensities don't contribute to a convolution
+                if(!correlate && x[j] == 0.) {
+                    continue;
+                }
+                const double mz = firstMz + j * mzStep;
+                const std::size_t hj = halfWidthInPoints_(localPsf.getSupportThreshold(mz), mzStep) + 1;
+                const std::size_t lo = j >= hj ? j - hj : 0;
+                const std::size_t hi = std::min(n, j + hj + 1);
+                observed.resize(hi - lo);
+                values.resize(hi - lo);
+                for(std::size_t i = lo; i < hi; ++i) {
+                    observed[i - lo] = firstMz + i * mzStep;
+                }
+                localPsf.evaluate(mz, observed.begin(), observed.end(), values.begin());
+                if(!correlate) {
+                    for(std::size_t i = lo; i < hi; ++i) {
+                        y[i] += x[j] * values[i - lo];
+                    }
+                }
+                else {
+                    double sum = 0.;
+                    for(std::size_t i = lo; i < hi; ++i) {
+                        sum += x[i] * values[i - lo];
+                    }
+                    y[j] = sum;
+                }
+            }
+        }
+    }
+}
+} /* anonymous namespace */
+
+// convolveOnUniformGrid()
+template< typename PeakShapeFunction, typename InIter, typename OutIter >
+void convolveOnUniformGrid(const PeakShapeFunction& psf, InIter firstIntensity, InIter lastIntensity, double firstMz, double mzStep, OutIter result, ConvolutionMethod method, std::size_t fftThreshold, double widthTolerance) {
+    std::vector<double> x(firstIntensity, lastIntensity), y;
+    filterOnUniformGrid_(psf, x, firstMz, mzStep, y, method, fftThreshold, widthTolerance, false);
+    std::copy(y.begin(), y.end(), result);
+}
+
+// correlateOnUniformGrid()
+template< typename PeakShapeFunction, typename InIter, typename OutIter >
+void correlateOnUniformGrid(const PeakShapeFunction& psf, InIter firstIntensity, InIter lastIntensity, double firstMz, double mzStep, OutIter result, ConvolutionMethod method, std::size_t fftThreshold, double widthTolerance) {
+    std::vector<double> x(firstIntensity, lastIntensity), y;
+    filterOnUniformGrid_(psf, x, firstMz, mzStep, y, method, fftThreshold, widthTolerance, true);
+    std::copy(y.begin(), y.end(), result);
+}
+
+} /* namespace psf */
+
+#endif /*__CONVOLUTION_H__*/
@@ -0,0 +1,49 @@
+#ifndef __FFT_H__
+#define __FFT_H__
+#include <psf/config.h>
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace psf
+{
+
+// nextPowerOfTwo()
+/**
+ * The smallest power of two, which is not smaller than n. Returns 1 for n == 0.
+ */
+PSF_EXPORT std::size_t nextPowerOfTwo(std::size_t n);
+
+// fft()
+/**
+ * In-place discrete Fourier transform.
+ *
+ * Iterative radix-2 Cooley-Tukey transform. The forward transform is
+ * @f$ X_k = \sum_j x_j e^{-2\pi ijk/n} @f$; the inverse transform includes the factor
+ * @f$ \frac{1}{n} @f$, so that fft(fft(x), true) reproduces x.
+ *
+ * @param data The sequence to transform. Its size has to be a power of two (or zero).
+ * @param inverse Do the inverse transform.
+ *
+ * @throw psf::PreconditionViolation The size of data is not a power of two.
+ */
+PSF_EXPORT void fft(std::vector<std::complex<double> >& data, bool inverse = false);
+
+// convolve()
+/**
+ * Full linear convolution of two real sequences using the FFT.
+ *
+ * @f$ \mathrm{result}_k = \sum_j a_j b_{k-j} @f$ for @f$ 0 \le k < |a| + |b| - 1 @f$.
+ * Both sequences are zero padded to a common power-of-two length, so there is no
+ * circular wrap-around. If one of the sequences is empty, the result is empty.
+ *
+ * @param a First sequence.
+ * @param b Second sequence.
+ * @param result Resized to |a| + |b| - 1 and overwritten.
+ */
+PSF_EXPORT void convolve(const std::vector<double>& a, const std::vector<double>& b, std::vector<double>& result);
+
+} /* namespace psf */
+
+#endif /*__FFT_H__*/
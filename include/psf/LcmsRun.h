@@ -0,0 +1,387 @@
+#ifndef __LCMSRUN_H__
+#define __LCMSRUN_H__
+#include <psf/config.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/Log.h>
+#include <psf/Parallel.h>
+#include <psf/PeakParameter.h>
+#include <psf/Spectrum.h>
+
+/**
+ * @page lcmsrun LC-MS Runs and Calibration Drift
+ *
+ * The peak widths of an instrument drift slowly over the gradient of a liquid
+ * chromatography run: with temperature, space charge and the composition of the eluent.
+ * Calibrating every scan on its own with psf::PeakParameterFwhm::learnFrom() is slow and
+ * noisy, since a scan with few peaks yields a poor model.
+ *
+ * A psf::LcmsRun holds the scans of a run together with their retention times. A
+ * psf::FwhmDrift calibrates a sparse, evenly spaced subset of the scans (in parallel),
+ * smooths every model parameter over the retention time with a robust local linear
+ * regression (LOWESS) and tabulates the result on a uniform grid. The parameters for any
+ * retention time are then interpolated from the grid in O(1) time:
+ *
+ * @code
+ * psf::LcmsRun run;
+ * run.load("run.mzML");
+ * psf::FwhmDrift<psf::LinearSqrtModel> drift;
+ * drift.calibrate(get_mz, get_int, run, 40);
+ * psf::OrbitrapFwhm fwhm;
+ * for(std::size_t i = 0; i < run.size(); ++i) {
+ *     drift.at(run.retentionTime(i), fwhm);
+ *     // process run.begin(i), run.end(i) with fwhm
+ * }
+ * @endcode
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class LcmsRun
+/**
+ * The scans of a run in order of retention time, in one block of elements with
+ * per-scan offsets.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT LcmsRun
+{
+public:
+    typedef const SpectrumElement* const_iterator;
+
+    LcmsRun();
+
+    // load()
+    /**
+     * Replaces the content of the run by the scans of a run file in order of retention
+     * time; see psf::IndexedRun.
+     *
+     * @param msLevel Only scans of this MS level and scans of unknown level are loaded;
+     *      zero loads all scans.
+     * @param nThreads Threads for decoding mzML; see psf::MzMLReader.
+     * @throw psf::RuntimeError The run couldn't be read; the run is empty then.
+     */
+    void load(const std::string& runFilename, int msLevel = 0, unsigned nThreads = 1);
+
+    // add()
+    /**
+     * Appends a scan.
+     *
+     * @throw psf::PreconditionViolation The retention time is smaller than the one of the
+     *      last scan.
+     */
+    template< typename FwdIter >
+    void add(double retentionTime, FwdIter first, FwdIter last, int scanNumber = 0, int msLevel = 0);
+
+    void clear();
+
+    void reserve(std::size_t nScans, std::size_t nElements);
+
+    /**
+     * Number of scans.
+     */
+    std::size_t size() const { return retentionTimes_.size(); }
+
+    const_iterator begin(const std::size_t i) const { return elements_.data() + offsets_[i]; }
+    const_iterator end(const std::size_t i) const { return elements_.data() + offsets_[i + 1]; }
+
+    /**
+     * In seconds.
+     */
+    double retentionTime(const std::size_t i) const { return retentionTimes_[i]; }
+    int scanNumber(const std::size_t i) const { return scanNumbers_[i]; }
+    int msLevel(const std::size_t i) const { return msLevels_[i]; }
+
+    /**
+     * Number of elements of all scans.
+     */
+    std::size_t numberOfElements() const { return offsets_.back(); }
+
+    // findRetentionTime()
+    /**
+     * Position of the first scan with a retention time not smaller than rt in
+     * O(log n) time; size(), if there is none.
+     */
+    std::size_t findRetentionTime(double rt) const;
+
+private:
+    std::vector<SpectrumElement> elements_;
+    std::vector<std::size_t> offsets_;
+    std::vector<double> retentionTimes_;
+    std::vector<int> scanNumbers_;
+    std::vector<int> msLevels_;
+};
+
+// class DriftModel
+/**
+ * A smooth vector valued function of the retention time.
+ *
+ * Fitted to samples by LOWESS: the value at a retention time x is the intercept of a
+ * linear regression of the samples nearest to x, weighted with the tricube of their
+ * distance to x. A fraction span of all samples is used for every regression. Afterwards,
+ * the samples are reweighted with the bisquare of their residuals in units of six median
+ * absolute residuals and the regressions are repeated, so that single bad samples don't
+ * pull the curve. Every component is smoothed on its own.
+ *
+ * The fitted function is tabulated on a uniform grid and evaluated by linear
+ * interpolation. Outside of the sampled range it is constant.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT DriftModel
+{
+public:
+    DriftModel();
+
+    // fit()
+    /**
+     * Replaces the model by one fitted to samples.
+     *
+     * @param retentionTimes Of the samples; in any order.
+     * @param values dimension values per sample, sample after sample.
+     * @param span Fraction of the samples used by every local regression, in (0, 1].
+     * @param nKnots Grid points of the tabulated function; at least two.
+     * @param robustnessIterations Reweighting steps after the first fit.
+     * @throw psf::PreconditionViolation No samples, wrong number of values or invalid
+     *      parameter.
+     */
+    void fit(const std::vector<double>& retentionTimes, const std::vector<double>& values, unsigned dimension,
+             double span = 0.5, unsigned nKnots = 256, unsigned robustnessIterations = 2);
+
+    bool empty() const { return knots_.empty(); }
+    unsigned dimension() const { return dimension_; }
+    double firstRetentionTime() const { return first_; }
+    double lastRetentionTime() const { return last_; }
+
+    // at()
+    /**
+     * Writes the dimension() values at a retention time to values.
+     */
+    void at(const double rt, double* values) const {
+        psf_precondition(!empty(), "DriftModel::at(): Model not fitted.");
+        std::size_t i;
+        double f;
+        locate_(rt, i, f);
+        const double* knot = &knots_[i * dimension_];
+        for(unsigned k = 0; k < dimension_; ++k) {
+            values[k] = knot[k] + f * (knot[k + dimension_] - knot[k]);
+        }
+    }
+
+    double at(const double rt, const unsigned k) const {
+        psf_precondition(!empty() && k < dimension_, "DriftModel::at(): Model not fitted or index out of range.");
+        std::size_t i;
+        double f;
+        locate_(rt, i, f);
+        return knots_[i * dimension_ + k] + f * (knots_[(i + 1) * dimension_ + k] - knots_[i * dimension_ + k]);
+    }
+
+private:
+    // the grid interval [i, i + 1] and the position f in it
+    void locate_(const double rt, std::size_t& i, double& f) const {
+        const double t = (rt - first_) * inverseStep_;
+        if(!(t > 0.)) {
+            i = 0;
+            f = 0.;
+        }
+        else if(t >= nKnots_ - 1) {
+            i = nKnots_ - 2;
+            f = 1.;
+        }
+        else {
+            i = static_cast<std::size_t>(t);
+            f = t - i;
+        }
+    }
+
+    unsigned dimension_;
+    std::size_t nKnots_;
+    double first_, last_, inverseStep_;
+    // dimension_ values per knot
+    std::vector<double> knots_;
+};
+
+// class FwhmDrift
+/**
+ * The parameters of a psf::PeakParameterFwhm as a smooth function of the retention time.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+template< typename ParameterModel >
+class PSF_EXPORT FwhmDrift
+{
+public:
+    typedef PeakParameterFwhm<ParameterModel> Fwhm;
+
+    /**
+     * @param prototype Its settings (minimal peak height, noise factor, regression
+     *      method) are used to calibrate the scans.
+     */
+    explicit FwhmDrift(const Fwhm& prototype = Fwhm()) : prototype_(prototype), span_(0.5), nKnots_(256) {}
+
+    // calibrate()
+    /**
+     * Fits the drift to the calibrations of nScans scans of a run.
+     *
+     * The scans are evenly spaced over the scans of the given MS level (and those of
+     * unknown level). A scan that can't be calibrated (psf::Starvation) is left out.
+     *
+     * @param msLevel Zero calibrates from scans of every level.
+     * @param nThreads Maximal number of threads including the calling one. Zero means
+     *      psf::hardwareConcurrency().
+     * @return The number of calibrated scans.
+     * @throw psf::PreconditionViolation nScans is zero.
+     * @throw psf::Starvation No scan could be calibrated.
+     */
+    template< typename MzExtractor, typename IntensityExtractor >
+    std::size_t calibrate(const MzExtractor&, const IntensityExtractor&, const LcmsRun& run, std::size_t nScans = 32,
+                          int msLevel = 1, unsigned nThreads = 0);
+
+    // at()
+    /**
+     * Sets the parameters of fwhm to those at a retention time in O(1) time.
+     */
+    void at(const double rt, Fwhm& fwhm) const {
+        psf_precondition(!model_.empty(), "FwhmDrift::at(): Drift not calibrated.");
+        double values[maxParameters_];
+        model_.at(rt, values);
+        for(unsigned k = 0; k < model_.dimension(); ++k) {
+            fwhm.setParameter(k, values[k] > 0. ? values[k] : 0.);
+        }
+    }
+
+    /**
+     * A copy of the prototype with the parameters at a retention time.
+     */
+    Fwhm at(const double rt) const {
+        Fwhm fwhm(prototype_);
+        at(rt, fwhm);
+        return fwhm;
+    }
+
+    const DriftModel& model() const { return model_; }
+
+    /**
+     * Retention times of the calibrated scans and their learned parameters, one row of
+     * numberOfParameters() values per scan.
+     */
+    const std::vector<double>& sampleRetentionTimes() const { return sampleRetentionTimes_; }
+    const std::vector<double>& sampleParameters() const { return sampleParameters_; }
+
+    // setSpan()
+    /**
+     * Fraction of the calibrated scans smoothed over; see psf::DriftModel::fit().
+     * Defaults to 0.5.
+     */
+    void setSpan(const double span) {
+        psf_precondition(span > 0. && span <= 1., "FwhmDrift::setSpan(): Span out of (0, 1].");
+        span_ = span;
+    }
+
+    // setNumberOfKnots()
+    /**
+     * Grid points of the tabulated drift; defaults to 256.
+     */
+    void setNumberOfKnots(const unsigned nKnots) {
+        psf_precondition(nKnots >= 2, "FwhmDrift::setNumberOfKnots(): At least two knots needed.");
+        nKnots_ = nKnots;
+    }
+
+private:
+    static const unsigned maxParameters_ = 8;
+
+    Fwhm prototype_;
+    double span_;
+    unsigned nKnots_;
+    DriftModel model_;
+    std::vector<double> sampleRetentionTimes_;
+    std::vector<double> sampleParameters_;
+};
+
+
+
+////////////////////
+/* implementation */
+////////////////////
+
+template< typename FwdIter >
+void LcmsRun::add(const double retentionTime, FwdIter first, FwdIter last, const int scanNumber, const int msLevel) {
+    psf_precondition(retentionTimes_.empty() || retentionTime >= retentionTimes_.back(),
+                     "LcmsRun::add(): Scans have to be added in order of retention time.");
+    elements_.insert(elements_.end(), first, last);
+    offsets_.push_back(elements_.size());
+    retentionTimes_.push_back(retentionTime);
+    scanNumbers_.push_back(scanNumber);
+    msLevels_.push_back(msLevel);
+}
+
+// calibrate()
+template< typename ParameterModel >
+template< typename MzExtractor, typename IntensityExtractor >
+std::size_t FwhmDrift<ParameterModel>::calibrate(const MzExtractor& get_mz, const IntensityExtractor& get_int, const LcmsRun& run,
+                                                 const std::size_t nScans, const int msLevel, unsigned nThreads) {
+    psf_precondition(nScans > 0, "FwhmDrift::calibrate(): nScans has to be positive.");
+    std::vector<std::size_t> eligible;
+    for(std::size_t i = 0; i < run.size(); ++i) {
+        if(msLevel == 0 || run.msLevel(i) == 0 || run.msLevel(i) == msLevel) {
+            eligible.push_back(i);
+        }
+    }
+    std::vector<std::size_t> scans;
+    if(eligible.size() <= nScans) {
+        scans = eligible;
+    }
+    else {
+        for(std::size_t j = 0; j < nScans; ++j) {
+            // centered in nScans equal parts of the eligible scans
+            scans.push_back(eligible[(2 * j + 1) * eligible.size() / (2 * nScans)]);
+        }
+    }
+
+    const unsigned p = prototype_.numberOfParameters();
+    psf_precondition(p <= maxParameters_, "FwhmDrift::calibrate(): Too many model parameters.");
+    std::vector<double> parameters(scans.size() * p);
+    std::vector<char> calibrated(scans.size(), 0);
+    parallelFor(scans.size(), nThreads, [&](const std::size_t j) {
+        Fwhm fwhm(prototype_);
+        CalibrationWorkspace workspace;
+        try {
+            fwhm.learnFrom(get_mz, get_int, run.begin(scans[j]), run.end(scans[j]), workspace);
+        } catch(const Starvation& e) {
+            PSF_UNUSED(e);
+            return;
+        }
+        for(unsigned k = 0; k < p; ++k) {
+            parameters[j * p + k] = fwhm.getParameter(k);
+        }
+        calibrated[j] = 1;
+    });
+
+    sampleRetentionTimes_.clear();
+    sampleParameters_.clear();
+    for(std::size_t j = 0; j < scans.size(); ++j) {
+        if(calibrated[j]) {
+            sampleRetentionTimes_.push_back(run.retentionTime(scans[j]));
+            sampleParameters_.insert(sampleParameters_.end(), parameters.begin() + j * p, parameters.begin() + (j + 1) * p);
+        }
+        else {
+            PSF_LOG(logINFO) << "FwhmDrift::calibrate(): Scan at retention time " << run.retentionTime(scans[j]) << " couldn't be calibrated.";
+        }
+    }
+    if(sampleRetentionTimes_.empty()) {
+        throw psf::Starvation("FwhmDrift::calibrate(): No scan of the run could be calibrated.");
+    }
+    model_.fit(sampleRetentionTimes_, sampleParameters_, p, span_, nKnots_);
+    return sampleRetentionTimes_.size();
+}
+
+} /* namespace psf */
+
+#endif /*__LCMSRUN_H__*/
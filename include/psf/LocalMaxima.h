@@ -0,0 +1,199 @@
+#ifndef __LOCALMAXIMA_H__
+#define __LOCALMAXIMA_H__
+#include <psf/config.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/SpectrumAlgorithm.h>
+
+/**
+ * @page localmaxima Local Maxima Prepass
+ *
+ * Most elements of a profile spectrum are not the apex of a bump, so psf::findBump()
+ * spends most of its time on rejecting elements. Every bump found by psf::findBump() has
+ * exactly one strict local maximum (an element greater than both neighbours) and every
+ * strict local maximum is the top of exactly one bump: the bump extends from the bottom
+ * of the strictly increasing slope left of the maximum to the bottom of the strictly
+ * decreasing slope right of it. (Plateaus are no strict maxima, which is why
+ * psf::findBump() doesn't report them.)
+ *
+ * psf::LocalMaximaMask marks the strict local maxima of a contiguous intensity array in a
+ * vectorized pass. psf::findBumps() and psf::measureFullWidths() with a mask then only
+ * visit the bumps around the marked elements. The results are the same as the ones of
+ * the sequential versions.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class LocalMaximaMask
+/**
+ * A bitmask of the strict local maxima of an intensity sequence.
+ *
+ * Bit i is set, if intensities[i-1] < intensities[i] > intensities[i+1]. The first and
+ * the last element are never set.
+ *
+ * The mask is computed with SSE2 or AVX compares, if the library is compiled for them,
+ * and with a scalar loop else.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT LocalMaximaMask
+{
+public:
+    LocalMaximaMask();
+
+    // assign()
+    /**
+     * Marks the strict local maxima of a contiguous array of intensities.
+     */
+    void assign(const double* intensities, std::size_t n);
+
+    // assign()
+    /**
+     * Marks the strict local maxima of the intensities of a sequence of elements.
+     *
+     * The intensities are gathered into an internal buffer first, which is reused by
+     * subsequent calls.
+     */
+    template< typename FwdIter, typename IntensityExtractor >
+    void assign(const IntensityExtractor&, FwdIter first, FwdIter last);
+
+    /**
+     * Number of elements covered by the mask.
+     */
+    std::size_t size() const;
+
+    /**
+     * Number of strict local maxima.
+     */
+    std::size_t count() const;
+
+    /**
+     * @throw psf::PreconditionViolation Parameter i is not less than size().
+     */
+    bool test(std::size_t i) const;
+
+    // next()
+    /**
+     * The index of the first strict local maximum not before i; size() if there is none.
+     */
+    std::size_t next(std::size_t i) const;
+
+private:
+    std::vector<unsigned long long> words_;
+    std::size_t size_;
+    std::vector<double> buffer_;
+};
+
+// findBumps()
+/**
+ * Finds all bumps in a sequence, visiting only the marked local maxima.
+ *
+ * The result is the same as calling psf::findBump() repeatedly, each time starting at the
+ * right edge of the previous bump.
+ *
+ * @param maxima The strict local maxima of the sequence according to comp.
+ * @return The bumps [pair.first, pair.second] in ascending order.
+ *
+ * @throw psf::PreconditionViolation The mask is of a different size than the sequence.
+ */
+template<typename RandomAccessIter, typename Compare>
+std::vector<std::pair<RandomAccessIter, RandomAccessIter> > findBumps(RandomAccessIter first, RandomAccessIter last, Compare comp, const LocalMaximaMask& maxima);
+
+// measureFullWidths()
+/**
+ * Sample the full width at a fraction of the maximum, visiting only the marked local
+ * maxima.
+ *
+ * The result is exactly the same as the one of the sequential version.
+ *
+ * @param maxima The strict local maxima of the intensities of the sequence.
+ *
+ * @throw psf::PreconditionViolation Parameter fraction is out of the required range or
+ *      the mask is of a different size than the sequence.
+ */
+template<typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor>
+std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> >
+measureFullWidths(const MzExtractor&, const IntensityExtractor&, RandomAccessIter first, RandomAccessIter last, double fraction, typename IntensityExtractor::result_type minimalPeakHeight, const LocalMaximaMask& maxima);
+
+
+
+/******************/
+/* implementation */
+/******************/
+
+// assign()
+template< typename FwdIter, typename IntensityExtractor >
+void LocalMaximaMask::assign(const IntensityExtractor& get_int, FwdIter first, FwdIter last) {
+    buffer_.resize(std::distance(first, last));
+    for(std::vector<double>::iterator value = buffer_.begin(); value != buffer_.end(); ++value, ++first) {
+        *value = get_int(*first);
+    }
+    assign(buffer_.empty() ? 0 : &buffer_[0], buffer_.size());
+}
+
+namespace
+{
+    // bumpAround_()
+    // The bump with its top at the strict local maximum top.
+    template< typename RandomAccessIter, typename Compare >
+    std::pair<RandomAccessIter, RandomAccessIter> bumpAround_(const RandomAccessIter first, const RandomAccessIter top, const RandomAccessIter last, Compare comp) {
+        RandomAccessIter right = top;
+        while(right + 1 != last && comp(*(right + 1), *right)) {
+            ++right;
+        }
+        return std::make_pair(bottomOfSlope_(first, top, comp), right);
+    }
+} /* anonymous namespace */
+
+// findBumps()
+template<typename RandomAccessIter, typename Compare>
+std::vector<std::pair<RandomAccessIter, RandomAccessIter> > findBumps(RandomAccessIter first, RandomAccessIter last, Compare comp, const LocalMaximaMask& maxima) {
+    psf_precondition(maxima.size() == static_cast<std::size_t>(last - first), "findBumps(): Mask and sequence differ in size.");
+    std::vector<std::pair<RandomAccessIter, RandomAccessIter> > bumps;
+    for(std::size_t i = maxima.next(0); i < maxima.size(); i = maxima.next(i + 1)) {
+        bumps.push_back(bumpAround_(first, first + static_cast<std::ptrdiff_t>(i), last, comp));
+    }
+    return bumps;
+}
+
+// measureFullWidths()
+template<typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor>
+std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> >
+measureFullWidths(const MzExtractor& get_mz, const IntensityExtractor& get_int, RandomAccessIter first, RandomAccessIter last, double fraction, typename IntensityExtractor::result_type minimalPeakHeight, const LocalMaximaMask& maxima) {
+    typedef typename MzExtractor::result_type Mz;
+    psf_precondition(0. <= fraction && fraction <= 1.,
+        "measureFullWidths(): Parameter fraction out of required range.");
+    psf_precondition(maxima.size() == static_cast<std::size_t>(last - first), "measureFullWidths(): Mask and sequence differ in size.");
+
+    std::vector<std::pair<Mz, Mz> > widths;
+    const double requiredLowness = 1. - fraction;
+    LessByExtractor< typename IntensityExtractor::element_type, IntensityExtractor > comp(get_int);
+    for(std::size_t i = maxima.next(0); i < maxima.size(); i = maxima.next(i + 1)) {
+        const RandomAccessIter top = first + static_cast<std::ptrdiff_t>(i);
+        // the top is the maximum of its bump; cheap rejection before walking the slopes
+        if(get_int(*top) < minimalPeakHeight) {
+            continue;
+        }
+        const std::pair<RandomAccessIter, RandomAccessIter> bump = bumpAround_(first, top, last, comp);
+        // The minima of the slopes are their bottoms, so the lowness is the one computed by
+        // SpectralPeak::lowness(), without searching the bump.
+        const typename IntensityExtractor::result_type base = std::max(get_int(*bump.first), get_int(*bump.second));
+        if(1. - (base / get_int(*top)) >= requiredLowness) {
+            widths.push_back(std::make_pair(get_mz(*top), SpectralPeak::fullWidthAtFractionOfMaximum(get_mz, get_int, bump.first, bump.second, fraction)));
+        }
+    }
+    return widths;
+}
+
+} /* namespace psf */
+
+#endif /*__LOCALMAXIMA_H__*/
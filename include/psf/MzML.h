@@ -0,0 +1,246 @@
+#ifndef __MZML_H__
+#define __MZML_H__
+#include <psf/config.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <psf/SaxParser.h>
+#include <psf/Spectrum.h>
+
+/**
+ * @page mzml mzML Files
+ *
+ * mzML is the open exchange format for mass spectrometry runs: an XML document with one
+ * <spectrum> element per scan, whose m/z and intensity arrays are stored as base64
+ * encoded, optionally zlib compressed, little endian floating point numbers.
+ *
+ * psf::MzMLReader streams the spectra of a run one scan at a time. The document is parsed
+ * with a psf::SaxParser on the calling thread, while the binary arrays of the next few
+ * scans are decoded on worker threads; at most a fixed number of scans is held in memory
+ * at any time, however long the run is.
+ *
+ * @code
+ * psf::MzMLReader reader("run.mzML", 0);
+ * psf::MzMLScan scan;
+ * while(reader.next(scan)) {
+ *     fwhm.learnFrom(get_mz, get_int, scan.spectrum.begin(), scan.spectrum.end());
+ * }
+ * @endcode
+ *
+ * psf::MzMLWriter writes spectra as mzML, for example to convert .wsv files.
+ *
+ * Supported are 32 and 64 bit floating point arrays and MS-Numpress encoded arrays
+ * (@ref numpress), uncompressed or zlib compressed; zlib compression needs a build with
+ * zlib (PSF_HAVE_ZLIB). Parameters defined in referenceable
+ * parameter groups are not resolved.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// struct MzMLScan
+/**
+ * A spectrum read from an mzML file, together with its metadata.
+ */
+struct PSF_EXPORT MzMLScan
+{
+    MzMLScan() : index(0), offset(0), length(0), scanNumber(-1), msLevel(0), retentionTime(0.) {}
+
+    /**
+     * Position of the spectrum in the file, starting at zero.
+     */
+    std::size_t index;
+
+    /**
+     * Byte offset of the <spectrum> element in the stream and its length up to the end
+     * of the closing tag.
+     */
+    unsigned long long offset, length;
+
+    /**
+     * The native id, for example 'controllerType=0 controllerNumber=1 scan=42'.
+     */
+    std::string id;
+
+    /**
+     * The 'scan=' part of the id, or index + 1, if the id has none.
+     */
+    int scanNumber;
+
+    /**
+     * Zero, if the spectrum doesn't specify it.
+     */
+    int msLevel;
+
+    /**
+     * Scan start time in seconds.
+     */
+    double retentionTime;
+
+    /**
+     * All elements of the spectrum; unlike psf::loadSpectrumElements(), zero intensities
+     * are kept.
+     */
+    Spectrum spectrum;
+};
+
+// class MzMLReader
+/**
+ * Reads the spectra of an mzML file in document order.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT MzMLReader
+{
+public:
+    /**
+     * @param filename An mzML or indexed mzML file.
+     * @param nThreads Maximal number of threads including the calling one. The calling
+     *      thread parses, the others decode. Zero means psf::hardwareConcurrency(); with
+     *      one thread, each scan is decoded by next().
+     * @param maxPendingScans Maximal number of scans parsed ahead of the one returned
+     *      next. Zero means four per decoding thread.
+     *
+     * @throw psf::RuntimeError The file couldn't be opened.
+     */
+    explicit MzMLReader(const std::string& filename, unsigned nThreads = 1, std::size_t maxPendingScans = 0);
+
+    /**
+     * Reads the document from is, which has to outlive the reader.
+     */
+    explicit MzMLReader(std::istream& is, unsigned nThreads = 1, std::size_t maxPendingScans = 0);
+
+    ~MzMLReader();
+
+    // next()
+    /**
+     * The next spectrum of the file.
+     *
+     * The previous content of scan is replaced; its buffers are reused.
+     *
+     * @return false after the last spectrum.
+     * @throw psf::RuntimeError The document is malformed, or an array can't be decoded.
+     *      The reader can't be used any more afterwards.
+     */
+    bool next(MzMLScan& scan);
+
+    /**
+     * Number of spectra returned so far.
+     */
+    std::size_t numberOfScans() const { return returned_; }
+
+    // readSpectrum()
+    /**
+     * Reads the first spectrum at or after the current position of is, for example after
+     * seeking to the offset of a spectrum; the index is zero, the offset relative to the
+     * initial position. The position of is afterwards is unspecified.
+     *
+     * @return false, if there is no spectrum.
+     * @throw psf::RuntimeError See next().
+     */
+    static bool readSpectrum(std::istream& is, MzMLScan& scan);
+
+private:
+    MzMLReader(const MzMLReader&);
+    MzMLReader& operator=(const MzMLReader&);
+
+    struct Pending_;
+    class Handler_;
+
+    void start_(unsigned nThreads, std::size_t maxPendingScans);
+    static bool parse_(SaxParser& parser, Handler_& handler, Pending_& pending);
+    static void take_(Pending_& pending, MzMLScan& scan);
+    void work_();
+
+    std::ifstream file_;
+    std::unique_ptr<SaxParser> parser_;
+    std::unique_ptr<Handler_> handler_;
+    bool exhausted_;
+    std::size_t parsed_;
+    std::size_t returned_;
+    std::size_t window_;
+
+    // scans in document order, parsed and queued for decoding
+    std::deque<std::shared_ptr<Pending_> > pending_;
+    std::deque<std::shared_ptr<Pending_> > tasks_;
+    std::vector<std::shared_ptr<Pending_> > recycled_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable queued_;
+    std::condition_variable decoded_;
+    bool stopping_;
+};
+
+// class MzMLWriter
+/**
+ * Writes spectra as an mzML document with 64 bit floating point or numpress encoded arrays.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT MzMLWriter
+{
+public:
+    /**
+     * Writes the header of the document.
+     *
+     * @param os Has to outlive the writer.
+     * @param numberOfSpectra Exact number of spectra that will be written; mzML states
+     *      it in front of them.
+     * @param compress Compress the arrays with zlib.
+     * @param numpress Encode the m/z values with numpress linear prediction and the
+     *      intensities as numpress short logged floats (lossy, see @ref numpress); combined
+     *      with compress, zlib is applied on top.
+     *
+     * @throw psf::RuntimeError Compression was requested, but the build has no zlib.
+     */
+    MzMLWriter(std::ostream& os, std::size_t numberOfSpectra, bool compress = true, bool numpress = false);
+
+    // write()
+    /**
+     * Appends a spectrum.
+     *
+     * @param retentionTime Scan start time in seconds.
+     * @param msLevel Stage of the spectrum, 1 for survey scans.
+     */
+    void write(const Spectrum& spectrum, double retentionTime, int msLevel = 1);
+
+    // close()
+    /**
+     * Writes the end of the document.
+     *
+     * @throw psf::PreconditionViolation Not exactly the announced number of spectra was
+     *      written.
+     */
+    void close();
+
+private:
+    MzMLWriter(const MzMLWriter&);
+    MzMLWriter& operator=(const MzMLWriter&);
+
+    void writeArray_(const std::vector<double>& values, bool mz);
+
+    std::ostream& os_;
+    std::size_t numberOfSpectra_;
+    std::size_t written_;
+    bool compress_;
+    bool numpress_;
+    bool closed_;
+    std::vector<double> values_;
+    std::string bytes_;
+    std::string encoded_;
+};
+
+} /* namespace psf */
+
+#endif /*__MZML_H__*/
@@ -0,0 +1,197 @@
+#ifndef __NOISETHRESHOLD_H__
+#define __NOISETHRESHOLD_H__
+#include <psf/config.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/SpectrumAlgorithm.h>
+
+/**
+ * @page noisethreshold Adaptive Noise Threshold
+ *
+ * A fixed minimal peak height either starves a calibration (too high) or lets it measure
+ * lots of noise bumps (too low), and the right value differs between instruments and
+ * m/z regions. psf::NoiseThreshold estimates the noise level of a spectrum region by
+ * region in a single pass: the spectrum is cut into windows of a fixed number of
+ * elements, and in every window the median and the median absolute deviation (MAD) of the
+ * intensities are determined. Both are robust, as long as less than half of the elements
+ * in a window belong to peaks.
+ *
+ * The threshold of a window is median + factor * 1.4826 * MAD (1.4826 * MAD estimates the
+ * standard deviation of normally distributed noise). Between the window centres the
+ * threshold is interpolated linearly.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class NoiseThreshold
+/**
+ * A minimal peak height depending on the m/z value.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT NoiseThreshold
+{
+public:
+    NoiseThreshold();
+
+    // estimate()
+    /**
+     * Estimates the noise threshold of a spectrum.
+     *
+     * The spectrum is read once; a trailing window shorter than half of windowSize is
+     * merged into the previous one. The memory of a previous estimate is reused.
+     *
+     * @param first Points to the first element of a spectrum in ascending m/z order.
+     * @param last Points to one past the last element.
+     * @param factor Number of noise standard deviations above the median; may not be
+     *      negative.
+     * @param windowSize Number of elements per window; at least 3.
+     * @throw psf::PreconditionViolation Invalid factor or windowSize.
+     */
+    template< typename FwdIter, typename MzExtractor, typename IntensityExtractor >
+    void estimate(const MzExtractor&, const IntensityExtractor&, FwdIter first, FwdIter last, double factor = 3., std::size_t windowSize = 256);
+
+    // at()
+    /**
+     * The threshold at a m/z value; never below getMinimum().
+     *
+     * Constant before the first and after the last window centre. Equal to getMinimum()
+     * without any window.
+     */
+    double at(double mz) const;
+
+    // setMinimum()
+    /**
+     * A lower bound of the threshold, for example a fixed minimal peak height.
+     * The default is zero.
+     */
+    void setMinimum(double minimum);
+    double getMinimum() const;
+
+    std::size_t numberOfWindows() const;
+
+private:
+    // Determines the threshold of a window from its intensities (which are reordered).
+    void addWindow_(double mz, std::vector<double>& intensities, double factor);
+
+    std::vector<double> mzs_;
+    std::vector<double> thresholds_;
+    double minimum_;
+    std::vector<double> window_;
+};
+
+// measureFullWidths()
+/**
+ * Sample the full width at a fraction of the maximum of the bumps above a m/z dependent
+ * threshold.
+ *
+ * The same as the psf::measureFullWidths() version with a fixed minimal peak height,
+ * but a bump is only measured, if its height is at least threshold.at(mz) at the m/z of
+ * its maximum.
+ *
+ * @throw psf::PreconditionViolation Parameter fraction is out of the required range.
+ */
+template<typename FwdIter, typename MzExtractor, typename IntensityExtractor>
+std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> >
+measureFullWidths(const MzExtractor&, const IntensityExtractor&, FwdIter first, FwdIter last, double fraction, const NoiseThreshold& threshold);
+
+// measureFullWidths()
+/**
+ * The same, but writes the pairs to widths, which is cleared first; repeated calls
+ * reuse its memory.
+ */
+template<typename FwdIter, typename MzExtractor, typename IntensityExtractor, typename Allocator>
+void measureFullWidths(const MzExtractor&, const IntensityExtractor&, FwdIter first, FwdIter last, double fraction, const NoiseThreshold& threshold, std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type>, Allocator>& widths);
+
+
+
+/******************/
+/* implementation */
+/******************/
+
+// estimate()
+template< typename FwdIter, typename MzExtractor, typename IntensityExtractor >
+void NoiseThreshold::estimate(const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter first, FwdIter last, const double factor, const std::size_t windowSize) {
+    psf_precondition(factor >= 0, "NoiseThreshold::estimate(): Parameter factor may not be negative.");
+    psf_precondition(windowSize >= 3, "NoiseThreshold::estimate(): Parameter windowSize has to be at least 3.");
+    mzs_.clear();
+    thresholds_.clear();
+    window_.clear();
+    double firstMz = 0., lastMz = 0.;
+    for(; first != last; ++first) {
+        if(window_.empty()) {
+            firstMz = get_mz(*first);
+        }
+        window_.push_back(get_int(*first));
+        lastMz = get_mz(*first);
+        if(window_.size() == windowSize) {
+            // wait for the next one, if it is the last window
+            FwdIter next = first;
+            ++next;
+            std::size_t remaining = 0;
+            for(; next != last && remaining < windowSize / 2; ++next) {
+                ++remaining;
+            }
+            if(remaining < windowSize / 2) {
+                for(++first; first != last; ++first) {
+                    window_.push_back(get_int(*first));
+                    lastMz = get_mz(*first);
+                }
+                break;
+            }
+            addWindow_(0.5 * (firstMz + lastMz), window_, factor);
+            window_.clear();
+        }
+    }
+    if(!window_.empty()) {
+        addWindow_(0.5 * (firstMz + lastMz), window_, factor);
+    }
+}
+
+// measureFullWidths()
+template<typename FwdIter, typename MzExtractor, typename IntensityExtractor>
+std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> >
+measureFullWidths(const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter first, FwdIter last, double fraction, const NoiseThreshold& threshold) {
+    std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> > widths;
+    measureFullWidths(get_mz, get_int, first, last, fraction, threshold, widths);
+    return widths;
+}
+
+namespace
+{
+    // AboveThreshold_
+    // Height rule of measureBumps_(): the maximum of a bump has to reach the threshold at
+    // its m/z.
+    struct AboveThreshold_
+    {
+        explicit AboveThreshold_(const NoiseThreshold& t) : threshold(t) {}
+
+        template< typename Mz, typename Intensity >
+        bool operator()(const Mz& mz, const Intensity height) const {
+            return height >= threshold.at(mz);
+        }
+
+        const NoiseThreshold& threshold;
+    };
+} /* anonymous namespace */
+
+// measureFullWidths()
+template<typename FwdIter, typename MzExtractor, typename IntensityExtractor, typename Allocator>
+void measureFullWidths(const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter first, FwdIter last, double fraction, const NoiseThreshold& threshold, std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type>, Allocator>& widths) {
+    psf_precondition(0. <= fraction && fraction <= 1.,
+        "measureFullWidths(): Parameter fraction out of required range.");
+    widths.clear();
+    measureBumps_(get_mz, get_int, first, first, last, last, fraction, AboveThreshold_(threshold), widths);
+}
+
+} /* namespace psf */
+
+#endif /*__NOISETHRESHOLD_H__*/
@@ -0,0 +1,103 @@
+#ifndef __NUMPRESS_H__
+#define __NUMPRESS_H__
+#include <psf/config.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @page numpress Numpress Compression of Spectra
+ *
+ * 64 bit doubles are wasteful for spectra: the m/z values of a profile spectrum are
+ * nearly linear in their index and intensities are known to three or four significant
+ * digits. The MS-Numpress encodings (Teleman et al., Mol. Cell. Proteomics 13, 2014)
+ * exploit that and are understood by mzML readers:
+ *
+ * @li Linear prediction (psf::encodeNumpressLinear()) for m/z: the values are rounded to
+ *     a fixed point and each is predicted by extrapolating the previous two; only the
+ *     residual is stored, in a variable number of half bytes. The absolute error is at
+ *     most 0.5 / fixedPoint, about 1e-7 m/z with the optimal fixed point.
+ * @li Short logged float (psf::encodeNumpressSlof()) for intensities: log(x + 1) in 16
+ *     bit fixed point. The relative error of x + 1 is at most exp(0.5 / fixedPoint) - 1,
+ *     about 1e-4 for intensities up to 1e6 with the optimal fixed point.
+ * @li Positive integers (psf::encodeNumpressPic()) for intensities that are counts: the
+ *     values are rounded and stored in a variable number of half bytes.
+ *
+ * A profile spectrum shrinks to about a fourth of its 64 bit size; zlib on top of the
+ * encodings gains a little more. psf::MzMLReader decodes numpress arrays and
+ * psf::MzMLWriter writes them on request.
+ *
+ * The byte layout follows the reference implementation, so the arrays are exchangeable
+ * with other software. The decoders work in two passes: the variable length integers
+ * are unpacked in a serial loop, the conversion to m/z or intensity runs in a separate
+ * branch-free loop over the whole array. At -O3 the compiler vectorizes the scaling of
+ * the linear prediction and the unpacking of the short logged floats, but not their
+ * std::exp(), which stays a call per value; the default -O2 vectorizes none of them.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// optimalNumpressLinearFixedPoint()
+/**
+ * The largest fixed point for which the linear prediction residuals of data fit into 32
+ * bits.
+ */
+PSF_EXPORT double optimalNumpressLinearFixedPoint(const double* data, std::size_t n);
+
+// encodeNumpressLinear()
+/**
+ * Replaces bytes by the linear prediction encoding of data.
+ *
+ * @throw psf::RuntimeError A value or a residual doesn't fit the fixed point.
+ */
+PSF_EXPORT void encodeNumpressLinear(const double* data, std::size_t n, double fixedPoint, std::string& bytes);
+
+// decodeNumpressLinear()
+/**
+ * Replaces out by the values of a linear prediction encoding.
+ *
+ * @throw psf::RuntimeError The bytes are corrupt.
+ */
+PSF_EXPORT void decodeNumpressLinear(const std::string& bytes, std::vector<double>& out);
+
+// optimalNumpressSlofFixedPoint()
+/**
+ * The largest fixed point for which log(x + 1) of all values fits into 16 bits.
+ */
+PSF_EXPORT double optimalNumpressSlofFixedPoint(const double* data, std::size_t n);
+
+// encodeNumpressSlof()
+/**
+ * Replaces bytes by the short logged float encoding of the non-negative data.
+ *
+ * @throw psf::RuntimeError A value doesn't fit the fixed point.
+ */
+PSF_EXPORT void encodeNumpressSlof(const double* data, std::size_t n, double fixedPoint, std::string& bytes);
+
+// decodeNumpressSlof()
+/**
+ * @throw psf::RuntimeError The bytes are corrupt.
+ */
+PSF_EXPORT void decodeNumpressSlof(const std::string& bytes, std::vector<double>& out);
+
+// encodeNumpressPic()
+/**
+ * Replaces bytes by the positive integer encoding of the data rounded to integers.
+ *
+ * @throw psf::RuntimeError A value is negative or doesn't fit into 32 bits.
+ */
+PSF_EXPORT void encodeNumpressPic(const double* data, std::size_t n, std::string& bytes);
+
+// decodeNumpressPic()
+/**
+ * @throw psf::RuntimeError The bytes are corrupt.
+ */
+PSF_EXPORT void decodeNumpressPic(const std::string& bytes, std::vector<double>& out);
+
+} /* namespace psf */
+
+#endif /*__NUMPRESS_H__*/
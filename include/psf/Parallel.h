@@ -0,0 +1,90 @@
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+#include <psf/config.h>
+
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace psf
+{
+
+// hardwareConcurrency()
+/**
+ * The number of threads the hardware can run concurrently; at least one.
+ */
+inline unsigned hardwareConcurrency() {
+    const unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+// parallelFor()
+/**
+ * Calls f(i) for every i in [0, n) using up to nThreads threads.
+ *
+ * The index range is split into contiguous chunks, one per thread. The calling thread
+ * works on the last chunk itself. There is no synchronization besides joining the threads at
+ * the end, so f(i) and f(j) for i != j must not write to the same memory.
+ *
+ * @param n Number of indices.
+ * @param nThreads Maximal number of threads including the calling one. Zero means
+ *                 psf::hardwareConcurrency().
+ * @param f Callable with signature void(std::size_t).
+ *
+ * @throw The first exception thrown by f (in order of the chunks) is rethrown after all
+ *        threads have finished.
+ */
+template< typename Function >
+void parallelFor(const std::size_t n, unsigned nThreads, Function f) {
+    if(nThreads == 0) {
+        nThreads = hardwareConcurrency();
+    }
+    if(nThreads > n) {
+        nThreads = static_cast<unsigned>(n);
+    }
+    if(nThreads <= 1) {
+        for(std::size_t i = 0; i < n; ++i) {
+            f(i);
+        }
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(nThreads);
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+
+    for(unsigned t = 0; t < nThreads; ++t) {
+        const std::size_t begin = n * t / nThreads;
+        const std::size_t end = n * (t + 1) / nThreads;
+        std::exception_ptr& error = errors[t];
+        auto chunk = [begin, end, &error, &f]() {
+            try {
+                for(std::size_t i = begin; i < end; ++i) {
+                    f(i);
+                }
+            } catch(...) {
+                error = std::current_exception();
+            }
+        };
+        if(t + 1 < nThreads) {
+            threads.push_back(std::thread(chunk));
+        }
+        else {
+            chunk();
+        }
+    }
+
+    for(std::size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    for(unsigned t = 0; t < nThreads; ++t) {
+        if(errors[t]) {
+            std::rethrow_exception(errors[t]);
+        }
+    }
+}
+
+} /* namespace psf */
+
+#endif /*__PARALLEL_H__*/
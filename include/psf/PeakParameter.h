@@ -1,11 +1,18 @@
 #ifndef __PEAKPARAMETER_H__
 #define __PEAKPARAMETER_H__
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
 #include <utility>
 #include <vector>
 
 #include <psf/Error.h>
 #include <psf/Log.h>
+#include <psf/NoiseThreshold.h>
+#include <psf/Regression.h>
 #include <psf/SpectrumAlgorithm.h>
 
 #include <vigra/windows.h>
@@ -62,11 +69,21 @@ protected:
      */
     ~ConstantModel() {}
 
+    /**
+     * Antiderivative of 1/at(x); equal to @f$ x/a @f$.
+     */
+    double warpAt(const double x) const;
+
     /**
      * Equal to @f$ (1.,0.) @f$.
      */
     GeneralizedSlope slopeInParameterSpaceFor(double x) const;
 
+    /**
+     * The same, but reusing the memory of slope.
+     */
+    void slopeInParameterSpaceFor(double x, GeneralizedSlope& slope) const;
+
 public:
     ConstantModel() : a_(0.1) {}
 
@@ -118,11 +135,21 @@ protected:
      */
     ~LinearSqrtModel() {}
 
+    /**
+     * Antiderivative of 1/at(x); equal to @f$ \int 1/(a\cdot x\sqrt{x} + b)\,dx @f$ in closed form.
+     */
+    double warpAt(const double x) const;
+
     /**
      * Equal to @f$ (x\sqrt{x},1.,0.) @f$.
      */
     GeneralizedSlope slopeInParameterSpaceFor(double x) const;
 
+    /**
+     * The same, but reusing the memory of slope.
+     */
+    void slopeInParameterSpaceFor(double x, GeneralizedSlope& slope) const;
+
 public:
     LinearSqrtModel() : a_(0.1), b_(0.1) {}
 
@@ -177,11 +204,21 @@ protected:
      */
     ~LinearSqrtOriginModel() {}
 
+    /**
+     * Antiderivative of 1/at(x); equal to @f$ -2/(a\sqrt{x}) @f$.
+     */
+    double warpAt(const double x) const;
+
     /**
      * Equal to @f$ (x\sqrt{x},0.) @f$.
      */
     GeneralizedSlope slopeInParameterSpaceFor(double x) const;
 
+    /**
+     * The same, but reusing the memory of slope.
+     */
+    void slopeInParameterSpaceFor(double x, GeneralizedSlope& slope) const;
+
 public:
     LinearSqrtOriginModel() : a_(0.1) {}
 
@@ -233,11 +270,21 @@ protected:
      */
     ~SqrtModel() {}
 
+    /**
+     * Antiderivative of 1/at(x); equal to @f$ 2/a\cdot(\sqrt{x} - b/a\cdot\ln|a\sqrt{x} + b|) @f$.
+     */
+    double warpAt(const double x) const;
+
     /**
      * Equal to @f$ (\sqrt{x},1.,0.) @f$.
      */    
     GeneralizedSlope slopeInParameterSpaceFor(double x) const;
 
+    /**
+     * The same, but reusing the memory of slope.
+     */
+    void slopeInParameterSpaceFor(double x, GeneralizedSlope& slope) const;
+
 public:
     SqrtModel() : a_(0.1), b_(0.1) {}
 
@@ -292,11 +339,21 @@ protected:
      */
     ~QuadraticModel() {}
 
+    /**
+     * Antiderivative of 1/at(x); equal to @f$ \int 1/(a\cdot x^2 + b)\,dx @f$ in closed form.
+     */
+    double warpAt(const double x) const;
+
     /**
      * Equal to @f$ (x^2,1.,0.) @f$.
      */ 
     GeneralizedSlope slopeInParameterSpaceFor(double x) const;
 
+    /**
+     * The same, but reusing the memory of slope.
+     */
+    void slopeInParameterSpaceFor(double x, GeneralizedSlope& slope) const;
+
 public:
     QuadraticModel() : a_(0.1), b_(0.1) {}
 
@@ -398,10 +455,70 @@ protected:
      * @return The generalized slope, a mulitdimensional vector including the bias.
      */
     virtual GeneralizedSlope slopeInParameterSpaceFor(double x) const = 0;
+
+    /**
+     * The same, but reusing the memory of slope.
+     *
+     * Used by the psf::CalibrationWorkspace versions of psf::PeakParameterFwhm::learnFrom().
+     */
+    virtual void slopeInParameterSpaceFor(double x, GeneralizedSlope& slope) const = 0;
+
+    /**
+     * An antiderivative of @f$ 1/model(x) @f$.
+     *
+     * In the warped coordinate @f$ u = warpAt(x) @f$ the model is constant and equal to
+     * one: an interval of length model(x) around x is mapped to an interval of length one.
+     * Used by psf::PeakParameterFwhm::warp().
+     * @attention This function is part of the optional interface, since not every model
+     * may have a closed form antiderivative.
+     *
+     * @param x Only required to be valid where model(x) is positive.
+     */
+    virtual double warpAt(double x) const = 0;
 };
 
 
 
+// class CalibrationWorkspace
+/**
+ * Reusable buffers for repeated calibrations.
+ *
+ * A calibration measures the peak widths in a spectrum, computes a row of the design
+ * matrix per peak and solves the normal equations, several times for a robust regression.
+ * Every buffer needed for that is owned by the workspace and only grows. Once a workspace
+ * has seen the largest spectrum of a run, psf::PeakParameterFwhm::learnFrom() doesn't
+ * allocate memory any more.
+ *
+ * A workspace may be passed to different peak parameters one after the other, but it
+ * may not be used by several threads at the same time.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT CalibrationWorkspace
+{
+public:
+    CalibrationWorkspace() : equations_(1) {}
+
+    /**
+     * The (mz | fwhm) pairs measured by the last calibration.
+     */
+    const std::vector<std::pair<double, double> >& widthPairs() const { return pairs_; }
+
+private:
+    template <typename ParameterModel> friend class PeakParameterFwhm;
+
+    std::vector<std::pair<double, double> > pairs_;
+    NoiseThreshold threshold_;
+    GeneralizedSlope slope_;
+    std::vector<double> design_; // one row of numberOfParameters() elements per pair
+    std::vector<double> widths_;
+    std::vector<double> residuals_;
+    std::vector<double> absoluteResiduals_;
+    std::vector<double> x_;
+    std::vector<double> previous_;
+    NormalEquations equations_;
+};
+
 // class PeakParameterFwhm
 /**
  * 'Full width at half maximum' peak shape parameter.
@@ -429,7 +546,7 @@ template <typename ParameterModel>
 class PSF_EXPORT PeakParameterFwhm : public ParameterModel 
 {
 public:
-    PeakParameterFwhm() : minimalPeakHeightToLearnFrom_(0) {}
+    PeakParameterFwhm() : minimalPeakHeightToLearnFrom_(0), noiseFactorToLearnFrom_(0), regressionMethod_(leastSquaresRegression) {}
 
     /**
      * The FWHM at a specific mass channel.
@@ -446,6 +563,45 @@ public:
         return fwhm;
     }
 
+    // warp()
+    /**
+     * The mass channel in warped coordinates.
+     *
+     * The warped coordinate is the antiderivative of 1/at(mz). In this coordinate the FWHM
+     * is constant and equal to one, so a mass spectrum mapped into warped coordinates (for
+     * example with psf::resampleOnGrid() and a psf::WarpedScale) can be processed with a
+     * single fixed kernel instead of a mass dependent one.
+     *
+     * The ParameterModel has to support the optional warpAt() function. Else, calling this
+     * function will not compile.
+     *
+     * @param mz Mass channel; has to be positive.
+     * @throw psf::PreconditionViolation Parameter mz is not positive.
+     */
+    double warp(const double mz) const {
+        psf_precondition(mz > 0, "PeakParameterFwhm::warp(): Parameter mz has to be positive.");
+        return this->ParameterModel::warpAt(mz);
+    }
+
+    // unwarp()
+    /**
+     * The inverse of warp().
+     *
+     * The inverse is found with Newton's method starting from mzGuess. The warped
+     * coordinate is a concave function of the mass channel for all non-decreasing FWHM
+     * models, so the iteration converges monotonically after the first step. A guess close
+     * to the result (for example the result of the previous call, when mapping a sorted
+     * sequence) saves iterations.
+     *
+     * @param u Warped coordinate.
+     * @param mzGuess Start of the iteration; has to be positive and the FWHM at mzGuess has
+     *      to be positive, too.
+     * @throw psf::PreconditionViolation Parameter mzGuess is not positive.
+     * @throw psf::NumericalInstability The iteration didn't converge. u is probably out
+     *      of the range of warp().
+     */
+    double unwarp(double u, double mzGuess = 400.) const;
+
     /**
      * Calibrates the internal model for a specific mass spectrum.
      *
@@ -469,6 +625,51 @@ public:
     template< typename FwdIter, typename MzExtractor, typename IntensityExtractor >
     void learnFrom(const MzExtractor&, const IntensityExtractor&, FwdIter first, FwdIter last);
 
+    // learnFrom()
+    /**
+     * The same, but all temporary memory is taken from a reusable workspace.
+     *
+     * Every regression method solves the normal equations, so a least squares result
+     * agrees with the one of the version above up to rounding. The measured pairs are
+     * left in workspace.widthPairs(). The extractors have to return double values.
+     *
+     * @throw psf::Starvation To few or bad data extracted from the input sequence to make a
+     *                       calibration possible.
+     */
+    template< typename FwdIter, typename MzExtractor, typename IntensityExtractor >
+    void learnFrom(const MzExtractor&, const IntensityExtractor&, FwdIter first, FwdIter last, CalibrationWorkspace& workspace);
+
+    // learnFromSample()
+    /**
+     * Calibrates the internal model from a random sample of the peaks in a spectrum.
+     *
+     * A low order model is determined long before every peak in a large spectrum has been
+     * measured. The spectrum is divided into strata of equal m/z width. The strata are
+     * visited round robin, each time measuring the peaks starting in a randomly chosen,
+     * not yet visited block of elements; so the sample covers the whole m/z range from the
+     * beginning.
+     *
+     * After each block, the least squares fit and its covariance are updated from the
+     * running normal equations in O(p^2). With a robust regression method, the sample is
+     * refitted whenever it has grown by half. The 95% confidence interval of the parameters is
+     * propagated to the FWHM at the stratum borders. Sampling stops, as soon as the half
+     * width of this interval is below relativeTolerance times the FWHM everywhere, or
+     * when the whole spectrum has been visited. Finally, the sampled peaks are fitted with
+     * the current regression method.
+     *
+     * @param first Points to the first Element of the sequence.
+     * @param last Points to one past the last Element of the sequence.
+     * @param relativeTolerance Has to be positive.
+     * @param seed Seed of the random visiting order.
+     * @return The number of peaks, the model was learned from.
+     *
+     * @throw psf::PreconditionViolation relativeTolerance is not positive.
+     * @throw psf::Starvation To few or bad data extracted from the input sequence to make a
+     *                       calibration possible.
+     */
+    template< typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor >
+    std::size_t learnFromSample(const MzExtractor&, const IntensityExtractor&, RandomAccessIter first, RandomAccessIter last, double relativeTolerance = 0.01, unsigned seed = 0);
+
     // setMinimalPeakHeightToLearnFrom()
     /**
      * Only use peaks with a minimum absolute intensity to learn from.
@@ -483,10 +684,64 @@ public:
      */
     double getMinimalPeakHeightToLearnFrom();
 
+    // setNoiseFactorToLearnFrom()
+    /**
+     * Only use peaks rising above the local noise level to learn from.
+     *
+     * With a positive factor, learnFrom() and learnFromSample() estimate a
+     * psf::NoiseThreshold of the input spectrum and use only peaks at least median +
+     * factor * sigma high, where median and sigma are the robust noise statistics around
+     * the peak. The minimal peak height still applies as a lower bound. Zero (the default)
+     * switches the noise threshold off.
+     *
+     * @param factor Number of noise standard deviations; may not be negative.
+     * @throw psf::PreconditionViolation Parameter factor is negative.
+     */
+    void setNoiseFactorToLearnFrom(double factor);
+
+    // getNoiseFactorToLearnFrom()
+    double getNoiseFactorToLearnFrom() const;
+
+    // thresholdToLearnFrom()
+    /**
+     * The height a peak of the spectrum has to reach to be learned from: the noise
+     * threshold, if a noise factor is set, but at least the minimal peak height.
+     *
+     * learnFrom() applies it to every peak; learnFromSample() and calibrateWithCache()
+     * estimate it once and apply it to their sample, so that all of them measure the same
+     * peaks.
+     */
+    template< typename FwdIter, typename MzExtractor, typename IntensityExtractor >
+    NoiseThreshold thresholdToLearnFrom(const MzExtractor&, const IntensityExtractor&, FwdIter first, FwdIter last) const;
+
+    // setRegressionMethod()
+    /**
+     * The method used by learnFrom() to fit the model to the measured widths.
+     *
+     * Overlapping peaks and noise produce widths far off the model. With a robust method
+     * (psf::huberRegression or psf::tukeyRegression) these outliers are downweighted by
+     * iteratively reweighted least squares, so the calibration doesn't have to be repeated
+     * with different minimal peak heights. The default is psf::leastSquaresRegression.
+     *
+     * @see psf::RegressionMethod
+     */
+    void setRegressionMethod(RegressionMethod method);
+
+    // getRegressionMethod()
+    RegressionMethod getRegressionMethod() const;
+
+    // getFractionOfMaximum()
+    /**
+     * The fraction of the peak maximum, the widths are measured at: 0.5 for a FWHM.
+     */
+    static double getFractionOfMaximum();
+
 private:
     static const double fractionOfMaximum_;
 
     double minimalPeakHeightToLearnFrom_; 
+    double noiseFactorToLearnFrom_;
+    RegressionMethod regressionMethod_;
 
     /**
      * Fit the parameter model to measured mz-width pairs.
@@ -503,6 +758,49 @@ private:
      */
     template< typename MzExtractor >
     void learn_(const std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> >& pairs);
+
+    /**
+     * Fit the parameter model to measured mz-width pairs with iteratively reweighted least
+     * squares.
+     *
+     * The rows of the design matrix are computed once. Every iteration reweights the pairs
+     * according to their residuals, accumulates the p x p normal equations and solves them
+     * under the constraint of non-negative parameters.
+     *
+     * @throw psf::InvariantViolation The model is inconsistent.
+     */
+    template< typename MzExtractor >
+    void learnRobustly_(const std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> >& pairs);
+
+    /**
+     * Clears the design matrix and the widths of a workspace and prepares its normal
+     * equations for the parameters of the model.
+     *
+     * @throw psf::InvariantViolation The model has no parameters.
+     */
+    void prepare_(CalibrationWorkspace& workspace);
+
+    /**
+     * Appends the design matrix row and the width of a measured pair to a workspace.
+     *
+     * @throw psf::InvariantViolation The generalized slope has the wrong dimension.
+     */
+    void addRow_(double mz, double width, CalibrationWorkspace& workspace) const;
+
+    /**
+     * Solves the normal equations for the design matrix and the widths in a workspace
+     * with the current regression method.
+     *
+     * For leastSquaresRegression, the pairs are weighted equally. Else, the pairs are
+     * reweighted iteratively and the normal equations hold the final weights on return.
+     * The non-negative solution is left in the workspace.
+     */
+    void fitNormalEquations_(CalibrationWorkspace& workspace) const;
+
+    /**
+     * Sets the model parameters to the solution in a workspace.
+     */
+    void setParameters_(const CalibrationWorkspace& workspace);
 };
 
 /**
@@ -549,7 +847,16 @@ void PeakParameterFwhm<ParameterModel>::learnFrom(const MzExtractor& get_mz, con
     typedef std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> > MzWidthPairs_;
  
     // sample some FWHMs from the spectrum
-    MzWidthPairs_ pairs = measureFullWidths(get_mz, get_int, first, last, fractionOfMaximum_, getMinimalPeakHeightToLearnFrom());        
+    MzWidthPairs_ pairs;
+    if(noiseFactorToLearnFrom_ > 0) {
+        NoiseThreshold threshold;
+        threshold.estimate(get_mz, get_int, first, last, noiseFactorToLearnFrom_);
+        threshold.setMinimum(getMinimalPeakHeightToLearnFrom());
+        pairs = measureFullWidths(get_mz, get_int, first, last, fractionOfMaximum_, threshold);
+    }
+    else {
+        pairs = measureFullWidths(get_mz, get_int, first, last, fractionOfMaximum_, getMinimalPeakHeightToLearnFrom());        
+    }
 
     if(pairs.empty()) {
         throw psf::Starvation("PeakParameterFwhm::learnFrom(): No (Mz | FWHM) could be measured in input spectrum to learn from.");
@@ -567,6 +874,202 @@ void PeakParameterFwhm<ParameterModel>::learnFrom(const MzExtractor& get_mz, con
     PSF_LOG(logINFO) << "Learned peak parameter FWHM from spectrum. FWHM at 400 Th is now " << at(400)  << " Th. This corresponds to a resolution of " << 400./at(400) << ".";
 }
 
+// learnFrom()
+template <typename ParameterModel>
+template< typename FwdIter, typename MzExtractor, typename IntensityExtractor >
+void PeakParameterFwhm<ParameterModel>::learnFrom(const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter first, FwdIter last, CalibrationWorkspace& workspace) {
+    if(noiseFactorToLearnFrom_ > 0) {
+        workspace.threshold_.estimate(get_mz, get_int, first, last, noiseFactorToLearnFrom_);
+        workspace.threshold_.setMinimum(getMinimalPeakHeightToLearnFrom());
+        measureFullWidths(get_mz, get_int, first, last, fractionOfMaximum_, workspace.threshold_, workspace.pairs_);
+    }
+    else {
+        measureFullWidths(get_mz, get_int, first, last, fractionOfMaximum_, getMinimalPeakHeightToLearnFrom(), workspace.pairs_);
+    }
+
+    if(workspace.pairs_.empty()) {
+        throw psf::Starvation("PeakParameterFwhm::learnFrom(): No (Mz | FWHM) could be measured in input spectrum to learn from.");
+    }
+
+    try {
+        prepare_(workspace);
+        for(std::size_t i = 0; i < workspace.pairs_.size(); ++i) {
+            addRow_(workspace.pairs_[i].first, workspace.pairs_[i].second, workspace);
+        }
+        fitNormalEquations_(workspace);
+    } catch(const psf::InvariantViolation& e) {
+        PSF_UNUSED(e);
+        PSF_LOG(logWARNING) << "PeakParameterFwhm::learnFrom(): Numerical regression failed.";
+        throw psf::Starvation("PeakParameterFwhm::learnFrom(): Regression of the parameter model for the measured (Mz | FWHM) pairs failed.");
+    }
+    setParameters_(workspace);
+
+    PSF_LOG(logINFO) << "Learned peak parameter FWHM from spectrum. FWHM at 400 Th is now " << at(400)  << " Th. This corresponds to a resolution of " << 400./at(400) << ".";
+}
+
+// unwarp()
+template <typename ParameterModel>
+double PeakParameterFwhm<ParameterModel>::unwarp(const double u, const double mzGuess) const {
+    psf_precondition(mzGuess > 0, "PeakParameterFwhm::unwarp(): Parameter mzGuess has to be positive.");
+    const int maxIterations = 100;
+    const double relativeTolerance = 1e-13;
+
+    double mz = mzGuess;
+    for(int iteration = 0; iteration < maxIterations; ++iteration) {
+        // d(warp)/d(mz) is 1/fwhm
+        double next = mz - (this->ParameterModel::warpAt(mz) - u) * this->ParameterModel::at(mz);
+        if(!(next > 0) || !(this->ParameterModel::at(next) > 0)) {
+            // overshot the origin or the range of positive widths; approach the root from
+            // the left
+            next = 0.5 * (mz + std::max(next, 0.));
+        }
+        if(next > std::numeric_limits<double>::max()) {
+            break;
+        }
+        if(std::abs(next - mz) <= relativeTolerance * next) {
+            return next;
+        }
+        mz = next;
+    }
+    throw psf::NumericalInstability("PeakParameterFwhm::unwarp(): Newton iteration didn't converge.");
+}
+
+// learnFromSample()
+template <typename ParameterModel>
+template< typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor >
+std::size_t PeakParameterFwhm<ParameterModel>::learnFromSample(const MzExtractor& get_mz, const IntensityExtractor& get_int, RandomAccessIter first, RandomAccessIter last, const double relativeTolerance, const unsigned seed) {
+    typedef std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> > MzWidthPairs_;
+    psf_precondition(relativeTolerance > 0, "PeakParameterFwhm::learnFromSample(): Parameter relativeTolerance has to be positive.");
+    psf_invariant(this->ParameterModel::numberOfParameters() > 0, "PeakParameterFwhm::learnFromSample(): Number of model parameters is not greater than zero.");
+
+    const std::size_t nStrata = 16;
+    const double z95 = 1.96;
+    const unsigned nParameters = this->ParameterModel::numberOfParameters();
+    const std::size_t minimalPeaks = std::max<std::size_t>(30, 10 * nParameters);
+
+    MzWidthPairs_ pairs;
+    const std::ptrdiff_t size = last - first;
+    if(size < 1) {
+        throw psf::Starvation("PeakParameterFwhm::learnFromSample(): No (Mz | FWHM) could be measured in input spectrum to learn from.");
+    }
+    // about 16 blocks per stratum, but not smaller than a typical peak
+    const std::size_t blockSize = std::min<std::size_t>(256, std::max<std::size_t>(16, size / (16 * nStrata)));
+
+    /* strata of equal m/z width, each divided into blocks visited in random order */
+    const double firstMz = get_mz(*first);
+    const double lastMz = get_mz(*(last - 1));
+    std::vector<RandomAccessIter> borders(nStrata + 1, first);
+    std::vector<double> borderMzs(nStrata + 1);
+    for(std::size_t s = 0; s <= nStrata; ++s) {
+        borderMzs[s] = firstMz + (lastMz - firstMz) * s / nStrata;
+        if(s == nStrata) {
+            borders[s] = last;
+        }
+        else if(s > 0) {
+            borders[s] = std::lower_bound(borders[s - 1], last, borderMzs[s], LessThanValue<typename MzExtractor::element_type, MzExtractor>(get_mz));
+        }
+    }
+    std::mt19937 random(seed);
+    std::vector<std::vector<std::size_t> > blocks(nStrata);
+    for(std::size_t s = 0; s < nStrata; ++s) {
+        const std::ptrdiff_t stratumSize = borders[s + 1] - borders[s];
+        for(std::ptrdiff_t b = 0; b * static_cast<std::ptrdiff_t>(blockSize) < stratumSize; ++b) {
+            blocks[s].push_back(static_cast<std::size_t>(b));
+        }
+        std::shuffle(blocks[s].begin(), blocks[s].end(), random);
+    }
+
+    /* visit blocks until the fit is precise enough */
+    // A least squares fit is checked after every block with the running normal equations.
+    // A robust fit has to reweight every sampled peak, so it is only checked whenever the
+    // sample has grown by a constant factor; the total effort stays linear in the number
+    // of sampled peaks.
+    const double checkGrowth = 1.5;
+    const NoiseThreshold threshold = thresholdToLearnFrom(get_mz, get_int, first, last);
+    CalibrationWorkspace workspace;
+    prepare_(workspace);
+    NormalEquations& equations = workspace.equations_;
+    std::vector<double>& x = workspace.x_;
+    std::vector<double> covariance;
+    std::vector<GeneralizedSlope> borderSlopes(nStrata + 1);
+    for(std::size_t s = 0; s <= nStrata; ++s) {
+        borderSlopes[s] = this->ParameterModel::slopeInParameterSpaceFor(borderMzs[s] > 0 ? borderMzs[s] : firstMz);
+    }
+    std::size_t nextCheck = minimalPeaks;
+    bool converged = false;
+    for(std::size_t round = 0; !converged; ++round) {
+        bool visitedBlock = false;
+        for(std::size_t s = 0; s < nStrata && !converged; ++s) {
+            if(round >= blocks[s].size()) {
+                continue;
+            }
+            visitedBlock = true;
+            const RandomAccessIter blockFirst = borders[s] + blocks[s][round] * blockSize;
+            const RandomAccessIter blockLast = (borders[s + 1] - blockFirst > static_cast<std::ptrdiff_t>(blockSize)) ? blockFirst + blockSize : borders[s + 1];
+            const std::size_t before = pairs.size();
+            measureBumps_(get_mz, get_int, first, blockFirst, blockLast, last, fractionOfMaximum_, AboveThreshold_(threshold), pairs);
+            for(std::size_t i = before; i < pairs.size(); ++i) {
+                addRow_(pairs[i].first, pairs[i].second, workspace);
+                if(regressionMethod_ == leastSquaresRegression) {
+                    equations.add(&workspace.design_[i * nParameters], pairs[i].second);
+                }
+            }
+            if(pairs.size() == before || pairs.size() < minimalPeaks) {
+                continue;
+            }
+
+            // confidence interval of the fwhm at the stratum borders
+            if(regressionMethod_ == leastSquaresRegression) {
+                // the running normal equations are up to date
+                equations.solveNonnegative(x);
+            }
+            else {
+                if(pairs.size() < nextCheck) {
+                    continue;
+                }
+                nextCheck = static_cast<std::size_t>(checkGrowth * pairs.size()) + 1;
+                fitNormalEquations_(workspace);
+            }
+            try {
+                equations.covariance(x, covariance);
+            }
+            catch(const psf::Exception& e) {
+                PSF_UNUSED(e);
+                continue;
+            }
+            converged = true;
+            for(std::size_t b = 0; b <= nStrata && converged; ++b) {
+                double fwhm = 0., variance = 0.;
+                for(unsigned i = 0; i < nParameters; ++i) {
+                    fwhm += borderSlopes[b][i] * x[i];
+                    for(unsigned j = 0; j < nParameters; ++j) {
+                        variance += borderSlopes[b][i] * covariance[i * nParameters + j] * borderSlopes[b][j];
+                    }
+                }
+                converged = fwhm > 0 && z95 * std::sqrt(std::max(0., variance)) <= relativeTolerance * fwhm;
+            }
+        }
+        if(!visitedBlock) {
+            break;
+        }
+    }
+
+    if(pairs.empty()) {
+        throw psf::Starvation("PeakParameterFwhm::learnFromSample(): No (Mz | FWHM) could be measured in input spectrum to learn from.");
+    }
+    std::sort(pairs.begin(), pairs.end());
+    try {
+        learn_<MzExtractor>(pairs);
+    } catch(const psf::InvariantViolation& e) {
+        PSF_UNUSED(e);
+        PSF_LOG(logWARNING) << "PeakParameterFwhm::learnFromSample(): Numerical regression failed.";
+        throw psf::Starvation("PeakParameterFwhm::learnFromSample(): Regression of the parameter model for the measured (Mz | FWHM) pairs failed.");
+    }
+
+    PSF_LOG(logINFO) << "Learned peak parameter FWHM from " << pairs.size() << " sampled peaks" << (converged ? "" : " (tolerance not reached)") << ". FWHM at 400 Th is now " << at(400) << " Th.";
+    return pairs.size();
+}
+
 template <typename ParameterModel>
 void PeakParameterFwhm<ParameterModel>::setMinimalPeakHeightToLearnFrom(const double minimalHeight) {
     minimalPeakHeightToLearnFrom_ = minimalHeight;
@@ -577,6 +1080,45 @@ double PeakParameterFwhm<ParameterModel>::getMinimalPeakHeightToLearnFrom() {
     return minimalPeakHeightToLearnFrom_;
 }
 
+template <typename ParameterModel>
+void PeakParameterFwhm<ParameterModel>::setNoiseFactorToLearnFrom(const double factor) {
+    psf_precondition(factor >= 0, "PeakParameterFwhm::setNoiseFactorToLearnFrom(): Parameter factor may not be negative.");
+    noiseFactorToLearnFrom_ = factor;
+}
+
+template <typename ParameterModel>
+double PeakParameterFwhm<ParameterModel>::getNoiseFactorToLearnFrom() const {
+    return noiseFactorToLearnFrom_;
+}
+
+// thresholdToLearnFrom()
+template <typename ParameterModel>
+template< typename FwdIter, typename MzExtractor, typename IntensityExtractor >
+NoiseThreshold PeakParameterFwhm<ParameterModel>::thresholdToLearnFrom(const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter first, FwdIter last) const {
+    // without windows, the threshold is the minimal peak height everywhere
+    NoiseThreshold threshold;
+    if(noiseFactorToLearnFrom_ > 0) {
+        threshold.estimate(get_mz, get_int, first, last, noiseFactorToLearnFrom_);
+    }
+    threshold.setMinimum(minimalPeakHeightToLearnFrom_);
+    return threshold;
+}
+
+template <typename ParameterModel>
+void PeakParameterFwhm<ParameterModel>::setRegressionMethod(const RegressionMethod method) {
+    regressionMethod_ = method;
+}
+
+template <typename ParameterModel>
+RegressionMethod PeakParameterFwhm<ParameterModel>::getRegressionMethod() const {
+    return regressionMethod_;
+}
+
+template <typename ParameterModel>
+double PeakParameterFwhm<ParameterModel>::getFractionOfMaximum() {
+    return fractionOfMaximum_;
+}
+
 // learn_()
 template <typename ParameterModel>
 template< typename MzExtractor >
@@ -585,6 +1127,11 @@ void PeakParameterFwhm<ParameterModel>::learn_(const std::vector<std::pair<typen
     typedef std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> > MzWidthPairs_;
     psf_precondition(pairs.empty() == false, "PeakParameterFwhm::learn_(): Called with empty input vector. This is not supposed to happen. A bug in the code preceding the call of learn_ probably caused it.");
 
+    if(regressionMethod_ != leastSquaresRegression) {
+        learnRobustly_<MzExtractor>(pairs);
+        return;
+    }
+
     // We now fit the PeakParameterModel to the spectrum using linear regression.    
     // We minimize the residue |A*x - b|^2.
     // b is a column vector with all measured widths.
@@ -641,6 +1188,117 @@ void PeakParameterFwhm<ParameterModel>::learn_(const std::vector<std::pair<typen
     }
 }
 
+// learnRobustly_()
+template <typename ParameterModel>
+template< typename MzExtractor >
+void PeakParameterFwhm<ParameterModel>::learnRobustly_(const std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> >& pairs) {
+    // the design matrix doesn't change between iterations
+    CalibrationWorkspace workspace;
+    prepare_(workspace);
+    for(std::size_t i = 0; i < pairs.size(); ++i) {
+        addRow_(pairs[i].first, pairs[i].second, workspace);
+    }
+    fitNormalEquations_(workspace);
+    setParameters_(workspace);
+}
+
+// prepare_()
+template <typename ParameterModel>
+void PeakParameterFwhm<ParameterModel>::prepare_(CalibrationWorkspace& workspace) {
+    psf_invariant(this->ParameterModel::numberOfParameters() > 0, "PeakParameterFwhm::prepare_(): Number of model parameters is not greater than zero.");
+    workspace.equations_.reset(this->ParameterModel::numberOfParameters());
+    workspace.design_.clear();
+    workspace.widths_.clear();
+}
+
+// addRow_()
+template <typename ParameterModel>
+void PeakParameterFwhm<ParameterModel>::addRow_(const double mz, const double width, CalibrationWorkspace& workspace) const {
+    const unsigned nParameters = workspace.equations_.numberOfParameters();
+    this->ParameterModel::slopeInParameterSpaceFor(mz, workspace.slope_);
+    psf_invariant((workspace.slope_.size() - 1) == nParameters, "PeakParameterFwhm::addRow_(): Generalized slope has different dimension than the space, it is living in.");
+    // the bias can't be optimized
+    workspace.design_.insert(workspace.design_.end(), workspace.slope_.begin(), workspace.slope_.begin() + nParameters);
+    workspace.widths_.push_back(width);
+}
+
+// fitNormalEquations_()
+template <typename ParameterModel>
+void PeakParameterFwhm<ParameterModel>::fitNormalEquations_(CalibrationWorkspace& workspace) const {
+    NormalEquations& equations = workspace.equations_;
+    std::vector<double>& x = workspace.x_;
+    const std::vector<double>& widths = workspace.widths_;
+    const unsigned nParameters = equations.numberOfParameters();
+    const std::size_t nPairs = widths.size();
+    const int maxIterations = 50;
+    const double relativeTolerance = 1e-10;
+    // scales the median absolute deviation to the standard deviation of a normal distribution
+    const double madToSigma = 1.4826;
+
+    equations.clear();
+    for(std::size_t i = 0; i < nPairs; ++i) {
+        equations.add(&workspace.design_[i * nParameters], widths[i]);
+    }
+    equations.solveNonnegative(x);
+    if(regressionMethod_ == leastSquaresRegression || nPairs == 0) {
+        return;
+    }
+
+    // Tukey's biweight is not convex, so it starts from the converged Huber fit.
+    RegressionMethod stage = huberRegression;
+    std::vector<double>& residuals = workspace.residuals_;
+    std::vector<double>& absoluteResiduals = workspace.absoluteResiduals_;
+    residuals.resize(nPairs);
+    absoluteResiduals.resize(nPairs);
+    for(int iteration = 0; iteration < maxIterations; ++iteration) {
+        for(std::size_t i = 0; i < nPairs; ++i) {
+            const double* row = &workspace.design_[i * nParameters];
+            double model = 0.;
+            for(unsigned k = 0; k < nParameters; ++k) {
+                model += row[k] * x[k];
+            }
+            residuals[i] = widths[i] - model;
+            absoluteResiduals[i] = std::abs(residuals[i]);
+        }
+        std::nth_element(absoluteResiduals.begin(), absoluteResiduals.begin() + nPairs / 2, absoluteResiduals.end());
+        const double scale = madToSigma * absoluteResiduals[nPairs / 2];
+        if(!(scale > 0)) {
+            // the majority of the pairs is fitted perfectly
+            break;
+        }
+
+        equations.clear();
+        for(std::size_t i = 0; i < nPairs; ++i) {
+            const double r = residuals[i] / scale;
+            equations.add(&workspace.design_[i * nParameters], widths[i], stage == huberRegression ? huberWeight(r) : tukeyWeight(r));
+        }
+        workspace.previous_.assign(x.begin(), x.end());
+        equations.solveNonnegative(x);
+
+        double change = 0., size = 0.;
+        for(unsigned k = 0; k < nParameters; ++k) {
+            change = std::max(change, std::abs(x[k] - workspace.previous_[k]));
+            size = std::max(size, std::abs(x[k]));
+        }
+        if(change <= relativeTolerance * size) {
+            if(stage == regressionMethod_) {
+                PSF_LOG(logDEBUG1) << "PeakParameterFwhm::fitNormalEquations_(): Converged after " << iteration + 1 << " iterations.";
+                break;
+            }
+            stage = tukeyRegression;
+        }
+    }
+}
+
+// setParameters_()
+template <typename ParameterModel>
+void PeakParameterFwhm<ParameterModel>::setParameters_(const CalibrationWorkspace& workspace) {
+    for(unsigned index = 0; index < workspace.x_.size(); ++index) {
+        PSF_LOG(logDEBUG2) << "PeakParameterFwhm::setParameters_(): Parameter " << index << " found: " << workspace.x_[index];
+        this->ParameterModel::setParameter(index, workspace.x_[index]);
+    }
+}
+
 } /* namespace psf */
 
 #endif /*__PEAKPARAMETER_H__*/
@@ -257,6 +257,14 @@ private:
     double sigma_;
     double sigmaFactorForSupportThreshold_;
 
+    /**
+     * @f$ -\frac{1}{2\sigma^2} @f$, kept in sync with sigma_.
+     *
+     * at() is called far more often than the width is changed, so the division is done
+     * once in the setters and at() reduces to a multiplication and an exponential.
+     */
+    double exponentFactor_;
+
 friend struct ::peakshapeTestSuite;
 };
 
@@ -323,6 +331,11 @@ private:
     double fwhm_;
     double fwhmFactorForSupportThreshold_;
 
+    /**
+     * @f$ \mathrm{fwhm}^2 @f$, kept in sync with fwhm_.
+     */
+    double fwhmSquared_;
+
 friend struct ::peakshapeTestSuite;
 };
 
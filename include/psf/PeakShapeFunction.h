@@ -10,6 +10,7 @@
 
 #include "psf/PeakParameter.h"
 #include "psf/PeakShape.h"
+#include "psf/SpectrumView.h"
 
 
 
@@ -172,6 +173,29 @@ public:
      */
     double operator()(const double referenceMass, const double observedMass) const;
 
+    /**
+     * Evaluates the PSF centered at one reference mass for a sequence of observed masses.
+     *
+     * Yields the same values as calling operator()(referenceMass, observedMass) for every
+     * observed mass, but the peak width and the support threshold are determined only once
+     * per reference mass. Prefer this function, if the PSF has to be evaluated in a whole
+     * m/z window around a peak.
+     *
+     * @param referenceMass the m/z value at the center of the PSF
+     * @param firstObserved Points to the first observed m/z value.
+     * @param lastObserved Points to one past the last observed m/z value.
+     * @param result Receives one PSF value per observed m/z value.
+     * @return One past the last written element of result.
+     */
+    template< typename InIter, typename OutIter >
+    OutIter evaluate(const double referenceMass, InIter firstObserved, InIter lastObserved, OutIter result) const;
+
+    /**
+     * The same for the m/z values of a view.
+     */
+    template< typename MzT, typename IntensityT, typename OutIter >
+    OutIter evaluate(const double referenceMass, const BasicSpectrumView<MzT, IntensityT>& observed, OutIter result) const;
+
     /**
      * Return the width of the PSF support at a specific m/z value.
      *
@@ -183,6 +207,14 @@ public:
      */
     double getSupportThreshold(const double mz) const;
 
+    // getFwhm()
+    /**
+     * The full width at half maximum of the PSF at a specific m/z value.
+     *
+     * Cheaper than getSupportThreshold(), which is proportional to it.
+     */
+    double getFwhm(const double mz) const;
+
     /**
      * Returns the actual implementation type of the abstract PeakShapeFunction interface.
      *
@@ -222,6 +254,14 @@ public:
      */
     template< typename FwdIter, typename MzExtractor, typename IntensityExtractor >
     void calibrateFor(const MzExtractor&, const IntensityExtractor&, FwdIter first, FwdIter last);
+
+    /**
+     * Autocalibrate for the elements of a view, without copying them.
+     *
+     * @throw psf::Starvation See above.
+     */
+    template< typename MzT, typename IntensityT >
+    void calibrateFor(const BasicSpectrumView<MzT, IntensityT>& spectrum);
     
     // setMinimalPeakHeightForCalibration()
     /**
@@ -243,6 +283,22 @@ public:
      */
     double getMinimalPeakHeightForCalibration();
 
+    // setNoiseFactorForCalibration()
+    /**
+     * Use only peaks above the local noise level for autocalibration.
+     *
+     * The internally used peak parameters have to support this feature. Else, calling the
+     * function would result in a compile time error.
+     *
+     * @param factor Number of noise standard deviations above the noise median; zero
+     *               switches the noise threshold off.
+     * @see psf::NoiseThreshold
+     */
+    void setNoiseFactorForCalibration(double factor);
+
+    // getNoiseFactorForCalibration()
+    double getNoiseFactorForCalibration() const;
+
 private:
     mutable PeakShapeT peakshape_;
     PeakParameterT peakparameter_;
@@ -304,11 +360,12 @@ template <typename PeakShapeT, typename PeakParameterT, psf::PeakShapeFunctionTy
 double 
 PeakShapeFunctionTemplate<PeakShapeT, PeakParameterT, PeakShapeFunctionTypeT>::
 operator()(const double referenceMass, const double observedMass) const {
-    double supportThreshold = this->getSupportThreshold( referenceMass );        
+    // the peak shape is set up only once; getSupportThreshold() would do it a second time
+    peakshape_.setFwhm(peakparameter_.at(referenceMass));
+    double supportThreshold = peakshape_.getSupportThreshold();
     double massDifference = observedMass - referenceMass;
 
     if((-supportThreshold <= massDifference) && (massDifference <= supportThreshold)) {
-        peakshape_.setFwhm(peakparameter_.at(referenceMass));
         return peakshape_.at(massDifference);
     }
     else {
@@ -316,6 +373,36 @@ operator()(const double referenceMass, const double observedMass) const {
     }
 }
 
+// evaluate()
+template <typename PeakShapeT, typename PeakParameterT, psf::PeakShapeFunctionTypes PeakShapeFunctionTypeT>
+template< typename InIter, typename OutIter >
+OutIter
+PeakShapeFunctionTemplate<PeakShapeT, PeakParameterT, PeakShapeFunctionTypeT>::
+evaluate(const double referenceMass, InIter firstObserved, InIter lastObserved, OutIter result) const {
+    peakshape_.setFwhm(peakparameter_.at(referenceMass));
+    const double supportThreshold = peakshape_.getSupportThreshold();
+
+    for(; firstObserved != lastObserved; ++firstObserved, ++result) {
+        const double massDifference = *firstObserved - referenceMass;
+        if((-supportThreshold <= massDifference) && (massDifference <= supportThreshold)) {
+            *result = peakshape_.at(massDifference);
+        }
+        else {
+            *result = 0.0;
+        }
+    }
+    return result;
+}
+
+// evaluate()
+template <typename PeakShapeT, typename PeakParameterT, psf::PeakShapeFunctionTypes PeakShapeFunctionTypeT>
+template< typename MzT, typename IntensityT, typename OutIter >
+OutIter
+PeakShapeFunctionTemplate<PeakShapeT, PeakParameterT, PeakShapeFunctionTypeT>::
+evaluate(const double referenceMass, const BasicSpectrumView<MzT, IntensityT>& observed, OutIter result) const {
+    return evaluate(referenceMass, observed.mzBegin(), observed.mzEnd(), result);
+}
+
 // getSupportThreshold()
 template <typename PeakShapeT, typename PeakParameterT, psf::PeakShapeFunctionTypes PeakShapeFunctionTypeT>
 double 
@@ -325,6 +412,14 @@ getSupportThreshold(const double mz) const {
     return peakshape_.getSupportThreshold();        
 }
 
+// getFwhm()
+template <typename PeakShapeT, typename PeakParameterT, psf::PeakShapeFunctionTypes PeakShapeFunctionTypeT>
+double 
+PeakShapeFunctionTemplate<PeakShapeT, PeakParameterT, PeakShapeFunctionTypeT>::
+getFwhm(const double mz) const {
+    return peakparameter_.at(mz);
+}
+
 // getType()
 template <typename PeakShapeT, typename PeakParameterT, psf::PeakShapeFunctionTypes PeakShapeFunctionTypeT>
 inline
@@ -396,6 +491,15 @@ calibrateFor(const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIt
   peakparameter_.learnFrom(get_mz, get_int, first, last);
 }
 
+// calibrateFor()
+template <typename PeakShapeT, typename PeakParameterT, psf::PeakShapeFunctionTypes PeakShapeFunctionTypeT>
+template< typename MzT, typename IntensityT >
+void
+PeakShapeFunctionTemplate<PeakShapeT, PeakParameterT, PeakShapeFunctionTypeT>::
+calibrateFor(const BasicSpectrumView<MzT, IntensityT>& spectrum) {
+  peakparameter_.learnFrom(MzExtractor(), IntensityExtractor(), spectrum.begin(), spectrum.end());
+}
+
 // setMinimalPeakHeightForCalibration()
 template <typename PeakShapeT, typename PeakParameterT, psf::PeakShapeFunctionTypes PeakShapeFunctionTypeT>
 void 
@@ -412,6 +516,22 @@ getMinimalPeakHeightForCalibration() {
     return peakparameter_.getMinimalPeakHeightToLearnFrom();
 }
 
+// setNoiseFactorForCalibration()
+template <typename PeakShapeT, typename PeakParameterT, psf::PeakShapeFunctionTypes PeakShapeFunctionTypeT>
+void 
+PeakShapeFunctionTemplate<PeakShapeT, PeakParameterT, PeakShapeFunctionTypeT>::
+setNoiseFactorForCalibration(const double factor) {
+    peakparameter_.setNoiseFactorToLearnFrom(factor);
+}
+
+// getNoiseFactorForCalibration()
+template <typename PeakShapeT, typename PeakParameterT, psf::PeakShapeFunctionTypes PeakShapeFunctionTypeT>
+double
+PeakShapeFunctionTemplate<PeakShapeT, PeakParameterT, PeakShapeFunctionTypeT>::
+getNoiseFactorForCalibration() const {
+    return peakparameter_.getNoiseFactorToLearnFrom();
+}
+
 } /* namespace psf */
 
 #endif /*__PEAKSHAPEFUNCTION_H__*/
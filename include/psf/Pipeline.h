@@ -0,0 +1,393 @@
+#ifndef __PIPELINE_H__
+#define __PIPELINE_H__
+#include <psf/config.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <psf/BoundedQueue.h>
+#include <psf/Error.h>
+#include <psf/Parallel.h>
+
+/**
+ * @page pipeline Pipelined Processing of Runs
+ *
+ * Processing a run is a chain of stages: read a scan, calibrate, evaluate the peak shape
+ * function, write the results. Run one after another, every scan costs the sum of the
+ * stages. A psf::Pipeline runs the stages concurrently on different scans, so that the
+ * throughput is set by the slowest stage; a slow stage that doesn't depend on the
+ * previous scans can be given several threads.
+ *
+ * @code
+ * struct Job { psf::MzMLScan scan; std::vector<psf::Centroid> centroids; };
+ * psf::MzMLReader reader("run.mzML", 2);
+ * psf::Pipeline<Job> pipeline;
+ * pipeline.addStage([&](Job& job) { orbi.calibrateFor(get_mz, get_int, job.scan.spectrum.begin(), job.scan.spectrum.end()); })
+ *         .addStage([&](Job& job) { ... centroid with a copy of orbi ... }, 4);
+ * pipeline.run([&](Job& job) { return reader.next(job.scan); },
+ *              [&](Job& job) { write(job.centroids); });
+ * @endcode
+ *
+ * The items are preallocated and reused: a fixed number of them circulates from the source
+ * through the stages to the sink and back, so their buffers keep their capacity and the
+ * memory of a run doesn't grow with its length. Stages pass the items through bounded
+ * lock-free queues (psf::BoundedQueue). When a stage falls behind, its input queue fills
+ * up until all items are in flight; then the source waits for the sink to return one
+ * (back-pressure). A thread waiting on a full or empty queue tries a few times, then
+ * sleeps until the queue changes, so that waiting threads leave the cores to the busy
+ * stages.
+ *
+ * On a single core the threads only take turns, and every hand-over costs a context
+ * switch. There the pipeline falls back to the plain loop: run() calls the source, the
+ * stages and the sink one after another for every item on the calling thread (see
+ * setConcurrent()).
+ *
+ * The source and the sink run serially and see the items in order. A stage with one
+ * thread sees the items in order, too, so it may carry state from scan to scan (like a
+ * calibration that follows the drift of the instrument); a stage with several threads
+ * sees them in any order.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class Pipeline
+/**
+ * Runs a source, a chain of stages and a sink concurrently on a stream of items.
+ *
+ * @tparam Item Default constructible; the items are reused from run to run.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+template< typename Item >
+class Pipeline
+{
+public:
+    /**
+     * @param maxItemsInFlight Number of items circulating. Zero means twice the number of
+     *      threads of the pipeline (including the source and the sink).
+     */
+    explicit Pipeline(const std::size_t maxItemsInFlight = 0) : maxItemsInFlight_(maxItemsInFlight), concurrent_(hardwareConcurrency() > 1) {}
+
+    // addStage()
+    /**
+     * Appends a stage calling stage(item) for every item.
+     *
+     * @param nThreads Threads running the stage. Zero means psf::hardwareConcurrency().
+     *      With one thread, the items are processed in order.
+     * @return The pipeline, to chain further stages.
+     */
+    Pipeline& addStage(const std::function<void(Item&)>& stage, unsigned nThreads = 1) {
+        if(nThreads == 0) {
+            nThreads = hardwareConcurrency();
+        }
+        Stage_ s;
+        s.f = stage;
+        s.nThreads = nThreads;
+        stages_.push_back(s);
+        return *this;
+    }
+
+    std::size_t numberOfStages() const { return stages_.size(); }
+
+    // setConcurrent()
+    /**
+     * Whether run() runs the source, the stages and the sink on threads of their own.
+     * If not, the items are processed one after another on the calling thread, with the
+     * same results. The default is concurrent, if the hardware runs more than one thread.
+     * A source waiting for a disk or the network still gains from concurrency on a single
+     * core, since the stages run while it waits.
+     */
+    void setConcurrent(const bool concurrent) { concurrent_ = concurrent; }
+    bool isConcurrent() const { return concurrent_; }
+
+    // run()
+    /**
+     * Processes items until the source is exhausted.
+     *
+     * The source runs on a thread of its own, the sink on the calling thread; without
+     * concurrency, all of them run on the calling thread.
+     *
+     * @param source Callable bool(Item&): fills the item with the next input; false at
+     *      the end.
+     * @param sink Callable void(Item&): consumes an item after the last stage, in the
+     *      order of the source.
+     * @return Number of items passed to the sink.
+     * @throw The first exception thrown by the source, a stage or the sink, after all
+     *      threads have stopped.
+     */
+    template< typename Source, typename Sink >
+    std::size_t run(Source source, Sink sink);
+
+private:
+    struct Stage_
+    {
+        std::function<void(Item&)> f;
+        unsigned nThreads;
+    };
+
+    // an item on its way; sequence end_ marks the end of the stream
+    struct Token_
+    {
+        Token_() : slot(0), sequence(0) {}
+        Token_(const std::size_t s, const std::size_t q) : slot(s), sequence(q) {}
+        std::size_t slot;
+        std::size_t sequence;
+    };
+
+    static const std::size_t end_ = static_cast<std::size_t>(-1);
+
+    std::vector<Stage_> stages_;
+    std::size_t maxItemsInFlight_;
+    bool concurrent_;
+    std::vector<Item> items_;
+};
+
+
+
+/******************/
+/* implementation */
+/******************/
+namespace {
+    // Tries on a full or empty queue before the thread goes to sleep. Most waits in a
+    // pipeline are short, but a thread spinning on a slow stage takes its core away.
+    const int spins_ = 16;
+
+    // A psf::BoundedQueue threads can sleep on until it changes.
+    template< typename T >
+    struct WaitingQueue_
+    {
+        explicit WaitingQueue_(const std::size_t capacity) : queue(capacity), sleepers(0) {}
+
+        BoundedQueue<T> queue;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::atomic<unsigned> sleepers;
+    };
+
+    // Wakes the threads sleeping on the queue; after a push, a pop or a cancellation.
+    template< typename T >
+    void wake_(WaitingQueue_<T>& queue) {
+        // pairs with the fence after the increment of sleepers in waitFor_(): either the
+        // sleeper sees the change or the change sees the sleeper
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(queue.sleepers.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.changed.notify_all();
+        }
+    }
+
+    // Calls attempt() until it succeeds; false, if cancelled meanwhile.
+    template< typename T, typename Attempt >
+    bool waitFor_(WaitingQueue_<T>& queue, Attempt attempt, const std::atomic<bool>& cancelled) {
+        for(int i = 0; i < spins_; ++i) {
+            if(attempt()) {
+                wake_(queue);
+                return true;
+            }
+            if(cancelled.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        ++queue.sleepers;
+        // pairs with the fence in wake_(): the last try below sees the change, or the
+        // waker sees the sleeper and notifies under the mutex, after the sleeper waits
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while(true) {
+            if(attempt()) {
+                --queue.sleepers;
+                lock.unlock();
+                wake_(queue);
+                return true;
+            }
+            if(cancelled.load()) {
+                --queue.sleepers;
+                return false;
+            }
+            queue.changed.wait(lock);
+        }
+    }
+
+    // Waits until the value is pushed; false, if cancelled meanwhile.
+    template< typename T >
+    bool pushOrCancel_(WaitingQueue_<T>& queue, const T& value, const std::atomic<bool>& cancelled) {
+        return waitFor_(queue, [&queue, &value]() { return queue.queue.tryPush(value); }, cancelled);
+    }
+
+    template< typename T >
+    bool popOrCancel_(WaitingQueue_<T>& queue, T& value, const std::atomic<bool>& cancelled) {
+        return waitFor_(queue, [&queue, &value]() { return queue.queue.tryPop(value); }, cancelled);
+    }
+} /* anonymous namespace */
+
+template< typename Item >
+template< typename Source, typename Sink >
+std::size_t Pipeline<Item>::run(Source source, Sink sink) {
+    const std::size_t nStages = stages_.size();
+    if(!concurrent_) {
+        if(items_.empty()) {
+            items_.resize(1);
+        }
+        Item& item = items_[0];
+        std::size_t consumed = 0;
+        while(source(item)) {
+            for(std::size_t k = 0; k < nStages; ++k) {
+                stages_[k].f(item);
+            }
+            sink(item);
+            ++consumed;
+        }
+        return consumed;
+    }
+
+    std::size_t nThreads = 2;
+    for(std::size_t k = 0; k < nStages; ++k) {
+        nThreads += stages_[k].nThreads;
+    }
+    const std::size_t inFlight = maxItemsInFlight_ ? maxItemsInFlight_ : 2 * nThreads;
+    if(items_.size() < inFlight) {
+        items_.resize(inFlight);
+    }
+
+    // queue k feeds stage k, the last one the sink; each holds every item and end token
+    WaitingQueue_<std::size_t> freeSlots(inFlight);
+    for(std::size_t slot = 0; slot < inFlight; ++slot) {
+        freeSlots.queue.tryPush(slot);
+    }
+    std::vector<std::unique_ptr<WaitingQueue_<Token_> > > queues;
+    std::vector<unsigned> consumers; // threads popping from queue k
+    for(std::size_t k = 0; k <= nStages; ++k) {
+        consumers.push_back(k < nStages ? stages_[k].nThreads : 1);
+        queues.push_back(std::unique_ptr<WaitingQueue_<Token_> >(new WaitingQueue_<Token_>(inFlight + consumers[k])));
+    }
+    std::vector<std::unique_ptr<std::atomic<unsigned> > > running;
+    for(std::size_t k = 0; k < nStages; ++k) {
+        running.push_back(std::unique_ptr<std::atomic<unsigned> >(new std::atomic<unsigned>(stages_[k].nThreads)));
+    }
+
+    std::atomic<bool> cancelled(false);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto fail = [&cancelled, &error, &errorMutex, &freeSlots, &queues]() {
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if(!error) {
+                error = std::current_exception();
+            }
+        }
+        cancelled.store(true);
+        // the sleepers check for the cancellation before they go to sleep
+        wake_(freeSlots);
+        for(std::size_t k = 0; k < queues.size(); ++k) {
+            wake_(*queues[k]);
+        }
+    };
+    auto endStream = [&queues, &consumers, &cancelled](const std::size_t k) {
+        for(unsigned i = 0; i < consumers[k]; ++i) {
+            pushOrCancel_(*queues[k], Token_(0, end_), cancelled);
+        }
+    };
+
+    // Pops the tokens of queue k and hands them to process() in order of their sequence;
+    // the tokens arriving early wait in a ring indexed by sequence.
+    auto inOrder = [&queues, &cancelled, inFlight](const std::size_t k, const std::function<void(const Token_&)>& process) {
+        std::vector<Token_> waiting(inFlight);
+        std::vector<char> present(inFlight, 0);
+        std::size_t next = 0;
+        Token_ token;
+        while(popOrCancel_(*queues[k], token, cancelled)) {
+            if(token.sequence == end_) {
+                return;
+            }
+            waiting[token.sequence % inFlight] = token;
+            present[token.sequence % inFlight] = 1;
+            while(present[next % inFlight] && !cancelled.load(std::memory_order_relaxed)) {
+                present[next % inFlight] = 0;
+                process(waiting[next % inFlight]);
+                ++next;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.push_back(std::thread([&]() {
+        try {
+            std::size_t sequence = 0;
+            std::size_t slot;
+            while(popOrCancel_(freeSlots, slot, cancelled)) {
+                if(!source(items_[slot])) {
+                    break;
+                }
+                if(!pushOrCancel_(*queues[0], Token_(slot, sequence++), cancelled)) {
+                    return;
+                }
+            }
+            endStream(0);
+        } catch(...) {
+            fail();
+        }
+    }));
+
+    for(std::size_t k = 0; k < nStages; ++k) {
+        const Stage_& stage = stages_[k];
+        for(unsigned t = 0; t < stage.nThreads; ++t) {
+            threads.push_back(std::thread([&, k]() {
+                try {
+                    if(stage.nThreads == 1) {
+                        inOrder(k, [&](const Token_& token) {
+                            stage.f(items_[token.slot]);
+                            pushOrCancel_(*queues[k + 1], token, cancelled);
+                        });
+                    }
+                    else {
+                        Token_ token;
+                        while(popOrCancel_(*queues[k], token, cancelled) && token.sequence != end_) {
+                            stage.f(items_[token.slot]);
+                            pushOrCancel_(*queues[k + 1], token, cancelled);
+                        }
+                    }
+                    // the last thread of the stage ends the stream downstream
+                    if(--*running[k] == 0) {
+                        endStream(k + 1);
+                    }
+                } catch(...) {
+                    fail();
+                }
+            }));
+        }
+    }
+
+    std::size_t consumed = 0;
+    try {
+        inOrder(nStages, [&](const Token_& token) {
+            sink(items_[token.slot]);
+            ++consumed;
+            pushOrCancel_(freeSlots, token.slot, cancelled);
+        });
+    } catch(...) {
+        fail();
+    }
+
+    for(std::size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    if(error) {
+        std::rethrow_exception(error);
+    }
+    return consumed;
+}
+
+} /* namespace psf */
+
+#endif /*__PIPELINE_H__*/
@@ -0,0 +1,171 @@
+#ifndef __REGRESSION_H__
+#define __REGRESSION_H__
+#include <psf/config.h>
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @page regression Linear Regression with Normal Equations
+ *
+ * The peak parameter models are linear in their parameters, so fitting them to measured
+ * (m/z | width) pairs is a linear regression. psf::NormalEquations accumulates the
+ * weighted normal equations @f$ A^T W A\,x = A^T W b @f$ one observation at a time. Solving
+ * them only involves a @f$ p \times p @f$ system, where p is the (small) number of model
+ * parameters, independent of the number of observations.
+ *
+ * This makes iteratively reweighted least squares cheap: psf::PeakParameterFwhm with a
+ * robust psf::RegressionMethod reweights the observations and solves the p x p system in
+ * every iteration, instead of a full least squares problem over all pairs.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// enum RegressionMethod
+/**
+ * Method to fit a peak parameter model to measured (m/z | width) pairs.
+ *
+ * leastSquaresRegression: Ordinary non-negative least squares. Every pair has the same
+ *                         influence, so outliers like widths of overlapping peaks bias
+ *                         the fit.
+ * huberRegression: Iteratively reweighted least squares with Huber weights. Large
+ *                  residuals are downweighted.
+ * tukeyRegression: Iteratively reweighted least squares with Tukey's biweight, starting
+ *                  from the Huber fit. Gross outliers are ignored completely.
+ */
+enum PSF_EXPORT RegressionMethod {leastSquaresRegression, huberRegression, tukeyRegression};
+
+// huberWeight()
+/**
+ * Weight of a residual in Huber's M-estimator: 1 for |r| <= k and k/|r| else.
+ *
+ * @param residual Residual divided by the scale of the residuals.
+ * @param k Tuning constant; 1.345 gives 95% efficiency for normally distributed residuals.
+ */
+PSF_EXPORT double huberWeight(double residual, double k = 1.345);
+
+// tukeyWeight()
+/**
+ * Weight of a residual in Tukey's biweight M-estimator: (1 - (r/c)^2)^2 for |r| < c and 0 else.
+ *
+ * @param residual Residual divided by the scale of the residuals.
+ * @param c Tuning constant; 4.685 gives 95% efficiency for normally distributed residuals.
+ */
+PSF_EXPORT double tukeyWeight(double residual, double c = 4.685);
+
+// class NormalEquations
+/**
+ * Weighted normal equations of a linear least squares problem.
+ *
+ * Observations are rows @f$ a_i @f$ of the design matrix A together with the observed
+ * value @f$ b_i @f$ and a weight @f$ w_i @f$. Only the @f$ p \times p @f$ matrix
+ * @f$ A^T W A @f$, the vector @f$ A^T W b @f$ and @f$ b^T W b @f$ are stored.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT NormalEquations
+{
+public:
+    /**
+     * @param nParameters Number of unknowns p; has to be positive.
+     * @throw psf::PreconditionViolation nParameters is zero.
+     */
+    explicit NormalEquations(unsigned nParameters);
+
+    unsigned numberOfParameters() const;
+
+    /**
+     * Number of added observations.
+     */
+    std::size_t count() const;
+
+    /**
+     * Removes all observations.
+     */
+    void clear();
+
+    /**
+     * Removes all observations and changes the number of unknowns.
+     *
+     * Doesn't allocate memory, if nParameters is not larger than any number of unknowns
+     * before.
+     *
+     * @throw psf::PreconditionViolation nParameters is zero.
+     */
+    void reset(unsigned nParameters);
+
+    /**
+     * Adds an observation.
+     *
+     * @param row Row of the design matrix; only the first numberOfParameters() elements are
+     *      used, so a psf::GeneralizedSlope including the bias may be passed directly.
+     * @param value The observed value.
+     * @param weight Has to be non-negative.
+     * @throw psf::PreconditionViolation row is too short or weight is negative.
+     */
+    void add(const std::vector<double>& row, double value, double weight = 1.);
+
+    /**
+     * The same for a row given by its first element; numberOfParameters() elements are
+     * read.
+     *
+     * @throw psf::PreconditionViolation weight is negative.
+     */
+    void add(const double* row, double value, double weight = 1.);
+
+    /**
+     * Least squares solution under the constraint x >= 0.
+     *
+     * The problem is a convex quadratic program in p variables. It is solved exactly by
+     * trying every set of active constraints, which is cheap for the small number of
+     * parameters of a peak parameter model. No memory is allocated, if x has
+     * already the capacity for numberOfParameters() elements.
+     *
+     * @param x Resized to numberOfParameters() and overwritten.
+     * @throw psf::PreconditionViolation More than 16 parameters.
+     */
+    void solveNonnegative(std::vector<double>& x) const;
+
+    /**
+     * The weighted residual sum of squares @f$ \sum_i w_i (b_i - a_i x)^2 @f$.
+     *
+     * @param x Has to have numberOfParameters() elements.
+     */
+    double residualSumOfSquares(const std::vector<double>& x) const;
+
+    /**
+     * Sum of the weights of all added observations.
+     */
+    double sumOfWeights() const;
+
+    /**
+     * Estimated covariance matrix of the parameters at the solution x.
+     *
+     * @f$ s^2 (A^T W A)^{-1} @f$ with the residual variance
+     * @f$ s^2 = RSS / (\sum_i w_i - p) @f$. For unit weights this is the usual least
+     * squares estimate; for the weights of a robust fit it is an approximation with the sum
+     * of weights as effective number of observations.
+     *
+     * @param x Has to have numberOfParameters() elements.
+     * @param result Resized to numberOfParameters()^2 and overwritten (row major).
+     * @throw psf::Starvation The (effective) number of observations doesn't exceed the
+     *      number of parameters.
+     * @throw psf::NumericalInstability The normal equations are singular.
+     */
+    void covariance(const std::vector<double>& x, std::vector<double>& result) const;
+
+private:
+    unsigned nParameters_;
+    std::size_t count_;
+    std::vector<double> gram_; // A^T W A, row major
+    std::vector<double> moment_; // A^T W b
+    double valueSquares_; // b^T W b
+    double sumOfWeights_;
+};
+
+} /* namespace psf */
+
+#endif /*__REGRESSION_H__*/
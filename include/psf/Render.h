@@ -0,0 +1,253 @@
+#ifndef __RENDER_H__
+#define __RENDER_H__
+#include <psf/config.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/Log.h>
+#include <psf/Parallel.h>
+
+/**
+ * @page render Rendering of Stick Spectra
+ *
+ *
+ *
+ * @section renderintroduction From sticks to profiles
+ *
+ * A theoretical mass spectrum is a list of sticks: pairs of a true m/z value and an
+ * abundance. A profile mass spectrum as measured by an instrument is obtained by blurring every
+ * stick with the peak shape function of the instrument and summing up the contributions on
+ * the m/z grid of the detector:
+ * @f$ \mathrm{profile}(m) = \sum_s \mathrm{abundance}_s \cdot \mathrm{psf}(m_s, m) @f$.
+ *
+ * Since a peak shape function is zero beyond its support threshold, every stick contributes
+ * only to the few grid points within its support window. psf::renderProfile() and
+ * psf::renderProfileOnUniformGrid() evaluate the peak shape function only there.
+ *
+ *
+ * @section renderparallel Parallel rendering
+ *
+ * The target grid is split into contiguous blocks of equal size. Every block is rendered by
+ * exactly one thread, which collects all sticks whose support window overlaps the block. So,
+ * no two threads write to the same grid point and no atomic operations or locks are needed.
+ *
+ * The peak shape functions are not thread-safe (they cache the current peak width), so
+ * every block works on its own copy of the peak shape function.
+ *
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// renderProfile()
+/**
+ * Renders a stick spectrum into a profile spectrum on an arbitrary m/z grid.
+ *
+ * Computes @f$ \mathrm{result}_i = \sum_s \mathrm{abundance}_s \cdot \mathrm{psf}(m_s, \mathrm{grid}_i) @f$
+ * for every grid point. Sticks are only evaluated within their support window.
+ *
+ * The distances (lastStick - firstStick) and (lastMz - firstMz) may not be negative, else the
+ * behaviour is undefined.
+ *
+ * @param psf A (calibrated) peak shape function, for example a psf::OrbitrapPeakShapeFunction.
+ * @param firstStick Points to the first stick. The sticks have to be in ascending order of m/z.
+ * @param lastStick Points to one past the last stick.
+ * @param firstMz Points to the first m/z value of the target grid. The grid has to be in
+ *                ascending order.
+ * @param lastMz Points to one past the last m/z value of the target grid.
+ * @param result Receives one intensity per grid point. Existing values are overwritten.
+ * @param nThreads Number of threads to render with. Zero means psf::hardwareConcurrency().
+ *
+ * @throw psf::PreconditionViolation A stick has a non-positive m/z value.
+ *
+ * @see psf::renderProfileOnUniformGrid
+ */
+template< typename PeakShapeFunction, typename FwdIter, typename MzExtractor, typename IntensityExtractor, typename RandomAccessGridIter, typename RandomAccessOutIter >
+void renderProfile(const PeakShapeFunction& psf, const MzExtractor&, const IntensityExtractor&, FwdIter firstStick, FwdIter lastStick, RandomAccessGridIter firstMz, RandomAccessGridIter lastMz, RandomAccessOutIter result, unsigned nThreads = 1);
+
+// renderProfileOnUniformGrid()
+/**
+ * Renders a stick spectrum into a profile spectrum on a uniform m/z grid.
+ *
+ * The grid consists of the nPoints m/z values @f$ \mathrm{firstMz} + i\cdot\mathrm{mzStep} @f$.
+ * The support window of a stick is mapped to grid indices directly, without searching.
+ *
+ * @param mzStep Distance between two grid points; has to be positive.
+ *
+ * @throw psf::PreconditionViolation mzStep is not positive or a stick has a non-positive m/z value.
+ *
+ * @see psf::renderProfile
+ */
+template< typename PeakShapeFunction, typename FwdIter, typename MzExtractor, typename IntensityExtractor, typename RandomAccessOutIter >
+void renderProfileOnUniformGrid(const PeakShapeFunction& psf, const MzExtractor&, const IntensityExtractor&, FwdIter firstStick, FwdIter lastStick, double firstMz, double mzStep, std::size_t nPoints, RandomAccessOutIter result, unsigned nThreads = 1);
+
+
+
+
+
+
+/******************/
+/* implementation */
+/******************/
+
+// renderProfile(): private implementation details
+namespace
+{
+// class SortedRenderGrid
+/**
+ * Grid given by an ascending sequence of m/z values.
+ */
+template< typename RandomAccessIter >
+class SortedRenderGrid {
+  public:
+  SortedRenderGrid( RandomAccessIter first, RandomAccessIter last ) : first_(first), size_(last - first) {};
+
+  std::size_t size() const { return size_; };
+  double mz( std::size_t i ) const { return first_[i]; };
+
+  // index of the first grid point inside [block, blockEnd) with mz >= lower
+  std::size_t lowerIndex( double lower, std::size_t block, std::size_t blockEnd ) const {
+    return std::lower_bound(first_ + block, first_ + blockEnd, lower) - first_;
+  };
+  // index of one past the last grid point inside [block, blockEnd) with mz <= upper
+  std::size_t upperIndex( double upper, std::size_t block, std::size_t blockEnd ) const {
+    return std::upper_bound(first_ + block, first_ + blockEnd, upper) - first_;
+  };
+
+  private:
+  RandomAccessIter first_;
+  std::size_t size_;
+};
+
+// class UniformRenderGrid
+/**
+ * Grid with equidistant m/z values. The index bounds are computed conservatively; grid points
+ * just outside a support window are evaluated to zero by the peak shape function anyway.
+ */
+class UniformRenderGrid {
+  public:
+  UniformRenderGrid( double firstMz, double mzStep, std::size_t size ) : firstMz_(firstMz), mzStep_(mzStep), size_(size) {};
+
+  std::size_t size() const { return size_; };
+  double mz( std::size_t i ) const { return firstMz_ + i * mzStep_; };
+
+  std::size_t lowerIndex( double lower, std::size_t block, std::size_t blockEnd ) const {
+    const double i = std::floor((lower - firstMz_) / mzStep_);
+    return clamp_(i, block, blockEnd);
+  };
+  std::size_t upperIndex( double upper, std::size_t block, std::size_t blockEnd ) const {
+    const double i = std::floor((upper - firstMz_) / mzStep_) + 2;
+    return clamp_(i, block, blockEnd);
+  };
+
+  private:
+  static std::size_t clamp_( double i, std::size_t block, std::size_t blockEnd ) {
+    if(i <= static_cast<double>(block)) return block;
+    if(i >= static_cast<double>(blockEnd)) return blockEnd;
+    return static_cast<std::size_t>(i);
+  };
+
+  double firstMz_;
+  double mzStep_;
+  std::size_t size_;
+};
+
+// renderSticks_()
+/**
+ * Renders sticks given as parallel arrays (m/z, abundance, support threshold) onto a grid.
+ */
+template< typename PeakShapeFunction, typename Grid, typename RandomAccessOutIter >
+void renderSticks_(const PeakShapeFunction& psf, const std::vector<double>& mzs, const std::vector<double>& abundances, const std::vector<double>& supports, const Grid& grid, RandomAccessOutIter result, unsigned nThreads) {
+    const std::size_t nPoints = grid.size();
+    if(nPoints == 0) {
+        return;
+    }
+    if(nThreads == 0) {
+        nThreads = hardwareConcurrency();
+    }
+    const double maxSupport = supports.empty() ? 0. : *std::max_element(supports.begin(), supports.end());
+    const std::size_t nBlocks = std::min<std::size_t>(nThreads, nPoints);
+
+    parallelFor(nBlocks, nThreads, [&](std::size_t blockIndex) {
+        const std::size_t block = nPoints * blockIndex / nBlocks;
+        const std::size_t blockEnd = nPoints * (blockIndex + 1) / nBlocks;
+        for(std::size_t i = block; i < blockEnd; ++i) {
+            result[i] = 0.;
+        }
+        if(block == blockEnd) {
+            return;
+        }
+
+        // every block works on its own copy; the peak shape caches its current width
+        PeakShapeFunction localPsf(psf);
+        std::vector<double> observed, values;
+
+        // only sticks within maxSupport of the block can contribute
+        std::vector<double>::const_iterator stick = std::lower_bound(mzs.begin(), mzs.end(), grid.mz(block) - maxSupport);
+        const double upperMz = grid.mz(blockEnd - 1) + maxSupport;
+        for(; stick != mzs.end() && *stick <= upperMz; ++stick) {
+            const std::size_t s = stick - mzs.begin();
+            const std::size_t lo = grid.lowerIndex(mzs[s] - supports[s], block, blockEnd);
+            const std::size_t hi = grid.upperIndex(mzs[s] + supports[s], block, blockEnd);
+            if(lo >= hi) {
+                continue;
+            }
+
+            observed.resize(hi - lo);
+            values.resize(hi - lo);
+            for(std::size_t i = lo; i < hi; ++i) {
+                observed[i - lo] = grid.mz(i);
+            }
+            localPsf.evaluate(mzs[s], observed.begin(), observed.end(), values.begin());
+            for(std::size_t i = lo; i < hi; ++i) {
+                result[i] += abundances[s] * values[i - lo];
+            }
+        }
+    });
+}
+
+// collectSticks_()
+/**
+ * Copies the sticks into parallel arrays and determines their support thresholds.
+ */
+template< typename PeakShapeFunction, typename FwdIter, typename MzExtractor, typename IntensityExtractor >
+void collectSticks_(const PeakShapeFunction& psf, const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter first, FwdIter last, std::vector<double>& mzs, std::vector<double>& abundances, std::vector<double>& supports) {
+    for(; first != last; ++first) {
+        mzs.push_back(get_mz(*first));
+        abundances.push_back(get_int(*first));
+        supports.push_back(psf.getSupportThreshold(get_mz(*first)));
+    }
+}
+} /* anonymous namespace */
+
+// renderProfile()
+template< typename PeakShapeFunction, typename FwdIter, typename MzExtractor, typename IntensityExtractor, typename RandomAccessGridIter, typename RandomAccessOutIter >
+void renderProfile(const PeakShapeFunction& psf, const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter firstStick, FwdIter lastStick, RandomAccessGridIter firstMz, RandomAccessGridIter lastMz, RandomAccessOutIter result, unsigned nThreads) {
+    std::vector<double> mzs, abundances, supports;
+    collectSticks_(psf, get_mz, get_int, firstStick, lastStick, mzs, abundances, supports);
+
+    SortedRenderGrid<RandomAccessGridIter> grid(firstMz, lastMz);
+    renderSticks_(psf, mzs, abundances, supports, grid, result, nThreads);
+}
+
+// renderProfileOnUniformGrid()
+template< typename PeakShapeFunction, typename FwdIter, typename MzExtractor, typename IntensityExtractor, typename RandomAccessOutIter >
+void renderProfileOnUniformGrid(const PeakShapeFunction& psf, const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter firstStick, FwdIter lastStick, double firstMz, double mzStep, std::size_t nPoints, RandomAccessOutIter result, unsigned nThreads) {
+    psf_precondition(mzStep > 0, "renderProfileOnUniformGrid(): Parameter mzStep has to be positive.");
+    std::vector<double> mzs, abundances, supports;
+    collectSticks_(psf, get_mz, get_int, firstStick, lastStick, mzs, abundances, supports);
+
+    UniformRenderGrid grid(firstMz, mzStep, nPoints);
+    renderSticks_(psf, mzs, abundances, supports, grid, result, nThreads);
+}
+
+} /* namespace psf */
+
+#endif /*__RENDER_H__*/
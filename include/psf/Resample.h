@@ -0,0 +1,383 @@
+#ifndef __RESAMPLE_H__
+#define __RESAMPLE_H__
+#include <psf/config.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include <psf/Error.h>
+#include <psf/Log.h>
+
+/**
+ * @page resample Resampling on Uniform Grids
+ *
+ *
+ *
+ * @section resampleintroduction Why resample?
+ *
+ * Profile spectra, as for example written by an Orbitrap, are not uniformly spaced in m/z and
+ * elements with zero intensity are usually missing (psf::operator>>() drops them). Kernels
+ * with a fixed stride, like the FFT in psf::convolveOnUniformGrid() or vectorized loops,
+ * need a uniform grid instead.
+ *
+ * psf::resampleOnGrid() maps a spectrum onto a psf::ResamplingGrid in a single linear pass
+ * and writes the intensities into a buffer provided by the caller.
+ *
+ *
+ * @section resamplescales Grid scales
+ *
+ * A ResamplingGrid is uniform in a transformed coordinate u(m/z). The transformation is
+ * given by a scale policy:
+ * @li psf::LinearScale: u = m/z. Matches a constant FWHM (psf::ConstantFwhm).
+ * @li psf::SqrtScale: u = sqrt(m/z). Matches a FWHM proportional to sqrt(m/z) (psf::TofFwhm).
+ * @li psf::LogScale: u = log(m/z). Matches a FWHM proportional to m/z, i.e. a constant
+ *     resolving power.
+ *
+ * @li psf::WarpedScale: u = fwhm.warp(m/z). Matches any psf::PeakParameterFwhm, whose
+ *     model supports warping; the FWHM is one in the warped coordinate.
+ *
+ * On a matching scale every peak covers the same number of grid points regardless of its
+ * m/z value. psf::makeResamplingGrid() chooses the grid spacing such that the narrowest peak
+ * of a PeakParameterFwhm is sampled by a given number of points.
+ *
+ *
+ * psf::resampleFromGrid() maps grid intensities back onto arbitrary m/z positions. Together
+ * with resampleOnGrid() and a WarpedScale, it allows to process a whole spectrum with one
+ * fixed kernel (for example with psf::convolve()), although the peak width depends on m/z.
+ *
+ *
+ * @section resamplescaleinterface Scale interface
+ *
+ * struct MyScale {
+ *  double forward( double mz ) const; // m/z -> u, strictly increasing
+ *  double inverse( double u ) const; // u -> m/z
+ * };
+ *
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class LinearScale
+/**
+ * u = m/z
+ */
+class PSF_EXPORT LinearScale
+{
+public:
+    double forward(const double mz) const { return mz; }
+    double inverse(const double u) const { return u; }
+};
+
+// class SqrtScale
+/**
+ * u = sqrt(m/z)
+ */
+class PSF_EXPORT SqrtScale
+{
+public:
+    double forward(const double mz) const { return std::sqrt(mz); }
+    double inverse(const double u) const { return u * u; }
+};
+
+// class LogScale
+/**
+ * u = log(m/z)
+ */
+class PSF_EXPORT LogScale
+{
+public:
+    double forward(const double mz) const { return std::log(mz); }
+    double inverse(const double u) const { return std::exp(u); }
+};
+
+
+// class WarpedScale
+/**
+ * u = fwhm.warp(m/z)
+ *
+ * The inverse transformation is computed iteratively and starts from the result of the
+ * previous call, which makes it cheap for sorted sequences like the points of a
+ * ResamplingGrid. Therefore, a WarpedScale is not thread-safe; use a copy per thread.
+ *
+ * @param PeakParameter A psf::PeakParameterFwhm, whose model supports warpAt().
+ */
+template< typename PeakParameter >
+class PSF_EXPORT WarpedScale
+{
+public:
+    explicit WarpedScale(const PeakParameter& fwhm, const double mzGuess = 400.) : fwhm_(fwhm), lastMz_(mzGuess) {}
+
+    double forward(const double mz) const { return fwhm_.warp(mz); }
+    double inverse(const double u) const {
+        lastMz_ = fwhm_.unwarp(u, lastMz_);
+        return lastMz_;
+    }
+
+    const PeakParameter& getFwhm() const { return fwhm_; }
+
+private:
+    PeakParameter fwhm_;
+    mutable double lastMz_;
+};
+
+
+// class ResamplingGrid
+/**
+ * A grid with nPoints points uniformly spaced in the coordinate u = scale.forward(m/z).
+ *
+ * The first grid point is at firstMz and the last one at lastMz.
+ *
+ * @param Scale A scale policy. See @ref resamplescaleinterface.
+ */
+template< typename Scale >
+class PSF_EXPORT ResamplingGrid
+{
+public:
+    /**
+     * @param scale The coordinate transform.
+     * @param firstMz m/z value of the first grid point.
+     * @param lastMz m/z value of the last grid point; has to be greater than firstMz.
+     * @param nPoints Number of grid points; at least two.
+     *
+     * @throw psf::PreconditionViolation The parameters are out of range.
+     */
+    ResamplingGrid(const Scale& scale, const double firstMz, const double lastMz, const std::size_t nPoints)
+        : scale_(scale), nPoints_(nPoints), firstMz_(firstMz), lastMz_(lastMz) {
+        psf_precondition(firstMz < lastMz, "ResamplingGrid::ResamplingGrid(): firstMz has to be smaller than lastMz.");
+        psf_precondition(nPoints >= 2, "ResamplingGrid::ResamplingGrid(): At least two grid points are needed.");
+        firstCoordinate_ = scale_.forward(firstMz);
+        step_ = (scale_.forward(lastMz) - firstCoordinate_) / (nPoints - 1);
+    }
+
+    std::size_t size() const { return nPoints_; }
+
+    /**
+     * The transformed coordinate u of grid point i.
+     */
+    double coordinate(const std::size_t i) const { return firstCoordinate_ + i * step_; }
+
+    /**
+     * The m/z value of grid point i.
+     *
+     * The first and last grid points are exactly at firstMz and lastMz and not subject to
+     * the rounding errors of the coordinate transform.
+     */
+    double mz(const std::size_t i) const {
+        if(i == 0) return firstMz_;
+        if(i + 1 == nPoints_) return lastMz_;
+        return scale_.inverse(coordinate(i));
+    }
+
+    /**
+     * The distance between two grid points in the transformed coordinate.
+     */
+    double getStep() const { return step_; }
+
+    const Scale& getScale() const { return scale_; }
+
+private:
+    Scale scale_;
+    std::size_t nPoints_;
+    double firstMz_;
+    double lastMz_;
+    double firstCoordinate_;
+    double step_;
+};
+
+
+
+// makeResamplingGrid()
+/**
+ * A grid on the given scale, that samples every peak with at least pointsPerFwhm points.
+ *
+ * The FWHM model is probed at 64 positions between firstMz and lastMz and the smallest
+ * FWHM, measured in the transformed coordinate, determines the grid spacing. If the scale
+ * matches the FWHM model, all peaks are sampled by the same number of points.
+ *
+ * @param fwhm A peak parameter with a member function 'double at(double mz) const', for
+ *             example a psf::OrbitrapWithOriginFwhm.
+ * @param pointsPerFwhm Has to be positive.
+ *
+ * @throw psf::PreconditionViolation The parameters are out of range.
+ */
+template< typename Scale, typename PeakParameter >
+ResamplingGrid<Scale> makeResamplingGrid(const Scale& scale, const PeakParameter& fwhm, double firstMz, double lastMz, double pointsPerFwhm);
+
+// resampleOnGrid()
+/**
+ * Maps a spectrum onto a resampling grid.
+ *
+ * The intensity at a grid point is linearly interpolated between the two spectrum elements
+ * enclosing it. Spectra usually don't contain elements with zero intensity, so two
+ * neighboring elements, that are farther apart than maximalGapInFwhm times the local FWHM,
+ * are considered to enclose a region of zero intensity instead; grid points in such a gap
+ * and outside of the spectrum get an intensity of zero.
+ *
+ * Spectrum and grid are traversed together exactly once, so the runtime is linear in
+ * (last - first) + grid.size() and no memory is allocated.
+ *
+ * The elements in the spectrum have to be in ascending order of their mz value. Else, the
+ * behaviour is undefined.
+ *
+ * @param fwhm A peak parameter with a member function 'double at(double mz) const'.
+ * @param grid The target grid.
+ * @param first Points to the first element of the spectrum.
+ * @param last Points to one past the last element of the spectrum.
+ * @param result Receives grid.size() intensities.
+ * @param maximalGapInFwhm Has to be positive.
+ * @return One past the last written element of result.
+ *
+ * @throw psf::PreconditionViolation maximalGapInFwhm is not positive.
+ */
+template< typename PeakParameter, typename Scale, typename FwdIter, typename MzExtractor, typename IntensityExtractor, typename OutIter >
+OutIter resampleOnGrid(const PeakParameter& fwhm, const ResamplingGrid<Scale>& grid, const MzExtractor&, const IntensityExtractor&, FwdIter first, FwdIter last, OutIter result, double maximalGapInFwhm = 1.0);
+
+
+// resampleFromGrid()
+/**
+ * Maps intensities on a resampling grid back onto arbitrary m/z positions.
+ *
+ * The inverse of resampleOnGrid(): the intensity at every m/z position is linearly
+ * interpolated (in the transformed coordinate) between the two enclosing grid points.
+ * Positions outside of the grid get an intensity of zero. Only the forward transformation
+ * of the scale is used, so the runtime is linear in (lastMz - firstMz).
+ *
+ * @param grid The grid, the intensities are given on.
+ * @param gridIntensities Points to grid.size() intensities.
+ * @param firstMz Points to the first m/z position.
+ * @param lastMz Points to one past the last m/z position.
+ * @param result Receives (lastMz - firstMz) intensities.
+ * @return One past the last written element of result.
+ */
+template< typename Scale, typename RandomAccessIter, typename InIter, typename OutIter >
+OutIter resampleFromGrid(const ResamplingGrid<Scale>& grid, RandomAccessIter gridIntensities, InIter firstMz, InIter lastMz, OutIter result);
+
+
+
+
+
+/******************/
+/* implementation */
+/******************/
+
+// makeResamplingGrid()
+template< typename Scale, typename PeakParameter >
+ResamplingGrid<Scale> makeResamplingGrid(const Scale& scale, const PeakParameter& fwhm, double firstMz, double lastMz, double pointsPerFwhm) {
+    psf_precondition(firstMz < lastMz, "makeResamplingGrid(): firstMz has to be smaller than lastMz.");
+    psf_precondition(pointsPerFwhm > 0, "makeResamplingGrid(): Parameter pointsPerFwhm has to be positive.");
+
+    const int nProbes = 64;
+    const double firstU = scale.forward(firstMz);
+    const double lastU = scale.forward(lastMz);
+    double smallestWidth = lastU - firstU;
+    for(int p = 0; p < nProbes; ++p) {
+        const double mz = scale.inverse(firstU + (lastU - firstU) * p / (nProbes - 1));
+        const double halfWidth = 0.5 * fwhm.at(mz);
+        // the FWHM measured in the transformed coordinate
+        const double width = (halfWidth < mz) ? scale.forward(mz + halfWidth) - scale.forward(mz - halfWidth)
+                                              : 2 * (scale.forward(mz + halfWidth) - scale.forward(mz));
+        if(width < smallestWidth) {
+            smallestWidth = width;
+        }
+    }
+
+    const double step = smallestWidth / pointsPerFwhm;
+    const std::size_t nPoints = static_cast<std::size_t>(std::ceil((lastU - firstU) / step)) + 1;
+    PSF_LOG(logDEBUG) << "makeResamplingGrid(): " << nPoints << " grid points between " << firstMz << " and " << lastMz << " Th.";
+    return ResamplingGrid<Scale>(scale, firstMz, lastMz, nPoints < 2 ? 2 : nPoints);
+}
+
+// resampleOnGrid()
+template< typename PeakParameter, typename Scale, typename FwdIter, typename MzExtractor, typename IntensityExtractor, typename OutIter >
+OutIter resampleOnGrid(const PeakParameter& fwhm, const ResamplingGrid<Scale>& grid, const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter first, FwdIter last, OutIter result, double maximalGapInFwhm) {
+    psf_precondition(maximalGapInFwhm > 0, "resampleOnGrid(): Parameter maximalGapInFwhm has to be positive.");
+
+    std::size_t i = 0;
+    const std::size_t nPoints = grid.size();
+
+    // grid points left of the spectrum
+    if(first == last) {
+        for(; i < nPoints; ++i, ++result) {
+            *result = 0.;
+        }
+        return result;
+    }
+    for(; i < nPoints && grid.mz(i) < get_mz(*first); ++i, ++result) {
+        *result = 0.;
+    }
+
+    // left and right enclose the current grid point: get_mz(*left) <= mz <= get_mz(*right)
+    FwdIter left = first;
+    FwdIter right = first; ++right;
+    bool newPair = true;
+    bool gap = false;
+    double leftMz = 0., leftIntensity = 0., slope = 0.;
+    for(; i < nPoints; ++i, ++result) {
+        const double mz = grid.mz(i);
+        while(right != last && get_mz(*right) < mz) {
+            left = right;
+            ++right;
+            newPair = true;
+        }
+        if(newPair) {
+            leftMz = get_mz(*left);
+            leftIntensity = get_int(*left);
+            if(right != last) {
+                const double rightMz = get_mz(*right);
+                gap = (rightMz - leftMz) > maximalGapInFwhm * fwhm.at(0.5 * (leftMz + rightMz));
+                slope = (rightMz > leftMz) ? (get_int(*right) - leftIntensity) / (rightMz - leftMz) : 0.;
+            }
+            newPair = false;
+        }
+
+        if(mz == leftMz) {
+            *result = leftIntensity;
+        }
+        else if(right == last) {
+            // grid points right of the spectrum
+            break;
+        }
+        else if(gap) {
+            *result = 0.;
+        }
+        else {
+            *result = leftIntensity + slope * (mz - leftMz);
+        }
+    }
+
+    for(; i < nPoints; ++i, ++result) {
+        *result = 0.;
+    }
+    return result;
+}
+
+// resampleFromGrid()
+template< typename Scale, typename RandomAccessIter, typename InIter, typename OutIter >
+OutIter resampleFromGrid(const ResamplingGrid<Scale>& grid, RandomAccessIter gridIntensities, InIter firstMz, InIter lastMz, OutIter result) {
+    // tolerate rounding errors of the coordinate transform at the grid borders
+    const double borderTolerance = 1e-9;
+    const double lastIndex = static_cast<double>(grid.size() - 1);
+    for(; firstMz != lastMz; ++firstMz, ++result) {
+        double position = (grid.getScale().forward(*firstMz) - grid.coordinate(0)) / grid.getStep();
+        if(position < -borderTolerance || position > lastIndex + borderTolerance) {
+            *result = 0.;
+            continue;
+        }
+        position = std::max(0., std::min(position, lastIndex));
+        std::size_t i = static_cast<std::size_t>(position);
+        if(i + 1 >= grid.size()) {
+            i = grid.size() - 2;
+        }
+        const double weight = position - i;
+        *result = (1. - weight) * gridIntensities[i] + weight * gridIntensities[i + 1];
+    }
+    return result;
+}
+
+} /* namespace psf */
+
+#endif /*__RESAMPLE_H__*/
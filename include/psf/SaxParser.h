@@ -0,0 +1,143 @@
+#ifndef __SAXPARSER_H__
+#define __SAXPARSER_H__
+#include <psf/config.h>
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <psf/Error.h>
+
+/**
+ * @page sax Streaming XML
+ *
+ * The mass spectrometry exchange formats (mzML, mzXML) are XML documents of several
+ * gigabytes. psf::SaxParser reads such a document front to back in chunks and reports
+ * start tags, end tags and text to a psf::SaxHandler, without building a tree; its memory
+ * is bounded by the chunk size and the longest tag.
+ *
+ * Only the subset of XML the exchange formats use is supported: elements, attributes,
+ * text, comments, processing instructions, CDATA sections and a DOCTYPE without internal
+ * subset. Namespaces are not resolved; names are reported as written. The five
+ * predefined entities and character references are replaced in attribute values, but
+ * not in text, which in these formats is numbers or base64.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class SaxAttributes
+/**
+ * The attributes of a start tag, in document order.
+ *
+ * Only valid during the psf::SaxHandler::startElement() call they are passed to.
+ */
+class PSF_EXPORT SaxAttributes
+{
+public:
+    SaxAttributes() : size_(0) {}
+
+    std::size_t size() const { return size_; }
+    const std::string& name(const std::size_t i) const { return attributes_[i].first; }
+    const std::string& value(const std::size_t i) const { return attributes_[i].second; }
+
+    /**
+     * The value of the attribute with the given name, or 0, if there is none.
+     */
+    const std::string* find(const char* name) const;
+
+private:
+    friend class SaxParser;
+
+    // the strings are reused from tag to tag
+    std::vector<std::pair<std::string, std::string> > attributes_;
+    std::size_t size_;
+};
+
+// class SaxHandler
+/**
+ * Receives the events of a psf::SaxParser. The default implementations ignore them.
+ */
+class PSF_EXPORT SaxHandler
+{
+public:
+    virtual ~SaxHandler() {}
+
+    /**
+     * An empty element '<a/>' is reported as a start and an end.
+     */
+    virtual void startElement(const std::string& name, const SaxAttributes& attributes) { PSF_UNUSED(name); PSF_UNUSED(attributes); }
+    virtual void endElement(const std::string& name) { PSF_UNUSED(name); }
+
+    /**
+     * A piece of text. Long text arrives in several consecutive pieces.
+     */
+    virtual void characters(const char* text, std::size_t length) { PSF_UNUSED(text); PSF_UNUSED(length); }
+};
+
+// class SaxParser
+/**
+ * An incremental, non-validating XML parser.
+ *
+ * Every call to parseNext() reports one construct, so the caller decides how far to
+ * parse; a reader of spectra stops at the end of each spectrum.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT SaxParser
+{
+public:
+    /**
+     * @param is Read from its current position on; has to outlive the parser.
+     * @param chunkSize Number of bytes read at once; at least 16.
+     */
+    explicit SaxParser(std::istream& is, std::size_t chunkSize = 1 << 16);
+
+    // parseNext()
+    /**
+     * Reports the next tag, or the next piece of text, to the handler.
+     *
+     * @return false at the end of the document.
+     * @throw psf::RuntimeError The document ends within a tag, or a tag is malformed.
+     */
+    bool parseNext(SaxHandler& handler);
+
+    /**
+     * Offset in the stream (relative to the initial position) of the construct reported
+     * last.
+     */
+    unsigned long long offset() const { return offset_; }
+
+    /**
+     * Offset in the stream of the first byte not parsed yet; the end of the construct
+     * reported last.
+     */
+    unsigned long long position() const { return base_ + begin_; }
+
+private:
+    SaxParser(const SaxParser&);
+    SaxParser& operator=(const SaxParser&);
+
+    bool fill_();
+    std::size_t find_(const char* terminator, std::size_t from);
+    std::size_t findTagEnd_();
+    void parseTag_(SaxHandler& handler, std::size_t end);
+
+    std::istream& is_;
+    std::vector<char> buffer_;
+    std::size_t begin_; // first unparsed byte in the buffer
+    std::size_t end_; // end of the valid bytes in the buffer
+    unsigned long long base_; // stream offset of buffer_[0]
+    unsigned long long offset_;
+    std::size_t chunkSize_;
+    std::string name_;
+    SaxAttributes attributes_;
+};
+
+} /* namespace psf */
+
+#endif /*__SAXPARSER_H__*/
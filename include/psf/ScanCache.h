@@ -0,0 +1,171 @@
+#ifndef __SCANCACHE_H__
+#define __SCANCACHE_H__
+#include <psf/config.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <psf/ScanIndex.h>
+#include <psf/Spectrum.h>
+
+/**
+ * @page scancache Processing Runs Larger than Memory
+ *
+ * A run of a hundred gigabytes doesn't fit into a psf::LcmsRun. A psf::ScanCache keeps
+ * only a bounded number of its scans in memory: scans are read through a psf::IndexedRun
+ * on demand and cached until the memory budget is exhausted; then the least recently used
+ * scans are dropped.
+ *
+ * While the caller processes a scan, a background thread reads the next scans of the
+ * processing order into the cache, so that reading overlaps with calibration or
+ * centroiding. The processing order is the order of the file by default; any other order
+ * (for example by retention time or only MS1 scans) is set with setProcessingOrder(). At
+ * most 64 scans are read ahead, and they take at most half of the budget.
+ *
+ * @code
+ * psf::ScanCache cache("run.mzML", 512 << 20);
+ * for(std::size_t i = 0; i < cache.size(); ++i) {
+ *     psf::ScanCache::ScanPtr scan = cache.scan(i);
+ *     fwhm.learnFrom(get_mz, get_int, scan->begin(), scan->end());
+ *     psf::centroid(psf, get_mz, get_int, scan->begin(), scan->end(), centroids.begin());
+ * }
+ * @endcode
+ *
+ * The memory taken by the run is the budget plus the scans the caller still holds.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class ScanCache
+/**
+ * The scans of a run file behind a least recently used cache with a memory budget and
+ * read ahead along the processing order.
+ *
+ * scan() may be called by several threads at the same time.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT ScanCache
+{
+public:
+    /**
+     * A scan stays valid as long as it is held, even after it was dropped from the cache.
+     */
+    typedef std::shared_ptr<const Spectrum> ScanPtr;
+
+    /**
+     * Opens the run and its index; see psf::IndexedRun.
+     *
+     * @param memoryBudget Bytes of the cached scans.
+     * @param nThreads Threads for decoding mzML; see psf::MzMLReader.
+     * @throw psf::RuntimeError The run couldn't be opened or indexed.
+     */
+    explicit ScanCache(const std::string& runFilename, std::size_t memoryBudget = std::size_t(256) << 20, unsigned nThreads = 1);
+
+    ~ScanCache();
+
+    const ScanIndex& index() const { return run_.index(); }
+
+    /**
+     * Number of scans of the run.
+     */
+    std::size_t size() const { return run_.index().size(); }
+
+    // setProcessingOrder()
+    /**
+     * The scans in the order they will be requested; the read ahead follows it.
+     *
+     * Scans missing from the order can still be requested, but aren't read ahead.
+     *
+     * @throw psf::PreconditionViolation A scan is out of range.
+     */
+    void setProcessingOrder(const std::vector<std::size_t>& order);
+
+    // scan()
+    /**
+     * Scan i of the index, from the cache or read on demand.
+     *
+     * @throw psf::PreconditionViolation i is out of range.
+     * @throw psf::RuntimeError The scan couldn't be read.
+     */
+    ScanPtr scan(std::size_t i);
+
+    /**
+     * True, if scan i is in the cache.
+     */
+    bool cached(std::size_t i) const;
+
+    // waitForReadAhead()
+    /**
+     * Blocks until the read ahead has nothing left to read: the scans ahead of the last
+     * requested one are cached, failed, or fill the share of the budget for the read ahead.
+     */
+    void waitForReadAhead() const;
+
+    std::size_t memoryBudget() const { return budget_; }
+
+    /**
+     * Bytes of the cached scans; at most the memory budget, unless a single scan is
+     * larger.
+     */
+    std::size_t bytesCached() const;
+
+    /**
+     * Calls of scan() served from the cache and read on demand.
+     */
+    std::size_t hits() const;
+    std::size_t misses() const;
+
+private:
+    ScanCache(const ScanCache&);
+    ScanCache& operator=(const ScanCache&);
+
+    static const std::size_t maximalReadAhead_ = 64;
+
+    struct Entry_
+    {
+        Entry_() : bytes(0) {}
+        ScanPtr scan;
+        std::size_t bytes;
+        std::list<std::size_t>::iterator lru;
+    };
+
+    static ScanPtr read_(IndexedRun& run, std::size_t i, std::size_t& bytes);
+    // with mutex_ held
+    void insert_(std::size_t i, const ScanPtr& scan, std::size_t bytes);
+    void prefetch_();
+
+    IndexedRun run_;
+    std::mutex readMutex_; // of run_
+    IndexedRun prefetchRun_;
+    std::size_t budget_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_; // the prefetcher
+    mutable std::condition_variable done_; // callers waiting for a scan in flight or the read ahead
+    std::vector<Entry_> entries_;
+    std::list<std::size_t> lru_; // most recently used first
+    std::size_t bytes_;
+    std::vector<std::size_t> order_;
+    std::vector<std::size_t> position_; // in order_, or order_.size()
+    std::vector<char> failed_;          // couldn't be read ahead
+    std::size_t next_;                  // position in order_ of the next scan to read ahead
+    std::size_t inFlight_;              // scan read ahead right now, or size()
+    std::size_t hits_, misses_;
+    bool idle_; // the prefetcher found nothing to read since it was last woken
+    bool stop_;
+    std::thread thread_;
+};
+
+} /* namespace psf */
+
+#endif /*__SCANCACHE_H__*/
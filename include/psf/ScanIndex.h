@@ -0,0 +1,271 @@
+#ifndef __SCANINDEX_H__
+#define __SCANINDEX_H__
+#include <psf/config.h>
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/MzML.h>
+#include <psf/Spectrum.h>
+
+/**
+ * @page scanindex Random Access to Runs
+ *
+ * A run file of tens of gigabytes holds tens of thousands of scans. A psf::ScanIndex
+ * records for every scan its byte range in the file, scan number, retention time, MS
+ * level and m/z range, so that a scan is read by seeking to it instead of parsing
+ * everything before it. Lookups by scan number and retention time range take
+ * O(log n) time.
+ *
+ * Two run formats are supported:
+ * - mzML (psf::MzMLReader), recognized by the leading '<'.
+ * - Concatenated .wsv spectra: every spectrum is preceded by a header line starting with
+ *   '#', which may carry the fields 'scan=', 'rt=' (in seconds) and 'level=', for example
+ *   '# scan=43000 rt=2710.5 level=1'. The lines up to the next header are the (mz
+ *   intensity) pairs of the spectrum. A file without header lines is a single spectrum.
+ *
+ * The index is built in one pass over the run and persisted as a sidecar file next to it
+ * (run file name + ".psfindex"). psf::IndexedRun reuses the sidecar as long as the size,
+ * the modification time and a checksum of the first and last 4 KiB of the run file are
+ * unchanged, and reads scans into any spectrum container:
+ *
+ * @code
+ * psf::IndexedRun run("run.mzML");
+ * std::vector<std::size_t> scans;
+ * run.index().findRetentionTimeRange(600., 900., scans);
+ * psf::Spectrum spectrum;
+ * for(std::size_t i = 0; i < scans.size(); ++i) {
+ *     run.read(scans[i], spectrum);
+ *     fwhm.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+ * }
+ * @endcode
+ *
+ * As their readers do, spectra read from .wsv runs lack the zero intensities, spectra read
+ * from mzML have them.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+enum RunFormat { wsvRun, mzmlRun };
+
+// struct ScanIndexEntry
+/**
+ * Where a scan is in a run file, and what it contains.
+ */
+struct PSF_EXPORT ScanIndexEntry
+{
+    ScanIndexEntry();
+
+    /**
+     * Byte range of the scan in the run file: the <spectrum> element of mzML, the lines
+     * after the header of .wsv.
+     */
+    unsigned long long offset, length;
+
+    /**
+     * As stated by the file, or the position of the scan in the file + 1.
+     */
+    int scanNumber;
+
+    /**
+     * Zero, if the file doesn't state it.
+     */
+    int msLevel;
+
+    /**
+     * In seconds; zero, if the file doesn't state it.
+     */
+    double retentionTime;
+
+    /**
+     * m/z range of the elements with positive intensity; both zero, if there are none.
+     */
+    double firstMz, lastMz;
+};
+
+// class ScanIndex
+/**
+ * The scans of a run file, in file order.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT ScanIndex
+{
+public:
+    ScanIndex();
+
+    // build()
+    /**
+     * Indexes a run file in one pass.
+     *
+     * @param nThreads Threads for decoding mzML; see psf::MzMLReader.
+     * @throw psf::RuntimeError The file couldn't be read or is malformed.
+     */
+    static ScanIndex build(const std::string& runFilename, unsigned nThreads = 1);
+
+    // open()
+    /**
+     * Loads the sidecar index of a run file, if it is valid for the run; otherwise builds
+     * the index and (re)writes the sidecar. If the sidecar can't be written, a warning is
+     * logged and the index is returned anyway.
+     */
+    static ScanIndex open(const std::string& runFilename, unsigned nThreads = 1);
+
+    /**
+     * The run file name + ".psfindex".
+     */
+    static std::string sidecarFilename(const std::string& runFilename);
+
+    // save()
+    /**
+     * Writes the index to a text file, replacing it atomically.
+     *
+     * @throw psf::RuntimeError The file couldn't be written.
+     */
+    void save(const std::string& filename) const;
+
+    // load()
+    /**
+     * Replaces the index by one saved before.
+     *
+     * @return false, if the file doesn't exist.
+     * @throw psf::RuntimeError The file is not a scan index or malformed.
+     */
+    bool load(const std::string& filename);
+
+    RunFormat format() const { return format_; }
+
+    /**
+     * Size of the indexed run file in bytes.
+     */
+    unsigned long long runSize() const { return runSize_; }
+
+    /**
+     * Modification time of the indexed run file in seconds since the epoch.
+     */
+    long long runModified() const { return runModified_; }
+
+    /**
+     * Checksum of the first and last 4 KiB of the indexed run file.
+     */
+    unsigned long long runChecksum() const { return runChecksum_; }
+
+    std::size_t size() const { return entries_.size(); }
+    const ScanIndexEntry& operator[](const std::size_t i) const { return entries_[i]; }
+
+    // findScan()
+    /**
+     * Position of the scan with the given number in O(log n) time; size(), if there is
+     * none. If several scans have the number, the first one in the file.
+     */
+    std::size_t findScan(int scanNumber) const;
+
+    // findRetentionTimeRange()
+    /**
+     * Replaces indices by the positions of the scans with first <= retention time <=
+     * last, in order of retention time. Takes O(log n + k) time for k scans.
+     */
+    void findRetentionTimeRange(double first, double last, std::vector<std::size_t>& indices) const;
+
+private:
+    void add_(const ScanIndexEntry& entry);
+    void sort_();
+
+    RunFormat format_;
+    unsigned long long runSize_;
+    long long runModified_;
+    unsigned long long runChecksum_;
+    std::vector<ScanIndexEntry> entries_;
+    // positions of the entries sorted by scan number and by retention time
+    std::vector<std::size_t> byScanNumber_;
+    std::vector<std::size_t> byRetentionTime_;
+};
+
+// class IndexedRun
+/**
+ * Random access to the scans of a run file through its psf::ScanIndex.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT IndexedRun
+{
+public:
+    /**
+     * Opens the run and its index; see psf::ScanIndex::open().
+     *
+     * @throw psf::RuntimeError The run couldn't be opened or indexed.
+     */
+    explicit IndexedRun(const std::string& runFilename, unsigned nThreads = 1);
+
+    /**
+     * Opens the run with an index built before, for example by another IndexedRun of
+     * the same file.
+     *
+     * @throw psf::RuntimeError The run couldn't be opened.
+     */
+    IndexedRun(const std::string& runFilename, const ScanIndex& index);
+
+    const ScanIndex& index() const { return index_; }
+
+    // read()
+    /**
+     * Replaces the elements of s by those of scan i of the index.
+     *
+     * @throw psf::PreconditionViolation i is out of range.
+     * @throw psf::RuntimeError The scan couldn't be read; the file changed after
+     *      indexing.
+     */
+    template< typename Allocator >
+    void read(const std::size_t i, std::vector<SpectrumElement, Allocator>& s) {
+        psf_precondition(i < index_.size(), "IndexedRun::read(): Scan out of range.");
+        s.clear();
+        if(index_.format() == mzmlRun) {
+            readMzML_(i);
+            s.assign(scan_.spectrum.begin(), scan_.spectrum.end());
+        }
+        else {
+            readText_(i);
+            SpectrumLoader::parse(&buffer_[0], s);
+        }
+    }
+
+    // readScan()
+    /**
+     * Replaces the elements of s by those of the scan with the given number.
+     *
+     * @return false, if there is no such scan; s is empty then.
+     */
+    template< typename Allocator >
+    bool readScan(const int scanNumber, std::vector<SpectrumElement, Allocator>& s) {
+        const std::size_t i = index_.findScan(scanNumber);
+        if(i == index_.size()) {
+            s.clear();
+            return false;
+        }
+        read(i, s);
+        return true;
+    }
+
+private:
+    IndexedRun(const IndexedRun&);
+    IndexedRun& operator=(const IndexedRun&);
+
+    void readMzML_(std::size_t i);
+    void readText_(std::size_t i);
+
+    std::string filename_;
+    std::ifstream file_;
+    ScanIndex index_;
+    std::vector<char> buffer_;
+    MzMLScan scan_;
+};
+
+} /* namespace psf */
+
+#endif /*__SCANINDEX_H__*/
@@ -0,0 +1,164 @@
+#ifndef __SPARSESPECTRUM_H__
+#define __SPARSESPECTRUM_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/Spectrum.h>
+
+/**
+ * @page sparsespectrum Sparse Profile Spectra
+ *
+ * Profile spectra, for example from Orbitrap instruments, contain long runs of zero
+ * intensities between the peaks. Dropping them (like psf::operator>>() for a
+ * psf::Spectrum does) loses the information, that a gap in the m/z values is a true zero
+ * and not missing data: the elements flanking a peak are gone and the peak edges are
+ * interpolated wrongly.
+ *
+ * A psf::SparseSpectrum keeps every nonzero element, but represents a run of zeros only
+ * by its first and its last element. Inside a run, the zeros are all equal; so
+ * psf::findBump() and psf::measureFullWidths() find the same bumps and widths on the
+ * sparse sequence as on the dense one, no matter how long the runs are. An iterator passes
+ * a whole run in at most two steps.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class SparseSpectrum
+/**
+ * A mass spectrum ordered by mz with runs of zero intensity compressed to their borders.
+ *
+ * The elements are psf::SpectrumElement objects, so the psf::MzExtractor and
+ * psf::IntensityExtractor work with the iterators of a SparseSpectrum.
+ */
+class SparseSpectrum
+{
+public:
+    typedef std::vector<SpectrumElement>::const_iterator const_iterator;
+    typedef const_iterator iterator;
+
+    // struct ZeroRun
+    /**
+     * A run of zero intensities in the dense spectrum.
+     */
+    struct ZeroRun
+    {
+        ZeroRun(const std::size_t p, const std::size_t l) : position(p), length(l) {}
+
+        /**
+         * Index of the first zero of the run in the sparse sequence.
+         */
+        std::size_t position;
+
+        /**
+         * Number of zeros in the dense spectrum; the sparse sequence holds min(length, 2).
+         */
+        std::size_t length;
+    };
+
+    SparseSpectrum() : denseSize_(0) {}
+
+    // assign()
+    /**
+     * Compresses a dense sequence of elements.
+     */
+    template< typename FwdIter, typename MzExtractor, typename IntensityExtractor >
+    void assign(const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter first, FwdIter last) {
+        clear();
+        for(; first != last; ++first) {
+            push_back(SpectrumElement(get_mz(*first), get_int(*first)));
+        }
+    }
+
+    // push_back()
+    /**
+     * Appends the next element of the dense spectrum.
+     *
+     * A zero following at least two zeros replaces the last one, the end of the run.
+     */
+    void push_back(const SpectrumElement& element) {
+        ++denseSize_;
+        if(element.intensity != 0.) {
+            elements_.push_back(element);
+            return;
+        }
+        if(!runs_.empty() && runs_.back().position + std::min<std::size_t>(runs_.back().length, 2) == elements_.size()) {
+            ZeroRun& run = runs_.back();
+            ++run.length;
+            if(run.length > 2) {
+                elements_.back() = element;
+                return;
+            }
+        }
+        else {
+            runs_.push_back(ZeroRun(elements_.size(), 1));
+        }
+        elements_.push_back(element);
+    }
+
+    void clear() {
+        elements_.clear();
+        runs_.clear();
+        denseSize_ = 0;
+    }
+
+    const_iterator begin() const { return elements_.begin(); }
+    const_iterator end() const { return elements_.end(); }
+    const SpectrumElement& operator[](const std::size_t i) const { return elements_[i]; }
+
+    /**
+     * Number of elements in the sparse sequence.
+     */
+    std::size_t size() const { return elements_.size(); }
+    bool empty() const { return elements_.empty(); }
+
+    /**
+     * Number of elements in the dense spectrum including every zero.
+     */
+    std::size_t denseSize() const { return denseSize_; }
+
+    /**
+     * The zero runs in ascending order.
+     */
+    const std::vector<ZeroRun>& zeroRuns() const { return runs_; }
+
+private:
+    std::vector<SpectrumElement> elements_;
+    std::vector<ZeroRun> runs_;
+    std::size_t denseSize_;
+};
+
+// operator>>()
+/**
+ * Reads whitespace separated (mz intensity) pairs like the psf::Spectrum version, but
+ * keeps the zero runs.
+ */
+inline std::istream& operator>>(std::istream& is, SparseSpectrum& s) {
+    double mz, intensity;
+    if (is.good()) {
+        while (is >> mz >> intensity) {
+            s.push_back(SpectrumElement(mz, intensity));
+        }
+    }
+    return is;
+}
+
+inline void loadSpectrumElements(SparseSpectrum& s, const std::string& filename) {
+    std::ifstream ifs(filename.c_str());
+    if (ifs.good()) {
+        ifs >> s;
+    }
+}
+
+} /* namespace psf */
+
+#endif /*__SPARSESPECTRUM_H__*/
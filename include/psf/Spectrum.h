@@ -1,9 +1,15 @@
 #ifndef __SPECTRUM_H__
 #define __SPECTRUM_H__
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <istream>
+#include <iterator>
 #include <string>
+#include <vector>
 
 /**
  * @page spectrum Spectrum Sample Implementation
@@ -73,10 +79,14 @@ struct IntensityExtractor {
 
 /**
  * A mass spectrum is a sequence of SpectrumElements ordered by mz.
+ *
+ * The functions below accept a std::vector<SpectrumElement> with any allocator, for
+ * example a psf::ArenaAllocator.
  */ 
 typedef std::vector<SpectrumElement> Spectrum;
 
-std::istream& operator>>(std::istream& is, Spectrum& s) {
+template< typename Allocator >
+std::istream& operator>>(std::istream& is, std::vector<SpectrumElement, Allocator>& s) {
     double mz, intensity;
     if (is.good()) {
         while (is >> mz >> intensity) {
@@ -88,7 +98,8 @@ std::istream& operator>>(std::istream& is, Spectrum& s) {
     return is;
 }
 
-void loadSpectrumElements(Spectrum& s, const std::string& filename){
+template< typename Allocator >
+void loadSpectrumElements(std::vector<SpectrumElement, Allocator>& s, const std::string& filename){
     std::ifstream ifs(filename.c_str());
     if (ifs.good()) {
         ifs >> s;
@@ -96,6 +107,101 @@ void loadSpectrumElements(Spectrum& s, const std::string& filename){
 }
 
 
+
+// class SpectrumLoader
+/**
+ * Loads spectra from files like loadSpectrumElements(), but into reused memory.
+ *
+ * A file is read in one block into a buffer owned by the loader and parsed in place with
+ * std::strtod(); the elements are written to a spectrum, whose capacity is kept. Once the
+ * buffer and the spectrum have grown to the largest file of a run, loading doesn't
+ * allocate memory with operator new any more. (The C library still allocates its FILE
+ * handle for every opened file.)
+ *
+ * The numbers are parsed in the C locale of the program, which is the classic one
+ * unless std::setlocale() was called.
+ */
+class SpectrumLoader
+{
+public:
+    // load()
+    /**
+     * Replaces the elements of s by the (mz intensity) pairs with positive intensity in a
+     * file of whitespace separated numbers. Reading stops at the first malformed pair.
+     *
+     * @return false, if the file couldn't be opened; s is empty then.
+     */
+    template< typename Allocator >
+    bool load(const std::string& filename, std::vector<SpectrumElement, Allocator>& s) {
+        s.clear();
+        std::FILE* file = std::fopen(filename.c_str(), "rb");
+        if(!file) {
+            return false;
+        }
+        // we read into our own buffer, so stdio doesn't need one
+        std::setvbuf(file, 0, _IONBF, 0);
+        const std::size_t chunk = 1 << 16;
+        std::size_t used = 0;
+        for(;;) {
+            if(buffer_.size() < used + chunk + 1) {
+                buffer_.resize(std::max(2 * buffer_.size(), used + chunk + 1));
+            }
+            const std::size_t n = std::fread(&buffer_[used], 1, buffer_.size() - used - 1, file);
+            if(n == 0) {
+                break;
+            }
+            used += n;
+        }
+        std::fclose(file);
+        buffer_[used] = '\0';
+        parse(&buffer_[0], s);
+        return true;
+    }
+
+    // parse()
+    /**
+     * Appends the (mz intensity) pairs with positive intensity of a nul terminated text to s.
+     *
+     * @return Where parsing stopped: the terminating nul or the first text that isn't a pair.
+     */
+    template< typename Allocator >
+    static const char* parse(const char* text, std::vector<SpectrumElement, Allocator>& s) {
+        std::back_insert_iterator<std::vector<SpectrumElement, Allocator> > out(s);
+        return parseInto(text, out);
+    }
+
+    // parseInto()
+    /**
+     * Like parse(), but writes the elements through an output iterator, which is left
+     * behind the last one.
+     */
+    template< typename OutputIterator >
+    static const char* parseInto(const char* text, OutputIterator& out) {
+        char* end = 0;
+        for(;;) {
+            const double mz = std::strtod(text, &end);
+            if(end == text) {
+                return text;
+            }
+            const char* pair = text;
+            text = end;
+            const double intensity = std::strtod(text, &end);
+            if(end == text) {
+                return pair;
+            }
+            text = end;
+            if(intensity > 0) {
+                *out = SpectrumElement(mz, intensity);
+                ++out;
+            }
+        }
+    }
+
+private:
+    std::vector<char> buffer_;
+};
+
+
 } /* namespace psf */
 
 #endif /*__SPECTRUM_H__*/
@@ -3,12 +3,14 @@
 #include <psf/config.h>
 
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <utility>
 #include <vector>
 
 #include <psf/Log.h>
 #include <psf/Error.h>
+#include <psf/Parallel.h>
 
 namespace psf
 {
@@ -46,6 +48,25 @@ class PSF_EXPORT MoreThanValue {
   typename Extractor::result_type val_;
 };
 
+// class LessThanValue
+/**
+ * Compare an element with a value with regard to a certain aspect.
+ *
+ * Use it to search a sorted sequence with std::lower_bound(), for example for the first
+ * element with a m/z value not less than a target value.
+ */
+template< typename Element, typename Extractor >
+class PSF_EXPORT LessThanValue {
+   public:
+   LessThanValue( const Extractor& e ) : extract_(e) {};
+   bool operator()( const Element& e, typename Extractor::result_type val ) const {
+     return extract_(e) < val;
+  };
+
+  private:
+  Extractor extract_;
+};
+
 
 
 // findBump()
@@ -111,6 +132,61 @@ PSF_EXPORT
 std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> > 
 measureFullWidths(const MzExtractor&, const IntensityExtractor&, FwdIter first, FwdIter last, double fraction, typename IntensityExtractor::result_type minimalPeakHeight = 0);
 
+// measureFullWidths()
+/**
+ * Sample the full width at a fraction of the maximum into a reused vector.
+ *
+ * The same as the version above, but the pairs are written to widths, which is cleared
+ * first. Once its capacity suffices, repeated calls don't allocate memory.
+ *
+ * @param widths Receives the pairs of (mz | width at mz) in ascending order of mz. Any
+ *      allocator may be used, for example a psf::ArenaAllocator.
+ *
+ * @throw psf::PreconditionViolation Parameter fraction is out of the required range.
+ */
+template<typename FwdIter, typename MzExtractor, typename IntensityExtractor, typename Allocator> 
+void measureFullWidths(const MzExtractor&, const IntensityExtractor&, FwdIter first, FwdIter last, double fraction, typename IntensityExtractor::result_type minimalPeakHeight, std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type>, Allocator>& widths);
+
+
+
+// findBumps()
+/**
+ * Finds all bumps in a sequence using several threads.
+ *
+ * The result is the same as calling psf::findBump() repeatedly, each time starting at the
+ * right edge of the previous bump, like psf::measureFullWidths() does.
+ *
+ * The sequence is split into one chunk per thread. A bump belongs to the chunk
+ * containing its left edge. Every chunk is scanned independently, beginning at the
+ * bottom of the increasing slope its first element is part of; there, the state of the
+ * sequential scan doesn't depend on the elements before. Bumps straddling the end of a
+ * chunk are followed into the next chunk, and the chunk results are concatenated in
+ * order.
+ *
+ * @param nThreads Number of threads. Zero means psf::hardwareConcurrency().
+ * @return The bumps [pair.first, pair.second] in ascending order.
+ *
+ * @see psf::findBump
+ */
+template<typename RandomAccessIter, typename Compare>
+PSF_EXPORT std::vector<std::pair<RandomAccessIter, RandomAccessIter> > findBumps(RandomAccessIter first, RandomAccessIter last, Compare comp, unsigned nThreads = 1);
+
+// measureFullWidths()
+/**
+ * Sample the full width at a fraction of the maximum using several threads.
+ *
+ * The result is exactly the same as the one of the sequential version. The chunks are
+ * processed like in psf::findBumps().
+ *
+ * @param nThreads Number of threads. Zero means psf::hardwareConcurrency().
+ *
+ * @throw psf::PreconditionViolation Parameter fraction is out of the required range.
+ */
+template<typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor>
+PSF_EXPORT
+std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> >
+measureFullWidths(const MzExtractor&, const IntensityExtractor&, RandomAccessIter first, RandomAccessIter last, double fraction, typename IntensityExtractor::result_type minimalPeakHeight, unsigned nThreads);
+
 
 
 /**
@@ -231,83 +307,118 @@ namespace SpectralPeak
 /* implementation */
 /******************/
 
-// findBump()
-template<typename FwdIter, typename Compare>
-std::pair<FwdIter, FwdIter> findBump(FwdIter first, FwdIter last, Compare comp) {
-    // First, let's assume the bump starts right on the first element.
-    FwdIter leftEdge = first;
-    // Furthermore, we are starting out on the first element, too.
-    FwdIter currentElement = first;
-
-    // Since we are working with ForwardIterators, we cannot rewind and have to store the
-    // next position separately
-    const FwdIter onePastLastElement = last;
-    FwdIter onePastCurrentElement = currentElement; std::advance(onePastCurrentElement, 1);   
-
-    // state of our search
-    bool onIncreasingSlope = false;
-    bool foundBumpTop = false;
-
-    // Now let's go through the sequence element by element.
-    while(onePastCurrentElement != onePastLastElement) {
-        psf_invariant(std::distance(currentElement, onePastCurrentElement) == 1, "findBump(): Distance between current and next elment is not 1.");
-        
-        /* Current element is smaller than its right neighbor. */      
-        if(comp(*currentElement, *(onePastCurrentElement))) {
-            // We already passed the top of a bump and are finished!
-            if(foundBumpTop) {
-                // currentElement points to the right edge of the bump
-                break;
+namespace
+{
+    // findBumpWithTop_()
+    // findBump(), which also yields the top of the bump: the elements rise strictly from
+    // the left edge to the top and fall strictly from the top to the right edge. Without a
+    // bump, top is last, too.
+    template< typename FwdIter, typename Compare >
+    std::pair<FwdIter, FwdIter> findBumpWithTop_(FwdIter first, const FwdIter last, Compare comp, FwdIter& top) {
+        top = last;
+        if(first == last) {
+            return std::make_pair(last, last);
+        }
+        FwdIter next = first;
+        ++next;
+        while(true) {
+            // down or level to the bottom of the next increasing slope
+            while(next != last && !comp(*first, *next)) {
+                first = next;
+                ++next;
             }
-            else {
-                // We are on the bottom of an increasing slope.
-                if(!onIncreasingSlope) {
-                    onIncreasingSlope = true;
-                    // That's were bumps are starting!
-                    leftEdge = currentElement;
-                }
+            if(next == last) {
+                return std::make_pair(last, last);
             }
-        }
-        
-        /* Current element is bigger than its right neighbor. */
-        else if(comp(*(onePastCurrentElement), *currentElement)) { 
-            // Were we on an increasing slope?
-            if(onIncreasingSlope) {
-                // So we are on the top of the bump!
-                foundBumpTop = true;
+            const FwdIter leftEdge = first;
+
+            // up to the top
+            while(next != last && comp(*first, *next)) {
+                first = next;
+                ++next;
             }
-            // We are on a decreasing slope.
-            else {
-                onIncreasingSlope = false;
+            if(next == last) {
+                return std::make_pair(last, last);
+            }
+            // a plateau is no top; start again from here
+            if(!comp(*next, *first)) {
+                continue;
             }
+            top = first;
+
+            // down to the right edge
+            while(next != last && comp(*next, *first)) {
+                first = next;
+                ++next;
+            }
+            return std::make_pair(leftEdge, first);
+        }
+    }
+
+    // bottomOfSlope_()
+    // Rewinds from position to the bottom of the increasing slope it is part of. There, a
+    // scan for bumps can be started independently of the elements before.
+    template< typename RandomAccessIter, typename Compare >
+    RandomAccessIter bottomOfSlope_(const RandomAccessIter first, RandomAccessIter position, Compare comp) {
+        while(position != first && comp(*(position - 1), *position)) {
+            --position;
+        }
+        return position;
+    }
+
+    // MinimalHeight_
+    // Height rule of measureBumps_(): the maximum of a bump has to be at least minimum.
+    template< typename Intensity >
+    struct MinimalHeight_
+    {
+        explicit MinimalHeight_(const Intensity m) : minimum(m) {}
+
+        template< typename Mz >
+        bool operator()(const Mz&, const Intensity height) const {
+            return height >= minimum;
         }
 
-        /* Current element and its neighbor are equal. */
-        else {
-            // Great, we are finished!
-            if(foundBumpTop) {
-                // currentElement points to the right edge of our bump.
+        Intensity minimum;
+    };
+
+    // measureBumps_()
+    // The walk behind every measureFullWidths() without a mask: the full widths at fraction
+    // of the bumps with a left edge in [blockFirst, blockLast), which are low enough and
+    // for which isHighEnough(mz, height) holds at their top. Bumps may extend up to last.
+    template< typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor, typename HeightRule, typename MzWidthPairs >
+    void measureBumps_(const MzExtractor& get_mz, const IntensityExtractor& get_int, const RandomAccessIter first, const RandomAccessIter blockFirst, const RandomAccessIter blockLast, const RandomAccessIter last, const double fraction, HeightRule isHighEnough, MzWidthPairs& pairs) {
+        LessByExtractor< typename IntensityExtractor::element_type, IntensityExtractor > comp(get_int);
+        const double requiredLowness = 1. - fraction;
+
+        RandomAccessIter start = bottomOfSlope_(first, blockFirst, comp);
+        while(start < last) {
+            RandomAccessIter top;
+            const std::pair<RandomAccessIter, RandomAccessIter> bump = findBumpWithTop_(start, last, comp, top);
+            if(bump.first == last || !(bump.first < blockLast)) {
                 break;
             }
-            
-            // That's bad. We have to start our search again.
-            else {            
-                leftEdge = onePastCurrentElement;
-                onIncreasingSlope = false;
+            // the top is the maximum of its bump
+            if(!(bump.first < blockFirst) && isHighEnough(get_mz(*top), get_int(*top)) && SpectralPeak::lowness(get_int, bump.first, bump.second) >= requiredLowness) {
+                pairs.push_back(std::make_pair(get_mz(*top), SpectralPeak::fullWidthAtFractionOfMaximum(get_mz, get_int, bump.first, bump.second, fraction)));
             }
+            // last element of the bump may be the first of the next one
+            start = bump.second;
         }
-
-        ++currentElement;
-        ++onePastCurrentElement;
-    }
-    
-    if(foundBumpTop) { 
-        // we return [leftEdge, rightEdge]
-        return std::make_pair(leftEdge, currentElement);
     }
-    else {
-        return std::make_pair(last, last);
+
+    // measureBumpsStartingIn_()
+    // measureBumps_() with a fixed minimal peak height.
+    template< typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor, typename MzWidthPairs >
+    void measureBumpsStartingIn_(const MzExtractor& get_mz, const IntensityExtractor& get_int, const RandomAccessIter first, const RandomAccessIter blockFirst, const RandomAccessIter blockLast, const RandomAccessIter last, const double fraction, const typename IntensityExtractor::result_type minimalPeakHeight, MzWidthPairs& pairs) {
+        measureBumps_(get_mz, get_int, first, blockFirst, blockLast, last, fraction, MinimalHeight_<typename IntensityExtractor::result_type>(minimalPeakHeight), pairs);
     }
+} /* anonymous namespace */
+
+// findBump()
+template<typename FwdIter, typename Compare>
+std::pair<FwdIter, FwdIter> findBump(FwdIter first, FwdIter last, Compare comp) {
+    FwdIter top;
+    return findBumpWithTop_(first, last, comp, top);
 }
 
 
@@ -316,52 +427,91 @@ std::pair<FwdIter, FwdIter> findBump(FwdIter first, FwdIter last, Compare comp)
 template<typename FwdIter, typename MzExtractor, typename IntensityExtractor> 
 std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> > 
 measureFullWidths(const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter first, FwdIter last, double fraction, typename IntensityExtractor::result_type minimalPeakHeight = 0) {
-    typedef typename MzExtractor::result_type Mz;
-    typedef typename IntensityExtractor::result_type Intensity;
+    std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> > widths;
+    measureFullWidths(get_mz, get_int, first, last, fraction, minimalPeakHeight, widths);
+    return widths;
+}
 
+// measureFullWidths()
+template<typename FwdIter, typename MzExtractor, typename IntensityExtractor, typename Allocator> 
+void measureFullWidths(const MzExtractor& get_mz, const IntensityExtractor& get_int, FwdIter first, FwdIter last, double fraction, typename IntensityExtractor::result_type minimalPeakHeight, std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type>, Allocator>& widths) {
     psf_precondition(0. <= fraction && fraction <= 1., 
         "measureFullWidths(): Parameter fraction out of required range.");
+    widths.clear();
+    measureBumpsStartingIn_(get_mz, get_int, first, first, last, last, fraction, minimalPeakHeight, widths);
+}
+
 
-    // The result
-    std::vector<std::pair<Mz, Mz> > widths;
 
-    // Check for empty spectrum or only one element
-    if((last - first) < 1) {
-        return widths;
+namespace
+{
+    // findBumpsStartingIn_()
+    // Like findBumps(), but only for the bumps with a left edge in [blockFirst, blockLast).
+    // Bumps may extend up to last.
+    template< typename RandomAccessIter, typename Compare, typename Bumps >
+    void findBumpsStartingIn_(const RandomAccessIter first, const RandomAccessIter blockFirst, const RandomAccessIter blockLast, const RandomAccessIter last, Compare comp, Bumps& bumps) {
+        RandomAccessIter start = bottomOfSlope_(first, blockFirst, comp);
+        while(start < last) {
+            std::pair<RandomAccessIter, RandomAccessIter> bump = findBump(start, last, comp);
+            if(bump.first == last || !(bump.first < blockLast)) {
+                break;
+            }
+            if(!(bump.first < blockFirst)) {
+                bumps.push_back(bump);
+            }
+            start = bump.second;
+        }
     }
 
-    // prerequisites    
-    const double requiredLowness = 1. - fraction;
-    std::pair<FwdIter, FwdIter> bump;
-    Mz positionOfMaximum = 0;
-    Intensity bumpHeight = 0;    
-    Mz width = 0;
-    LessByExtractor< typename IntensityExtractor::element_type, IntensityExtractor > comp(get_int);
-    
-    // go through all bumps in the spectrum */       
-    while(first < last) {
-        bump = findBump(first, last, comp);
-        // No new bump found
-        if (bump.first == last) {
-            break;
+    // inChunks_()
+    // Calls process(chunkFirst, chunkLast, result) for nThreads chunks of [first, last) in
+    // parallel and concatenates the results in order.
+    template< typename Result, typename RandomAccessIter, typename Process >
+    Result inChunks_(const RandomAccessIter first, const RandomAccessIter last, unsigned nThreads, Process process) {
+        if(nThreads == 0) {
+            nThreads = hardwareConcurrency();
+        }
+        const std::size_t size = static_cast<std::size_t>(last - first);
+        const std::size_t nChunks = std::max<std::size_t>(1, std::min<std::size_t>(nThreads, size));
+        std::vector<Result> chunkResults(nChunks);
+        parallelFor(nChunks, nThreads, [&](std::size_t chunk) {
+            const RandomAccessIter chunkFirst = first + static_cast<std::ptrdiff_t>(size * chunk / nChunks);
+            const RandomAccessIter chunkLast = first + static_cast<std::ptrdiff_t>(size * (chunk + 1) / nChunks);
+            process(chunkFirst, chunkLast, chunkResults[chunk]);
+        });
+
+        std::size_t total = 0;
+        for(std::size_t chunk = 0; chunk < nChunks; ++chunk) {
+            total += chunkResults[chunk].size();
         }
-        
-        // calc full width if bump is low enough and has a minimal height
-        psf_invariant(bump.first <= bump.second && bump.second < last, "Bump in illegal state.");
-        bumpHeight = get_int(*std::max_element(bump.first, bump.second + 1, comp));       
-        if(SpectralPeak::lowness(get_int, bump.first, bump.second) >= requiredLowness && bumpHeight >= minimalPeakHeight) {
-            // we don't have to try for exceptions here, because a bump fulfills the preconditions
-	  width = SpectralPeak::fullWidthAtFractionOfMaximum(get_mz, get_int, bump.first, bump.second, fraction);
-            positionOfMaximum = get_mz(*std::max_element(bump.first, bump.second + 1, comp));
-            PSF_LOG(logDEBUG) << "measureFullWidths(): Measured peak (mz | width): (" << positionOfMaximum << " | " << width << ")";
-            widths.push_back(std::make_pair(positionOfMaximum, width));
+        Result result;
+        result.reserve(total);
+        for(std::size_t chunk = 0; chunk < nChunks; ++chunk) {
+            result.insert(result.end(), chunkResults[chunk].begin(), chunkResults[chunk].end());
         }
-        
-        // last element of the bump may be the first of the next one
-        first = bump.second;
+        return result;
     }
-    
-    return widths;
+} /* anonymous namespace */
+
+// findBumps()
+template<typename RandomAccessIter, typename Compare>
+std::vector<std::pair<RandomAccessIter, RandomAccessIter> > findBumps(RandomAccessIter first, RandomAccessIter last, Compare comp, unsigned nThreads) {
+    typedef std::vector<std::pair<RandomAccessIter, RandomAccessIter> > Bumps;
+    return inChunks_<Bumps>(first, last, nThreads, [&](RandomAccessIter chunkFirst, RandomAccessIter chunkLast, Bumps& bumps) {
+        findBumpsStartingIn_(first, chunkFirst, chunkLast, last, comp, bumps);
+    });
+}
+
+// measureFullWidths()
+template<typename RandomAccessIter, typename MzExtractor, typename IntensityExtractor>
+std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> >
+measureFullWidths(const MzExtractor& get_mz, const IntensityExtractor& get_int, RandomAccessIter first, RandomAccessIter last, double fraction, typename IntensityExtractor::result_type minimalPeakHeight, unsigned nThreads) {
+    typedef std::vector<std::pair<typename MzExtractor::result_type, typename MzExtractor::result_type> > MzWidthPairs;
+    psf_precondition(0. <= fraction && fraction <= 1.,
+        "measureFullWidths(): Parameter fraction out of required range.");
+    return inChunks_<MzWidthPairs>(first, last, nThreads, [&](RandomAccessIter chunkFirst, RandomAccessIter chunkLast, MzWidthPairs& pairs) {
+        measureBumpsStartingIn_(get_mz, get_int, first, chunkFirst, chunkLast, last, fraction, minimalPeakHeight, pairs);
+    });
 }
 
 
@@ -375,7 +525,7 @@ SpectralPeak::height(const IntensityExtractor& get_int, FwdIter firstElement, Fw
     // Compare elements by intensity
     LessByExtractor<typename IntensityExtractor::element_type, IntensityExtractor> comp(get_int);
     // find maximum intensity
-    FwdIter maximum = max_element(firstElement, ++lastElement, comp);
+    FwdIter maximum = std::max_element(firstElement, ++lastElement, comp);
 
     return get_int(*maximum);
 }
@@ -393,12 +543,12 @@ double psf::SpectralPeak::lowness(const IntensityExtractor& get_int, FwdIter fir
     LessByExtractor<typename IntensityExtractor::element_type, IntensityExtractor> comp(get_int);
 
     // find maximum intensity
-    FwdIter maximum = max_element(firstElement, last, comp);
+    FwdIter maximum = std::max_element(firstElement, last, comp);
 
     // find least abundant element right of the maximum
-    FwdIter rightMinimum = min_element(maximum, last, comp);
+    FwdIter rightMinimum = std::min_element(maximum, last, comp);
     // and to the left (both times with the maximum included as possible minimum)
-    FwdIter leftMinimum = min_element(firstElement, ++maximum, comp);
+    FwdIter leftMinimum = std::min_element(firstElement, ++maximum, comp);
     --maximum; // STL required [first, last)
 
     // more abundant element of the two
@@ -464,7 +614,7 @@ fullWidthAtFractionOfMaximum(const MzExtractor& get_mz, const IntensityExtractor
     // Compare elements by intensity
     LessByExtractor<typename IntensityExtractor::element_type, IntensityExtractor> comp(get_int);
     // find maximum intensity
-    FwdIter maximum = max_element(firstElement, lastElement + 1, comp);
+    FwdIter maximum = std::max_element(firstElement, lastElement + 1, comp);
     PSF_LOG(logDEBUG1) << "fullWidthAtFractionOfMaximum(): Spectral peak maximum detected at (mz, intensity): " << get_mz(*maximum) << " ," << get_int(*maximum); 
     // calc target intensity
     const typename IntensityExtractor::result_type target = get_int(*maximum) * fraction;
@@ -475,7 +625,7 @@ fullWidthAtFractionOfMaximum(const MzExtractor& get_mz, const IntensityExtractor
 
     /* find utter left element nearest above or on target */
     // target <= above == !(above < target) 
-    FwdIter aboveOnLeft = find_if(firstElement, maximum + 1, compScalar);
+    FwdIter aboveOnLeft = std::find_if(firstElement, maximum + 1, compScalar);
     PSF_LOG(logDEBUG1) << "fullWidthAtFractionOfMaximum(): aboveOnLeft detected at (mz, intensity): " << get_mz(*aboveOnLeft) << " ," << get_int(*aboveOnLeft); 
     // determine belowOnLeft
     FwdIter belowOnLeft = findElementBelowTargetAbundance(get_int, firstElement, aboveOnLeft, target);
@@ -486,7 +636,7 @@ fullWidthAtFractionOfMaximum(const MzExtractor& get_mz, const IntensityExtractor
     std::reverse_iterator<FwdIter> rlast(lastElement + 1);
     std::reverse_iterator<FwdIter> rmaximum(maximum);
     // target <= above == !(above < target) 
-    std::reverse_iterator<FwdIter> aboveOnRight = find_if(rlast, rmaximum, compScalar);
+    std::reverse_iterator<FwdIter> aboveOnRight = std::find_if(rlast, rmaximum, compScalar);
     PSF_LOG(logDEBUG1) << "fullWidthAtFractionOfMaximum(): aboveOnRight detected at (mz, intensity): " << get_mz(*aboveOnRight) << " ," << get_int(*aboveOnRight);     
     // determine belowOnRight
     std::reverse_iterator<FwdIter> belowOnRight = findElementBelowTargetAbundance(get_int, rlast, aboveOnRight, target);
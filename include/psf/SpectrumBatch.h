@@ -0,0 +1,119 @@
+#ifndef __SPECTRUMBATCH_H__
+#define __SPECTRUMBATCH_H__
+#include <psf/config.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <psf/Arena.h>
+#include <psf/Spectrum.h>
+
+/**
+ * @page spectrumbatch Loading Many Spectra
+ *
+ * An archived run is a directory of thousands of .wsv files. A psf::SpectrumBatch loads
+ * them with a pool of threads into a single block of psf::SpectrumElement objects taken
+ * from an arena; spectrum i is the range [begin(i), end(i)) of the block. Files larger
+ * than the chunk size are split at line boundaries and parsed by several threads, too, so
+ * a single huge file loads in parallel as well.
+ *
+ * The chunks are read first, and every chunk gets room for one pair per line in the
+ * block; then the chunks are parsed straight into their room, without going through a
+ * temporary spectrum. The spectra may therefore be separated by unused elements. Only
+ * text with several pairs on a line doesn't fit and is packed into a second block.
+ *
+ * @code
+ * psf::SpectrumBatch batch;
+ * batch.load(psf::SpectrumBatch::listDirectory("archive/run42"));
+ * for(std::size_t i = 0; i < batch.size(); ++i) {
+ *     fwhm.learnFrom(get_mz, get_int, batch.begin(i), batch.end(i));
+ * }
+ * @endcode
+ *
+ * The files are parsed like psf::loadSpectrumElements() does: the (mz intensity) pairs
+ * with positive intensity are kept. Loading the next batch reuses the memory of the
+ * previous one.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class SpectrumBatch
+/**
+ * The spectra of many .wsv files in one arena-backed block with per-spectrum ranges.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+class PSF_EXPORT SpectrumBatch
+{
+public:
+    typedef const SpectrumElement* const_iterator;
+
+    SpectrumBatch();
+
+    // load()
+    /**
+     * Replaces the content of the batch by the spectra of the files, in the given order.
+     *
+     * @param nThreads Maximal number of threads including the calling one. Zero means
+     *      psf::hardwareConcurrency().
+     * @param chunkSize Files are parsed in pieces of about this many bytes.
+     * @throw psf::RuntimeError A file couldn't be read; the batch is empty then.
+     */
+    void load(const std::vector<std::string>& filenames, unsigned nThreads = 0, std::size_t chunkSize = 1 << 22);
+
+    // listDirectory()
+    /**
+     * The files ending in extension in the directory and its subdirectories, sorted by
+     * path.
+     *
+     * @throw psf::RuntimeError The directory couldn't be read.
+     */
+    static std::vector<std::string> listDirectory(const std::string& directory, const std::string& extension = ".wsv");
+
+    void clear();
+
+    /**
+     * Number of spectra.
+     */
+    std::size_t size() const { return filenames_.size(); }
+
+    const_iterator begin(const std::size_t i) const { return elements_ + offsets_[i]; }
+    const_iterator end(const std::size_t i) const { return elements_ + ends_[i]; }
+
+    /**
+     * Position of the first element of spectrum i in the block.
+     */
+    std::size_t offset(const std::size_t i) const { return offsets_[i]; }
+
+    const std::string& filename(const std::size_t i) const { return filenames_[i]; }
+
+    /**
+     * Number of elements of all spectra.
+     */
+    std::size_t numberOfElements() const { return numberOfElements_; }
+
+    /**
+     * Bytes parsed by the last load().
+     */
+    unsigned long long bytesLoaded() const { return bytes_; }
+
+private:
+    SpectrumBatch(const SpectrumBatch&);
+    SpectrumBatch& operator=(const SpectrumBatch&);
+
+    Arena arena_;
+    SpectrumElement* elements_;
+    std::vector<std::size_t> offsets_;
+    std::vector<std::size_t> ends_;
+    std::size_t numberOfElements_;
+    std::vector<std::string> filenames_;
+    unsigned long long bytes_;
+};
+
+} /* namespace psf */
+
+#endif /*__SPECTRUMBATCH_H__*/
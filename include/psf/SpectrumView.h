@@ -0,0 +1,283 @@
+#ifndef __SPECTRUMVIEW_H__
+#define __SPECTRUMVIEW_H__
+#include <psf/config.h>
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <psf/Spectrum.h>
+#include <psf/SpectrumAlgorithm.h>
+
+/**
+ * @page spectrumview Spectra in Foreign Memory
+ *
+ * Vendor libraries, memory mapped files and other programs hold spectra as separate m/z
+ * and intensity arrays, as interleaved (mz, intensity) pairs or as arrays of their own
+ * structs, often with float intensities. A psf::BasicSpectrumView wraps such memory
+ * without copying it: an m/z pointer and an intensity pointer, each with a stride in
+ * bytes, and the number of elements.
+ *
+ * The elements of a view are psf::SpectrumElement values made on the fly, so the iterators
+ * of a view work with psf::MzExtractor and psf::IntensityExtractor and therefore with
+ * every algorithm taking iterators and extractors. For the common cases there are
+ * overloads taking the view itself: psf::measureFullWidths(),
+ * psf::PeakShapeFunctionTemplate::calibrateFor() and
+ * psf::PeakShapeFunctionTemplate::evaluate().
+ *
+ * @code
+ * struct VendorPeak { double mz; float intensity; int flags; };
+ * const VendorPeak* peaks = ...;
+ * psf::BasicSpectrumView<double, float> view(&peaks[0].mz, &peaks[0].intensity, n, sizeof(VendorPeak), sizeof(VendorPeak));
+ * psf::OrbitrapPeakShapeFunction psf;
+ * psf.calibrateFor(view);
+ * psf::centroid(psf, psf::MzExtractor(), psf::IntensityExtractor(), view.begin(), view.end(), centroids.begin());
+ * @endcode
+ *
+ * The memory has to outlive the view and its iterators; the iterators don't refer to the
+ * view itself.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+
+namespace psf
+{
+
+// class StridedIterator
+/**
+ * Random access to values a fixed number of bytes apart.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+template< typename T >
+class StridedIterator
+{
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T* pointer;
+    typedef const T& reference;
+
+    StridedIterator() : first_(0), stride_(0), i_(0) {}
+    StridedIterator(const T* first, const std::ptrdiff_t stride, const std::ptrdiff_t i = 0)
+        : first_(reinterpret_cast<const char*>(first)), stride_(stride), i_(i) {}
+
+    reference operator*() const { return *operator->(); }
+    pointer operator->() const { return reinterpret_cast<const T*>(first_ + i_ * stride_); }
+    reference operator[](const difference_type n) const { return *(*this + n); }
+
+    StridedIterator& operator++() { ++i_; return *this; }
+    StridedIterator operator++(int) { StridedIterator old(*this); ++i_; return old; }
+    StridedIterator& operator--() { --i_; return *this; }
+    StridedIterator operator--(int) { StridedIterator old(*this); --i_; return old; }
+    StridedIterator& operator+=(const difference_type n) { i_ += n; return *this; }
+    StridedIterator& operator-=(const difference_type n) { i_ -= n; return *this; }
+    StridedIterator operator+(const difference_type n) const { return StridedIterator(*this) += n; }
+    StridedIterator operator-(const difference_type n) const { return StridedIterator(*this) -= n; }
+    difference_type operator-(const StridedIterator& other) const { return i_ - other.i_; }
+
+    bool operator==(const StridedIterator& other) const { return i_ == other.i_; }
+    bool operator!=(const StridedIterator& other) const { return i_ != other.i_; }
+    bool operator<(const StridedIterator& other) const { return i_ < other.i_; }
+    bool operator>(const StridedIterator& other) const { return i_ > other.i_; }
+    bool operator<=(const StridedIterator& other) const { return i_ <= other.i_; }
+    bool operator>=(const StridedIterator& other) const { return i_ >= other.i_; }
+
+private:
+    const char* first_;
+    std::ptrdiff_t stride_;
+    std::ptrdiff_t i_;
+};
+
+// class SpectrumViewIterator
+/**
+ * Random access to the elements of a view.
+ *
+ * A proxy iterator, like std::vector<bool>::iterator: the elements are assembled from
+ * the two strided arrays on the fly, so dereferencing yields a psf::SpectrumElement by
+ * value and reference is not a real reference. It moves like a random access iterator,
+ * which std::lower_bound() and the psf algorithms rely on, but &*it and the pointer of
+ * operator->() only live as long as the full expression. Writing through it is not
+ * possible.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+template< typename MzT, typename IntensityT >
+class SpectrumViewIterator
+{
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef SpectrumElement value_type;
+    typedef std::ptrdiff_t difference_type;
+    class pointer;
+    typedef SpectrumElement reference;
+
+    SpectrumViewIterator() : mz_(0), intensity_(0), mzStride_(0), intensityStride_(0), i_(0) {}
+    SpectrumViewIterator(const MzT* mz, const IntensityT* intensity, const std::ptrdiff_t mzStride, const std::ptrdiff_t intensityStride, const std::ptrdiff_t i = 0)
+        : mz_(reinterpret_cast<const char*>(mz) + i * mzStride), intensity_(reinterpret_cast<const char*>(intensity) + i * intensityStride),
+          mzStride_(mzStride), intensityStride_(intensityStride), i_(i) {}
+
+    reference operator*() const {
+        return SpectrumElement(static_cast<double>(*reinterpret_cast<const MzT*>(mz_)), static_cast<double>(*reinterpret_cast<const IntensityT*>(intensity_)));
+    }
+    pointer operator->() const { return pointer(**this); }
+    reference operator[](const difference_type n) const { return *(*this + n); }
+
+    SpectrumViewIterator& operator++() { return *this += 1; }
+    SpectrumViewIterator operator++(int) { SpectrumViewIterator old(*this); *this += 1; return old; }
+    SpectrumViewIterator& operator--() { return *this -= 1; }
+    SpectrumViewIterator operator--(int) { SpectrumViewIterator old(*this); *this -= 1; return old; }
+    SpectrumViewIterator& operator+=(const difference_type n) {
+        mz_ += n * mzStride_;
+        intensity_ += n * intensityStride_;
+        i_ += n;
+        return *this;
+    }
+    SpectrumViewIterator& operator-=(const difference_type n) { return *this += -n; }
+    SpectrumViewIterator operator+(const difference_type n) const { return SpectrumViewIterator(*this) += n; }
+    SpectrumViewIterator operator-(const difference_type n) const { return SpectrumViewIterator(*this) -= n; }
+    difference_type operator-(const SpectrumViewIterator& other) const { return i_ - other.i_; }
+
+    bool operator==(const SpectrumViewIterator& other) const { return i_ == other.i_; }
+    bool operator!=(const SpectrumViewIterator& other) const { return i_ != other.i_; }
+    bool operator<(const SpectrumViewIterator& other) const { return i_ < other.i_; }
+    bool operator>(const SpectrumViewIterator& other) const { return i_ > other.i_; }
+    bool operator<=(const SpectrumViewIterator& other) const { return i_ <= other.i_; }
+    bool operator>=(const SpectrumViewIterator& other) const { return i_ >= other.i_; }
+
+private:
+    const char* mz_;
+    const char* intensity_;
+    std::ptrdiff_t mzStride_;
+    std::ptrdiff_t intensityStride_;
+    std::ptrdiff_t i_;
+};
+
+/**
+ * Holds the element for operator->(), which chains to the address of the copy.
+ */
+template< typename MzT, typename IntensityT >
+class SpectrumViewIterator<MzT, IntensityT>::pointer
+{
+public:
+    explicit pointer(const SpectrumElement& element) : element_(element) {}
+    const SpectrumElement* operator->() const { return &element_; }
+
+private:
+    SpectrumElement element_;
+};
+
+// class BasicSpectrumView
+/**
+ * A spectrum in memory owned by someone else: n m/z values of type MzT and n
+ * intensities of type IntensityT, each a stride of bytes apart.
+ *
+ * The elements have to be in ascending order of m/z for most algorithms, like the ones
+ * of a psf::Spectrum.
+ *
+ * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
+ */
+template< typename MzT = double, typename IntensityT = double >
+class BasicSpectrumView
+{
+public:
+    typedef SpectrumViewIterator<MzT, IntensityT> const_iterator;
+    typedef StridedIterator<MzT> mz_iterator;
+    typedef StridedIterator<IntensityT> intensity_iterator;
+
+    BasicSpectrumView() : mz_(0), intensity_(0), size_(0), mzStride_(sizeof(MzT)), intensityStride_(sizeof(IntensityT)) {}
+
+    /**
+     * @param mzStride Bytes from one m/z value to the next; may be negative.
+     * @param intensityStride Bytes from one intensity to the next; may be negative.
+     */
+    BasicSpectrumView(const MzT* mz, const IntensityT* intensity, const std::size_t n,
+                      const std::ptrdiff_t mzStride = sizeof(MzT), const std::ptrdiff_t intensityStride = sizeof(IntensityT))
+        : mz_(mz), intensity_(intensity), size_(n), mzStride_(mzStride), intensityStride_(intensityStride) {}
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    SpectrumElement operator[](const std::ptrdiff_t i) const {
+        return SpectrumElement(static_cast<double>(mzBegin()[i]), static_cast<double>(intensityBegin()[i]));
+    }
+
+    const_iterator begin() const { return const_iterator(mz_, intensity_, mzStride_, intensityStride_); }
+    const_iterator end() const { return const_iterator(mz_, intensity_, mzStride_, intensityStride_, static_cast<std::ptrdiff_t>(size_)); }
+
+    mz_iterator mzBegin() const { return mz_iterator(mz_, mzStride_); }
+    mz_iterator mzEnd() const { return mz_iterator(mz_, mzStride_, static_cast<std::ptrdiff_t>(size_)); }
+    intensity_iterator intensityBegin() const { return intensity_iterator(intensity_, intensityStride_); }
+    intensity_iterator intensityEnd() const { return intensity_iterator(intensity_, intensityStride_, static_cast<std::ptrdiff_t>(size_)); }
+
+private:
+    const MzT* mz_;
+    const IntensityT* intensity_;
+    std::size_t size_;
+    std::ptrdiff_t mzStride_;
+    std::ptrdiff_t intensityStride_;
+};
+
+/**
+ * A view of double m/z values and intensities.
+ */
+typedef BasicSpectrumView<double, double> SpectrumView;
+
+// makeSpectrumView()
+/**
+ * A view of the elements of a spectrum.
+ */
+template< typename Allocator >
+SpectrumView makeSpectrumView(const std::vector<SpectrumElement, Allocator>& s) {
+    if(s.empty()) {
+        return SpectrumView();
+    }
+    return SpectrumView(&s[0].mz, &s[0].intensity, s.size(), sizeof(SpectrumElement), sizeof(SpectrumElement));
+}
+
+// makeInterleavedSpectrumView()
+/**
+ * A view of n interleaved (mz, intensity) pairs: mz0, intensity0, mz1, intensity1, ...
+ */
+template< typename T >
+BasicSpectrumView<T, T> makeInterleavedSpectrumView(const T* pairs, const std::size_t n) {
+    return BasicSpectrumView<T, T>(pairs, pairs + 1, n, 2 * sizeof(T), 2 * sizeof(T));
+}
+
+// measureFullWidths()
+/**
+ * psf::measureFullWidths() of the elements of a view.
+ *
+ * @throw psf::PreconditionViolation Parameter fraction is out of the required range.
+ */
+template< typename MzT, typename IntensityT >
+std::vector<std::pair<double, double> > measureFullWidths(const BasicSpectrumView<MzT, IntensityT>& view, const double fraction, const double minimalPeakHeight = 0) {
+    return measureFullWidths(MzExtractor(), IntensityExtractor(), view.begin(), view.end(), fraction, minimalPeakHeight);
+}
+
+// measureFullWidths()
+/**
+ * The same, but the pairs are written to widths, which is cleared first.
+ */
+template< typename MzT, typename IntensityT, typename Allocator >
+void measureFullWidths(const BasicSpectrumView<MzT, IntensityT>& view, const double fraction, const double minimalPeakHeight,
+                       std::vector<std::pair<double, double>, Allocator>& widths) {
+    measureFullWidths(MzExtractor(), IntensityExtractor(), view.begin(), view.end(), fraction, minimalPeakHeight, widths);
+}
+
+// measureFullWidths()
+/**
+ * The same using several threads; see the parallel psf::measureFullWidths().
+ *
+ * @param nThreads Number of threads. Zero means psf::hardwareConcurrency().
+ */
+template< typename MzT, typename IntensityT >
+std::vector<std::pair<double, double> > measureFullWidths(const BasicSpectrumView<MzT, IntensityT>& view, const double fraction, const double minimalPeakHeight, const unsigned nThreads) {
+    return measureFullWidths(MzExtractor(), IntensityExtractor(), view.begin(), view.end(), fraction, minimalPeakHeight, nThreads);
+}
+
+} /* namespace psf */
+
+#endif /*__SPECTRUMVIEW_H__*/
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <psf/Error.h>
+#include "psf/Arena.h"
+
+namespace psf
+{
+
+namespace {
+    // Offset of the first multiple of alignment not before address + offset.
+    std::size_t alignedOffset_(const char* address, const std::size_t offset, const std::size_t alignment) {
+        const std::size_t misalignment = reinterpret_cast<std::size_t>(address + offset) & (alignment - 1);
+        return misalignment ? offset + alignment - misalignment : offset;
+    }
+} /* anonymous namespace */
+
+Arena::Arena(const std::size_t blockSize) : current_(0), offset_(0), used_(0), blockSize_(blockSize > 0 ? blockSize : 1) {
+}
+
+Arena::~Arena() {
+    release_();
+}
+
+void* Arena::allocate(const std::size_t bytes, const std::size_t alignment) {
+    psf_precondition(alignment > 0 && (alignment & (alignment - 1)) == 0, "Arena::allocate(): Alignment has to be a power of two.");
+    while(current_ < blocks_.size()) {
+        Block& block = blocks_[current_];
+        const std::size_t begin = alignedOffset_(block.data, offset_, alignment);
+        if(begin <= block.size && bytes <= block.size - begin) {
+            offset_ = begin + bytes;
+            return block.data + begin;
+        }
+        // the rest of the block is lost until the next reset
+        if(current_ + 1 == blocks_.size()) {
+            break;
+        }
+        used_ += block.size;
+        ++current_;
+        offset_ = 0;
+    }
+    addBlock_(bytes + alignment);
+    return allocate(bytes, alignment);
+}
+
+void Arena::deallocate(void* p, const std::size_t bytes) {
+    if(current_ < blocks_.size()) {
+        char* const data = blocks_[current_].data;
+        if(static_cast<char*>(p) + bytes == data + offset_ && static_cast<char*>(p) >= data) {
+            offset_ = static_cast<char*>(p) - data;
+        }
+    }
+}
+
+void Arena::reset() {
+    if(blocks_.size() > 1) {
+        // one block for everything, so that the next round fits without a new block
+        const std::size_t total = capacity();
+        release_();
+        addBlock_(total);
+    }
+    current_ = 0;
+    offset_ = 0;
+    used_ = 0;
+}
+
+std::size_t Arena::bytesUsed() const {
+    return used_ + offset_;
+}
+
+std::size_t Arena::capacity() const {
+    std::size_t total = 0;
+    for(std::size_t i = 0; i < blocks_.size(); ++i) {
+        total += blocks_[i].size;
+    }
+    return total;
+}
+
+std::size_t Arena::numberOfBlocks() const {
+    return blocks_.size();
+}
+
+void Arena::addBlock_(const std::size_t minimalSize) {
+    // grow geometrically, so that a long round needs only a few blocks
+    std::size_t size = std::max(blockSize_, minimalSize);
+    if(!blocks_.empty()) {
+        size = std::max(size, 2 * blocks_.back().size);
+    }
+    Block block;
+    block.data = static_cast<char*>(::operator new(size));
+    block.size = size;
+    blocks_.push_back(block);
+    if(blocks_.size() > 1) {
+        used_ += (current_ + 1 < blocks_.size()) ? blocks_[current_].size : 0;
+        current_ = blocks_.size() - 1;
+        offset_ = 0;
+    }
+}
+
+void Arena::release_() {
+    for(std::size_t i = 0; i < blocks_.size(); ++i) {
+        ::operator delete(blocks_[i].data);
+    }
+    blocks_.clear();
+    current_ = 0;
+    offset_ = 0;
+    used_ = 0;
+}
+
+ArenaPool::ArenaPool(const std::size_t blockSize) : blockSize_(blockSize) {
+}
+
+ArenaPool::~ArenaPool() {
+    for(std::size_t i = 0; i < arenas_.size(); ++i) {
+        delete arenas_[i];
+    }
+}
+
+std::size_t ArenaPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return arenas_.size();
+}
+
+Arena* ArenaPool::acquire_() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(free_.empty()) {
+        // reserve, so that release_() never has to allocate
+        free_.reserve(arenas_.size() + 1);
+        arenas_.reserve(arenas_.size() + 1);
+        Arena* arena = new Arena(blockSize_);
+        arenas_.push_back(arena);
+        return arena;
+    }
+    Arena* arena = free_.back();
+    free_.pop_back();
+    return arena;
+}
+
+void ArenaPool::release_(Arena* const arena) {
+    arena->reset();
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(arena);
+}
+
+ArenaLease::ArenaLease(ArenaPool& pool) : pool_(pool), arena_(pool.acquire_()) {
+}
+
+ArenaLease::~ArenaLease() {
+    pool_.release_(arena_);
+}
+
+Arena& ArenaLease::arena() const {
+    return *arena_;
+}
+
+} /* namespace psf */
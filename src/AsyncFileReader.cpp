@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef PSF_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include <psf/Error.h>
+#include "psf/AsyncFileReader.h"
+
+namespace psf
+{
+
+// A file on its way to the consumer.
+struct AsyncFileReader::Slot_
+{
+    enum State { idle, busy, ready, failed };
+
+    Slot_() : file(0), fd(-1), size(0), done(0), state(idle) {}
+
+    std::size_t file;
+    int fd;
+    std::size_t size;
+    std::size_t done;
+    struct iovec iov;
+    State state;
+    std::string error;
+    std::vector<char> buffer;
+};
+
+// Reads files into slots; the slot states are the only link to the consumer.
+class AsyncFileReader::Engine_
+{
+public:
+    virtual ~Engine_() {}
+    virtual void start(Slot_& slot, const std::string& filename) = 0;
+    virtual void wait(Slot_& slot) = 0;
+};
+
+namespace {
+    std::string errorMessage_(const std::string& filename, const int error) {
+        return "AsyncFileReader: Couldn't read '" + filename + "': " + std::strerror(error);
+    }
+
+    // Opens the file and sizes the buffer for its content and a nul; false on error.
+    template< typename Slot >
+    bool open_(Slot& slot, const std::string& filename) {
+        slot.fd = ::open(filename.c_str(), O_RDONLY);
+        struct stat status;
+        if(slot.fd < 0 || ::fstat(slot.fd, &status) != 0) {
+            slot.error = errorMessage_(filename, errno);
+            return false;
+        }
+        slot.size = static_cast<std::size_t>(status.st_size);
+        slot.done = 0;
+        slot.buffer.resize(slot.size + 1);
+        slot.buffer[slot.size] = '\0';
+        return true;
+    }
+
+    template< typename Slot >
+    void close_(Slot& slot) {
+        if(slot.fd >= 0) {
+            ::close(slot.fd);
+            slot.fd = -1;
+        }
+    }
+} /* anonymous namespace */
+
+// A pool of threads, each reading one file at a time with pread().
+class AsyncFileReader::ThreadPool_ : public AsyncFileReader::Engine_
+{
+public:
+    explicit ThreadPool_(const unsigned nThreads) : stopping_(false) {
+        for(unsigned t = 0; t < nThreads; ++t) {
+            threads_.push_back(std::thread([this]() { work_(); }));
+        }
+    }
+
+    ~ThreadPool_() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        started_.notify_all();
+        for(std::size_t t = 0; t < threads_.size(); ++t) {
+            threads_[t].join();
+        }
+    }
+
+    void start(Slot_& slot, const std::string& filename) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slot.state = Slot_::busy;
+            queue_.push_back(std::make_pair(&slot, &filename));
+        }
+        started_.notify_one();
+    }
+
+    void wait(Slot_& slot) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        finished_.wait(lock, [&slot]() { return slot.state != Slot_::busy; });
+    }
+
+private:
+    void work_() {
+        for(;;) {
+            std::pair<Slot_*, const std::string*> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                started_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+                if(queue_.empty()) {
+                    return;
+                }
+                job = queue_.front();
+                queue_.pop_front();
+            }
+            // the consumer doesn't touch a busy slot
+            Slot_& slot = *job.first;
+            bool ok = open_(slot, *job.second);
+            while(ok && slot.done < slot.size) {
+                const ssize_t n = ::pread(slot.fd, &slot.buffer[slot.done], slot.size - slot.done, static_cast<off_t>(slot.done));
+                if(n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if(n <= 0) {
+                    slot.error = n < 0 ? errorMessage_(*job.second, errno) : "AsyncFileReader: '" + *job.second + "' got shorter.";
+                    ok = false;
+                }
+                else {
+                    slot.done += static_cast<std::size_t>(n);
+                }
+            }
+            close_(slot);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                slot.state = ok ? Slot_::ready : Slot_::failed;
+            }
+            finished_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable started_;
+    std::condition_variable finished_;
+    std::deque<std::pair<Slot_*, const std::string*> > queue_;
+    std::vector<std::thread> threads_;
+    bool stopping_;
+};
+
+#ifdef PSF_HAVE_IO_URING
+namespace {
+    // see AsyncFileReader::injectIoUringFaults()
+    std::size_t faultReadSize_ = 0;
+    std::size_t faultSubmission_ = 0;
+
+    int ioUringSetup_(const unsigned entries, io_uring_params& params) {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    }
+
+    int ioUringEnter_(const int fd, const unsigned toSubmit, const unsigned minComplete, const unsigned flags) {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, 0, 0));
+    }
+} /* anonymous namespace */
+
+// The submission and completion rings shared with the kernel, driven by the consumer
+// thread: the reads are submitted in start() and reaped in wait().
+class AsyncFileReader::IoUring_ : public AsyncFileReader::Engine_
+{
+public:
+    // Returns 0, if the kernel doesn't support io_uring.
+    static IoUring_* create(const unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        const int fd = ioUringSetup_(entries, params);
+        if(fd < 0) {
+            return 0;
+        }
+        IoUring_* ring = new IoUring_(fd, params);
+        if(ring->sqes_ == 0) {
+            delete ring;
+            return 0;
+        }
+        return ring;
+    }
+
+    ~IoUring_() {
+        while(inFlight_ > 0 && reap_(true)) {
+        }
+        if(sqes_ != 0) {
+            ::munmap(sqes_, sqesSize_);
+        }
+        if(cqRing_ != 0 && cqRing_ != sqRing_) {
+            ::munmap(cqRing_, cqSize_);
+        }
+        if(sqRing_ != 0) {
+            ::munmap(sqRing_, sqSize_);
+        }
+        ::close(fd_);
+    }
+
+    void start(Slot_& slot, const std::string& filename) {
+        slot.state = Slot_::busy;
+        if(!open_(slot, filename)) {
+            finish_(slot, false);
+        }
+        else if(slot.size == 0) {
+            finish_(slot, true);
+        }
+        else {
+            submit_(slot);
+        }
+    }
+
+    void wait(Slot_& slot) {
+        while(slot.state == Slot_::busy) {
+            if(!reap_(true)) {
+                // the read may still be in flight: the slot stays busy, so that its buffer
+                // is neither handed out nor reused before the completion is reaped
+                psf_fail("AsyncFileReader: io_uring_enter failed: " + std::string(std::strerror(errno)));
+            }
+        }
+    }
+
+private:
+    IoUring_(const int fd, const io_uring_params& params)
+        : fd_(fd), sqRing_(0), cqRing_(0), sqes_(0), inFlight_(0),
+          readSize_(faultReadSize_), failingSubmission_(faultSubmission_), submissions_(0) {
+        sqSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        bool single = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+        single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if(single) {
+            sqSize_ = cqSize_ = std::max(sqSize_, cqSize_);
+        }
+#endif
+        sqRing_ = map_(sqSize_, IORING_OFF_SQ_RING);
+        cqRing_ = single ? sqRing_ : map_(cqSize_, IORING_OFF_CQ_RING);
+        if(sqRing_ == 0 || cqRing_ == 0) {
+            return;
+        }
+        sqes_ = static_cast<io_uring_sqe*>(map_(sqesSize_, IORING_OFF_SQES));
+
+        char* sq = static_cast<char*>(sqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    void* map_(const std::size_t size, const off_t offset) {
+        void* p = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return p == MAP_FAILED ? 0 : p;
+    }
+
+    // Submits a read of the rest of the file; at most one per slot and one per entry.
+    // Doesn't throw: if the read can't be submitted, the slot fails.
+    void submit_(Slot_& slot) {
+        slot.iov.iov_base = &slot.buffer[slot.done];
+        slot.iov.iov_len = slot.size - slot.done;
+        if(readSize_ > 0) {
+            slot.iov.iov_len = std::min(slot.iov.iov_len, readSize_);
+        }
+        const unsigned tail = *sqTail_;
+        const unsigned index = tail & sqMask_;
+        io_uring_sqe& sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = slot.fd;
+        sqe.addr = reinterpret_cast<unsigned long long>(&slot.iov);
+        sqe.len = 1;
+        sqe.off = slot.done;
+        sqe.user_data = reinterpret_cast<unsigned long long>(&slot);
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        ++inFlight_;
+        const bool injected = ++submissions_ == failingSubmission_;
+        int error = injected ? EIO : 0;
+        while(!injected && ioUringEnter_(fd_, 1, 0, 0) < 0) {
+            if(errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                error = errno;
+                break;
+            }
+        }
+        if(error != 0 && __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) == tail) {
+            // the kernel didn't take the entry, so no completion will come: take it back
+            __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+            --inFlight_;
+            slot.error = "AsyncFileReader: io_uring_enter failed: " + std::string(std::strerror(error));
+            finish_(slot, false);
+        }
+    }
+
+    // Handles the available completions, after waiting for one if wait is set.
+    bool reap_(const bool wait) {
+        if(wait && ioUringEnter_(fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            return false;
+        }
+        unsigned head = *cqHead_;
+        const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        while(head != tail) {
+            const io_uring_cqe cqe = cqes_[head & cqMask_];
+            // handed back before anything is resubmitted, so that whatever happens below,
+            // a completion is never handled twice
+            __atomic_store_n(cqHead_, ++head, __ATOMIC_RELEASE);
+            Slot_& slot = *reinterpret_cast<Slot_*>(cqe.user_data);
+            --inFlight_;
+            if(cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                submit_(slot);
+            }
+            else if(cqe.res < 0) {
+                slot.error = "AsyncFileReader: Couldn't read: " + std::string(std::strerror(-cqe.res));
+                finish_(slot, false);
+            }
+            else if(cqe.res == 0) {
+                slot.error = "AsyncFileReader: A file got shorter.";
+                finish_(slot, false);
+            }
+            else {
+                slot.done += static_cast<std::size_t>(cqe.res);
+                if(slot.done < slot.size) {
+                    submit_(slot); // a short read
+                }
+                else {
+                    finish_(slot, true);
+                }
+            }
+        }
+        return true;
+    }
+
+    void finish_(Slot_& slot, const bool ok) {
+        close_(slot);
+        slot.state = ok ? Slot_::ready : Slot_::failed;
+    }
+
+    int fd_;
+    void* sqRing_;
+    void* cqRing_;
+    io_uring_sqe* sqes_;
+    std::size_t sqSize_;
+    std::size_t cqSize_;
+    std::size_t sqesSize_;
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned sqMask_;
+    unsigned* sqArray_;
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned cqMask_;
+    io_uring_cqe* cqes_;
+    std::size_t inFlight_;
+    std::size_t readSize_;          // at most per read; zero for the whole rest
+    std::size_t failingSubmission_; // counted from one; zero for none
+    std::size_t submissions_;
+};
+#endif
+
+AsyncFileReader::AsyncFileReader(const std::vector<std::string>& filenames, const unsigned depth, const Backend backend)
+    : filenames_(filenames), depth_(depth > 0 ? depth : 1), backend_(threadBackend), next_(0), started_(0) {
+    slots_.reset(new Slot_[depth_]);
+#ifdef PSF_HAVE_IO_URING
+    if(backend != threadBackend) {
+        engine_.reset(IoUring_::create(static_cast<unsigned>(depth_)));
+        if(engine_) {
+            backend_ = ioUringBackend;
+        }
+    }
+#endif
+    if(!engine_) {
+        if(backend == ioUringBackend) {
+            psf_fail("AsyncFileReader: io_uring isn't available.");
+        }
+        engine_.reset(new ThreadPool_(static_cast<unsigned>(depth_)));
+    }
+    while(started_ < filenames_.size() && started_ < depth_) {
+        start_(started_);
+    }
+}
+
+AsyncFileReader::~AsyncFileReader() {
+    // the engine waits for the reads in flight
+    engine_.reset();
+    // a read the engine couldn't reap may still write into its buffer; leaked, not freed
+    for(std::size_t i = 0; i < depth_; ++i) {
+        if(slots_[i].state == Slot_::busy) {
+            (new std::vector<char>())->swap(slots_[i].buffer);
+        }
+    }
+}
+
+void AsyncFileReader::start_(const std::size_t file) {
+    Slot_& slot = slots_[file % depth_];
+    slot.file = file;
+    slot.error.clear();
+    engine_->start(slot, filenames_[file]);
+    ++started_;
+}
+
+bool AsyncFileReader::next(std::vector<char>& text) {
+    if(next_ == filenames_.size()) {
+        return false;
+    }
+    Slot_& slot = slots_[next_ % depth_];
+    engine_->wait(slot);
+    filename_ = filenames_[next_];
+    ++next_;
+    const bool ok = slot.state == Slot_::ready;
+    const std::string error = slot.error;
+    text.swap(slot.buffer);
+    slot.state = Slot_::idle;
+    if(started_ < filenames_.size()) {
+        start_(started_);
+    }
+    if(!ok) {
+        psf_fail(error);
+    }
+    return true;
+}
+
+void AsyncFileReader::injectIoUringFaults(const std::size_t readSize, const std::size_t failingSubmission) {
+#ifdef PSF_HAVE_IO_URING
+    faultReadSize_ = readSize;
+    faultSubmission_ = failingSubmission;
+#else
+    PSF_UNUSED(readSize);
+    PSF_UNUSED(failingSubmission);
+#endif
+}
+
+bool AsyncFileReader::ioUringAvailable() {
+#ifdef PSF_HAVE_IO_URING
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    const int fd = ioUringSetup_(2, params);
+    if(fd >= 0) {
+        ::close(fd);
+        return true;
+    }
+#endif
+    return false;
+}
+
+} /* namespace psf */
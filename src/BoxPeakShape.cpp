@@ -5,6 +5,12 @@
 
 using namespace psf;
 
+namespace
+{
+    // 2*sqrt(2*ln(2)); computed once instead of on every fwhm conversion
+    const double sigmaToFwhm = 2 * std::sqrt(2 * std::log(2.));
+}
+
 double BoxPeakShape::at(const double xCoordinate) const {
     // this is the only difference between the Box and tha Gaussian
     return 1.0;
@@ -31,10 +37,10 @@ void BoxPeakShape::setSigma(const double sigma) {
 
 void BoxPeakShape::setFwhm(const double fwhm) {
     psf_precondition(fwhm > 0, "BoxPeakShape::BoxPeakShape(): Parameter fwhm has to be positive.");
-    sigma_ = fwhm / sigmaToFwhmConversionFactor();
+    sigma_ = fwhm / sigmaToFwhm;
 }
 double BoxPeakShape::getFwhm() const {
-    return sigma_ * sigmaToFwhmConversionFactor();
+    return sigma_ * sigmaToFwhm;
 }
 
 void BoxPeakShape::setSigmaFactorForSupportThreshold(const double factor) {
@@ -46,5 +52,5 @@ double BoxPeakShape::getSigmaFactorForSupportThreshold() const {
 }
 
 double BoxPeakShape::sigmaToFwhmConversionFactor() const {
-    return 2 * sqrt(2 * std::log(2.));
+    return sigmaToFwhm;
 }
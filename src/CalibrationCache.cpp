@@ -0,0 +1,125 @@
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+
+#include <psf/Error.h>
+#include "psf/CalibrationCache.h"
+
+namespace psf
+{
+
+namespace {
+    const char* const header_ = "# psf calibration cache 1";
+} /* anonymous namespace */
+
+CalibrationRecord::CalibrationRecord()
+    : regressionMethod(leastSquaresRegression), firstMz(0.), lastMz(0.), numberOfPeaks(0), medianRelativeResidual(0.), medianAbsoluteRelativeResidual(0.) {
+}
+
+CalibrationCache::CalibrationCache(const std::string& filename) : filename_(filename) {
+    load_();
+}
+
+bool CalibrationCache::find(const std::string& fingerprint, CalibrationRecord& record) const {
+    std::map<std::string, CalibrationRecord>::const_iterator found = records_.find(fingerprint);
+    if(found == records_.end()) {
+        return false;
+    }
+    record = found->second;
+    return true;
+}
+
+void CalibrationCache::store(const std::string& fingerprint, const CalibrationRecord& record) {
+    psf_precondition(!fingerprint.empty() && fingerprint.find_first_of("\t\r\n") == std::string::npos, "CalibrationCache::store(): Fingerprint has to be non-empty and without tabs or line breaks.");
+    psf_precondition(!record.parameters.empty(), "CalibrationCache::store(): Record has no parameters.");
+    psf_precondition(!record.model.empty() && record.model.find_first_of("\t\r\n") == std::string::npos, "CalibrationCache::store(): Invalid model name in record.");
+    records_[fingerprint] = record;
+    save_();
+}
+
+bool CalibrationCache::erase(const std::string& fingerprint) {
+    if(records_.erase(fingerprint) == 0) {
+        return false;
+    }
+    save_();
+    return true;
+}
+
+std::size_t CalibrationCache::size() const {
+    return records_.size();
+}
+
+const std::string& CalibrationCache::getFilename() const {
+    return filename_;
+}
+
+void CalibrationCache::load_() {
+    std::ifstream ifs(filename_.c_str());
+    if(!ifs.is_open()) {
+        return;
+    }
+    std::string line;
+    if(!std::getline(ifs, line) || line != header_) {
+        psf_fail("CalibrationCache: '" + filename_ + "' is not a calibration store.");
+    }
+    while(std::getline(ifs, line)) {
+        if(line.empty()) {
+            continue;
+        }
+        const std::string::size_type tab = line.find('\t');
+        std::istringstream fields(tab == std::string::npos ? std::string() : line.substr(tab + 1));
+        fields.imbue(std::locale::classic());
+        CalibrationRecord record;
+        int method = 0;
+        std::size_t nParameters = 0;
+        fields >> record.model >> method >> record.firstMz >> record.lastMz >> record.numberOfPeaks
+               >> record.medianRelativeResidual >> record.medianAbsoluteRelativeResidual >> nParameters;
+        for(std::size_t i = 0; fields && i < nParameters; ++i) {
+            double parameter;
+            if(fields >> parameter) {
+                record.parameters.push_back(parameter);
+            }
+        }
+        if(tab == std::string::npos || !fields || nParameters == 0 || method < leastSquaresRegression || method > tukeyRegression) {
+            psf_fail("CalibrationCache: Malformed record in '" + filename_ + "'.");
+        }
+        record.regressionMethod = static_cast<RegressionMethod>(method);
+        records_[line.substr(0, tab)] = record;
+    }
+}
+
+void CalibrationCache::save_() const {
+    // write a complete new store, then replace the old one
+    const std::string temporary = filename_ + ".tmp";
+    {
+        std::ofstream ofs(temporary.c_str());
+        ofs.imbue(std::locale::classic());
+        ofs.precision(std::numeric_limits<double>::digits10 + 2);
+        ofs << header_ << '\n';
+        for(std::map<std::string, CalibrationRecord>::const_iterator it = records_.begin(); it != records_.end(); ++it) {
+            const CalibrationRecord& record = it->second;
+            ofs << it->first << '\t' << record.model << '\t' << record.regressionMethod << '\t'
+                << record.firstMz << '\t' << record.lastMz << '\t' << record.numberOfPeaks << '\t'
+                << record.medianRelativeResidual << '\t' << record.medianAbsoluteRelativeResidual << '\t'
+                << record.parameters.size();
+            for(std::size_t i = 0; i < record.parameters.size(); ++i) {
+                ofs << '\t' << record.parameters[i];
+            }
+            ofs << '\n';
+        }
+        ofs.flush();
+        if(!ofs) {
+            std::remove(temporary.c_str());
+            psf_fail("CalibrationCache: Couldn't write '" + temporary + "'.");
+        }
+    }
+    if(std::rename(temporary.c_str(), filename_.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        psf_fail("CalibrationCache: Couldn't replace '" + filename_ + "'.");
+    }
+}
+
+} /* namespace psf */
@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <psf/Error.h>
+#include "psf/Chromatogram.h"
+
+namespace psf
+{
+
+IonChromatograms::IonChromatograms(const std::vector<double>& targets, const std::vector<double>& tolerances) : targets_(targets), nScans_(0) {
+    psf_precondition(targets.size() == tolerances.size(), "IonChromatograms::IonChromatograms(): One tolerance per target needed.");
+    for(std::size_t t = 0; t < tolerances.size(); ++t) {
+        psf_precondition(tolerances[t] >= 0, "IonChromatograms::IonChromatograms(): Tolerances may not be negative.");
+    }
+    sortWindows_(tolerances);
+}
+
+void IonChromatograms::chromatogram(const std::size_t t, std::vector<double>& xic) const {
+    psf_precondition(t < targets_.size(), "IonChromatograms::chromatogram(): Target out of range.");
+    xic.resize(nScans_);
+    const std::size_t m = targets_.size();
+    for(std::size_t i = 0; i < nScans_; ++i) {
+        xic[i] = intensities_[i * m + t];
+    }
+}
+
+void IonChromatograms::sortWindows_(const std::vector<double>& tolerances) {
+    const std::size_t m = targets_.size();
+    std::vector<std::pair<double, std::size_t> > byLower(m);
+    for(std::size_t t = 0; t < m; ++t) {
+        byLower[t] = std::make_pair(targets_[t] - tolerances[t], t);
+    }
+    std::sort(byLower.begin(), byLower.end());
+    lower_.resize(m);
+    upper_.resize(m);
+    targetOf_.resize(m);
+    rank_.resize(m);
+    for(std::size_t k = 0; k < m; ++k) {
+        const std::size_t t = byLower[k].second;
+        lower_[k] = byLower[k].first;
+        upper_[k] = targets_[t] + tolerances[t];
+        targetOf_[k] = t;
+        rank_[t] = k;
+    }
+}
+
+} /* namespace psf */
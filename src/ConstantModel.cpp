@@ -20,9 +20,19 @@ double ConstantModel::at(const double x) const {
     return a_;
 }
 
+double ConstantModel::warpAt(const double x) const {
+    return x / a_;
+}
+
 GeneralizedSlope ConstantModel::slopeInParameterSpaceFor(double x) const {
-    double slope[] = {1., 0.};
-    return GeneralizedSlope(slope, slope + 2);
+    GeneralizedSlope slope;
+    slopeInParameterSpaceFor(x, slope);
+    return slope;
+}
+
+void ConstantModel::slopeInParameterSpaceFor(double x, GeneralizedSlope& slope) const {
+    const double s[] = {1., 0.};
+    slope.assign(s, s + 2);
 }
 
 // setter / getter
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include <psf/Error.h>
+#include "psf/Fft.h"
+
+namespace psf
+{
+
+std::size_t nextPowerOfTwo(std::size_t n) {
+    std::size_t power = 1;
+    while(power < n) {
+        power <<= 1;
+    }
+    return power;
+}
+
+void fft(std::vector<std::complex<double> >& data, bool inverse) {
+    typedef std::complex<double> Complex;
+    const std::size_t n = data.size();
+    psf_precondition((n & (n - 1)) == 0, "fft(): Size of input data has to be a power of two.");
+    if(n < 2) {
+        return;
+    }
+
+    // bit reversal permutation
+    for(std::size_t i = 1, j = 0; i < n; ++i) {
+        std::size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if(i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+
+    // Twiddle factors for the largest stage; the smaller stages use every (n/length)th one.
+    // Computing them directly (instead of by repeated multiplication) keeps the rounding
+    // error independent of n.
+    const double pi = 3.14159265358979323846;
+    const double sign = inverse ? 1. : -1.;
+    std::vector<Complex> twiddles(n / 2);
+    for(std::size_t k = 0; k < n / 2; ++k) {
+        const double angle = sign * 2 * pi * k / n;
+        twiddles[k] = Complex(std::cos(angle), std::sin(angle));
+    }
+
+    // butterflies
+    for(std::size_t length = 2; length <= n; length <<= 1) {
+        const std::size_t half = length / 2;
+        const std::size_t stride = n / length;
+        for(std::size_t start = 0; start < n; start += length) {
+            for(std::size_t k = 0; k < half; ++k) {
+                const Complex t = twiddles[k * stride] * data[start + k + half];
+                data[start + k + half] = data[start + k] - t;
+                data[start + k] += t;
+            }
+        }
+    }
+
+    if(inverse) {
+        const double scale = 1. / n;
+        for(std::size_t i = 0; i < n; ++i) {
+            data[i] *= scale;
+        }
+    }
+}
+
+void convolve(const std::vector<double>& a, const std::vector<double>& b, std::vector<double>& result) {
+    typedef std::complex<double> Complex;
+    if(a.empty() || b.empty()) {
+        result.clear();
+        return;
+    }
+    const std::size_t length = a.size() + b.size() - 1;
+    const std::size_t n = nextPowerOfTwo(length);
+
+    // Both real sequences are transformed at once: a in the real, b in the imaginary part.
+    std::vector<Complex> packed(n, Complex(0., 0.));
+    for(std::size_t i = 0; i < a.size(); ++i) {
+        packed[i].real(a[i]);
+    }
+    for(std::size_t i = 0; i < b.size(); ++i) {
+        packed[i].imag(b[i]);
+    }
+    fft(packed);
+
+    // Unpack A_k = (P_k + conj(P_{n-k}))/2 and B_k = (P_k - conj(P_{n-k}))/2i and multiply.
+    std::vector<Complex> product(n);
+    for(std::size_t k = 0; k < n; ++k) {
+        const Complex p = packed[k];
+        const Complex q = std::conj(packed[(n - k) % n]);
+        const Complex transformedA = 0.5 * (p + q);
+        const Complex transformedB = Complex(0., -0.5) * (p - q);
+        product[k] = transformedA * transformedB;
+    }
+    fft(product, true);
+
+    result.resize(length);
+    for(std::size_t i = 0; i < length; ++i) {
+        result[i] = product[i].real();
+    }
+}
+
+} /* namespace psf */
@@ -5,8 +5,14 @@
 
 using namespace psf;
 
+namespace
+{
+    // 2*sqrt(2*ln(2)); computed once instead of on every fwhm conversion
+    const double sigmaToFwhm = 2 * std::sqrt(2 * std::log(2.));
+}
+
 double GaussianPeakShape::at(const double xCoordinate) const {
-    return std::exp(-(xCoordinate * xCoordinate) / (2 * sigma_ * sigma_));
+    return std::exp(exponentFactor_ * (xCoordinate * xCoordinate));
 }
 
 double GaussianPeakShape::getSupportThreshold() const {
@@ -18,6 +24,7 @@ GaussianPeakShape::GaussianPeakShape(const double sigma, const double sigmaFacto
     : sigma_(sigma), sigmaFactorForSupportThreshold_(sigmaFactorForSupportThreshold) {
     psf_precondition(sigma > 0, "GaussianPeakShape::GaussianPeakShape(): sigma has to be positive.");
     psf_precondition(sigmaFactorForSupportThreshold > 0, "GaussianPeakShape::GaussianPeakShape(): sigmaFactorForSupportThreshold has to be positive.");
+    exponentFactor_ = -1. / (2 * sigma_ * sigma_);
 }
 
 
@@ -25,15 +32,17 @@ GaussianPeakShape::GaussianPeakShape(const double sigma, const double sigmaFacto
 void GaussianPeakShape::setSigma(const double sigma) {
     psf_precondition(sigma > 0, "GaussianPeakShape::GaussianPeakShape(): Parameter sigma has to be positive."); 
     sigma_ = sigma; 
+    exponentFactor_ = -1. / (2 * sigma_ * sigma_);
 }
 
 
 void GaussianPeakShape::setFwhm(const double fwhm) {
     psf_precondition(fwhm > 0, "GaussianPeakShape::GaussianPeakShape(): Parameter fwhm has to be positive.");
-    sigma_ = fwhm / sigmaToFwhmConversionFactor();
+    sigma_ = fwhm / sigmaToFwhm;
+    exponentFactor_ = -1. / (2 * sigma_ * sigma_);
 }
 double GaussianPeakShape::getFwhm() const {
-    return sigma_ * sigmaToFwhmConversionFactor();
+    return sigma_ * sigmaToFwhm;
 }
 
 void GaussianPeakShape::setSigmaFactorForSupportThreshold(const double factor) {
@@ -45,5 +54,5 @@ double GaussianPeakShape::getSigmaFactorForSupportThreshold() const {
 }
 
 double GaussianPeakShape::sigmaToFwhmConversionFactor() const {
-    return 2 * sqrt(2 * std::log(2.));
+    return sigmaToFwhm;
 }
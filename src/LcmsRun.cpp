@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/ScanIndex.h>
+#include "psf/LcmsRun.h"
+
+namespace psf
+{
+
+LcmsRun::LcmsRun() : offsets_(1, 0) {}
+
+void LcmsRun::load(const std::string& runFilename, const int msLevel, const unsigned nThreads) {
+    clear();
+    try {
+        IndexedRun run(runFilename, nThreads);
+        std::vector<std::size_t> scans;
+        run.index().findRetentionTimeRange(-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), scans);
+        Spectrum spectrum;
+        for(std::size_t j = 0; j < scans.size(); ++j) {
+            const ScanIndexEntry& entry = run.index()[scans[j]];
+            if(msLevel != 0 && entry.msLevel != 0 && entry.msLevel != msLevel) {
+                continue;
+            }
+            run.read(scans[j], spectrum);
+            add(entry.retentionTime, spectrum.begin(), spectrum.end(), entry.scanNumber, entry.msLevel);
+        }
+    } catch(...) {
+        clear();
+        throw;
+    }
+}
+
+void LcmsRun::clear() {
+    elements_.clear();
+    offsets_.assign(1, 0);
+    retentionTimes_.clear();
+    scanNumbers_.clear();
+    msLevels_.clear();
+}
+
+void LcmsRun::reserve(const std::size_t nScans, const std::size_t nElements) {
+    elements_.reserve(nElements);
+    offsets_.reserve(nScans + 1);
+    retentionTimes_.reserve(nScans);
+    scanNumbers_.reserve(nScans);
+    msLevels_.reserve(nScans);
+}
+
+std::size_t LcmsRun::findRetentionTime(const double rt) const {
+    return std::lower_bound(retentionTimes_.begin(), retentionTimes_.end(), rt) - retentionTimes_.begin();
+}
+
+
+
+namespace {
+    double tricube_(const double u) {
+        if(u >= 1.) {
+            return 0.;
+        }
+        const double v = 1. - u * u * u;
+        return v * v * v;
+    }
+
+    double bisquare_(const double u) {
+        if(u >= 1.) {
+            return 0.;
+        }
+        const double v = 1. - u * u;
+        return v * v;
+    }
+
+    // Local linear regression at x of the samples (xs, ys) with robustness weights; the
+    // q nearest samples get positive tricube weights. distances is scratch memory.
+    double lowessAt_(const double x, const std::vector<double>& xs, const std::vector<double>& ys, const std::vector<double>& robustness,
+                     const std::size_t q, std::vector<double>& distances) {
+        const std::size_t n = xs.size();
+        for(std::size_t j = 0; j < n; ++j) {
+            distances[j] = std::abs(xs[j] - x);
+        }
+        std::nth_element(distances.begin(), distances.begin() + (q - 1), distances.end());
+        // slightly wider, so that the q-th sample keeps a small weight
+        const double h = distances[q - 1] * 1.000001;
+
+        double s0 = 0., s1 = 0., s2 = 0., t0 = 0., t1 = 0.;
+        for(std::size_t j = 0; j < n; ++j) {
+            const double d = xs[j] - x;
+            const double w = (h > 0. ? tricube_(std::abs(d) / h) : (d == 0. ? 1. : 0.)) * robustness[j];
+            s0 += w;
+            s1 += w * d;
+            s2 += w * d * d;
+            t0 += w * ys[j];
+            t1 += w * d * ys[j];
+        }
+        if(!(s0 > 0.)) {
+            // every neighbour was rejected as an outlier; take the nearest sample
+            std::size_t nearest = 0;
+            for(std::size_t j = 1; j < n; ++j) {
+                if(std::abs(xs[j] - x) < std::abs(xs[nearest] - x)) {
+                    nearest = j;
+                }
+            }
+            return ys[nearest];
+        }
+        const double det = s0 * s2 - s1 * s1;
+        if(det <= 1e-12 * s0 * s2) {
+            return t0 / s0;
+        }
+        return (s2 * t0 - s1 * t1) / det;
+    }
+} /* anonymous namespace */
+
+DriftModel::DriftModel() : dimension_(0), nKnots_(0), first_(0.), last_(0.), inverseStep_(0.) {}
+
+void DriftModel::fit(const std::vector<double>& retentionTimes, const std::vector<double>& values, const unsigned dimension,
+                     const double span, const unsigned nKnots, const unsigned robustnessIterations) {
+    const std::size_t n = retentionTimes.size();
+    psf_precondition(n > 0 && dimension > 0 && values.size() == n * dimension, "DriftModel::fit(): No samples or wrong number of values.");
+    psf_precondition(span > 0. && span <= 1. && nKnots >= 2, "DriftModel::fit(): Invalid span or number of knots.");
+
+    dimension_ = dimension;
+    nKnots_ = nKnots;
+    first_ = *std::min_element(retentionTimes.begin(), retentionTimes.end());
+    last_ = *std::max_element(retentionTimes.begin(), retentionTimes.end());
+    inverseStep_ = last_ > first_ ? (nKnots_ - 1) / (last_ - first_) : 0.;
+    knots_.assign(nKnots_ * dimension_, 0.);
+
+    const std::size_t q = std::min(n, std::max<std::size_t>(2, static_cast<std::size_t>(std::ceil(span * n))));
+    std::vector<double> ys(n), robustness(n), fitted(n), residuals(n), distances(n);
+    for(unsigned k = 0; k < dimension_; ++k) {
+        for(std::size_t j = 0; j < n; ++j) {
+            ys[j] = values[j * dimension_ + k];
+        }
+        robustness.assign(n, 1.);
+        for(unsigned iteration = 0; iteration < robustnessIterations && n > 2; ++iteration) {
+            for(std::size_t j = 0; j < n; ++j) {
+                fitted[j] = lowessAt_(retentionTimes[j], retentionTimes, ys, robustness, q, distances);
+                residuals[j] = std::abs(ys[j] - fitted[j]);
+            }
+            std::vector<double> sorted(residuals);
+            std::nth_element(sorted.begin(), sorted.begin() + n / 2, sorted.end());
+            double scale = 6. * sorted[n / 2];
+            if(!(scale > 0.)) {
+                // more than half of the samples are fitted exactly; fall back to the mean
+                double sum = 0.;
+                for(std::size_t j = 0; j < n; ++j) {
+                    sum += residuals[j];
+                }
+                scale = 6. * sum / n;
+            }
+            if(!(scale > 0.)) {
+                break;
+            }
+            for(std::size_t j = 0; j < n; ++j) {
+                robustness[j] = bisquare_(residuals[j] / scale);
+            }
+        }
+        for(std::size_t g = 0; g < nKnots_; ++g) {
+            const double x = last_ > first_ ? first_ + g / inverseStep_ : first_;
+            knots_[g * dimension_ + k] = lowessAt_(x, retentionTimes, ys, robustness, q, distances);
+        }
+    }
+}
+
+} /* namespace psf */
@@ -33,9 +33,31 @@ double LinearSqrtModel::at(const double x) const {
     return a_ * x * std::sqrt(x) + b_;
 }
 
+double LinearSqrtModel::warpAt(const double x) const {
+    psf_precondition(x >= 0, "LinearSqrtModel::warpAt(): Parameter x has to be >= 0.");
+    if(a_ == 0.) {
+        return x / b_;
+    }
+    const double s = std::sqrt(x);
+    if(b_ == 0.) {
+        return -2. / (a_ * s);
+    }
+    // With s = sqrt(x) and c^3 = b/a the integral becomes 2/a * int s/(s^3 + c^3) ds.
+    const double c = (b_ / a_ < 0) ? -std::pow(-b_ / a_, 1. / 3.) : std::pow(b_ / a_, 1. / 3.);
+    const double sqrt3 = std::sqrt(3.);
+    return 2. / a_ * (std::log((s * s - c * s + c * c) / ((s + c) * (s + c))) / (6. * c)
+                      + std::atan((2. * s - c) / (c * sqrt3)) / (c * sqrt3));
+}
+
 GeneralizedSlope LinearSqrtModel::slopeInParameterSpaceFor(double x) const {
-    double slope[] = {x * std::sqrt(x), 1., 0.};
-    return GeneralizedSlope(slope, slope + 3);
+    GeneralizedSlope slope;
+    slopeInParameterSpaceFor(x, slope);
+    return slope;
+}
+
+void LinearSqrtModel::slopeInParameterSpaceFor(double x, GeneralizedSlope& slope) const {
+    const double s[] = {x * std::sqrt(x), 1., 0.};
+    slope.assign(s, s + 3);
 }
 
 // setter / getter
@@ -74,9 +96,20 @@ double LinearSqrtOriginModel::at(const double x) const {
     return a_ * x * std::sqrt(x);
 }
 
+double LinearSqrtOriginModel::warpAt(const double x) const {
+    psf_precondition(x > 0, "LinearSqrtOriginModel::warpAt(): Parameter x has to be > 0.");
+    return -2. / (a_ * std::sqrt(x));
+}
+
 GeneralizedSlope LinearSqrtOriginModel::slopeInParameterSpaceFor(double x) const {
-    double slope[] = {x * std::sqrt(x), 0.};
-    return GeneralizedSlope(slope, slope + 2);
+    GeneralizedSlope slope;
+    slopeInParameterSpaceFor(x, slope);
+    return slope;
+}
+
+void LinearSqrtOriginModel::slopeInParameterSpaceFor(double x, GeneralizedSlope& slope) const {
+    const double s[] = {x * std::sqrt(x), 0.};
+    slope.assign(s, s + 2);
 }
 
 // setter / getter
@@ -0,0 +1,129 @@
+#include <cstddef>
+#include <vector>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define PSF_LOCALMAXIMA_SSE2
+#endif
+
+#include <psf/Error.h>
+#include "psf/LocalMaxima.h"
+
+namespace psf
+{
+
+namespace {
+    const std::size_t bitsPerWord_ = 64;
+
+    // Bit i - base of the result is set, if x[i] is a strict local maximum. Has to be
+    // called for positions with both neighbours only.
+    unsigned long long scalarMaxima_(const double* x, const std::size_t base, const std::size_t begin, const std::size_t end) {
+        unsigned long long bits = 0;
+        for(std::size_t i = begin; i < end; ++i) {
+            if(x[i - 1] < x[i] && x[i + 1] < x[i]) {
+                bits |= 1ull << (i - base);
+            }
+        }
+        return bits;
+    }
+
+    // The same for a whole word: x[base - 1] up to x[base + 64] have to exist.
+    unsigned long long wordMaxima_(const double* x, const std::size_t base) {
+#if defined(__AVX__)
+        unsigned long long bits = 0;
+        for(std::size_t k = 0; k < bitsPerWord_; k += 4) {
+            const double* c = x + base + k;
+            const __m256d centre = _mm256_loadu_pd(c);
+            const __m256d greater = _mm256_and_pd(_mm256_cmp_pd(centre, _mm256_loadu_pd(c - 1), _CMP_GT_OQ),
+                                                  _mm256_cmp_pd(centre, _mm256_loadu_pd(c + 1), _CMP_GT_OQ));
+            bits |= static_cast<unsigned long long>(_mm256_movemask_pd(greater)) << k;
+        }
+        return bits;
+#elif defined(PSF_LOCALMAXIMA_SSE2)
+        unsigned long long bits = 0;
+        for(std::size_t k = 0; k < bitsPerWord_; k += 2) {
+            const double* c = x + base + k;
+            const __m128d centre = _mm_loadu_pd(c);
+            const __m128d greater = _mm_and_pd(_mm_cmpgt_pd(centre, _mm_loadu_pd(c - 1)),
+                                               _mm_cmpgt_pd(centre, _mm_loadu_pd(c + 1)));
+            bits |= static_cast<unsigned long long>(_mm_movemask_pd(greater)) << k;
+        }
+        return bits;
+#else
+        return scalarMaxima_(x, base, base, base + bitsPerWord_);
+#endif
+    }
+
+    // Index of the lowest set bit; word may not be zero.
+    std::size_t lowestBit_(unsigned long long word) {
+#if defined(__GNUC__)
+        return static_cast<std::size_t>(__builtin_ctzll(word));
+#else
+        std::size_t index = 0;
+        while(!(word & 1ull)) {
+            word >>= 1;
+            ++index;
+        }
+        return index;
+#endif
+    }
+} /* anonymous namespace */
+
+LocalMaximaMask::LocalMaximaMask() : size_(0) {
+}
+
+void LocalMaximaMask::assign(const double* intensities, const std::size_t n) {
+    size_ = n;
+    words_.assign((n + bitsPerWord_ - 1) / bitsPerWord_, 0ull);
+    if(n < 3) {
+        return;
+    }
+    for(std::size_t w = 0; w < words_.size(); ++w) {
+        const std::size_t base = w * bitsPerWord_;
+        if(base >= 1 && base + bitsPerWord_ + 1 <= n) {
+            words_[w] = wordMaxima_(intensities, base);
+        }
+        else {
+            // the borders of the sequence
+            const std::size_t begin = (base < 1) ? 1 : base;
+            const std::size_t end = (base + bitsPerWord_ < n - 1) ? base + bitsPerWord_ : n - 1;
+            words_[w] = (begin < end) ? scalarMaxima_(intensities, base, begin, end) : 0ull;
+        }
+    }
+}
+
+std::size_t LocalMaximaMask::size() const {
+    return size_;
+}
+
+std::size_t LocalMaximaMask::count() const {
+    std::size_t n = 0;
+    for(std::size_t i = next(0); i < size_; i = next(i + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+bool LocalMaximaMask::test(const std::size_t i) const {
+    psf_precondition(i < size_, "LocalMaximaMask::test(): Index out of range.");
+    return (words_[i / bitsPerWord_] >> (i % bitsPerWord_)) & 1ull;
+}
+
+std::size_t LocalMaximaMask::next(const std::size_t i) const {
+    if(i >= size_) {
+        return size_;
+    }
+    std::size_t w = i / bitsPerWord_;
+    unsigned long long word = words_[w] & (~0ull << (i % bitsPerWord_));
+    while(word == 0) {
+        if(++w == words_.size()) {
+            return size_;
+        }
+        word = words_[w];
+    }
+    return w * bitsPerWord_ + lowestBit_(word);
+}
+
+} /* namespace psf */
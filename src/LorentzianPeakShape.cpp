@@ -6,7 +6,7 @@
 using namespace psf;
 
 double LorentzianPeakShape::at(const double xCoordinate) const {
-    return fwhm_ / ((xCoordinate * xCoordinate) + (fwhm_*fwhm_));
+    return fwhm_ / ((xCoordinate * xCoordinate) + fwhmSquared_);
 }
 
 double LorentzianPeakShape::getSupportThreshold() const {
@@ -15,7 +15,7 @@ double LorentzianPeakShape::getSupportThreshold() const {
 
 // construction
 LorentzianPeakShape::LorentzianPeakShape(const double fwhm, const double fwhmFactorForSupportThreshold) 
-    : fwhm_(fwhm), fwhmFactorForSupportThreshold_(fwhmFactorForSupportThreshold) {
+    : fwhm_(fwhm), fwhmFactorForSupportThreshold_(fwhmFactorForSupportThreshold), fwhmSquared_(fwhm * fwhm) {
     psf_precondition(fwhm > 0, "LorentzianPeakShape::LorentzianPeakShape(): Parameter fwhm has to be positive.");
     psf_precondition(fwhmFactorForSupportThreshold > 0, "LorentzianPeakShape::LorentzianPeakShape(): fwhmFactorForSupportThreshold has to be positive.");
 }
@@ -25,6 +25,7 @@ LorentzianPeakShape::LorentzianPeakShape(const double fwhm, const double fwhmFac
 void LorentzianPeakShape::setFwhm(const double fwhm) {
     psf_precondition(fwhm > 0, "LorentzianPeakShape::LorentzianPeakShape(): Parameter fwhm has to be positive.");
     fwhm_ = fwhm;
+    fwhmSquared_ = fwhm * fwhm;
 }
 double LorentzianPeakShape::getFwhm() const {
     return fwhm_;
@@ -0,0 +1,693 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef PSF_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <psf/Error.h>
+#include <psf/Numpress.h>
+#include <psf/Parallel.h>
+#include <psf/SaxParser.h>
+#include "psf/MzML.h"
+
+namespace psf
+{
+
+namespace {
+    enum ArrayKind_ { otherArray_, mzArray_, intensityArray_ };
+    enum Numpress_ { noNumpress_, linearNumpress_, picNumpress_, slofNumpress_ };
+
+    // A binary data array as found in the document.
+    struct EncodedArray_
+    {
+        void reset(const std::size_t arrayLength) {
+            kind = otherArray_;
+            bits = 64;
+            zlib = false;
+            numpress = noNumpress_;
+            unsupported.clear();
+            length = arrayLength;
+            text.clear();
+        }
+
+        ArrayKind_ kind;
+        int bits;
+        bool zlib;
+        Numpress_ numpress;
+        std::string unsupported; // name of an encoding we can't decode
+        std::size_t length;
+        std::string text;
+    };
+
+    // Values of the base64 alphabet; -2 for whitespace, -3 for padding, -1 otherwise.
+    struct Base64Table_
+    {
+        Base64Table_() {
+            std::fill(values, values + 256, static_cast<signed char>(-1));
+            const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for(int i = 0; i < 64; ++i) {
+                values[static_cast<unsigned char>(alphabet[i])] = static_cast<signed char>(i);
+            }
+            values[static_cast<unsigned char>(' ')] = values[static_cast<unsigned char>('\t')] = -2;
+            values[static_cast<unsigned char>('\n')] = values[static_cast<unsigned char>('\r')] = -2;
+            values[static_cast<unsigned char>('=')] = -3;
+        }
+
+        signed char values[256];
+    };
+
+    const Base64Table_ base64Table_;
+    const char base64Alphabet_[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    void decodeBase64_(const std::string& text, std::string& out) {
+        const unsigned char* s = reinterpret_cast<const unsigned char*>(text.data());
+        const std::size_t size = text.size();
+        out.resize(size / 4 * 3 + 3);
+        char* o = &out[0];
+        const signed char* table = base64Table_.values;
+
+        // whole quadruples without whitespace or padding
+        std::size_t i = 0;
+        for(; i + 4 <= size; i += 4) {
+            const int a = table[s[i]], b = table[s[i + 1]], c = table[s[i + 2]], d = table[s[i + 3]];
+            if((a | b | c | d) < 0) {
+                break;
+            }
+            const unsigned long v = (static_cast<unsigned long>(a) << 18) | (b << 12) | (c << 6) | d;
+            *o++ = static_cast<char>(v >> 16);
+            *o++ = static_cast<char>(v >> 8);
+            *o++ = static_cast<char>(v);
+        }
+
+        // the rest one by one
+        unsigned long accumulator = 0;
+        int bits = 0;
+        for(; i < size; ++i) {
+            const int v = table[s[i]];
+            if(v >= 0) {
+                accumulator = (accumulator << 6) | v;
+                bits += 6;
+                if(bits >= 8) {
+                    bits -= 8;
+                    *o++ = static_cast<char>(accumulator >> bits);
+                }
+            }
+            else if(v == -3) {
+                break;
+            }
+            else if(v == -1) {
+                psf_fail("MzMLReader: Invalid character in base64 data.");
+            }
+        }
+        out.resize(o - &out[0]);
+    }
+
+    void encodeBase64_(const std::string& bytes, std::string& out) {
+        const unsigned char* s = reinterpret_cast<const unsigned char*>(bytes.data());
+        const std::size_t size = bytes.size();
+        out.resize((size + 2) / 3 * 4);
+        char* o = &out[0];
+        std::size_t i = 0;
+        for(; i + 3 <= size; i += 3) {
+            const unsigned long v = (static_cast<unsigned long>(s[i]) << 16) | (s[i + 1] << 8) | s[i + 2];
+            *o++ = base64Alphabet_[(v >> 18) & 0x3F];
+            *o++ = base64Alphabet_[(v >> 12) & 0x3F];
+            *o++ = base64Alphabet_[(v >> 6) & 0x3F];
+            *o++ = base64Alphabet_[v & 0x3F];
+        }
+        if(i < size) {
+            const unsigned long v = (static_cast<unsigned long>(s[i]) << 16) | (i + 1 < size ? s[i + 1] << 8 : 0);
+            *o++ = base64Alphabet_[(v >> 18) & 0x3F];
+            *o++ = base64Alphabet_[(v >> 12) & 0x3F];
+            *o++ = i + 1 < size ? base64Alphabet_[(v >> 6) & 0x3F] : '=';
+            *o++ = '=';
+        }
+    }
+
+    bool littleEndian_() {
+        const unsigned short probe = 1;
+        return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+    }
+
+    // Inflates exactly expected bytes or, if not exact, at most expected bytes.
+    void inflate_(const std::string& compressed, const std::size_t expected, std::string& out, const bool exact = true) {
+#ifdef PSF_HAVE_ZLIB
+        // one byte more, so that too long data is detected
+        out.resize(expected + 1);
+        uLongf length = static_cast<uLongf>(out.size());
+        const int status = uncompress(reinterpret_cast<Bytef*>(&out[0]), &length, reinterpret_cast<const Bytef*>(compressed.data()), static_cast<uLong>(compressed.size()));
+        if(status != Z_OK || (exact ? length != expected : length > expected)) {
+            psf_fail("MzMLReader: Corrupt zlib compressed array.");
+        }
+        out.resize(length);
+#else
+        PSF_UNUSED(compressed); PSF_UNUSED(expected); PSF_UNUSED(out); PSF_UNUSED(exact);
+        psf_fail("MzMLReader: zlib compressed arrays need a build with zlib.");
+#endif
+    }
+
+    // Little endian floating point numbers to doubles.
+    void toDoubles_(const std::string& bytes, const int bits, std::vector<double>& out) {
+        const std::size_t width = bits / 8;
+        const std::size_t n = bytes.size() / width;
+        out.resize(n);
+        const bool little = littleEndian_();
+        if(bits == 64 && little) {
+            if(n) {
+                std::memcpy(&out[0], bytes.data(), n * 8);
+            }
+            return;
+        }
+        for(std::size_t i = 0; i < n; ++i) {
+            unsigned char b[8];
+            std::memcpy(b, bytes.data() + i * width, width);
+            if(!little) {
+                std::reverse(b, b + width);
+            }
+            if(bits == 64) {
+                std::memcpy(&out[i], b, 8);
+            }
+            else {
+                float f;
+                std::memcpy(&f, b, 4);
+                out[i] = f;
+            }
+        }
+    }
+
+    // Per-scan scratch space, kept with the scan to be reused by the next one.
+    struct DecodeBuffers_
+    {
+        std::string bytes;
+        std::string inflated;
+        std::vector<double> mz;
+        std::vector<double> intensity;
+    };
+
+    void decodeArray_(const EncodedArray_& array, const std::string& id, DecodeBuffers_& buffers, std::vector<double>& out) {
+        if(!array.unsupported.empty()) {
+            psf_fail("MzMLReader: Unsupported encoding '" + array.unsupported + "' in spectrum '" + id + "'.");
+        }
+        decodeBase64_(array.text, buffers.bytes);
+        if(array.numpress != noNumpress_) {
+            const std::string* raw = &buffers.bytes;
+            if(array.zlib) {
+                // no encoding takes more than 16 bytes plus 5 per value
+                inflate_(buffers.bytes, 16 + 5 * array.length, buffers.inflated, false);
+                raw = &buffers.inflated;
+            }
+            switch(array.numpress) {
+                case linearNumpress_: decodeNumpressLinear(*raw, out); break;
+                case picNumpress_: decodeNumpressPic(*raw, out); break;
+                default: decodeNumpressSlof(*raw, out); break;
+            }
+            if(out.size() != array.length) {
+                psf_fail("MzMLReader: Array of unexpected length in spectrum '" + id + "'.");
+            }
+            return;
+        }
+        const std::size_t expected = array.length * (array.bits / 8);
+        const std::string* raw = &buffers.bytes;
+        if(array.zlib) {
+            inflate_(buffers.bytes, expected, buffers.inflated);
+            raw = &buffers.inflated;
+        }
+        if(raw->size() != expected) {
+            psf_fail("MzMLReader: Array of unexpected length in spectrum '" + id + "'.");
+        }
+        toDoubles_(*raw, array.bits, out);
+    }
+
+    // The number after 'scan=' in a native id, or -1.
+    int scanNumberFromId_(const std::string& id) {
+        std::size_t position = 0;
+        while((position = id.find("scan=", position)) != std::string::npos) {
+            if(position == 0 || id[position - 1] == ' ') {
+                return std::atoi(id.c_str() + position + 5);
+            }
+            position += 5;
+        }
+        return -1;
+    }
+
+    void appendNumber_(std::string& s, const double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+        s += buffer;
+    }
+} /* anonymous namespace */
+
+// A scan on its way through the reader.
+struct MzMLReader::Pending_
+{
+    Pending_() : defaultLength(0), nArrays(0), decoded(false) {}
+
+    void decode() {
+        try {
+            const EncodedArray_* mz = 0;
+            const EncodedArray_* intensity = 0;
+            for(std::size_t i = 0; i < nArrays; ++i) {
+                if(arrays[i].kind == mzArray_) {
+                    mz = &arrays[i];
+                }
+                else if(arrays[i].kind == intensityArray_) {
+                    intensity = &arrays[i];
+                }
+            }
+            if(!mz || !intensity) {
+                psf_fail("MzMLReader: Spectrum '" + scan.id + "' lacks an m/z or an intensity array.");
+            }
+            decodeArray_(*mz, scan.id, buffers, buffers.mz);
+            decodeArray_(*intensity, scan.id, buffers, buffers.intensity);
+            if(buffers.mz.size() != buffers.intensity.size()) {
+                psf_fail("MzMLReader: Arrays of different lengths in spectrum '" + scan.id + "'.");
+            }
+            scan.spectrum.clear();
+            scan.spectrum.reserve(buffers.mz.size());
+            for(std::size_t i = 0; i < buffers.mz.size(); ++i) {
+                scan.spectrum.push_back(SpectrumElement(buffers.mz[i], buffers.intensity[i]));
+            }
+        } catch(...) {
+            error = std::current_exception();
+        }
+    }
+
+    MzMLScan scan;
+    std::size_t defaultLength;
+    std::vector<EncodedArray_> arrays;
+    std::size_t nArrays;
+    DecodeBuffers_ buffers;
+    bool decoded;
+    std::exception_ptr error;
+};
+
+// Collects the metadata and the encoded arrays of one spectrum.
+class MzMLReader::Handler_ : public SaxHandler
+{
+public:
+    explicit Handler_(const SaxParser& parser) : parser_(parser), pending_(0), array_(0), inSpectrum_(false), inBinary_(false), done_(false), endOfSpectra_(false) {}
+
+    void begin(Pending_& pending) {
+        pending_ = &pending;
+        done_ = false;
+    }
+
+    bool done() const { return done_; }
+    bool endOfSpectra() const { return endOfSpectra_; }
+    bool inSpectrum() const { return inSpectrum_; }
+
+    virtual void startElement(const std::string& name, const SaxAttributes& attributes) {
+        if(!inSpectrum_) {
+            if(name == "spectrum") {
+                inSpectrum_ = true;
+                MzMLScan& scan = pending_->scan;
+                scan.offset = parser_.offset();
+                const std::string* id = attributes.find("id");
+                scan.id = id ? *id : std::string();
+                scan.scanNumber = scanNumberFromId_(scan.id);
+                scan.msLevel = 0;
+                scan.retentionTime = 0.;
+                const std::string* length = attributes.find("defaultArrayLength");
+                pending_->defaultLength = length ? std::strtoul(length->c_str(), 0, 10) : 0;
+                pending_->nArrays = 0;
+            }
+            return;
+        }
+        if(name == "binaryDataArray") {
+            if(pending_->nArrays == pending_->arrays.size()) {
+                pending_->arrays.push_back(EncodedArray_());
+            }
+            array_ = &pending_->arrays[pending_->nArrays++];
+            const std::string* length = attributes.find("arrayLength");
+            array_->reset(length ? std::strtoul(length->c_str(), 0, 10) : pending_->defaultLength);
+        }
+        else if(name == "binary") {
+            inBinary_ = array_ != 0;
+        }
+        else if(name == "cvParam") {
+            cvParam_(attributes);
+        }
+    }
+
+    virtual void endElement(const std::string& name) {
+        if(!inSpectrum_) {
+            if(name == "spectrumList") {
+                endOfSpectra_ = true;
+            }
+            return;
+        }
+        if(name == "binary") {
+            inBinary_ = false;
+        }
+        else if(name == "binaryDataArray") {
+            array_ = 0;
+        }
+        else if(name == "spectrum") {
+            inSpectrum_ = false;
+            done_ = true;
+        }
+    }
+
+    virtual void characters(const char* text, const std::size_t length) {
+        if(inBinary_) {
+            array_->text.append(text, length);
+        }
+    }
+
+private:
+    void cvParam_(const SaxAttributes& attributes) {
+        const std::string* accession = attributes.find("accession");
+        if(!accession) {
+            return;
+        }
+        const std::string& a = *accession;
+        if(array_) {
+            if(a == "MS:1000523") array_->bits = 64;
+            else if(a == "MS:1000521") array_->bits = 32;
+            else if(a == "MS:1000574") array_->zlib = true;
+            else if(a == "MS:1000514") array_->kind = mzArray_;
+            else if(a == "MS:1000515") array_->kind = intensityArray_;
+            else if(a == "MS:1000576") {}
+            else if(a == "MS:1002312") array_->numpress = linearNumpress_;
+            else if(a == "MS:1002313") array_->numpress = picNumpress_;
+            else if(a == "MS:1002314") array_->numpress = slofNumpress_;
+            else if(a == "MS:1002746") { array_->numpress = linearNumpress_; array_->zlib = true; }
+            else if(a == "MS:1002747") { array_->numpress = picNumpress_; array_->zlib = true; }
+            else if(a == "MS:1002748") { array_->numpress = slofNumpress_; array_->zlib = true; }
+            else {
+                // other compressions and integer types
+                const std::string* name = attributes.find("name");
+                if(name && (name->find("ompression") != std::string::npos || name->find("umpress") != std::string::npos || name->find("integer") != std::string::npos)) {
+                    array_->unsupported = *name;
+                }
+            }
+            return;
+        }
+        if(a == "MS:1000511") {
+            const std::string* value = attributes.find("value");
+            pending_->scan.msLevel = value ? std::atoi(value->c_str()) : 0;
+        }
+        else if(a == "MS:1000016") {
+            const std::string* value = attributes.find("value");
+            const std::string* unit = attributes.find("unitAccession");
+            const double time = value ? std::strtod(value->c_str(), 0) : 0.;
+            pending_->scan.retentionTime = (unit && *unit == "UO:0000031") ? 60. * time : time;
+        }
+    }
+
+    const SaxParser& parser_;
+    Pending_* pending_;
+    EncodedArray_* array_;
+    bool inSpectrum_;
+    bool inBinary_;
+    bool done_;
+    bool endOfSpectra_;
+};
+
+MzMLReader::MzMLReader(const std::string& filename, const unsigned nThreads, const std::size_t maxPendingScans) : file_(filename.c_str(), std::ios::in | std::ios::binary) {
+    if(!file_) {
+        psf_fail("MzMLReader: Couldn't open '" + filename + "'.");
+    }
+    parser_.reset(new SaxParser(file_, 1 << 20));
+    start_(nThreads, maxPendingScans);
+}
+
+MzMLReader::MzMLReader(std::istream& is, const unsigned nThreads, const std::size_t maxPendingScans) : parser_(new SaxParser(is, 1 << 20)) {
+    start_(nThreads, maxPendingScans);
+}
+
+MzMLReader::~MzMLReader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    queued_.notify_all();
+    for(std::size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i].join();
+    }
+}
+
+bool MzMLReader::next(MzMLScan& scan) {
+    // parse ahead, while the workers decode
+    while(pending_.size() < window_ && !exhausted_) {
+        std::shared_ptr<Pending_> pending;
+        if(recycled_.empty()) {
+            pending = std::make_shared<Pending_>();
+        }
+        else {
+            pending = recycled_.back();
+            recycled_.pop_back();
+        }
+        if(!parse_(*parser_, *handler_, *pending)) {
+            exhausted_ = true;
+            recycled_.push_back(pending);
+            break;
+        }
+        pending->scan.index = parsed_++;
+        pending->decoded = false;
+        pending->error = std::exception_ptr();
+        pending_.push_back(pending);
+        if(!workers_.empty()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.push_back(pending);
+            }
+            queued_.notify_one();
+        }
+    }
+    if(pending_.empty()) {
+        return false;
+    }
+
+    std::shared_ptr<Pending_> front = pending_.front();
+    pending_.pop_front();
+    if(workers_.empty()) {
+        front->decode();
+    }
+    else {
+        std::unique_lock<std::mutex> lock(mutex_);
+        decoded_.wait(lock, [&front]() { return front->decoded; });
+    }
+    recycled_.push_back(front);
+    if(front->error) {
+        std::rethrow_exception(front->error);
+    }
+
+    take_(*front, scan);
+    ++returned_;
+    return true;
+}
+
+bool MzMLReader::readSpectrum(std::istream& is, MzMLScan& scan) {
+    SaxParser parser(is);
+    Handler_ handler(parser);
+    Pending_ pending;
+    if(!parse_(parser, handler, pending)) {
+        return false;
+    }
+    pending.decode();
+    if(pending.error) {
+        std::rethrow_exception(pending.error);
+    }
+    take_(pending, scan);
+    return true;
+}
+
+void MzMLReader::start_(unsigned nThreads, const std::size_t maxPendingScans) {
+    handler_.reset(new Handler_(*parser_));
+    exhausted_ = false;
+    parsed_ = 0;
+    returned_ = 0;
+    stopping_ = false;
+    if(nThreads == 0) {
+        nThreads = hardwareConcurrency();
+    }
+    const unsigned nWorkers = nThreads - 1;
+    window_ = maxPendingScans ? maxPendingScans : (nWorkers ? 4 * nWorkers : 1);
+    workers_.reserve(nWorkers);
+    for(unsigned i = 0; i < nWorkers; ++i) {
+        workers_.push_back(std::thread(&MzMLReader::work_, this));
+    }
+}
+
+bool MzMLReader::parse_(SaxParser& parser, Handler_& handler, Pending_& pending) {
+    handler.begin(pending);
+    while(!handler.done() && !handler.endOfSpectra()) {
+        if(!parser.parseNext(handler)) {
+            if(handler.inSpectrum()) {
+                psf_fail("MzMLReader: Document ends within a spectrum.");
+            }
+            break;
+        }
+    }
+    if(!handler.done()) {
+        return false;
+    }
+    pending.scan.length = parser.position() - pending.scan.offset;
+    return true;
+}
+
+void MzMLReader::take_(Pending_& pending, MzMLScan& scan) {
+    scan.index = pending.scan.index;
+    scan.offset = pending.scan.offset;
+    scan.length = pending.scan.length;
+    scan.id.swap(pending.scan.id);
+    scan.scanNumber = pending.scan.scanNumber < 0 ? static_cast<int>(pending.scan.index) + 1 : pending.scan.scanNumber;
+    scan.msLevel = pending.scan.msLevel;
+    scan.retentionTime = pending.scan.retentionTime;
+    scan.spectrum.swap(pending.scan.spectrum);
+}
+
+void MzMLReader::work_() {
+    while(true) {
+        std::shared_ptr<Pending_> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queued_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if(stopping_) {
+                return;
+            }
+            task = tasks_.front();
+            tasks_.pop_front();
+        }
+        task->decode();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task->decoded = true;
+        }
+        decoded_.notify_all();
+    }
+}
+
+MzMLWriter::MzMLWriter(std::ostream& os, const std::size_t numberOfSpectra, const bool compress, const bool numpress) : os_(os), numberOfSpectra_(numberOfSpectra), written_(0), compress_(compress), numpress_(numpress), closed_(false) {
+#ifndef PSF_HAVE_ZLIB
+    if(compress_) {
+        psf_fail("MzMLWriter: Compression needs a build with zlib.");
+    }
+#endif
+    os_ << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        << "<mzML xmlns=\"http://psi.hupo.org/ms/mzml\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xsi:schemaLocation=\"http://psi.hupo.org/ms/mzml http://psidev.info/files/ms/mzML/xsd/mzML1.1.0.xsd\" version=\"1.1.0\">\n"
+        << "  <cvList count=\"2\">\n"
+        << "    <cv id=\"MS\" fullName=\"Proteomics Standards Initiative Mass Spectrometry Ontology\" URI=\"https://raw.githubusercontent.com/HUPO-PSI/psi-ms-CV/master/psi-ms.obo\"/>\n"
+        << "    <cv id=\"UO\" fullName=\"Unit Ontology\" URI=\"http://ontologies.berkeleybop.org/uo.obo\"/>\n"
+        << "  </cvList>\n"
+        << "  <fileDescription>\n"
+        << "    <fileContent>\n"
+        << "      <cvParam cvRef=\"MS\" accession=\"MS:1000579\" name=\"MS1 spectrum\" value=\"\"/>\n"
+        << "    </fileContent>\n"
+        << "  </fileDescription>\n"
+        << "  <softwareList count=\"1\">\n"
+        << "    <software id=\"psf\" version=\"0\">\n"
+        << "      <cvParam cvRef=\"MS\" accession=\"MS:1000799\" name=\"custom unreleased software tool\" value=\"libpsf\"/>\n"
+        << "    </software>\n"
+        << "  </softwareList>\n"
+        << "  <instrumentConfigurationList count=\"1\">\n"
+        << "    <instrumentConfiguration id=\"IC1\"/>\n"
+        << "  </instrumentConfigurationList>\n"
+        << "  <dataProcessingList count=\"1\">\n"
+        << "    <dataProcessing id=\"psf_conversion\">\n"
+        << "      <processingMethod order=\"0\" softwareRef=\"psf\">\n"
+        << "        <cvParam cvRef=\"MS\" accession=\"MS:1000544\" name=\"Conversion to mzML\" value=\"\"/>\n"
+        << "      </processingMethod>\n"
+        << "    </dataProcessing>\n"
+        << "  </dataProcessingList>\n"
+        << "  <run id=\"run\" defaultInstrumentConfigurationRef=\"IC1\">\n"
+        << "    <spectrumList count=\"" << numberOfSpectra_ << "\" defaultDataProcessingRef=\"psf_conversion\">\n";
+}
+
+void MzMLWriter::write(const Spectrum& spectrum, const double retentionTime, const int msLevel) {
+    psf_precondition(!closed_ && written_ < numberOfSpectra_, "MzMLWriter::write(): More spectra than announced.");
+    std::string time;
+    appendNumber_(time, retentionTime);
+    os_ << "      <spectrum index=\"" << written_ << "\" id=\"scan=" << written_ + 1 << "\" defaultArrayLength=\"" << spectrum.size() << "\">\n"
+        << "        <cvParam cvRef=\"MS\" accession=\"MS:1000511\" name=\"ms level\" value=\"" << msLevel << "\"/>\n"
+        << "        <cvParam cvRef=\"MS\" accession=\"MS:1000128\" name=\"profile spectrum\" value=\"\"/>\n"
+        << "        <scanList count=\"1\">\n"
+        << "          <cvParam cvRef=\"MS\" accession=\"MS:1000795\" name=\"no combination\" value=\"\"/>\n"
+        << "          <scan>\n"
+        << "            <cvParam cvRef=\"MS\" accession=\"MS:1000016\" name=\"scan start time\" value=\"" << time << "\" unitCvRef=\"UO\" unitAccession=\"UO:0000010\" unitName=\"second\"/>\n"
+        << "          </scan>\n"
+        << "        </scanList>\n"
+        << "        <binaryDataArrayList count=\"2\">\n";
+    values_.resize(spectrum.size());
+    for(std::size_t i = 0; i < spectrum.size(); ++i) {
+        values_[i] = spectrum[i].mz;
+    }
+    writeArray_(values_, true);
+    for(std::size_t i = 0; i < spectrum.size(); ++i) {
+        values_[i] = spectrum[i].intensity;
+    }
+    writeArray_(values_, false);
+    os_ << "        </binaryDataArrayList>\n"
+        << "      </spectrum>\n";
+    ++written_;
+}
+
+void MzMLWriter::close() {
+    psf_precondition(written_ == numberOfSpectra_, "MzMLWriter::close(): Fewer spectra than announced.");
+    if(!closed_) {
+        os_ << "    </spectrumList>\n"
+            << "  </run>\n"
+            << "</mzML>\n";
+        closed_ = true;
+    }
+}
+
+void MzMLWriter::writeArray_(const std::vector<double>& values, const bool mz) {
+    const char* compression = compress_ ? "MS:1000574\" name=\"zlib compression" : "MS:1000576\" name=\"no compression";
+    if(numpress_) {
+        const double* data = values.empty() ? 0 : &values[0];
+        if(mz) {
+            encodeNumpressLinear(data, values.size(), optimalNumpressLinearFixedPoint(data, values.size()), bytes_);
+            compression = compress_ ? "MS:1002746\" name=\"MS-Numpress linear prediction compression followed by zlib compression" : "MS:1002312\" name=\"MS-Numpress linear prediction compression";
+        }
+        else {
+            encodeNumpressSlof(data, values.size(), optimalNumpressSlofFixedPoint(data, values.size()), bytes_);
+            compression = compress_ ? "MS:1002748\" name=\"MS-Numpress short logged float compression followed by zlib compression" : "MS:1002314\" name=\"MS-Numpress short logged float compression";
+        }
+    }
+    else {
+        bytes_.resize(values.size() * 8);
+        for(std::size_t i = 0; i < values.size(); ++i) {
+            unsigned char b[8];
+            std::memcpy(b, &values[i], 8);
+            if(!littleEndian_()) {
+                std::reverse(b, b + 8);
+            }
+            std::memcpy(&bytes_[i * 8], b, 8);
+        }
+    }
+    const std::string* raw = &bytes_;
+    std::string compressed;
+#ifdef PSF_HAVE_ZLIB
+    if(compress_) {
+        uLongf length = compressBound(static_cast<uLong>(bytes_.size()));
+        compressed.resize(length);
+        if(compress2(reinterpret_cast<Bytef*>(&compressed[0]), &length, reinterpret_cast<const Bytef*>(bytes_.data()), static_cast<uLong>(bytes_.size()), Z_DEFAULT_COMPRESSION) != Z_OK) {
+            psf_fail("MzMLWriter: zlib compression failed.");
+        }
+        compressed.resize(length);
+        raw = &compressed;
+    }
+#endif
+    encodeBase64_(*raw, encoded_);
+    os_ << "          <binaryDataArray encodedLength=\"" << encoded_.size() << "\">\n"
+        << "            <cvParam cvRef=\"MS\" accession=\"MS:1000523\" name=\"64-bit float\" value=\"\"/>\n"
+        << "            <cvParam cvRef=\"MS\" accession=\"" << compression << "\" value=\"\"/>\n"
+        << "            <cvParam cvRef=\"MS\" accession=\"" << (mz ? "MS:1000514\" name=\"m/z array" : "MS:1000515\" name=\"intensity array") << "\" value=\"\"/>\n"
+        << "            <binary>" << encoded_ << "</binary>\n"
+        << "          </binaryDataArray>\n";
+}
+
+} /* namespace psf */
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <psf/Error.h>
+#include "psf/NoiseThreshold.h"
+
+namespace psf
+{
+
+namespace {
+    // Scales the MAD to the standard deviation of normally distributed noise.
+    const double madToSigma_ = 1.4826;
+
+    // Median of a nonempty buffer; reorders the buffer.
+    double median_(std::vector<double>& values) {
+        const std::size_t half = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + half, values.end());
+        const double upper = values[half];
+        if(values.size() % 2 == 1) {
+            return upper;
+        }
+        const double lower = *std::max_element(values.begin(), values.begin() + half);
+        return 0.5 * (lower + upper);
+    }
+} /* anonymous namespace */
+
+NoiseThreshold::NoiseThreshold() : minimum_(0.) {
+}
+
+void NoiseThreshold::addWindow_(const double mz, std::vector<double>& intensities, const double factor) {
+    const double median = median_(intensities);
+    for(std::vector<double>::iterator value = intensities.begin(); value != intensities.end(); ++value) {
+        *value = std::abs(*value - median);
+    }
+    const double mad = median_(intensities);
+    mzs_.push_back(mz);
+    thresholds_.push_back(median + factor * madToSigma_ * mad);
+}
+
+double NoiseThreshold::at(const double mz) const {
+    if(mzs_.empty()) {
+        return minimum_;
+    }
+    const std::vector<double>::const_iterator upper = std::lower_bound(mzs_.begin(), mzs_.end(), mz);
+    double threshold;
+    if(upper == mzs_.begin()) {
+        threshold = thresholds_.front();
+    }
+    else if(upper == mzs_.end()) {
+        threshold = thresholds_.back();
+    }
+    else {
+        const std::size_t i = upper - mzs_.begin();
+        const double t = (mz - mzs_[i - 1]) / (mzs_[i] - mzs_[i - 1]);
+        threshold = thresholds_[i - 1] + t * (thresholds_[i] - thresholds_[i - 1]);
+    }
+    return std::max(threshold, minimum_);
+}
+
+void NoiseThreshold::setMinimum(const double minimum) {
+    minimum_ = minimum;
+}
+
+double NoiseThreshold::getMinimum() const {
+    return minimum_;
+}
+
+std::size_t NoiseThreshold::numberOfWindows() const {
+    return mzs_.size();
+}
+
+} /* namespace psf */
@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <psf/Error.h>
+#include "psf/Numpress.h"
+
+namespace psf
+{
+
+namespace {
+    // The fixed point is stored as a big endian double in the first 8 bytes.
+    void appendFixedPoint_(const double fixedPoint, std::string& bytes) {
+        unsigned long long bits;
+        std::memcpy(&bits, &fixedPoint, 8);
+        for(int i = 7; i >= 0; --i) {
+            bytes.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+        }
+    }
+
+    double fixedPoint_(const std::string& bytes) {
+        unsigned long long bits = 0;
+        for(int i = 0; i < 8; ++i) {
+            bits = (bits << 8) | static_cast<unsigned char>(bytes[i]);
+        }
+        double fixedPoint;
+        std::memcpy(&fixedPoint, &bits, 8);
+        return fixedPoint;
+    }
+
+    // Packs half bytes into bytes, high half first; an odd one waits for the next call.
+    class HalfBytes_
+    {
+    public:
+        explicit HalfBytes_(std::string& bytes) : bytes_(bytes), pending_(-1) {}
+
+        void put(const unsigned value) {
+            if(pending_ < 0) {
+                pending_ = static_cast<int>(value & 0xF);
+            }
+            else {
+                bytes_.push_back(static_cast<char>((pending_ << 4) | (value & 0xF)));
+                pending_ = -1;
+            }
+        }
+
+        // A 32 bit integer: the number of leading zero (0..8) or leading one (9..15, minus
+        // 8) half bytes, followed by the remaining half bytes, least significant first.
+        void putInt(const unsigned x) {
+            const unsigned mask = 0xF0000000u;
+            const unsigned top = x & mask;
+            if(top == 0) {
+                unsigned l = 8;
+                for(unsigned i = 0; i < 8; ++i) {
+                    if((x & (mask >> (4 * i))) != 0) {
+                        l = i;
+                        break;
+                    }
+                }
+                putRest_(l, x, l);
+            }
+            else if(top == mask) {
+                unsigned l = 7;
+                for(unsigned i = 0; i < 8; ++i) {
+                    if((x & (mask >> (4 * i))) != (mask >> (4 * i))) {
+                        l = i;
+                        break;
+                    }
+                }
+                putRest_(l + 8, x, l);
+            }
+            else {
+                putRest_(0, x, 0);
+            }
+        }
+
+        void flush() {
+            if(pending_ >= 0) {
+                bytes_.push_back(static_cast<char>(pending_ << 4));
+                pending_ = -1;
+            }
+        }
+
+    private:
+        void putRest_(const unsigned head, const unsigned x, const unsigned l) {
+            put(head);
+            for(unsigned i = l; i < 8; ++i) {
+                put(x >> (4 * (i - l)));
+            }
+        }
+
+        std::string& bytes_;
+        int pending_;
+    };
+
+    // Unpacks the integers written by HalfBytes_::putInt() from bytes[first, ...).
+    class IntReader_
+    {
+    public:
+        IntReader_(const std::string& bytes, const std::size_t first)
+            : data_(reinterpret_cast<const unsigned char*>(bytes.data())), k_(2 * first), end_(2 * bytes.size()) {}
+
+        // false at the end, including a padding half byte
+        bool more() const {
+            return k_ < end_ && !(k_ + 1 == end_ && half_(k_) == 0);
+        }
+
+        unsigned next() {
+            const unsigned head = half_(k_++);
+            unsigned x = 0;
+            unsigned n = head;
+            if(head > 8) {
+                n = head - 8;
+                for(unsigned i = 0; i < n; ++i) {
+                    x |= 0xF0000000u >> (4 * i);
+                }
+            }
+            if(k_ + (8 - n) > end_) {
+                psf_fail("Numpress: Corrupt data.");
+            }
+            for(unsigned i = 0; i < 8 - n; ++i) {
+                x |= half_(k_++) << (4 * i);
+            }
+            return x;
+        }
+
+    private:
+        unsigned half_(const std::size_t k) const {
+            return (k & 1) ? (data_[k >> 1] & 0xF) : (data_[k >> 1] >> 4);
+        }
+
+        const unsigned char* data_;
+        std::size_t k_;
+        std::size_t end_;
+    };
+
+    void appendInt32_(const long long value, std::string& bytes) {
+        for(int i = 0; i < 4; ++i) {
+            bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    long long int32_(const std::string& bytes, const std::size_t first) {
+        unsigned long value = 0;
+        for(int i = 3; i >= 0; --i) {
+            value = (value << 8) | static_cast<unsigned char>(bytes[first + i]);
+        }
+        return static_cast<long long>(value);
+    }
+
+    void checkInt32_(const long long value) {
+        if(value < 0 || value > 0xFFFFFFFFll) {
+            psf_fail("Numpress: Value out of range for linear prediction.");
+        }
+    }
+
+    long long toFixedPoint_(const double value, const double fixedPoint) {
+        const double x = value * fixedPoint + 0.5;
+        if(!(x < static_cast<double>(LLONG_MAX))) {
+            psf_fail("Numpress: Value too large for the fixed point.");
+        }
+        return static_cast<long long>(x);
+    }
+} /* anonymous namespace */
+
+double optimalNumpressLinearFixedPoint(const double* data, const std::size_t n) {
+    if(n == 0) {
+        return 0.;
+    }
+    if(n == 1) {
+        return std::floor(0xFFFFFFFF / data[0]);
+    }
+    double maxDouble = std::max(data[0], data[1]);
+    for(std::size_t i = 2; i < n; ++i) {
+        const double extrapolated = data[i - 1] + (data[i - 1] - data[i - 2]);
+        maxDouble = std::max(maxDouble, std::ceil(std::abs(data[i] - extrapolated) + 1));
+    }
+    return std::floor(0x7FFFFFFF / maxDouble);
+}
+
+void encodeNumpressLinear(const double* data, const std::size_t n, const double fixedPoint, std::string& bytes) {
+    bytes.clear();
+    bytes.reserve(16 + n * 5 / 2);
+    appendFixedPoint_(fixedPoint, bytes);
+    if(n == 0) {
+        return;
+    }
+    long long ints[3];
+    ints[1] = toFixedPoint_(data[0], fixedPoint);
+    checkInt32_(ints[1]);
+    appendInt32_(ints[1], bytes);
+    if(n == 1) {
+        return;
+    }
+    ints[2] = toFixedPoint_(data[1], fixedPoint);
+    checkInt32_(ints[2]);
+    appendInt32_(ints[2], bytes);
+
+    HalfBytes_ halfBytes(bytes);
+    for(std::size_t i = 2; i < n; ++i) {
+        ints[0] = ints[1];
+        ints[1] = ints[2];
+        ints[2] = toFixedPoint_(data[i], fixedPoint);
+        const long long residual = ints[2] - (ints[1] + (ints[1] - ints[0]));
+        if(residual > INT_MAX || residual < INT_MIN) {
+            psf_fail("Numpress: Linear prediction residual too large for the fixed point.");
+        }
+        halfBytes.putInt(static_cast<unsigned>(static_cast<int>(residual)));
+    }
+    halfBytes.flush();
+}
+
+void decodeNumpressLinear(const std::string& bytes, std::vector<double>& out) {
+    out.clear();
+    if(bytes.size() == 8) {
+        return;
+    }
+    if(bytes.size() < 12 || bytes.size() == 13 || bytes.size() == 14 || bytes.size() == 15) {
+        psf_fail("Numpress: Corrupt linear prediction data.");
+    }
+    const double fixedPoint = fixedPoint_(bytes);
+    out.reserve(bytes.size() > 16 ? (bytes.size() - 16) * 2 + 2 : 2);
+
+    // the integers; exact in doubles below 2^53
+    long long previous = int32_(bytes, 8);
+    out.push_back(static_cast<double>(previous));
+    if(bytes.size() > 12) {
+        long long current = int32_(bytes, 12);
+        out.push_back(static_cast<double>(current));
+        IntReader_ reader(bytes, 16);
+        while(reader.more()) {
+            const long long next = 2 * current - previous + static_cast<int>(reader.next());
+            previous = current;
+            current = next;
+            out.push_back(static_cast<double>(current));
+        }
+    }
+
+    double* values = &out[0];
+    const std::size_t n = out.size();
+    for(std::size_t i = 0; i < n; ++i) {
+        values[i] /= fixedPoint;
+    }
+}
+
+double optimalNumpressSlofFixedPoint(const double* data, const std::size_t n) {
+    if(n == 0) {
+        return 0.;
+    }
+    double maxDouble = 1.;
+    for(std::size_t i = 0; i < n; ++i) {
+        maxDouble = std::max(maxDouble, std::log(data[i] + 1));
+    }
+    return std::floor(0xFFFF / maxDouble);
+}
+
+void encodeNumpressSlof(const double* data, const std::size_t n, const double fixedPoint, std::string& bytes) {
+    bytes.clear();
+    bytes.reserve(8 + 2 * n);
+    appendFixedPoint_(fixedPoint, bytes);
+    for(std::size_t i = 0; i < n; ++i) {
+        const double x = std::log(data[i] + 1) * fixedPoint + 0.5;
+        if(!(x >= 0. && x < 65536.)) {
+            psf_fail("Numpress: Value out of range for short logged float.");
+        }
+        const unsigned short value = static_cast<unsigned short>(x);
+        bytes.push_back(static_cast<char>(value & 0xFF));
+        bytes.push_back(static_cast<char>(value >> 8));
+    }
+}
+
+void decodeNumpressSlof(const std::string& bytes, std::vector<double>& out) {
+    if(bytes.size() < 8 || bytes.size() % 2 != 0) {
+        psf_fail("Numpress: Corrupt short logged float data.");
+    }
+    const double fixedPoint = fixedPoint_(bytes);
+    const std::size_t n = (bytes.size() - 8) / 2;
+    out.resize(n);
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(bytes.data()) + 8;
+    double* values = n ? &out[0] : 0;
+    for(std::size_t i = 0; i < n; ++i) {
+        values[i] = static_cast<double>(data[2 * i] | (data[2 * i + 1] << 8));
+    }
+    for(std::size_t i = 0; i < n; ++i) {
+        values[i] = std::exp(values[i] / fixedPoint) - 1;
+    }
+}
+
+void encodeNumpressPic(const double* data, const std::size_t n, std::string& bytes) {
+    bytes.clear();
+    bytes.reserve(n * 5 / 2);
+    HalfBytes_ halfBytes(bytes);
+    for(std::size_t i = 0; i < n; ++i) {
+        if(!(data[i] >= -0.5 && data[i] + 0.5 < 4294967296.)) {
+            psf_fail("Numpress: Value out of range for positive integers.");
+        }
+        halfBytes.putInt(static_cast<unsigned>(data[i] + 0.5));
+    }
+    halfBytes.flush();
+}
+
+void decodeNumpressPic(const std::string& bytes, std::vector<double>& out) {
+    out.clear();
+    out.reserve(bytes.size() * 2);
+    IntReader_ reader(bytes, 0);
+    while(reader.more()) {
+        out.push_back(static_cast<double>(reader.next()));
+    }
+}
+
+} /* namespace psf */
@@ -31,9 +31,30 @@ double QuadraticModel::at(const double x) const {
     return a_ * x*x + b_;
 }
 
+double QuadraticModel::warpAt(const double x) const {
+    if(a_ == 0.) {
+        return x / b_;
+    }
+    if(b_ == 0.) {
+        return -1. / (a_ * x);
+    }
+    if(a_ * b_ > 0) {
+        return std::atan(x * std::sqrt(a_ / b_)) / (a_ * std::sqrt(b_ / a_));
+    }
+    // a and b with opposite signs: a*x^2 + b = a*(x - k)*(x + k)
+    const double k = std::sqrt(-b_ / a_);
+    return std::log(std::abs((x - k) / (x + k))) / (2. * a_ * k);
+}
+
 GeneralizedSlope QuadraticModel::slopeInParameterSpaceFor(double x) const {
-    double slope[] = {x * x, 1., 0.};
-    return GeneralizedSlope(slope, slope + 3);
+    GeneralizedSlope slope;
+    slopeInParameterSpaceFor(x, slope);
+    return slope;
+}
+
+void QuadraticModel::slopeInParameterSpaceFor(double x, GeneralizedSlope& slope) const {
+    const double s[] = {x * x, 1., 0.};
+    slope.assign(s, s + 3);
 }
 
 // setter / getter
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <psf/Error.h>
+#include "psf/Regression.h"
+
+namespace psf
+{
+
+double huberWeight(const double residual, const double k) {
+    const double r = std::abs(residual);
+    return (r <= k) ? 1. : k / r;
+}
+
+double tukeyWeight(const double residual, const double c) {
+    const double r = residual / c;
+    if(std::abs(r) >= 1.) {
+        return 0.;
+    }
+    return (1. - r * r) * (1. - r * r);
+}
+
+NormalEquations::NormalEquations(const unsigned nParameters)
+    : nParameters_(nParameters), count_(0), gram_(nParameters * nParameters, 0.), moment_(nParameters, 0.), valueSquares_(0.), sumOfWeights_(0.) {
+    psf_precondition(nParameters > 0, "NormalEquations::NormalEquations(): Number of parameters has to be positive.");
+}
+
+unsigned NormalEquations::numberOfParameters() const {
+    return nParameters_;
+}
+
+std::size_t NormalEquations::count() const {
+    return count_;
+}
+
+void NormalEquations::clear() {
+    count_ = 0;
+    gram_.assign(gram_.size(), 0.);
+    moment_.assign(moment_.size(), 0.);
+    valueSquares_ = 0.;
+    sumOfWeights_ = 0.;
+}
+
+void NormalEquations::reset(const unsigned nParameters) {
+    psf_precondition(nParameters > 0, "NormalEquations::reset(): Number of parameters has to be positive.");
+    nParameters_ = nParameters;
+    gram_.resize(nParameters * nParameters);
+    moment_.resize(nParameters);
+    clear();
+}
+
+double NormalEquations::sumOfWeights() const {
+    return sumOfWeights_;
+}
+
+void NormalEquations::add(const std::vector<double>& row, const double value, const double weight) {
+    psf_precondition(row.size() >= nParameters_, "NormalEquations::add(): Row has less elements than parameters.");
+    add(&row[0], value, weight);
+}
+
+void NormalEquations::add(const double* row, const double value, const double weight) {
+    psf_precondition(weight >= 0, "NormalEquations::add(): Weight has to be non-negative.");
+    for(unsigned i = 0; i < nParameters_; ++i) {
+        const double wa = weight * row[i];
+        for(unsigned j = 0; j < nParameters_; ++j) {
+            gram_[i * nParameters_ + j] += wa * row[j];
+        }
+        moment_[i] += wa * value;
+    }
+    valueSquares_ += weight * value * value;
+    sumOfWeights_ += weight;
+    ++count_;
+}
+
+namespace
+{
+    // upper bound of the number of parameters of solveNonnegative()
+    const unsigned maximalParameters_ = 16;
+
+    // Solves the subsystem of the normal equations restricted to the m free parameters
+    // with Gaussian elimination and partial pivoting. Returns false, if it is singular.
+    // All n elements of x are overwritten.
+    bool solveSubsystem_(const std::vector<double>& gram, const std::vector<double>& moment, const unsigned n, const unsigned* free, const std::size_t m, double* x) {
+        double system[maximalParameters_ * (maximalParameters_ + 1)];
+        double largest = 0.;
+        for(std::size_t i = 0; i < m; ++i) {
+            for(std::size_t j = 0; j < m; ++j) {
+                system[i * (m + 1) + j] = gram[free[i] * n + free[j]];
+                largest = std::max(largest, std::abs(system[i * (m + 1) + j]));
+            }
+            system[i * (m + 1) + m] = moment[free[i]];
+        }
+        const double singular = 1e-12 * largest;
+
+        for(std::size_t column = 0; column < m; ++column) {
+            std::size_t pivot = column;
+            for(std::size_t row = column + 1; row < m; ++row) {
+                if(std::abs(system[row * (m + 1) + column]) > std::abs(system[pivot * (m + 1) + column])) {
+                    pivot = row;
+                }
+            }
+            if(!(std::abs(system[pivot * (m + 1) + column]) > singular)) {
+                return false;
+            }
+            for(std::size_t k = 0; k <= m; ++k) {
+                std::swap(system[column * (m + 1) + k], system[pivot * (m + 1) + k]);
+            }
+            for(std::size_t row = column + 1; row < m; ++row) {
+                const double factor = system[row * (m + 1) + column] / system[column * (m + 1) + column];
+                for(std::size_t k = column; k <= m; ++k) {
+                    system[row * (m + 1) + k] -= factor * system[column * (m + 1) + k];
+                }
+            }
+        }
+
+        std::fill(x, x + n, 0.);
+        for(std::size_t i = m; i-- > 0; ) {
+            double sum = system[i * (m + 1) + m];
+            for(std::size_t k = i + 1; k < m; ++k) {
+                sum -= system[i * (m + 1) + k] * x[free[k]];
+            }
+            x[free[i]] = sum / system[i * (m + 1) + i];
+        }
+        return true;
+    }
+} /* namespace */
+
+void NormalEquations::solveNonnegative(std::vector<double>& x) const {
+    psf_precondition(nParameters_ <= maximalParameters_, "NormalEquations::solveNonnegative(): Too many parameters for an exhaustive active set search.");
+    const unsigned n = nParameters_;
+
+    // x = 0 is always feasible
+    x.assign(n, 0.);
+    double bestObjective = 0.;
+
+    unsigned free[maximalParameters_] = {};
+    double candidate[maximalParameters_];
+    for(unsigned long subset = 1; subset < (1ul << n); ++subset) {
+        std::size_t m = 0;
+        for(unsigned i = 0; i < n; ++i) {
+            if(subset & (1ul << i)) {
+                free[m++] = i;
+            }
+        }
+        if(!solveSubsystem_(gram_, moment_, n, free, m, candidate)) {
+            continue;
+        }
+        bool feasible = true;
+        for(std::size_t i = 0; i < m; ++i) {
+            if(candidate[free[i]] < 0.) {
+                feasible = false;
+                break;
+            }
+        }
+        if(!feasible) {
+            continue;
+        }
+        // 1/2 x^T G x - x^T c; at the subsystem's optimum this is -1/2 x^T c
+        double objective = 0.;
+        for(std::size_t i = 0; i < m; ++i) {
+            objective -= 0.5 * candidate[free[i]] * moment_[free[i]];
+        }
+        if(objective < bestObjective) {
+            bestObjective = objective;
+            std::copy(candidate, candidate + n, x.begin());
+        }
+    }
+}
+
+double NormalEquations::residualSumOfSquares(const std::vector<double>& x) const {
+    psf_precondition(x.size() == nParameters_, "NormalEquations::residualSumOfSquares(): x has the wrong number of elements.");
+    double rss = valueSquares_;
+    for(unsigned i = 0; i < nParameters_; ++i) {
+        rss -= 2. * x[i] * moment_[i];
+        for(unsigned j = 0; j < nParameters_; ++j) {
+            rss += x[i] * gram_[i * nParameters_ + j] * x[j];
+        }
+    }
+    return rss;
+}
+
+void NormalEquations::covariance(const std::vector<double>& x, std::vector<double>& result) const {
+    const unsigned n = nParameters_;
+    if(count_ <= n || sumOfWeights_ <= n) {
+        throw psf::Starvation("NormalEquations::covariance(): Not more observations than parameters.");
+    }
+    const double variance = std::max(0., residualSumOfSquares(x)) / (sumOfWeights_ - n);
+
+    // Gauss-Jordan elimination on [G | I]
+    std::vector<double> g(gram_);
+    result.assign(n * n, 0.);
+    for(unsigned i = 0; i < n; ++i) {
+        result[i * n + i] = 1.;
+    }
+    double largest = 0.;
+    for(std::size_t i = 0; i < g.size(); ++i) {
+        largest = std::max(largest, std::abs(g[i]));
+    }
+    for(unsigned column = 0; column < n; ++column) {
+        unsigned pivot = column;
+        for(unsigned row = column + 1; row < n; ++row) {
+            if(std::abs(g[row * n + column]) > std::abs(g[pivot * n + column])) {
+                pivot = row;
+            }
+        }
+        if(!(std::abs(g[pivot * n + column]) > 1e-12 * largest)) {
+            throw psf::NumericalInstability("NormalEquations::covariance(): Normal equations are singular.");
+        }
+        for(unsigned k = 0; k < n; ++k) {
+            std::swap(g[column * n + k], g[pivot * n + k]);
+            std::swap(result[column * n + k], result[pivot * n + k]);
+        }
+        const double diagonal = g[column * n + column];
+        for(unsigned k = 0; k < n; ++k) {
+            g[column * n + k] /= diagonal;
+            result[column * n + k] /= diagonal;
+        }
+        for(unsigned row = 0; row < n; ++row) {
+            if(row == column) {
+                continue;
+            }
+            const double factor = g[row * n + column];
+            for(unsigned k = 0; k < n; ++k) {
+                g[row * n + k] -= factor * g[column * n + k];
+                result[row * n + k] -= factor * result[column * n + k];
+            }
+        }
+    }
+    for(std::size_t i = 0; i < result.size(); ++i) {
+        result[i] *= variance;
+    }
+}
+
+} /* namespace psf */
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <string>
+
+#include <psf/Error.h>
+#include "psf/SaxParser.h"
+
+namespace psf
+{
+
+namespace {
+    inline bool isSpace_(const char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    void appendUtf8_(std::string& s, const unsigned long c) {
+        if(c < 0x80) {
+            s += static_cast<char>(c);
+        }
+        else if(c < 0x800) {
+            s += static_cast<char>(0xC0 | (c >> 6));
+            s += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else if(c < 0x10000) {
+            s += static_cast<char>(0xE0 | (c >> 12));
+            s += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else {
+            s += static_cast<char>(0xF0 | (c >> 18));
+            s += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            s += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+
+    // Assigns [first, last) to value, replacing the predefined entities and character
+    // references.
+    void assignValue_(std::string& value, const char* first, const char* const last) {
+        const char* amp = static_cast<const char*>(std::memchr(first, '&', last - first));
+        if(!amp) {
+            value.assign(first, last);
+            return;
+        }
+        value.assign(first, amp);
+        first = amp;
+        while(first < last) {
+            if(*first != '&') {
+                value += *first++;
+                continue;
+            }
+            const char* semicolon = std::find(first, last, ';');
+            if(semicolon == last) {
+                psf_fail("SaxParser: Unterminated entity in attribute value.");
+            }
+            const std::string entity(first + 1, semicolon);
+            if(entity == "amp") value += '&';
+            else if(entity == "lt") value += '<';
+            else if(entity == "gt") value += '>';
+            else if(entity == "quot") value += '"';
+            else if(entity == "apos") value += '\'';
+            else if(entity.size() > 1 && entity[0] == '#') {
+                const bool hex = entity[1] == 'x';
+                appendUtf8_(value, std::strtoul(entity.c_str() + (hex ? 2 : 1), 0, hex ? 16 : 10));
+            }
+            else {
+                psf_fail("SaxParser: Unknown entity '&" + entity + ";' in attribute value.");
+            }
+            first = semicolon + 1;
+        }
+    }
+} /* anonymous namespace */
+
+const std::string* SaxAttributes::find(const char* name) const {
+    for(std::size_t i = 0; i < size_; ++i) {
+        if(attributes_[i].first == name) {
+            return &attributes_[i].second;
+        }
+    }
+    return 0;
+}
+
+SaxParser::SaxParser(std::istream& is, const std::size_t chunkSize) : is_(is), buffer_(chunkSize > 16 ? chunkSize : 16), begin_(0), end_(0), base_(0), offset_(0), chunkSize_(chunkSize > 16 ? chunkSize : 16) {
+}
+
+bool SaxParser::parseNext(SaxHandler& handler) {
+    if(begin_ == end_ && !fill_()) {
+        return false;
+    }
+    offset_ = base_ + begin_;
+
+    if(buffer_[begin_] != '<') {
+        const char* first = buffer_.data() + begin_;
+        const char* found = static_cast<const char*>(std::memchr(first, '<', end_ - begin_));
+        const std::size_t length = found ? found - first : end_ - begin_;
+        begin_ += length;
+        handler.characters(first, length);
+        return true;
+    }
+
+    // enough to tell the kind of markup
+    while(end_ - begin_ < 9 && fill_()) {
+    }
+    const char* markup = buffer_.data() + begin_;
+    const std::size_t available = end_ - begin_;
+    if(available >= 2 && std::strncmp(markup, "<?", 2) == 0) {
+        begin_ += find_("?>", 2) + 2;
+    }
+    else if(available >= 4 && std::strncmp(markup, "<!--", 4) == 0) {
+        begin_ += find_("-->", 4) + 3;
+    }
+    else if(available >= 9 && std::strncmp(markup, "<![CDATA[", 9) == 0) {
+        const std::size_t end = find_("]]>", 9);
+        handler.characters(buffer_.data() + begin_ + 9, end - 9);
+        begin_ += end + 3;
+    }
+    else if(available >= 2 && markup[1] == '!') {
+        begin_ += find_(">", 2) + 1;
+    }
+    else {
+        const std::size_t end = findTagEnd_();
+        parseTag_(handler, end);
+        begin_ += end + 1;
+    }
+    return true;
+}
+
+bool SaxParser::fill_() {
+    if(begin_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        base_ += begin_;
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    if(buffer_.size() - end_ < chunkSize_) {
+        // only for constructs longer than a chunk
+        buffer_.resize(end_ + chunkSize_);
+    }
+    is_.read(buffer_.data() + end_, chunkSize_);
+    const std::size_t n = static_cast<std::size_t>(is_.gcount());
+    end_ += n;
+    return n > 0;
+}
+
+std::size_t SaxParser::find_(const char* terminator, std::size_t from) {
+    const std::size_t n = std::strlen(terminator);
+    while(true) {
+        const char* first = buffer_.data() + begin_;
+        const char* last = buffer_.data() + end_;
+        const char* found = std::search(first + std::min(from, end_ - begin_), last, terminator, terminator + n);
+        if(found != last) {
+            return found - first;
+        }
+        // a terminator may straddle the end of the buffer
+        from = std::max(from, end_ - begin_ >= n ? end_ - begin_ - n + 1 : 0);
+        if(!fill_()) {
+            psf_fail("SaxParser: Unexpected end of document.");
+        }
+    }
+}
+
+std::size_t SaxParser::findTagEnd_() {
+    char quote = 0;
+    std::size_t i = 1;
+    while(true) {
+        for(; begin_ + i < end_; ++i) {
+            const char c = buffer_[begin_ + i];
+            if(quote) {
+                if(c == quote) {
+                    quote = 0;
+                }
+            }
+            else if(c == '"' || c == '\'') {
+                quote = c;
+            }
+            else if(c == '>') {
+                return i;
+            }
+        }
+        if(!fill_()) {
+            psf_fail("SaxParser: Unexpected end of document.");
+        }
+    }
+}
+
+void SaxParser::parseTag_(SaxHandler& handler, const std::size_t end) {
+    const char* p = buffer_.data() + begin_ + 1;
+    const char* last = buffer_.data() + begin_ + end;
+
+    if(*p == '/') {
+        ++p;
+        const char* nameEnd = p;
+        while(nameEnd < last && !isSpace_(*nameEnd)) {
+            ++nameEnd;
+        }
+        name_.assign(p, nameEnd);
+        handler.endElement(name_);
+        return;
+    }
+
+    const bool empty = last > p && last[-1] == '/';
+    if(empty) {
+        --last;
+    }
+    const char* nameEnd = p;
+    while(nameEnd < last && !isSpace_(*nameEnd)) {
+        ++nameEnd;
+    }
+    if(nameEnd == p) {
+        psf_fail("SaxParser: Tag without name.");
+    }
+    name_.assign(p, nameEnd);
+    p = nameEnd;
+
+    attributes_.size_ = 0;
+    while(true) {
+        while(p < last && isSpace_(*p)) {
+            ++p;
+        }
+        if(p == last) {
+            break;
+        }
+        const char* attributeName = p;
+        while(p < last && *p != '=' && !isSpace_(*p)) {
+            ++p;
+        }
+        const char* attributeNameEnd = p;
+        while(p < last && isSpace_(*p)) {
+            ++p;
+        }
+        if(p == last || *p != '=') {
+            psf_fail("SaxParser: Attribute without value in tag '" + name_ + "'.");
+        }
+        ++p;
+        while(p < last && isSpace_(*p)) {
+            ++p;
+        }
+        if(p == last || (*p != '"' && *p != '\'')) {
+            psf_fail("SaxParser: Unquoted attribute value in tag '" + name_ + "'.");
+        }
+        const char quote = *p++;
+        const char* valueEnd = std::find(p, last, quote);
+        if(valueEnd == last) {
+            psf_fail("SaxParser: Unterminated attribute value in tag '" + name_ + "'.");
+        }
+        if(attributes_.size_ == attributes_.attributes_.size()) {
+            attributes_.attributes_.push_back(std::pair<std::string, std::string>());
+        }
+        std::pair<std::string, std::string>& attribute = attributes_.attributes_[attributes_.size_++];
+        attribute.first.assign(attributeName, attributeNameEnd);
+        assignValue_(attribute.second, p, valueEnd);
+        p = valueEnd + 1;
+    }
+
+    handler.startElement(name_, attributes_);
+    if(empty) {
+        handler.endElement(name_);
+    }
+}
+
+} /* namespace psf */
@@ -0,0 +1,191 @@
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/Log.h>
+#include "psf/ScanCache.h"
+
+namespace psf
+{
+
+ScanCache::ScanCache(const std::string& runFilename, const std::size_t memoryBudget, const unsigned nThreads)
+    : run_(runFilename, nThreads), prefetchRun_(runFilename, run_.index()), budget_(memoryBudget), entries_(run_.index().size()), bytes_(0),
+      failed_(run_.index().size(), 0), next_(0), inFlight_(run_.index().size()), hits_(0), misses_(0), idle_(false), stop_(false) {
+    order_.resize(size());
+    position_.resize(size());
+    for(std::size_t i = 0; i < size(); ++i) {
+        order_[i] = i;
+        position_[i] = i;
+    }
+    thread_ = std::thread(&ScanCache::prefetch_, this);
+}
+
+ScanCache::~ScanCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+}
+
+void ScanCache::setProcessingOrder(const std::vector<std::size_t>& order) {
+    for(std::size_t j = 0; j < order.size(); ++j) {
+        psf_precondition(order[j] < size(), "ScanCache::setProcessingOrder(): Scan out of range.");
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        order_ = order;
+        position_.assign(size(), order.size());
+        for(std::size_t j = 0; j < order.size(); ++j) {
+            position_[order[j]] = j;
+        }
+        failed_.assign(size(), 0);
+        next_ = 0;
+        idle_ = false;
+    }
+    wake_.notify_all();
+}
+
+ScanCache::ScanPtr ScanCache::scan(const std::size_t i) {
+    psf_precondition(i < size(), "ScanCache::scan(): Scan out of range.");
+    std::unique_lock<std::mutex> lock(mutex_);
+    if(position_[i] < order_.size()) {
+        next_ = position_[i] + 1;
+        idle_ = false;
+        wake_.notify_all();
+    }
+    while(inFlight_ == i) {
+        done_.wait(lock);
+    }
+    Entry_& entry = entries_[i];
+    if(entry.scan) {
+        ++hits_;
+        lru_.splice(lru_.begin(), lru_, entry.lru);
+        return entry.scan;
+    }
+    ++misses_;
+    lock.unlock();
+
+    std::size_t bytes;
+    ScanPtr scan;
+    {
+        std::lock_guard<std::mutex> readLock(readMutex_);
+        scan = read_(run_, i, bytes);
+    }
+    lock.lock();
+    if(!entries_[i].scan) {
+        insert_(i, scan, bytes);
+    }
+    return scan;
+}
+
+bool ScanCache::cached(const std::size_t i) const {
+    psf_precondition(i < size(), "ScanCache::cached(): Scan out of range.");
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<bool>(entries_[i].scan);
+}
+
+void ScanCache::waitForReadAhead() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(!idle_ && !stop_) {
+        done_.wait(lock);
+    }
+}
+
+std::size_t ScanCache::bytesCached() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+std::size_t ScanCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+std::size_t ScanCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+ScanCache::ScanPtr ScanCache::read_(IndexedRun& run, const std::size_t i, std::size_t& bytes) {
+    std::shared_ptr<Spectrum> scan(new Spectrum);
+    run.read(i, *scan);
+    bytes = sizeof(Spectrum) + scan->capacity() * sizeof(SpectrumElement);
+    return scan;
+}
+
+void ScanCache::insert_(const std::size_t i, const ScanPtr& scan, const std::size_t bytes) {
+    Entry_& entry = entries_[i];
+    entry.scan = scan;
+    entry.bytes = bytes;
+    lru_.push_front(i);
+    entry.lru = lru_.begin();
+    bytes_ += bytes;
+    while(bytes_ > budget_ && lru_.size() > 1) {
+        // the least recently used scan, but scans read ahead are kept as long as possible
+        std::list<std::size_t>::iterator victim = lru_.end();
+        do {
+            --victim;
+        } while(victim != lru_.begin() && position_[*victim] >= next_ && position_[*victim] < order_.size());
+        if(victim == lru_.begin()) {
+            victim = --lru_.end();
+        }
+        Entry_& entry = entries_[*victim];
+        bytes_ -= entry.bytes;
+        entry.scan.reset();
+        entry.bytes = 0;
+        lru_.erase(victim);
+    }
+}
+
+void ScanCache::prefetch_() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(!stop_) {
+        // the first scan ahead of the caller neither cached nor failed, unless the cached
+        // ones ahead take half of the budget or are enough
+        std::size_t ahead = 0;
+        std::size_t i = size();
+        for(std::size_t j = next_; j < order_.size() && j < next_ + maximalReadAhead_ && ahead < budget_ / 2; ++j) {
+            const Entry_& entry = entries_[order_[j]];
+            if(entry.scan) {
+                ahead += entry.bytes;
+            }
+            else if(!failed_[order_[j]]) {
+                i = order_[j];
+                break;
+            }
+        }
+        if(i == size()) {
+            idle_ = true;
+            done_.notify_all();
+            wake_.wait(lock);
+            continue;
+        }
+
+        inFlight_ = i;
+        lock.unlock();
+        std::size_t bytes = 0;
+        ScanPtr scan;
+        try {
+            scan = read_(prefetchRun_, i, bytes);
+        } catch(const std::exception& e) {
+            // scan() will read it again and report the error
+            PSF_LOG(logDEBUG) << "ScanCache: Reading scan " << i << " ahead failed: " << e.what();
+        }
+        lock.lock();
+        inFlight_ = size();
+        if(!scan) {
+            failed_[i] = 1;
+        }
+        else if(!entries_[i].scan) {
+            insert_(i, scan, bytes);
+        }
+        done_.notify_all();
+    }
+}
+
+} /* namespace psf */
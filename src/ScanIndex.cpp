@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <psf/Error.h>
+#include <psf/Log.h>
+#include <psf/MzML.h>
+#include "psf/ScanIndex.h"
+
+namespace psf
+{
+
+namespace {
+    const char* const header_ = "# psf scan index 2";
+
+    // Bytes at the start and at the end of a run file its checksum covers: the header and
+    // the footer (with the offsets of an indexed mzML file), which change with a rewrite.
+    const unsigned long long checksumBytes_ = 4096;
+
+    unsigned long long fileSize_(const std::string& filename) {
+        std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
+        if(!ifs.is_open()) {
+            psf_fail("ScanIndex: Couldn't open '" + filename + "'.");
+        }
+        ifs.seekg(0, std::ios::end);
+        return static_cast<unsigned long long>(ifs.tellg());
+    }
+
+    // Modification time of a file in seconds since the epoch.
+    long long modificationTime_(const std::string& filename) {
+        struct stat status;
+        if(::stat(filename.c_str(), &status) != 0) {
+            psf_fail("ScanIndex: Couldn't stat '" + filename + "'.");
+        }
+        return static_cast<long long>(status.st_mtime);
+    }
+
+    // FNV-1a hash of the first and the last checksumBytes_ bytes of a file of the given size.
+    unsigned long long checksum_(const std::string& filename, const unsigned long long size) {
+        std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
+        if(!ifs.is_open()) {
+            psf_fail("ScanIndex: Couldn't open '" + filename + "'.");
+        }
+        const unsigned long long tail = size > checksumBytes_ ? std::max(checksumBytes_, size - checksumBytes_) : size;
+        std::vector<char> bytes(static_cast<std::size_t>(std::min(size, checksumBytes_) + (size - tail)));
+        if(!bytes.empty()) {
+            const std::streamsize headLength = static_cast<std::streamsize>(std::min(size, checksumBytes_));
+            ifs.read(&bytes[0], headLength);
+            ifs.seekg(static_cast<std::streamoff>(tail));
+            ifs.read(&bytes[0] + headLength, static_cast<std::streamsize>(size - tail));
+            if(!ifs) {
+                psf_fail("ScanIndex: Couldn't read '" + filename + "'.");
+            }
+        }
+        unsigned long long hash = 14695981039346656037ULL;
+        for(std::size_t i = 0; i < bytes.size(); ++i) {
+            hash = (hash ^ static_cast<unsigned char>(bytes[i])) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // The value of a 'key=value' field of a .wsv header line, or 0.
+    const char* field_(const std::string& line, const char* key) {
+        const std::size_t length = std::strlen(key);
+        std::size_t position = 0;
+        while((position = line.find(key, position)) != std::string::npos) {
+            if(position == 0 || line[position - 1] == ' ' || line[position - 1] == '\t' || line[position - 1] == '#') {
+                return line.c_str() + position + length;
+            }
+            position += length;
+        }
+        return 0;
+    }
+
+    void addMz_(ScanIndexEntry& entry, bool& any, const double mz, const double intensity) {
+        if(intensity > 0) {
+            entry.firstMz = any ? std::min(entry.firstMz, mz) : mz;
+            entry.lastMz = any ? std::max(entry.lastMz, mz) : mz;
+            any = true;
+        }
+    }
+} /* anonymous namespace */
+
+ScanIndexEntry::ScanIndexEntry() : offset(0), length(0), scanNumber(0), msLevel(0), retentionTime(0.), firstMz(0.), lastMz(0.) {
+}
+
+ScanIndex::ScanIndex() : format_(wsvRun), runSize_(0), runModified_(0), runChecksum_(0) {
+}
+
+ScanIndex ScanIndex::build(const std::string& runFilename, const unsigned nThreads) {
+    ScanIndex index;
+    index.runSize_ = fileSize_(runFilename);
+    index.runModified_ = modificationTime_(runFilename);
+    index.runChecksum_ = checksum_(runFilename, index.runSize_);
+
+    std::ifstream ifs(runFilename.c_str(), std::ios::in | std::ios::binary);
+    char first = 0;
+    while(ifs.get(first) && (first == ' ' || first == '\t' || first == '\r' || first == '\n' || static_cast<unsigned char>(first) == 0xEF || static_cast<unsigned char>(first) == 0xBB || static_cast<unsigned char>(first) == 0xBF)) {
+        // whitespace and a UTF-8 byte order mark
+    }
+
+    if(first == '<') {
+        index.format_ = mzmlRun;
+        ifs.close();
+        MzMLReader reader(runFilename, nThreads);
+        MzMLScan scan;
+        while(reader.next(scan)) {
+            ScanIndexEntry entry;
+            entry.offset = scan.offset;
+            entry.length = scan.length;
+            entry.scanNumber = scan.scanNumber;
+            entry.msLevel = scan.msLevel;
+            entry.retentionTime = scan.retentionTime;
+            bool any = false;
+            for(std::size_t i = 0; i < scan.spectrum.size(); ++i) {
+                addMz_(entry, any, scan.spectrum[i].mz, scan.spectrum[i].intensity);
+            }
+            index.add_(entry);
+        }
+    }
+    else {
+        index.format_ = wsvRun;
+        ifs.clear();
+        ifs.seekg(0);
+        ScanIndexEntry entry;
+        entry.scanNumber = -1;
+        bool headed = false; // the current spectrum has a header line
+        bool data = false; // and at least one (mz intensity) pair
+        bool any = false;
+        unsigned long long position = 0;
+        std::string line;
+        while(std::getline(ifs, line)) {
+            const unsigned long long lineBegin = position;
+            position += line.size() + (ifs.eof() ? 0 : 1);
+            const std::size_t nonSpace = line.find_first_not_of(" \t\r");
+            if(nonSpace == std::string::npos) {
+                continue;
+            }
+            if(line[nonSpace] == '#') {
+                if(headed || data) {
+                    entry.length = lineBegin - entry.offset;
+                    index.add_(entry);
+                }
+                entry = ScanIndexEntry();
+                entry.offset = position;
+                entry.scanNumber = -1;
+                if(const char* scan = field_(line, "scan=")) {
+                    entry.scanNumber = std::atoi(scan);
+                }
+                if(const char* rt = field_(line, "rt=")) {
+                    entry.retentionTime = std::strtod(rt, 0);
+                }
+                if(const char* level = field_(line, "level=")) {
+                    entry.msLevel = std::atoi(level);
+                }
+                headed = true;
+                data = false;
+                any = false;
+                continue;
+            }
+            char* end = 0;
+            const double mz = std::strtod(line.c_str() + nonSpace, &end);
+            const char* intensityBegin = end;
+            const double intensity = std::strtod(intensityBegin, &end);
+            if(end != intensityBegin) {
+                data = true;
+                addMz_(entry, any, mz, intensity);
+            }
+        }
+        if(headed || data) {
+            entry.length = position - entry.offset;
+            index.add_(entry);
+        }
+    }
+
+    for(std::size_t i = 0; i < index.entries_.size(); ++i) {
+        if(index.entries_[i].scanNumber < 0) {
+            index.entries_[i].scanNumber = static_cast<int>(i) + 1;
+        }
+    }
+    index.sort_();
+    return index;
+}
+
+ScanIndex ScanIndex::open(const std::string& runFilename, const unsigned nThreads) {
+    const std::string sidecar = sidecarFilename(runFilename);
+    const unsigned long long size = fileSize_(runFilename);
+    ScanIndex index;
+    try {
+        // the checksum last, it reads the run
+        if(index.load(sidecar) && index.runSize() == size && index.runModified() == modificationTime_(runFilename) && index.runChecksum() == checksum_(runFilename, size)) {
+            return index;
+        }
+    } catch(const RuntimeError& e) {
+        PSF_LOG(logWARNING) << "ScanIndex::open(): Rebuilding the index: " << e.what();
+    }
+    index = build(runFilename, nThreads);
+    try {
+        index.save(sidecar);
+    } catch(const RuntimeError& e) {
+        PSF_LOG(logWARNING) << "ScanIndex::open(): " << e.what();
+    }
+    return index;
+}
+
+std::string ScanIndex::sidecarFilename(const std::string& runFilename) {
+    return runFilename + ".psfindex";
+}
+
+void ScanIndex::save(const std::string& filename) const {
+    // write a complete new index, then replace the old one
+    const std::string temporary = filename + ".tmp";
+    {
+        std::ofstream ofs(temporary.c_str());
+        ofs.imbue(std::locale::classic());
+        ofs.precision(std::numeric_limits<double>::digits10 + 2);
+        ofs << header_ << '\n'
+            << "format\t" << (format_ == mzmlRun ? "mzML" : "wsv") << '\n'
+            << "size\t" << runSize_ << '\n'
+            << "modified\t" << runModified_ << '\n'
+            << "checksum\t" << runChecksum_ << '\n';
+        for(std::size_t i = 0; i < entries_.size(); ++i) {
+            const ScanIndexEntry& entry = entries_[i];
+            ofs << entry.offset << '\t' << entry.length << '\t' << entry.scanNumber << '\t' << entry.msLevel << '\t'
+                << entry.retentionTime << '\t' << entry.firstMz << '\t' << entry.lastMz << '\n';
+        }
+        ofs.flush();
+        if(!ofs) {
+            std::remove(temporary.c_str());
+            psf_fail("ScanIndex: Couldn't write '" + temporary + "'.");
+        }
+    }
+    if(std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        psf_fail("ScanIndex: Couldn't replace '" + filename + "'.");
+    }
+}
+
+bool ScanIndex::load(const std::string& filename) {
+    std::ifstream ifs(filename.c_str());
+    if(!ifs.is_open()) {
+        return false;
+    }
+    ifs.imbue(std::locale::classic());
+    std::string line;
+    if(!std::getline(ifs, line) || line != header_) {
+        psf_fail("ScanIndex: '" + filename + "' is not a scan index.");
+    }
+    std::string key, format;
+    unsigned long long runSize = 0;
+    long long runModified = 0;
+    unsigned long long runChecksum = 0;
+    if(!(ifs >> key >> format) || key != "format" || (format != "mzML" && format != "wsv") || !(ifs >> key >> runSize) || key != "size"
+       || !(ifs >> key >> runModified) || key != "modified" || !(ifs >> key >> runChecksum) || key != "checksum") {
+        psf_fail("ScanIndex: Malformed header in '" + filename + "'.");
+    }
+    std::vector<ScanIndexEntry> entries;
+    ScanIndexEntry entry;
+    while(ifs >> entry.offset >> entry.length >> entry.scanNumber >> entry.msLevel >> entry.retentionTime >> entry.firstMz >> entry.lastMz) {
+        entries.push_back(entry);
+    }
+    if(!ifs.eof()) {
+        psf_fail("ScanIndex: Malformed entry in '" + filename + "'.");
+    }
+
+    format_ = format == "mzML" ? mzmlRun : wsvRun;
+    runSize_ = runSize;
+    runModified_ = runModified;
+    runChecksum_ = runChecksum;
+    entries_.swap(entries);
+    sort_();
+    return true;
+}
+
+std::size_t ScanIndex::findScan(const int scanNumber) const {
+    std::size_t first = 0, last = byScanNumber_.size();
+    while(first < last) {
+        const std::size_t middle = first + (last - first) / 2;
+        if(entries_[byScanNumber_[middle]].scanNumber < scanNumber) {
+            first = middle + 1;
+        }
+        else {
+            last = middle;
+        }
+    }
+    if(first < byScanNumber_.size() && entries_[byScanNumber_[first]].scanNumber == scanNumber) {
+        return byScanNumber_[first];
+    }
+    return entries_.size();
+}
+
+void ScanIndex::findRetentionTimeRange(const double first, const double last, std::vector<std::size_t>& indices) const {
+    indices.clear();
+    std::size_t begin = 0, end = byRetentionTime_.size();
+    while(begin < end) {
+        const std::size_t middle = begin + (end - begin) / 2;
+        if(entries_[byRetentionTime_[middle]].retentionTime < first) {
+            begin = middle + 1;
+        }
+        else {
+            end = middle;
+        }
+    }
+    for(; begin < byRetentionTime_.size() && entries_[byRetentionTime_[begin]].retentionTime <= last; ++begin) {
+        indices.push_back(byRetentionTime_[begin]);
+    }
+}
+
+void ScanIndex::add_(const ScanIndexEntry& entry) {
+    entries_.push_back(entry);
+}
+
+namespace {
+    struct ByScanNumber_
+    {
+        explicit ByScanNumber_(const std::vector<ScanIndexEntry>& entries) : entries(entries) {}
+        bool operator()(const std::size_t a, const std::size_t b) const {
+            return entries[a].scanNumber < entries[b].scanNumber || (entries[a].scanNumber == entries[b].scanNumber && a < b);
+        }
+        const std::vector<ScanIndexEntry>& entries;
+    };
+
+    struct ByRetentionTime_
+    {
+        explicit ByRetentionTime_(const std::vector<ScanIndexEntry>& entries) : entries(entries) {}
+        bool operator()(const std::size_t a, const std::size_t b) const {
+            return entries[a].retentionTime < entries[b].retentionTime || (entries[a].retentionTime == entries[b].retentionTime && a < b);
+        }
+        const std::vector<ScanIndexEntry>& entries;
+    };
+} /* anonymous namespace */
+
+void ScanIndex::sort_() {
+    byScanNumber_.resize(entries_.size());
+    for(std::size_t i = 0; i < entries_.size(); ++i) {
+        byScanNumber_[i] = i;
+    }
+    byRetentionTime_ = byScanNumber_;
+    std::sort(byScanNumber_.begin(), byScanNumber_.end(), ByScanNumber_(entries_));
+    std::sort(byRetentionTime_.begin(), byRetentionTime_.end(), ByRetentionTime_(entries_));
+}
+
+IndexedRun::IndexedRun(const std::string& runFilename, const unsigned nThreads) : filename_(runFilename), file_(runFilename.c_str(), std::ios::in | std::ios::binary), index_(ScanIndex::open(runFilename, nThreads)) {
+    if(!file_.is_open()) {
+        psf_fail("IndexedRun: Couldn't open '" + runFilename + "'.");
+    }
+}
+
+IndexedRun::IndexedRun(const std::string& runFilename, const ScanIndex& index) : filename_(runFilename), file_(runFilename.c_str(), std::ios::in | std::ios::binary), index_(index) {
+    if(!file_.is_open()) {
+        psf_fail("IndexedRun: Couldn't open '" + runFilename + "'.");
+    }
+}
+
+void IndexedRun::readMzML_(const std::size_t i) {
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(index_[i].offset));
+    if(!file_ || !MzMLReader::readSpectrum(file_, scan_)) {
+        psf_fail("IndexedRun: No spectrum at the indexed offset in '" + filename_ + "'.");
+    }
+}
+
+void IndexedRun::readText_(const std::size_t i) {
+    const ScanIndexEntry& entry = index_[i];
+    buffer_.resize(static_cast<std::size_t>(entry.length) + 1);
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(entry.offset));
+    file_.read(&buffer_[0], static_cast<std::streamsize>(entry.length));
+    if(static_cast<unsigned long long>(file_.gcount()) != entry.length) {
+        psf_fail("IndexedRun: '" + filename_ + "' is shorter than indexed.");
+    }
+    buffer_[entry.length] = '\0';
+}
+
+} /* namespace psf */
@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <psf/Error.h>
+#include <psf/Parallel.h>
+#include "psf/SpectrumBatch.h"
+
+namespace psf
+{
+
+namespace {
+    // The lines of a file starting in [begin, end), parsed by one thread.
+    struct Chunk_
+    {
+        std::size_t file;
+        unsigned long long begin;
+        unsigned long long end;
+        std::vector<char> text; // the complete lines from start on, nul terminated
+        std::size_t start;
+        std::size_t capacity; // lines of the text; at most one pair each, as a rule
+        std::size_t at; // first element in the block
+        std::size_t size;
+        Spectrum spilled; // the elements, if a line held several pairs
+        bool stopped; // at text that isn't a pair
+    };
+
+    // Writes elements to the range of a chunk in the block; counts the ones it has no room for.
+    struct ChunkOutput_
+    {
+        ChunkOutput_(SpectrumElement* f, SpectrumElement* l) : next(f), last(l), dropped(0) {}
+
+        ChunkOutput_& operator*() { return *this; }
+        ChunkOutput_& operator++() { return *this; }
+        ChunkOutput_& operator=(const SpectrumElement& e) {
+            if(next < last) {
+                new (next++) SpectrumElement(e);
+            }
+            else {
+                ++dropped;
+            }
+            return *this;
+        }
+
+        SpectrumElement* next;
+        SpectrumElement* last;
+        std::size_t dropped;
+    };
+
+    bool isDirectory_(const std::string& path) {
+        struct stat status;
+        return ::stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+    }
+
+    bool endsWith_(const std::string& s, const std::string& suffix) {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    void listDirectory_(const std::string& directory, const std::string& extension, std::vector<std::string>& files) {
+        DIR* dir = ::opendir(directory.c_str());
+        if(dir == 0) {
+            psf_fail("SpectrumBatch: Couldn't read directory '" + directory + "'.");
+        }
+        std::vector<std::string> subdirectories;
+        while(const dirent* entry = ::readdir(dir)) {
+            const std::string name = entry->d_name;
+            if(name == "." || name == "..") {
+                continue;
+            }
+            const std::string path = directory + "/" + name;
+            if(isDirectory_(path)) {
+                subdirectories.push_back(path);
+            }
+            else if(endsWith_(name, extension)) {
+                files.push_back(path);
+            }
+        }
+        ::closedir(dir);
+        for(std::size_t i = 0; i < subdirectories.size(); ++i) {
+            listDirectory_(subdirectories[i], extension, files);
+        }
+    }
+
+    unsigned long long fileSize_(const std::string& filename) {
+        std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
+        if(!ifs.is_open()) {
+            psf_fail("SpectrumBatch: Couldn't open '" + filename + "'.");
+        }
+        ifs.seekg(0, std::ios::end);
+        return static_cast<unsigned long long>(ifs.tellg());
+    }
+
+    // Reads the lines starting in [chunk.begin, chunk.end): the first one after the newline
+    // preceding chunk.begin, the last one up to the newline at or after chunk.end - 1.
+    void readChunk_(const std::string& filename, const unsigned long long size, Chunk_& chunk) {
+        std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
+        if(!ifs.is_open()) {
+            psf_fail("SpectrumBatch: Couldn't open '" + filename + "'.");
+        }
+        const unsigned long long first = chunk.begin > 0 ? chunk.begin - 1 : 0;
+        std::vector<char>& buffer = chunk.text;
+        buffer.resize(static_cast<std::size_t>(chunk.end - first));
+        ifs.seekg(static_cast<std::streamoff>(first));
+        ifs.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+        if(static_cast<std::size_t>(ifs.gcount()) != buffer.size()) {
+            psf_fail("SpectrumBatch: Couldn't read '" + filename + "'.");
+        }
+
+        std::size_t start = 0;
+        if(chunk.begin > 0) {
+            while(start < buffer.size() && buffer[start] != '\n') {
+                ++start;
+            }
+            ++start;
+            if(start >= buffer.size()) {
+                std::vector<char>().swap(buffer);
+                return; // no line starts in the chunk
+            }
+        }
+        // complete the last line
+        if(chunk.end < size && buffer.back() != '\n') {
+            char piece[4096];
+            bool complete = false;
+            while(!complete && ifs.read(piece, sizeof(piece)).gcount() > 0) {
+                const std::size_t n = static_cast<std::size_t>(ifs.gcount());
+                const char* newline = static_cast<const char*>(std::memchr(piece, '\n', n));
+                complete = newline != 0;
+                buffer.insert(buffer.end(), static_cast<const char*>(piece), complete ? newline : piece + n);
+            }
+        }
+
+        const char* line = &buffer[start];
+        const char* const last = &buffer[0] + buffer.size();
+        std::size_t lines = last[-1] != '\n' ? 1 : 0;
+        while((line = static_cast<const char*>(std::memchr(line, '\n', static_cast<std::size_t>(last - line)))) != 0) {
+            ++lines;
+            ++line;
+        }
+        buffer.push_back('\0');
+        chunk.start = start;
+        chunk.capacity = lines;
+    }
+
+    // Parses the text of the chunk into its range of the block and releases the text.
+    void parseChunk_(Chunk_& chunk, SpectrumElement* block) {
+        if(chunk.text.empty()) {
+            return;
+        }
+        ChunkOutput_ out(block + chunk.at, block + chunk.at + chunk.capacity);
+        const char* stop = SpectrumLoader::parseInto(&chunk.text[chunk.start], out);
+        chunk.size = static_cast<std::size_t>(out.next - (block + chunk.at));
+        if(out.dropped > 0) {
+            SpectrumLoader::parse(&chunk.text[chunk.start], chunk.spilled);
+            chunk.size = chunk.spilled.size();
+        }
+        while(std::isspace(static_cast<unsigned char>(*stop))) {
+            ++stop;
+        }
+        chunk.stopped = *stop != '\0';
+        std::vector<char>().swap(chunk.text);
+    }
+} /* anonymous namespace */
+
+SpectrumBatch::SpectrumBatch() : arena_(1 << 20), elements_(0), numberOfElements_(0), bytes_(0) {
+}
+
+void SpectrumBatch::load(const std::vector<std::string>& filenames, const unsigned nThreads, std::size_t chunkSize) {
+    clear();
+    if(chunkSize == 0) {
+        chunkSize = 1;
+    }
+
+    std::vector<unsigned long long> sizes(filenames.size());
+    parallelFor(filenames.size(), nThreads, [&](const std::size_t f) { sizes[f] = fileSize_(filenames[f]); });
+    std::vector<Chunk_> chunks;
+    unsigned long long bytes = 0;
+    for(std::size_t f = 0; f < filenames.size(); ++f) {
+        for(unsigned long long begin = 0; begin < sizes[f]; begin += chunkSize) {
+            Chunk_ chunk;
+            chunk.file = f;
+            chunk.begin = begin;
+            chunk.end = std::min<unsigned long long>(begin + chunkSize, sizes[f]);
+            chunk.start = 0;
+            chunk.capacity = 0;
+            chunk.at = 0;
+            chunk.size = 0;
+            chunk.stopped = false;
+            chunks.push_back(chunk);
+        }
+        bytes += sizes[f];
+    }
+    parallelFor(chunks.size(), nThreads, [&](const std::size_t c) { readChunk_(filenames[chunks[c].file], sizes[chunks[c].file], chunks[c]); });
+
+    // Every chunk gets room for a pair per line in the block and is parsed right into it.
+    std::size_t capacity = 0;
+    for(std::size_t c = 0; c < chunks.size(); ++c) {
+        chunks[c].at = capacity;
+        capacity += chunks[c].capacity;
+    }
+    SpectrumElement* elements = static_cast<SpectrumElement*>(arena_.allocate(capacity * sizeof(SpectrumElement), alignof(SpectrumElement)));
+    parallelFor(chunks.size(), nThreads, [&](const std::size_t c) { parseChunk_(chunks[c], elements); });
+
+    // Like a sequential parse, a file ends at the first text that isn't a pair.
+    bool stopped = false;
+    bool spilled = false;
+    for(std::size_t c = 0; c < chunks.size(); ++c) {
+        if(c > 0 && chunks[c].file != chunks[c - 1].file) {
+            stopped = false;
+        }
+        if(stopped) {
+            chunks[c].size = 0;
+        }
+        stopped = stopped || chunks[c].stopped;
+        spilled = spilled || chunks[c].size > chunks[c].capacity;
+    }
+
+    std::vector<std::size_t> offsets(filenames.size(), 0);
+    std::vector<std::size_t> ends(filenames.size(), 0);
+    std::size_t numberOfElements = 0;
+    if(!spilled) {
+        // A file starts where its first chunk was parsed to; the elements of its further
+        // chunks move down over the unused room of the previous ones, if there is any.
+        for(std::size_t c = 0; c < chunks.size(); ++c) {
+            const std::size_t f = chunks[c].file;
+            if(c == 0 || f != chunks[c - 1].file) {
+                offsets[f] = ends[f] = chunks[c].at;
+            }
+            if(ends[f] != chunks[c].at) {
+                std::copy(elements + chunks[c].at, elements + chunks[c].at + chunks[c].size, elements + ends[f]);
+            }
+            ends[f] += chunks[c].size;
+            numberOfElements += chunks[c].size;
+        }
+    }
+    else {
+        // Lines with several pairs; pack the spectra into a new block.
+        for(std::size_t c = 0; c < chunks.size(); ++c) {
+            ends[chunks[c].file] += chunks[c].size;
+        }
+        for(std::size_t f = 0; f < filenames.size(); ++f) {
+            offsets[f] = numberOfElements;
+            numberOfElements += ends[f];
+            ends[f] = offsets[f];
+        }
+        SpectrumElement* packed = static_cast<SpectrumElement*>(arena_.allocate(numberOfElements * sizeof(SpectrumElement), alignof(SpectrumElement)));
+        for(std::size_t c = 0; c < chunks.size(); ++c) {
+            const SpectrumElement* from = chunks[c].spilled.empty() ? elements + chunks[c].at : &chunks[c].spilled[0];
+            std::uninitialized_copy(from, from + chunks[c].size, packed + ends[chunks[c].file]);
+            ends[chunks[c].file] += chunks[c].size;
+        }
+        elements = packed;
+    }
+
+    elements_ = elements;
+    offsets_.swap(offsets);
+    ends_.swap(ends);
+    numberOfElements_ = numberOfElements;
+    filenames_ = filenames;
+    bytes_ = bytes;
+}
+
+std::vector<std::string> SpectrumBatch::listDirectory(const std::string& directory, const std::string& extension) {
+    std::vector<std::string> files;
+    listDirectory_(directory, extension, files);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+void SpectrumBatch::clear() {
+    arena_.reset();
+    elements_ = 0;
+    offsets_.clear();
+    ends_.clear();
+    numberOfElements_ = 0;
+    filenames_.clear();
+    bytes_ = 0;
+}
+
+} /* namespace psf */
@@ -34,9 +34,24 @@ double SqrtModel::at(const double x) const {
     return a_ * std::sqrt(x) + b_;
 }
 
+double SqrtModel::warpAt(const double x) const {
+    psf_precondition(x >= 0, "SqrtModel::warpAt(): Parameter x hast to be >= 0.");
+    if(a_ == 0.) {
+        return x / b_;
+    }
+    const double s = std::sqrt(x);
+    return 2. / a_ * (s - b_ / a_ * std::log(std::abs(a_ * s + b_)));
+}
+
 GeneralizedSlope SqrtModel::slopeInParameterSpaceFor(double x) const {
-    double slope[] = {std::sqrt(x), 1., 0.};
-    return GeneralizedSlope(slope, slope + 3);
+    GeneralizedSlope slope;
+    slopeInParameterSpaceFor(x, slope);
+    return slope;
+}
+
+void SqrtModel::slopeInParameterSpaceFor(double x, GeneralizedSlope& slope) const {
+    const double s[] = {std::sqrt(x), 1., 0.};
+    slope.assign(s, s + 3);
 }
 
 // setter / getter
@@ -0,0 +1,207 @@
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Arena.h>
+#include <psf/Centroid.h>
+#include <psf/Error.h>
+#include <psf/Parallel.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumAlgorithm.h>
+
+#include "testdata.h"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct ArenaTestSuite : vigra::test_suite {
+    ArenaTestSuite() : vigra::test_suite("Arena") {
+        add( testCase(&ArenaTestSuite::testAllocate));
+        add( testCase(&ArenaTestSuite::testReset));
+        add( testCase(&ArenaTestSuite::testAllocator));
+        add( testCase(&ArenaTestSuite::testSpectrum));
+        add( testCase(&ArenaTestSuite::testPool));
+    }
+
+    void testAllocate() {
+        Arena arena(256);
+        shouldEqual(arena.numberOfBlocks(), 0u);
+        shouldEqual(arena.bytesUsed(), 0u);
+
+        char* a = static_cast<char*>(arena.allocate(3, 1));
+        shouldEqual(arena.numberOfBlocks(), 1u);
+        double* b = static_cast<double*>(arena.allocate(sizeof(double), alignof(double)));
+        shouldEqual(reinterpret_cast<std::size_t>(b) % alignof(double), 0u);
+        should(reinterpret_cast<char*>(b) >= a + 3);
+        void* c = arena.allocate(10, 64);
+        shouldEqual(reinterpret_cast<std::size_t>(c) % 64, 0u);
+
+        // the most recent allocation is taken back, others are not
+        const std::size_t used = arena.bytesUsed();
+        arena.deallocate(c, 10);
+        should(arena.bytesUsed() < used);
+        should(arena.allocate(10, 64) == c);
+        arena.deallocate(a, 3);
+        shouldEqual(arena.bytesUsed(), used);
+
+        // larger than a block
+        arena.allocate(1000, 8);
+        shouldEqual(arena.numberOfBlocks(), 2u);
+        should(arena.capacity() >= 256u + 1000u);
+
+        bool thrown = false;
+        try {
+            arena.allocate(8, 3);
+        } catch (const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testReset() {
+        Arena arena(128);
+        for(int i = 0; i < 10; ++i) {
+            arena.allocate(100, 8);
+        }
+        should(arena.numberOfBlocks() > 1);
+        should(arena.bytesUsed() >= 1000u);
+        const std::size_t capacity = arena.capacity();
+
+        // one block for everything afterwards
+        arena.reset();
+        shouldEqual(arena.numberOfBlocks(), 1u);
+        shouldEqual(arena.capacity(), capacity);
+        shouldEqual(arena.bytesUsed(), 0u);
+        for(int i = 0; i < 10; ++i) {
+            arena.allocate(100, 8);
+        }
+        shouldEqual(arena.numberOfBlocks(), 1u);
+        arena.reset();
+        shouldEqual(arena.capacity(), capacity);
+    }
+
+    void testAllocator() {
+        Arena arena(1024);
+        ArenaAllocator<int> allocator(arena);
+        std::vector<int, ArenaAllocator<int> > v(allocator);
+        for(int i = 0; i < 1000; ++i) {
+            v.push_back(i);
+        }
+        for(int i = 0; i < 1000; ++i) {
+            shouldEqual(v[i], i);
+        }
+        // the buffers left behind by the growth add up to about the final one
+        should(arena.bytesUsed() < 3 * 1024 * sizeof(int));
+
+        // a temporary released right away is taken back
+        arena.reset();
+        std::vector<int, ArenaAllocator<int> > reserved(allocator);
+        reserved.reserve(1000);
+        const std::size_t used = arena.bytesUsed();
+        {
+            std::vector<int, ArenaAllocator<int> > temporary(500, 1, allocator);
+        }
+        shouldEqual(arena.bytesUsed(), used);
+        reserved.assign(1000, 7);
+        shouldEqual(arena.bytesUsed(), used);
+
+        ArenaAllocator<double> rebound(allocator);
+        should(rebound == allocator);
+        Arena other;
+        should(ArenaAllocator<int>(other) != allocator);
+    }
+
+    void testSpectrum() {
+        typedef std::vector<SpectrumElement, ArenaAllocator<SpectrumElement> > ArenaSpectrum;
+        typedef std::pair<double, double> MzWidthPair;
+        typedef std::vector<MzWidthPair, ArenaAllocator<MzWidthPair> > ArenaPairs;
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        const std::string filename = dirTestdata + "/shared_data/orbi_ms1.wsv";
+        Spectrum expected;
+        loadSpectrumElements(expected, filename);
+        const std::vector<MzWidthPair> expectedWidths = measureFullWidths(get_mz, get_int, expected.begin(), expected.end(), 0.5);
+        OrbitrapPeakShapeFunction orbi(1.19781e-06);
+        std::vector<Centroid> expectedCentroids(maximalNumberOfCentroids(expected.size()));
+        expectedCentroids.erase(centroid(orbi, get_mz, get_int, expected.begin(), expected.end(), expectedCentroids.begin()), expectedCentroids.end());
+
+        Arena arena;
+        SpectrumLoader loader;
+        for(int scan = 0; scan < 3; ++scan) {
+            arena.reset();
+            ArenaSpectrum spectrum((ArenaAllocator<SpectrumElement>(arena)));
+            if(scan == 0) {
+                loadSpectrumElements(spectrum, filename);
+            }
+            else {
+                should(loader.load(filename, spectrum));
+            }
+            shouldEqual(spectrum.size(), expected.size());
+
+            ArenaPairs widths((ArenaAllocator<MzWidthPair>(arena)));
+            measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 0., widths);
+            should(std::vector<MzWidthPair>(widths.begin(), widths.end()) == expectedWidths);
+
+            std::vector<Centroid, ArenaAllocator<Centroid> > centroids(maximalNumberOfCentroids(spectrum.size()), Centroid(), ArenaAllocator<Centroid>(arena));
+            centroids.erase(centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.end(), centroids.begin()), centroids.end());
+            shouldEqual(centroids.size(), expectedCentroids.size());
+            shouldEqual(centroids.back().mz, expectedCentroids.back().mz);
+        }
+        // the scans fit into one block after the first one
+        shouldEqual(arena.numberOfBlocks(), 1u);
+    }
+
+    void testPool() {
+        ArenaPool pool(1024);
+        shouldEqual(pool.size(), 0u);
+        {
+            ArenaLease lease(pool);
+            lease.arena().allocate(100, 8);
+            shouldEqual(pool.size(), 1u);
+            ArenaLease second(pool);
+            should(&second.arena() != &lease.arena());
+            shouldEqual(pool.size(), 2u);
+        }
+        // returned arenas are reset and reused
+        {
+            ArenaLease lease(pool);
+            shouldEqual(lease.arena().bytesUsed(), 0u);
+            shouldEqual(pool.size(), 2u);
+        }
+
+        // every task computes a sum in its own arena
+        const std::size_t nTasks = 64;
+        std::vector<long> sums(nTasks);
+        parallelFor(nTasks, 4, [&pool, &sums](const std::size_t task) {
+            ArenaLease lease(pool);
+            std::vector<long, ArenaAllocator<long> > values((ArenaAllocator<long>(lease.arena())));
+            for(long i = 0; i <= static_cast<long>(task) * 100; ++i) {
+                values.push_back(i);
+            }
+            long sum = 0;
+            for(std::size_t i = 0; i < values.size(); ++i) {
+                sum += values[i];
+            }
+            sums[task] = sum;
+        });
+        for(std::size_t task = 0; task < nTasks; ++task) {
+            const long n = static_cast<long>(task) * 100;
+            shouldEqual(sums[task], n * (n + 1) / 2);
+        }
+        should(pool.size() <= 4u);
+    }
+};
+
+int main() {
+    ArenaTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
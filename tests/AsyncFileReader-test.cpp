@@ -0,0 +1,179 @@
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/AsyncFileReader.h>
+#include <psf/Error.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumBatch.h>
+
+#include "testdata.h"
+#include "testhelpers.hxx"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+namespace {
+    std::string content(const std::string& filename) {
+        std::ifstream ifs(filename.c_str(), std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+
+    std::vector<AsyncFileReader::Backend> backends() {
+        std::vector<AsyncFileReader::Backend> b(1, AsyncFileReader::threadBackend);
+        if(AsyncFileReader::ioUringAvailable()) {
+            b.push_back(AsyncFileReader::ioUringBackend);
+        }
+        return b;
+    }
+}
+
+struct AsyncFileReaderTestSuite : vigra::test_suite {
+    AsyncFileReaderTestSuite() : vigra::test_suite("AsyncFileReader") {
+        add( testCase(&AsyncFileReaderTestSuite::testBackends));
+        add( testCase(&AsyncFileReaderTestSuite::testText));
+        add( testCase(&AsyncFileReaderTestSuite::testSpectra));
+        add( testCase(&AsyncFileReaderTestSuite::testErrors));
+        add( testCase(&AsyncFileReaderTestSuite::testFailedSubmission));
+    }
+
+    void testBackends() {
+        const std::vector<std::string> none;
+        AsyncFileReader any(none);
+        shouldEqual(any.backend(), AsyncFileReader::ioUringAvailable() ? AsyncFileReader::ioUringBackend : AsyncFileReader::threadBackend);
+        AsyncFileReader threads(none, 4, AsyncFileReader::threadBackend);
+        shouldEqual(threads.backend(), AsyncFileReader::threadBackend);
+        if(!AsyncFileReader::ioUringAvailable()) {
+            bool thrown = false;
+            try {
+                AsyncFileReader uring(none, 4, AsyncFileReader::ioUringBackend);
+            } catch(const RuntimeError& e) {
+                PSF_UNUSED(e);
+                thrown = true;
+            }
+            should(thrown);
+        }
+    }
+
+    void testText() {
+        const std::string empty = "AsyncFileReader-test-empty.wsv";
+        std::ofstream(empty.c_str()).close();
+        std::vector<std::string> files = SpectrumBatch::listDirectory(dirTestdata);
+        files.insert(files.begin() + 2, empty);
+        files.push_back(files[0]);
+
+        const std::vector<AsyncFileReader::Backend> b = backends();
+        const unsigned depths[] = {1, 3, 16};
+        for(std::size_t k = 0; k < b.size(); ++k) {
+            for(int d = 0; d < 3; ++d) {
+                AsyncFileReader reader(files, depths[d], b[k]);
+                shouldEqual(reader.numberOfFiles(), files.size());
+                std::vector<char> text;
+                std::size_t i = 0;
+                bool equal = true;
+                while(reader.next(text)) {
+                    const std::string expected = content(files[i]);
+                    equal = equal && reader.filename() == files[i] && text.size() == expected.size() + 1
+                            && std::string(&text[0], expected.size()) == expected && text.back() == '\0';
+                    ++i;
+                }
+                should(equal);
+                shouldEqual(i, files.size());
+                should(!reader.next(text));
+            }
+        }
+        std::remove(empty.c_str());
+    }
+
+    void testSpectra() {
+        const std::string filename = dirTestdata + "/shared_data/orbi_ms1.wsv";
+        Spectrum expected;
+        loadSpectrumElements(expected, filename);
+        const std::vector<AsyncFileReader::Backend> b = backends();
+        for(std::size_t k = 0; k < b.size(); ++k) {
+            AsyncFileReader reader(std::vector<std::string>(20, filename), 4, b[k]);
+            Spectrum spectrum;
+            int n = 0;
+            bool equal = true;
+            while(reader.next(spectrum)) {
+                equal = equal && psftest::equal(spectrum, expected);
+                ++n;
+            }
+            shouldEqual(n, 20);
+            should(equal);
+
+            // destroyed with reads in flight
+            AsyncFileReader abandoned(std::vector<std::string>(20, filename), 8, b[k]);
+            should(abandoned.next(spectrum));
+        }
+    }
+
+    void testErrors() {
+        const std::string filename = dirTestdata + "/shared_data/orbi_ms1.wsv";
+        std::vector<std::string> files(3, filename);
+        files[1] = "AsyncFileReader-test-missing.wsv";
+        const std::vector<AsyncFileReader::Backend> b = backends();
+        for(std::size_t k = 0; k < b.size(); ++k) {
+            AsyncFileReader reader(files, 2, b[k]);
+            Spectrum spectrum;
+            should(reader.next(spectrum));
+            bool thrown = false;
+            try {
+                reader.next(spectrum);
+            } catch(const RuntimeError& e) {
+                PSF_UNUSED(e);
+                thrown = true;
+            }
+            should(thrown);
+            shouldEqual(reader.filename(), files[1]);
+            // continues with the next file
+            should(reader.next(spectrum));
+            shouldEqual(spectrum.size(), 5179u);
+            should(!reader.next(spectrum));
+        }
+    }
+
+    void testFailedSubmission() {
+        if(!AsyncFileReader::ioUringAvailable()) {
+            return;
+        }
+        // small reads, so that the files are resubmitted while completions are reaped; the
+        // first two submissions start the reader, the fifth one is a resubmission
+        const std::string filename = dirTestdata + "/shared_data/orbi_ms1.wsv";
+        const std::string expected = content(filename);
+        AsyncFileReader::injectIoUringFaults(4096, 5);
+        AsyncFileReader reader(std::vector<std::string>(4, filename), 2, AsyncFileReader::ioUringBackend);
+        AsyncFileReader::injectIoUringFaults(0, 0);
+        std::vector<char> text;
+        int failed = 0;
+        bool equal = true;
+        for(int i = 0; i < 4; ++i) {
+            try {
+                should(reader.next(text));
+                equal = equal && text.size() == expected.size() + 1 && std::string(&text[0], expected.size()) == expected;
+            } catch(const RuntimeError& e) {
+                PSF_UNUSED(e);
+                ++failed;
+            }
+        }
+        // exactly the file whose read couldn't be resubmitted fails; no completion is
+        // handled twice, so the others arrive intact
+        shouldEqual(failed, 1);
+        should(equal);
+        should(!reader.next(text));
+    }
+};
+
+int main() {
+    AsyncFileReaderTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/CalibrationCache.h>
+#include <psf/Error.h>
+#include <psf/NoiseThreshold.h>
+#include <psf/PeakParameter.h>
+#include <psf/Spectrum.h>
+
+#include "testdata.h"
+
+#include "unittest.hxx"
+
+struct CalibrationCacheTestSuite : vigra::test_suite {
+    CalibrationCacheTestSuite() : vigra::test_suite("CalibrationCache"), filename_("CalibrationCache-test.store") {
+        add( testCase(&CalibrationCacheTestSuite::testStoreAndFind));
+        add( testCase(&CalibrationCacheTestSuite::testInvalidStore));
+        add( testCase(&CalibrationCacheTestSuite::testRecord));
+        add( testCase(&CalibrationCacheTestSuite::testCalibrateWithCache));
+        add( testCase(&CalibrationCacheTestSuite::testNoiseFactor));
+    }
+
+    void testStoreAndFind() {
+        using namespace psf;
+        std::remove(filename_.c_str());
+        CalibrationRecord record;
+        record.model = "LinearSqrtModel";
+        record.regressionMethod = tukeyRegression;
+        record.parameters.push_back(1.2345678901234567e-05);
+        record.parameters.push_back(-0.001);
+        record.firstMz = 301.5;
+        record.lastMz = 1999.25;
+        record.numberOfPeaks = 652;
+        record.medianRelativeResidual = 0.0125;
+        record.medianAbsoluteRelativeResidual = 0.0625;
+        {
+            CalibrationCache cache(filename_);
+            shouldEqual(cache.size(), 0u);
+            cache.store("orbitrap-01/top10", record);
+            cache.store("tof-02", record);
+            should(cache.erase("tof-02"));
+            should(!cache.erase("tof-02"));
+        }
+
+        // a new cache reads the records back exactly
+        CalibrationCache cache(filename_);
+        shouldEqual(cache.size(), 1u);
+        CalibrationRecord found;
+        should(!cache.find("tof-02", found));
+        should(cache.find("orbitrap-01/top10", found));
+        shouldEqual(found.model, record.model);
+        shouldEqual(found.regressionMethod, record.regressionMethod);
+        shouldEqual(found.parameters.size(), 2u);
+        shouldEqual(found.parameters[0], record.parameters[0]);
+        shouldEqual(found.parameters[1], record.parameters[1]);
+        shouldEqual(found.firstMz, record.firstMz);
+        shouldEqual(found.lastMz, record.lastMz);
+        shouldEqual(found.numberOfPeaks, record.numberOfPeaks);
+        shouldEqual(found.medianRelativeResidual, record.medianRelativeResidual);
+        shouldEqual(found.medianAbsoluteRelativeResidual, record.medianAbsoluteRelativeResidual);
+
+        bool thrown = false;
+        try {
+            cache.store("with\ttab", record);
+        } catch (const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        std::remove(filename_.c_str());
+    }
+
+    void testInvalidStore() {
+        using namespace psf;
+        {
+            std::ofstream ofs(filename_.c_str());
+            ofs << "no calibration store\n";
+        }
+        bool thrown = false;
+        try {
+            CalibrationCache cache(filename_);
+        } catch (const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+
+        {
+            std::ofstream ofs(filename_.c_str());
+            ofs << "# psf calibration cache 1\nfingerprint\tConstantModel\t0\t100\n";
+        }
+        thrown = false;
+        try {
+            CalibrationCache cache(filename_);
+        } catch (const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        std::remove(filename_.c_str());
+    }
+
+    void testRecord() {
+        using namespace psf;
+        OrbitrapFwhm fwhm;
+        fwhm.setA(1e-5);
+        fwhm.setB(0.001);
+        std::vector<std::pair<double, double> > pairs;
+        pairs.push_back(std::make_pair(400., fwhm.at(400.) * 1.1));
+        pairs.push_back(std::make_pair(500., fwhm.at(500.) * 0.9));
+        pairs.push_back(std::make_pair(600., fwhm.at(600.) * 1.3));
+
+        CalibrationRecord record = makeCalibrationRecord(fwhm, pairs, 300., 700.);
+        shouldEqual(record.model, std::string("LinearSqrtModel"));
+        shouldEqual(record.numberOfPeaks, 3u);
+        shouldEqualTolerance(record.medianRelativeResidual, 0.1, 1e-12);
+        shouldEqualTolerance(record.medianAbsoluteRelativeResidual, 0.1, 1e-12);
+
+        OrbitrapFwhm applied;
+        applyCalibrationRecord(record, applied);
+        shouldEqual(applied.getA(), fwhm.getA());
+        shouldEqual(applied.getB(), fwhm.getB());
+
+        ConstantFwhm other;
+        bool thrown = false;
+        try {
+            applyCalibrationRecord(record, other);
+        } catch (const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testCalibrateWithCache() {
+        using namespace psf;
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        Spectrum spectrum;
+        loadSpectrumElements(spectrum, dirTestdata + "/shared_data/orbi_ms1.wsv");
+        std::remove(filename_.c_str());
+        CalibrationCache cache(filename_);
+
+        OrbitrapWithOriginFwhm direct;
+        direct.setRegressionMethod(tukeyRegression);
+        direct.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+
+        // nothing cached yet
+        OrbitrapWithOriginFwhm fwhm;
+        fwhm.setRegressionMethod(tukeyRegression);
+        shouldEqual(calibrateWithCache(cache, "orbi", fwhm, get_mz, get_int, spectrum.begin(), spectrum.end()), calibrationLearned);
+        shouldEqual(fwhm.getA(), direct.getA());
+        shouldEqual(cache.size(), 1u);
+
+        // the same spectrum fits the cached calibration
+        OrbitrapWithOriginFwhm reused;
+        reused.setRegressionMethod(tukeyRegression);
+        shouldEqual(calibrateWithCache(cache, "orbi", reused, get_mz, get_int, spectrum.begin(), spectrum.end()), calibrationReused);
+        shouldEqual(reused.getA(), direct.getA());
+
+        // a changed resolution doesn't fit
+        CalibrationRecord record;
+        should(cache.find("orbi", record));
+        record.parameters[0] *= 1.5;
+        cache.store("orbi", record);
+        OrbitrapWithOriginFwhm relearned;
+        relearned.setRegressionMethod(tukeyRegression);
+        shouldEqual(calibrateWithCache(cache, "orbi", relearned, get_mz, get_int, spectrum.begin(), spectrum.end()), calibrationRelearned);
+        shouldEqual(relearned.getA(), direct.getA());
+        should(cache.find("orbi", record));
+        shouldEqual(record.parameters[0], direct.getA());
+
+        // neither does a spectrum far outside of the cached m/z range
+        Spectrum shifted(spectrum);
+        for(Spectrum::iterator it = shifted.begin(); it != shifted.end(); ++it) {
+            it->mz *= 4.;
+        }
+        OrbitrapWithOriginFwhm moved;
+        moved.setA(record.parameters[0]);
+        shouldEqual(calibrateWithCache(cache, "orbi", moved, get_mz, get_int, shifted.begin(), shifted.end()), calibrationRelearned);
+
+        // a record of another model is not usable
+        ConstantFwhm constant;
+        shouldEqual(calibrateWithCache(cache, "orbi", constant, get_mz, get_int, spectrum.begin(), spectrum.end()), calibrationLearned);
+        should(cache.find("orbi", record));
+        shouldEqual(record.model, std::string("ConstantModel"));
+
+        bool thrown = false;
+        try {
+            calibrateWithCache(cache, "orbi", constant, get_mz, get_int, spectrum.begin(), spectrum.end(), 0.);
+        } catch (const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        std::remove(filename_.c_str());
+    }
+
+    void testNoiseFactor() {
+        using namespace psf;
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        Spectrum spectrum;
+        loadSpectrumElements(spectrum, dirTestdata + "/shared_data/orbi_ms1.wsv");
+        // noise bumps between and on top of the peaks
+        std::vector<double> intensities;
+        for(Spectrum::const_iterator it = spectrum.begin(); it != spectrum.end(); ++it) {
+            intensities.push_back(it->intensity);
+        }
+        std::nth_element(intensities.begin(), intensities.begin() + intensities.size() / 2, intensities.end());
+        const double level = intensities[intensities.size() / 2];
+        std::mt19937 random(7);
+        std::uniform_real_distribution<double> noise(0., level);
+        for(Spectrum::iterator it = spectrum.begin(); it != spectrum.end(); ++it) {
+            it->intensity += noise(random);
+        }
+        std::remove(filename_.c_str());
+        CalibrationCache cache(filename_);
+
+        // the sample is measured above the same noise threshold as the peaks learned from,
+        // so the spectrum fits its own record
+        OrbitrapWithOriginFwhm fwhm;
+        fwhm.setRegressionMethod(tukeyRegression);
+        fwhm.setNoiseFactorToLearnFrom(3.);
+        shouldEqual(calibrateWithCache(cache, "noisy", fwhm, get_mz, get_int, spectrum.begin(), spectrum.end()), calibrationLearned);
+        OrbitrapWithOriginFwhm reused;
+        reused.setRegressionMethod(tukeyRegression);
+        reused.setNoiseFactorToLearnFrom(3.);
+        shouldEqual(calibrateWithCache(cache, "noisy", reused, get_mz, get_int, spectrum.begin(), spectrum.end()), calibrationReused);
+        shouldEqual(reused.getA(), fwhm.getA());
+
+        // the threshold is the minimal peak height without a noise factor
+        OrbitrapWithOriginFwhm plain;
+        plain.setMinimalPeakHeightToLearnFrom(5.);
+        const NoiseThreshold threshold = plain.thresholdToLearnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+        shouldEqual(threshold.numberOfWindows(), 0u);
+        shouldEqual(threshold.at(500.), 5.);
+        should(fwhm.thresholdToLearnFrom(get_mz, get_int, spectrum.begin(), spectrum.end()).numberOfWindows() > 0);
+        std::remove(filename_.c_str());
+    }
+
+    const std::string filename_;
+};
+
+int main()
+{
+    CalibrationCacheTestSuite test;
+    int failed = test.run();
+    std::cout << test.report() << std::endl;
+    return failed;
+}
@@ -0,0 +1,141 @@
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Centroid.h>
+#include <psf/Error.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/Spectrum.h>
+
+#include "testdata.h"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct CentroidTestSuite : vigra::test_suite {
+    CentroidTestSuite() : vigra::test_suite("Centroid") {
+        add( testCase(&CentroidTestSuite::testGaussianThreePoint));
+        add( testCase(&CentroidTestSuite::testPeakShapeFit));
+        add( testCase(&CentroidTestSuite::testMinimalPeakHeight));
+        add( testCase(&CentroidTestSuite::testOrbitrapSpectrum));
+    }
+
+    // Noise free Orbitrap peaks on a uniform grid; the apexes are between grid points.
+    Spectrum profile(const OrbitrapPeakShapeFunction& orbi) {
+        Spectrum spectrum;
+        for(double mz = 399.; mz < 405.; mz += 0.002) {
+            const double intensity = 1000. * orbi(400.0123, mz) + 250. * orbi(402.5071, mz) + 1e-3;
+            spectrum.push_back(SpectrumElement(mz, intensity));
+        }
+        return spectrum;
+    }
+
+    void checkPeaks(const std::vector<Centroid>& centroids, const OrbitrapPeakShapeFunction& orbi, const double tolerance) {
+        shouldEqual(centroids.size(), 2u);
+        shouldEqualTolerance(centroids[0].mz, 400.0123, tolerance);
+        shouldEqualTolerance(centroids[0].intensity, 1000., tolerance * 400.);
+        shouldEqualTolerance(centroids[1].mz, 402.5071, tolerance);
+        shouldEqualTolerance(centroids[1].intensity, 250., tolerance * 400.);
+
+        // integral of a gaussian within +/- 3 sigma
+        const double sigma = orbi.getSupportThreshold(400.0123) / 3.;
+        shouldEqualTolerance(centroids[0].area, 1000. * sigma * std::sqrt(2. * M_PI) * 0.9973, 1e-3);
+    }
+
+    void testGaussianThreePoint() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        OrbitrapPeakShapeFunction orbi(1.19781e-05);
+        Spectrum spectrum = profile(orbi);
+
+        std::vector<Centroid> centroids(maximalNumberOfCentroids(spectrum.size()));
+        std::vector<Centroid>::iterator end = centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.end(), centroids.begin());
+        centroids.erase(end, centroids.end());
+        // the small offset of the baseline disturbs the logarithms a little
+        checkPeaks(centroids, orbi, 1e-7);
+    }
+
+    void testPeakShapeFit() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        OrbitrapPeakShapeFunction orbi(1.19781e-05);
+        Spectrum spectrum = profile(orbi);
+
+        std::vector<Centroid> centroids;
+        centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.end(), std::back_inserter(centroids), peakShapeFit);
+        checkPeaks(centroids, orbi, 1e-7);
+
+        // disturbed neighbours of the top shift the three point estimate, but hardly the fit
+        spectrum = profile(orbi);
+        std::size_t top = 0;
+        for(std::size_t i = 0; spectrum[i].mz < 401.; ++i) {
+            if(spectrum[i].intensity > spectrum[top].intensity) {
+                top = i;
+            }
+        }
+        spectrum[top - 1].intensity *= 1.002;
+        spectrum[top + 1].intensity *= 0.998;
+        std::vector<Centroid> fitted, threePoint;
+        centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.end(), std::back_inserter(fitted), peakShapeFit);
+        centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.end(), std::back_inserter(threePoint), gaussianThreePoint);
+        shouldEqual(fitted.size(), 2u);
+        shouldEqual(threePoint.size(), 2u);
+        should(std::abs(fitted[0].mz - 400.0123) < 0.5 * std::abs(threePoint[0].mz - 400.0123));
+    }
+
+    void testMinimalPeakHeight() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        OrbitrapPeakShapeFunction orbi(1.19781e-05);
+        Spectrum spectrum = profile(orbi);
+
+        Centroid centroids[4];
+        shouldEqual(centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.end(), centroids, gaussianThreePoint, 500.) - centroids, 1);
+        shouldEqualTolerance(centroids[0].mz, 400.0123, 1e-7);
+        shouldEqual(centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.end(), centroids, gaussianThreePoint, 2000.) - centroids, 0);
+        shouldEqual(centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.begin() + 2, centroids) - centroids, 0);
+        shouldEqual(maximalNumberOfCentroids(2), 0u);
+        shouldEqual(maximalNumberOfCentroids(5), 2u);
+    }
+
+    void testOrbitrapSpectrum() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        Spectrum spectrum;
+        loadSpectrumElements(spectrum, dirTestdata + "/shared_data/orbi_ms1.wsv");
+        OrbitrapPeakShapeFunction orbi(1.19781e-05);
+
+        // one centroid per bump
+        std::size_t nBumps = 0;
+        LessByExtractor<SpectrumElement, IntensityExtractor> comp(get_int);
+        for(Spectrum::iterator start = spectrum.begin(); start < spectrum.end(); ) {
+            std::pair<Spectrum::iterator, Spectrum::iterator> bump = findBump(start, spectrum.end(), comp);
+            if(bump.first == spectrum.end()) {
+                break;
+            }
+            ++nBumps;
+            start = bump.second;
+        }
+        const ApexInterpolation interpolations[] = {gaussianThreePoint, peakShapeFit};
+        for(int m = 0; m < 2; ++m) {
+            std::vector<Centroid> centroids(maximalNumberOfCentroids(spectrum.size()));
+            centroids.erase(centroid(orbi, get_mz, get_int, spectrum.begin(), spectrum.end(), centroids.begin(), interpolations[m]), centroids.end());
+            shouldEqual(centroids.size(), nBumps);
+            for(std::size_t c = 1; c < centroids.size(); ++c) {
+                should(centroids[c - 1].mz < centroids[c].mz);
+                should(centroids[c].area >= 0.);
+            }
+        }
+    }
+};
+
+int main()
+{
+    CentroidTestSuite test;
+    int failed = test.run();
+    std::cout << test.report() << std::endl;
+    return failed;
+}
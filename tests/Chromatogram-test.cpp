@@ -0,0 +1,165 @@
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Chromatogram.h>
+#include <psf/Error.h>
+#include <psf/LcmsRun.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/Spectrum.h>
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct ChromatogramTestSuite : vigra::test_suite {
+    ChromatogramTestSuite() : vigra::test_suite("Chromatogram") {
+        add( testCase(&ChromatogramTestSuite::testTolerances));
+        add( testCase(&ChromatogramTestSuite::testPeakShapeFunction));
+        add( testCase(&ChromatogramTestSuite::testRandom));
+        add( testCase(&ChromatogramTestSuite::testPreconditions));
+    }
+
+    // The sum of the intensities in [target - tolerance, target + tolerance].
+    static double bruteForce(const Spectrum& s, const double target, const double tolerance) {
+        double sum = 0.;
+        for(std::size_t i = 0; i < s.size(); ++i) {
+            if(s[i].mz >= target - tolerance && s[i].mz <= target + tolerance) {
+                sum += s[i].intensity;
+            }
+        }
+        return sum;
+    }
+
+    void testTolerances() {
+        // overlapping windows around 200 and a window beyond the last element
+        std::vector<double> targets, tolerances;
+        targets.push_back(500.);
+        tolerances.push_back(0.1);
+        targets.push_back(200.);
+        tolerances.push_back(0.02);
+        targets.push_back(200.05);
+        tolerances.push_back(0.1);
+        targets.push_back(900.);
+        tolerances.push_back(1.);
+        IonChromatograms xics(targets, tolerances);
+        shouldEqual(xics.numberOfTargets(), 4u);
+        shouldEqual(xics.numberOfScans(), 0u);
+        shouldEqual(xics.target(1), 200.);
+        shouldEqualTolerance(xics.lowerMz(2), 199.95, 1e-12);
+        shouldEqualTolerance(xics.upperMz(0), 500.1, 1e-12);
+
+        Spectrum s;
+        s.push_back(SpectrumElement(199.97, 1.));
+        s.push_back(SpectrumElement(200., 2.));
+        s.push_back(SpectrumElement(200.1, 4.));
+        s.push_back(SpectrumElement(499.95, 8.));
+        s.push_back(SpectrumElement(500.2, 16.));
+        LcmsRun run;
+        run.add(1., s.begin(), s.end());
+        run.add(2., s.begin(), s.begin());
+        run.add(3., s.begin() + 2, s.end());
+        xics.extract(MzExtractor(), IntensityExtractor(), run, 2);
+        shouldEqual(xics.numberOfScans(), 3u);
+        shouldEqual(xics.intensity(0, 0), 8.);
+        shouldEqual(xics.intensity(1, 0), 2.);
+        shouldEqual(xics.intensity(2, 0), 7.);
+        shouldEqual(xics.intensity(3, 0), 0.);
+        for(std::size_t t = 0; t < 4; ++t) {
+            shouldEqual(xics.scan(1)[t], 0.);
+        }
+        shouldEqual(xics.intensity(1, 2), 0.);
+        shouldEqual(xics.intensity(2, 2), 4.);
+
+        std::vector<double> xic;
+        xics.chromatogram(0, xic);
+        shouldEqual(xic.size(), 3u);
+        shouldEqual(xic[0], 8.);
+        shouldEqual(xic[1], 0.);
+        shouldEqual(xic[2], 8.);
+    }
+
+    void testPeakShapeFunction() {
+        OrbitrapPeakShapeFunction orbi(1.19781e-05);
+        std::vector<double> targets;
+        targets.push_back(1200.);
+        targets.push_back(400.);
+        IonChromatograms xics(orbi, targets);
+        for(std::size_t t = 0; t < 2; ++t) {
+            shouldEqualTolerance(xics.upperMz(t) - targets[t], orbi.getSupportThreshold(targets[t]), 1e-12);
+            shouldEqualTolerance(targets[t] - xics.lowerMz(t), orbi.getSupportThreshold(targets[t]), 1e-12);
+        }
+        // the window grows with the peak width
+        should(xics.upperMz(0) - xics.lowerMz(0) > xics.upperMz(1) - xics.lowerMz(1));
+    }
+
+    void testRandom() {
+        std::srand(7);
+        LcmsRun run;
+        std::vector<Spectrum> scans(50);
+        for(std::size_t i = 0; i < scans.size(); ++i) {
+            double mz = 100.;
+            for(int j = 0; j < 500; ++j) {
+                mz += 2. * std::rand() / RAND_MAX;
+                scans[i].push_back(SpectrumElement(mz, 1 + std::rand() % 100));
+            }
+            run.add(i, scans[i].begin(), scans[i].end());
+        }
+        std::vector<double> targets, tolerances;
+        for(int t = 0; t < 300; ++t) {
+            targets.push_back(90. + 600. * std::rand() / RAND_MAX);
+            tolerances.push_back(3. * std::rand() / RAND_MAX);
+        }
+        IonChromatograms xics(targets, tolerances);
+        xics.extract(MzExtractor(), IntensityExtractor(), run, 3);
+        bool same = true;
+        for(std::size_t i = 0; i < scans.size(); ++i) {
+            for(std::size_t t = 0; t < targets.size(); ++t) {
+                same = same && xics.intensity(t, i) == bruteForce(scans[i], targets[t], tolerances[t]);
+            }
+        }
+        should(same);
+    }
+
+    void testPreconditions() {
+        bool thrown = false;
+        try {
+            IonChromatograms xics(std::vector<double>(2, 100.), std::vector<double>(1, 0.1));
+        } catch(const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        thrown = false;
+        try {
+            IonChromatograms xics(std::vector<double>(1, 100.), std::vector<double>(1, -0.1));
+        } catch(const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        thrown = false;
+        try {
+            IonChromatograms xics(OrbitrapPeakShapeFunction(), std::vector<double>(1, -100.));
+        } catch(const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+
+        const std::vector<double> empty;
+        IonChromatograms none(empty, empty);
+        LcmsRun run;
+        none.extract(MzExtractor(), IntensityExtractor(), run);
+        shouldEqual(none.numberOfScans(), 0u);
+    }
+};
+
+int main() {
+    ChromatogramTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
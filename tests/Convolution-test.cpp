@@ -0,0 +1,217 @@
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <psf/Convolution.h>
+#include <psf/Error.h>
+#include <psf/Fft.h>
+#include <psf/Log.h>
+#include <psf/PeakShapeFunction.h>
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct FftTestSuite : vigra::test_suite {
+    FftTestSuite() : vigra::test_suite("Fft") {
+        add( testCase(&FftTestSuite::testNextPowerOfTwo));
+        add( testCase(&FftTestSuite::testFft));
+        add( testCase(&FftTestSuite::testConvolve));
+    }
+
+    void testNextPowerOfTwo() {
+        shouldEqual(nextPowerOfTwo(0), (std::size_t)1);
+        shouldEqual(nextPowerOfTwo(1), (std::size_t)1);
+        shouldEqual(nextPowerOfTwo(2), (std::size_t)2);
+        shouldEqual(nextPowerOfTwo(3), (std::size_t)4);
+        shouldEqual(nextPowerOfTwo(1000), (std::size_t)1024);
+        shouldEqual(nextPowerOfTwo(1024), (std::size_t)1024);
+    }
+
+    void testFft() {
+        typedef std::complex<double> Complex;
+        const double pi = 3.14159265358979323846;
+
+        // compare with a naive DFT
+        std::vector<Complex> data(16);
+        for(std::size_t i = 0; i < data.size(); ++i) {
+            data[i] = Complex(std::sin(0.3 * i) + i, 0.5 * i - 2.);
+        }
+        std::vector<Complex> original(data);
+        fft(data);
+        for(std::size_t k = 0; k < data.size(); ++k) {
+            Complex expected(0., 0.);
+            for(std::size_t j = 0; j < original.size(); ++j) {
+                expected += original[j] * std::polar(1., -2 * pi * j * k / original.size());
+            }
+            shouldEqualTolerance(data[k].real(), expected.real(), 1e-10);
+            shouldEqualTolerance(data[k].imag(), expected.imag(), 1e-10);
+        }
+
+        // inverse transform reproduces the input
+        fft(data, true);
+        for(std::size_t i = 0; i < data.size(); ++i) {
+            shouldEqualTolerance(data[i].real(), original[i].real(), 1e-12);
+            shouldEqualTolerance(data[i].imag(), original[i].imag(), 1e-12);
+        }
+
+        // size has to be a power of two
+        std::vector<Complex> illegal(12);
+        bool thrown = false;
+        try {
+            fft(illegal);
+        }
+        catch(const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testConvolve() {
+        double a[] = {1., 2., 3.};
+        double b[] = {0., 1., 0.5, 4., -1.};
+        std::vector<double> va(a, a + 3), vb(b, b + 5), result;
+
+        convolve(va, vb, result);
+        shouldEqual(result.size(), (std::size_t)7);
+        double expected[] = {0., 1., 2.5, 8., 8.5, 10., -3.};
+        for(std::size_t i = 0; i < 7; ++i) {
+            shouldEqualTolerance(result[i] + 1., expected[i] + 1., 1e-12);
+        }
+
+        // empty input
+        std::vector<double> empty;
+        convolve(va, empty, result);
+        should(result.empty());
+    }
+};
+
+struct ConvolutionTestSuite : vigra::test_suite {
+    ConvolutionTestSuite() : vigra::test_suite("Convolution") {
+        add( testCase(&ConvolutionTestSuite::testConstantWidth));
+        add( testCase(&ConvolutionTestSuite::testMassDependentWidth));
+        add( testCase(&ConvolutionTestSuite::testPreconditions));
+    }
+
+    // a sparse profile with some peaks and zero gaps
+    std::vector<double> someProfile(std::size_t n) {
+        std::srand(7);
+        std::vector<double> profile(n, 0.);
+        for(std::size_t i = 0; i < n; i += 1 + std::rand() % 40) {
+            profile[i] = std::rand() % 100;
+        }
+        return profile;
+    }
+
+    template< typename PeakShapeFunction >
+    void naiveFilter(const PeakShapeFunction& function, const std::vector<double>& x, double firstMz, double mzStep, std::vector<double>& y, bool correlate) {
+        y.assign(x.size(), 0.);
+        for(std::size_t i = 0; i < x.size(); ++i) {
+            for(std::size_t j = 0; j < x.size(); ++j) {
+                const double mzi = firstMz + i * mzStep;
+                const double mzj = firstMz + j * mzStep;
+                y[i] += x[j] * (correlate ? function(mzi, mzj) : function(mzj, mzi));
+            }
+        }
+    }
+
+    void testConstantWidth() {
+        GaussianPeakShapeFunction gauss(0.05);
+        const double firstMz = 400.;
+        const double mzStep = 0.002;
+        std::vector<double> x = someProfile(700);
+        std::vector<double> expected, direct(x.size()), viaFft(x.size()), automatic(x.size());
+
+        naiveFilter(gauss, x, firstMz, mzStep, expected, false);
+        convolveOnUniformGrid(gauss, x.begin(), x.end(), firstMz, mzStep, direct.begin(), directConvolution);
+        convolveOnUniformGrid(gauss, x.begin(), x.end(), firstMz, mzStep, viaFft.begin(), fftConvolution);
+        convolveOnUniformGrid(gauss, x.begin(), x.end(), firstMz, mzStep, automatic.begin());
+        for(std::size_t i = 0; i < x.size(); ++i) {
+            shouldEqualTolerance(direct[i], expected[i], 1e-10);
+            shouldEqualTolerance(viaFft[i] + 1., expected[i] + 1., 1e-10);
+            shouldEqualTolerance(automatic[i] + 1., expected[i] + 1., 1e-10);
+        }
+
+        naiveFilter(gauss, x, firstMz, mzStep, expected, true);
+        correlateOnUniformGrid(gauss, x.begin(), x.end(), firstMz, mzStep, direct.begin(), directConvolution);
+        correlateOnUniformGrid(gauss, x.begin(), x.end(), firstMz, mzStep, viaFft.begin(), fftConvolution);
+        for(std::size_t i = 0; i < x.size(); ++i) {
+            shouldEqualTolerance(direct[i], expected[i], 1e-10);
+            shouldEqualTolerance(viaFft[i] + 1., expected[i] + 1., 1e-10);
+        }
+    }
+
+    void testMassDependentWidth() {
+        // a strongly mass-dependent width to get many blocks
+        OrbitrapPeakShapeFunction orbi(5e-06);
+        const double firstMz = 300.;
+        const double mzStep = 0.01;
+        std::vector<double> x = someProfile(1500);
+        std::vector<double> expected, direct(x.size()), viaFft(x.size());
+
+        // the direct path is exact
+        naiveFilter(orbi, x, firstMz, mzStep, expected, false);
+        convolveOnUniformGrid(orbi, x.begin(), x.end(), firstMz, mzStep, direct.begin(), directConvolution);
+        for(std::size_t i = 0; i < x.size(); ++i) {
+            shouldEqualTolerance(direct[i], expected[i], 1e-10);
+        }
+
+        // piecewise-constant widths are close
+        double maxIntensity = 0., maxDeviation = 0.;
+        convolveOnUniformGrid(orbi, x.begin(), x.end(), firstMz, mzStep, viaFft.begin(), fftConvolution, 64, 0.005);
+        for(std::size_t i = 0; i < x.size(); ++i) {
+            maxIntensity = std::max(maxIntensity, expected[i]);
+            maxDeviation = std::max(maxDeviation, std::fabs(viaFft[i] - expected[i]));
+        }
+        should(maxDeviation < 0.02 * maxIntensity);
+
+        naiveFilter(orbi, x, firstMz, mzStep, expected, true);
+        correlateOnUniformGrid(orbi, x.begin(), x.end(), firstMz, mzStep, direct.begin(), directConvolution);
+        for(std::size_t i = 0; i < x.size(); ++i) {
+            shouldEqualTolerance(direct[i], expected[i], 1e-10);
+        }
+    }
+
+    void testPreconditions() {
+        GaussianPeakShapeFunction gauss(0.05);
+        std::vector<double> x(10, 1.), y(10);
+        bool thrown = false;
+        try {
+            convolveOnUniformGrid(gauss, x.begin(), x.end(), 400., 0., y.begin());
+        }
+        catch(const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        thrown = false;
+
+        try {
+            correlateOnUniformGrid(gauss, x.begin(), x.end(), -1., 0.1, y.begin());
+        }
+        catch(const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+
+        // empty input
+        convolveOnUniformGrid(gauss, x.begin(), x.begin(), 400., 0.1, y.begin());
+    }
+};
+
+int main()
+{
+    FftTestSuite test1;
+    int failed = test1.run();
+    std::cout << test1.report() << std::endl;
+
+    ConvolutionTestSuite test2;
+    failed += test2.run();
+    std::cout << test2.report() << std::endl;
+
+    return failed;
+}
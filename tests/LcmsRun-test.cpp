@@ -0,0 +1,213 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Error.h>
+#include <psf/LcmsRun.h>
+#include <psf/PeakParameter.h>
+#include <psf/ScanIndex.h>
+#include <psf/Spectrum.h>
+
+#include "testdata.h"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct LcmsRunTestSuite : vigra::test_suite {
+    LcmsRunTestSuite() : vigra::test_suite("LcmsRun"), wsv_("LcmsRun-test.wsv") {
+        add( testCase(&LcmsRunTestSuite::testAdd));
+        add( testCase(&LcmsRunTestSuite::testLoad));
+        add( testCase(&LcmsRunTestSuite::testDriftModel));
+        add( testCase(&LcmsRunTestSuite::testFwhmDrift));
+    }
+
+    // The Orbitrap parameter a drifting by half over the run.
+    static double truth(const double rt) {
+        return 2e-6 * (1. + rt / 1200.);
+    }
+
+    // Gaussian peaks every 25 m/z between 300 and 1500 with widths a * mz^1.5, times
+    // widthFactor, and multiplicative noise.
+    static Spectrum gaussians(const double a, const double widthFactor, const unsigned seed) {
+        std::srand(seed);
+        Spectrum s;
+        for(double center = 300.; center < 1500.; center += 25.) {
+            const double sigma = widthFactor * a * center * std::sqrt(center) / 2.3548;
+            const double height = 1000. + std::rand() % 10000;
+            for(double mz = center - 4 * sigma; mz < center + 4 * sigma; mz += sigma / 8) {
+                const double noise = 1. + 0.02 * (2. * std::rand() / RAND_MAX - 1.);
+                s.push_back(SpectrumElement(mz, height * std::exp(-(mz - center) * (mz - center) / (2 * sigma * sigma)) * noise));
+            }
+        }
+        return s;
+    }
+
+    void testAdd() {
+        LcmsRun run;
+        shouldEqual(run.size(), 0u);
+        shouldEqual(run.numberOfElements(), 0u);
+        shouldEqual(run.findRetentionTime(1.), 0u);
+
+        Spectrum s;
+        s.push_back(SpectrumElement(100., 1.));
+        s.push_back(SpectrumElement(200., 2.));
+        run.add(10., s.begin(), s.end(), 7, 1);
+        run.add(10., s.begin(), s.begin(), 8, 2);
+        run.add(20., s.begin() + 1, s.end());
+        shouldEqual(run.size(), 3u);
+        shouldEqual(run.numberOfElements(), 3u);
+        shouldEqual(run.end(0) - run.begin(0), 2);
+        should(run.begin(1) == run.end(1));
+        shouldEqual(run.begin(2)->mz, 200.);
+        shouldEqual(run.scanNumber(1), 8);
+        shouldEqual(run.msLevel(1), 2);
+        shouldEqual(run.retentionTime(2), 20.);
+        shouldEqual(run.findRetentionTime(10.), 0u);
+        shouldEqual(run.findRetentionTime(15.), 2u);
+        shouldEqual(run.findRetentionTime(21.), 3u);
+
+        bool thrown = false;
+        try {
+            run.add(5., s.begin(), s.end());
+        } catch(const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        shouldEqual(run.size(), 3u);
+
+        run.clear();
+        shouldEqual(run.size(), 0u);
+        shouldEqual(run.numberOfElements(), 0u);
+    }
+
+    void testLoad() {
+        // descending retention times, alternating MS levels
+        {
+            std::ofstream ofs(wsv_.c_str());
+            for(int i = 0; i < 4; ++i) {
+                ofs << "# scan=" << 100 + i << " rt=" << 10. * (4 - i) << " level=" << 1 + i % 2 << "\n";
+                ofs << 100. + i << " " << 1. + i << "\n";
+            }
+        }
+        LcmsRun run;
+        run.load(wsv_);
+        shouldEqual(run.size(), 4u);
+        for(int i = 0; i < 4; ++i) {
+            shouldEqual(run.retentionTime(i), 10. * (1 + i));
+            shouldEqual(run.scanNumber(i), 103 - i);
+            shouldEqual(run.end(i) - run.begin(i), 1);
+            shouldEqual(run.begin(i)->mz, 103. - i);
+        }
+        run.load(wsv_, 2);
+        shouldEqual(run.size(), 2u);
+        shouldEqual(run.scanNumber(0), 103);
+        shouldEqual(run.scanNumber(1), 101);
+        std::remove(wsv_.c_str());
+        std::remove(ScanIndex::sidecarFilename(wsv_).c_str());
+
+        bool thrown = false;
+        try {
+            run.load("LcmsRun-test-missing.wsv");
+        } catch(const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        shouldEqual(run.size(), 0u);
+    }
+
+    void testDriftModel() {
+        // a smooth curve, a gross outlier and samples out of order
+        std::vector<double> rts, values;
+        for(int j = 20; j >= 0; --j) {
+            const double rt = 30. * j;
+            rts.push_back(rt);
+            values.push_back(1. + 0.001 * rt + 0.01 * std::sin(0.7 * j));
+            values.push_back(j == 10 ? 50. : -2.);
+        }
+        DriftModel model;
+        should(model.empty());
+        model.fit(rts, values, 2, 0.4, 101);
+        shouldEqual(model.dimension(), 2u);
+        shouldEqual(model.firstRetentionTime(), 0.);
+        shouldEqual(model.lastRetentionTime(), 600.);
+        for(double rt = 0.; rt <= 600.; rt += 7.) {
+            shouldEqualTolerance(model.at(rt, 0u), 1. + 0.001 * rt, 0.02);
+            shouldEqualTolerance(model.at(rt, 1u), -2., 1e-9);
+        }
+        double both[2];
+        model.at(300., both);
+        shouldEqual(both[0], model.at(300., 0u));
+        shouldEqual(both[1], model.at(300., 1u));
+        // constant outside of the samples
+        shouldEqual(model.at(-100., 0u), model.at(0., 0u));
+        shouldEqual(model.at(1e9, 0u), model.at(600., 0u));
+
+        // a single sample is a constant
+        model.fit(std::vector<double>(1, 5.), std::vector<double>(1, 3.), 1);
+        shouldEqual(model.at(0., 0u), 3.);
+        shouldEqual(model.at(5., 0u), 3.);
+        shouldEqual(model.at(9., 0u), 3.);
+
+        bool thrown = false;
+        try {
+            model.fit(std::vector<double>(2, 5.), std::vector<double>(3, 3.), 1);
+        } catch(const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testFwhmDrift() {
+        // 60 scans 10 s apart; of the 15 scans calibrated, scan 10 is empty and scan 30 has
+        // three times the widths
+        LcmsRun run;
+        for(int i = 0; i < 60; ++i) {
+            const double rt = 10. * i;
+            const Spectrum s = i == 10 ? Spectrum() : gaussians(truth(rt), i == 30 ? 3. : 1., i);
+            run.add(rt, s.begin(), s.end(), i + 1, 1);
+        }
+
+        FwhmDrift<LinearSqrtOriginModel> drift;
+        drift.setSpan(0.6);
+        shouldEqual(drift.calibrate(MzExtractor(), IntensityExtractor(), run, 15, 1, 2), 14u);
+        shouldEqual(drift.sampleRetentionTimes().size(), 14u);
+        shouldEqual(drift.sampleParameters().size(), 14u);
+        OrbitrapWithOriginFwhm fwhm;
+        for(std::size_t i = 0; i < run.size(); ++i) {
+            drift.at(run.retentionTime(i), fwhm);
+            shouldEqualTolerance(fwhm.getParameter(0) / truth(run.retentionTime(i)), 1., 0.03);
+        }
+        shouldEqual(drift.at(300.).getParameter(0), drift.model().at(300., 0u));
+
+        // nothing to learn from
+        LcmsRun empty;
+        empty.add(0., run.begin(10), run.end(10));
+        bool thrown = false;
+        try {
+            drift.calibrate(MzExtractor(), IntensityExtractor(), empty);
+        } catch(const Starvation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    const std::string wsv_;
+};
+
+int main() {
+    LcmsRunTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
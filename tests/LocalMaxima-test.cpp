@@ -0,0 +1,125 @@
+#include <functional>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Error.h>
+#include <psf/LocalMaxima.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumAlgorithm.h>
+
+#include "testdata.h"
+
+#include "unittest.hxx"
+
+struct LocalMaximaTestSuite : vigra::test_suite {
+    LocalMaximaTestSuite() : vigra::test_suite("LocalMaxima") {
+        add( testCase(&LocalMaximaTestSuite::testMask));
+        add( testCase(&LocalMaximaTestSuite::testFindBumps));
+        add( testCase(&LocalMaximaTestSuite::testMeasureFullWidths));
+    }
+
+    // few distinct values: many plateaus
+    static std::vector<double> plateaus(const std::size_t n) {
+        std::vector<double> values;
+        unsigned state = 7;
+        for(std::size_t i = 0; i < n; ++i) {
+            state = state * 1103515245u + 12345u;
+            values.push_back(static_cast<double>((state >> 16) % 4));
+        }
+        return values;
+    }
+
+    void testMask() {
+        psf::LocalMaximaMask mask;
+        shouldEqual(mask.size(), 0u);
+        shouldEqual(mask.next(0), 0u);
+
+        // sizes around the word borders
+        const std::size_t sizes[] = {1, 2, 3, 63, 64, 65, 66, 127, 128, 129, 1000};
+        for(std::size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+            const std::vector<double> x = plateaus(sizes[s]);
+            mask.assign(&x[0], x.size());
+            shouldEqual(mask.size(), x.size());
+            std::size_t expectedCount = 0;
+            for(std::size_t i = 0; i < x.size(); ++i) {
+                const bool expected = i > 0 && i + 1 < x.size() && x[i - 1] < x[i] && x[i + 1] < x[i];
+                shouldEqual(mask.test(i), expected);
+                if(expected) {
+                    shouldEqual(mask.next(i), i);
+                    ++expectedCount;
+                }
+            }
+            shouldEqual(mask.count(), expectedCount);
+        }
+
+        // reassigning resets the mask
+        double single[] = {1., 3., 1.};
+        mask.assign(single, 3);
+        shouldEqual(mask.count(), 1u);
+        shouldEqual(mask.next(0), 1u);
+        shouldEqual(mask.next(2), 3u);
+
+        bool thrown = false;
+        try {
+            mask.test(3);
+        } catch(const psf::PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testFindBumps() {
+        const std::vector<double> x = plateaus(5000);
+        const double* first = &x[0];
+        const double* last = first + x.size();
+        psf::LocalMaximaMask mask;
+        mask.assign(first, x.size());
+        should(psf::findBumps(first, last, std::less<double>(), mask) == psf::findBumps(first, last, std::less<double>()));
+
+        double twoBumps[] = {100, 81, 56, 56, 57, 69, 40, 13, 13, 9, 18, 21, 19, 15, 16, 19, 19, 18, 12, 11, 17, 22, 47};
+        mask.assign(twoBumps, 23);
+        std::vector<std::pair<double*, double*> > bumps = psf::findBumps(twoBumps, twoBumps + 23, std::less<double>(), mask);
+        shouldEqual(bumps.size(), 2u);
+        should(bumps[0] == std::make_pair(twoBumps + 3, twoBumps + 7));
+        should(bumps[1] == std::make_pair(twoBumps + 9, twoBumps + 13));
+
+        bool thrown = false;
+        try {
+            psf::findBumps(twoBumps, twoBumps + 22, std::less<double>(), mask);
+        } catch(const psf::PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testMeasureFullWidths() {
+        using namespace psf;
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        Spectrum spectrum;
+        loadSpectrumElements(spectrum, dirTestdata + "/shared_data/orbi_ms1.wsv");
+        LocalMaximaMask mask;
+        mask.assign(get_int, spectrum.begin(), spectrum.end());
+        shouldEqual(mask.size(), spectrum.size());
+
+        const double fractions[] = {0.1, 0.5, 0.7};
+        for(int f = 0; f < 3; ++f) {
+            should(measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), fractions[f], 0., mask) ==
+                   measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), fractions[f]));
+            should(measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), fractions[f], 1000., mask) ==
+                   measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), fractions[f], 1000.));
+        }
+    }
+};
+
+int main()
+{
+    LocalMaximaTestSuite test;
+    int failed = test.run();
+    std::cout << test.report() << std::endl;
+    return failed;
+}
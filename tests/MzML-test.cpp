@@ -0,0 +1,274 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Error.h>
+#include <psf/MzML.h>
+#include <psf/Spectrum.h>
+
+#include "testdata.h"
+#include "testhelpers.hxx"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct MzMLTestSuite : vigra::test_suite {
+    MzMLTestSuite() : vigra::test_suite("MzML"), filename_("MzML-test.mzML") {
+        add( testCase(&MzMLTestSuite::testRoundTrip));
+        add( testCase(&MzMLTestSuite::testThreads));
+        add( testCase(&MzMLTestSuite::testEncodings));
+        add( testCase(&MzMLTestSuite::testNumpress));
+        add( testCase(&MzMLTestSuite::testErrors));
+    }
+
+    // A few scans derived from orbi_ms1.wsv, among them an empty one.
+    static std::vector<Spectrum> scans(const std::size_t n) {
+        std::vector<Spectrum> result = psftest::scans(n, 3);
+        for(std::size_t i = 0; i < n; ++i) {
+            for(std::size_t j = 0; j < result[i].size(); ++j) {
+                result[i][j].intensity *= 1. + 0.1 * i;
+            }
+        }
+        if(n > 2) {
+            result[2].clear();
+        }
+        return result;
+    }
+
+    static void write(std::ostream& os, const std::vector<Spectrum>& spectra, const bool compress) {
+        MzMLWriter writer(os, spectra.size(), compress);
+        for(std::size_t i = 0; i < spectra.size(); ++i) {
+            writer.write(spectra[i], 1.5 * i, i % 2 ? 2 : 1);
+        }
+        writer.close();
+    }
+
+    static void check(MzMLReader& reader, const std::vector<Spectrum>& expected) {
+        MzMLScan scan;
+        for(std::size_t i = 0; i < expected.size(); ++i) {
+            should(reader.next(scan));
+            shouldEqual(scan.index, i);
+            shouldEqual(scan.scanNumber, static_cast<int>(i) + 1);
+            shouldEqual(scan.msLevel, i % 2 ? 2 : 1);
+            shouldEqual(scan.retentionTime, 1.5 * i);
+            shouldEqual(scan.spectrum.size(), expected[i].size());
+            should(psftest::equal(scan.spectrum, expected[i]));
+        }
+        should(!reader.next(scan));
+        should(!reader.next(scan));
+        shouldEqual(reader.numberOfScans(), expected.size());
+    }
+
+    void testRoundTrip() {
+        const std::vector<Spectrum> spectra = scans(5);
+#ifdef PSF_HAVE_ZLIB
+        const int nCompressions = 2;
+#else
+        const int nCompressions = 1;
+#endif
+        for(int compress = 0; compress < nCompressions; ++compress) {
+            std::stringstream document;
+            write(document, spectra, compress == 1);
+            MzMLReader reader(document);
+            check(reader, spectra);
+        }
+
+        {
+            std::ofstream ofs(filename_.c_str(), std::ios::binary);
+            write(ofs, spectra, nCompressions == 2);
+        }
+        MzMLReader reader(filename_);
+        check(reader, spectra);
+        std::remove(filename_.c_str());
+    }
+
+    void testThreads() {
+        const std::vector<Spectrum> spectra = scans(12);
+        std::stringstream document;
+#ifdef PSF_HAVE_ZLIB
+        write(document, spectra, true);
+#else
+        write(document, spectra, false);
+#endif
+        const std::string text = document.str();
+        const unsigned threads[] = {0, 2, 4};
+        const std::size_t windows[] = {0, 1, 3};
+        for(int t = 0; t < 3; ++t) {
+            for(int w = 0; w < 3; ++w) {
+                std::istringstream is(text);
+                MzMLReader reader(is, threads[t], windows[w]);
+                check(reader, spectra);
+            }
+        }
+
+        // stopping early
+        std::istringstream is(text);
+        MzMLReader reader(is, 4);
+        MzMLScan scan;
+        should(reader.next(scan));
+    }
+
+    void testEncodings() {
+        // 32 bit floats, minutes, an indexed file with wrapped base64 and a chromatogram
+        const std::string document =
+            "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+            "<indexedmzML><mzML><run><spectrumList count=\"2\">\n"
+            "<spectrum index=\"0\" id=\"controllerType=0 controllerNumber=1 scan=17\" defaultArrayLength=\"2\">\n"
+            "  <cvParam cvRef=\"MS\" accession=\"MS:1000511\" name=\"ms level\" value=\"1\"/>\n"
+            "  <scanList count=\"1\"><scan><cvParam cvRef=\"MS\" accession=\"MS:1000016\" name=\"scan start time\" value=\"0.5\" unitAccession=\"UO:0000031\" unitName=\"minute\"/></scan></scanList>\n"
+            "  <binaryDataArrayList count=\"2\">\n"
+            "    <binaryDataArray encodedLength=\"12\"><cvParam accession=\"MS:1000521\" name=\"32-bit float\"/><cvParam accession=\"MS:1000576\" name=\"no compression\"/><cvParam accession=\"MS:1000514\" name=\"m/z array\"/><binary>AADIQg\n  CASEM=</binary></binaryDataArray>\n"
+            "    <binaryDataArray encodedLength=\"12\"><cvParam accession=\"MS:1000515\" name=\"intensity array\"/><cvParam accession=\"MS:1000521\" name=\"32-bit float\"/><binary>AAAgQQAAAAA=</binary></binaryDataArray>\n"
+            "  </binaryDataArrayList>\n"
+            "</spectrum>\n"
+            "<spectrum index=\"1\" id=\"index=1\" defaultArrayLength=\"0\">\n"
+            "  <binaryDataArrayList count=\"2\">\n"
+            "    <binaryDataArray encodedLength=\"0\"><cvParam accession=\"MS:1000514\" name=\"m/z array\"/><binary/></binaryDataArray>\n"
+            "    <binaryDataArray encodedLength=\"0\"><cvParam accession=\"MS:1000515\" name=\"intensity array\"/><binary></binary></binaryDataArray>\n"
+            "  </binaryDataArrayList>\n"
+            "</spectrum>\n"
+            "</spectrumList>\n"
+            "<chromatogramList count=\"1\"><chromatogram index=\"0\" id=\"TIC\" defaultArrayLength=\"3\"><binaryDataArrayList count=\"1\"><binaryDataArray encodedLength=\"16\"><binary>AACAPwAAAEAAAEBA</binary></binaryDataArray></binaryDataArrayList></chromatogram></chromatogramList>\n"
+            "</run></mzML><indexList count=\"1\"/></indexedmzML>\n";
+        std::istringstream is(document);
+        MzMLReader reader(is);
+        MzMLScan scan;
+        should(reader.next(scan));
+        shouldEqual(scan.id, std::string("controllerType=0 controllerNumber=1 scan=17"));
+        shouldEqual(scan.scanNumber, 17);
+        shouldEqual(scan.msLevel, 1);
+        shouldEqual(scan.retentionTime, 30.);
+        shouldEqual(scan.spectrum.size(), 2u);
+        shouldEqual(scan.spectrum[0].mz, 100.);
+        shouldEqual(scan.spectrum[1].mz, 200.5);
+        shouldEqual(scan.spectrum[0].intensity, 10.);
+        shouldEqual(scan.spectrum[1].intensity, 0.);
+
+        // the previous spectrum is replaced
+        should(reader.next(scan));
+        shouldEqual(scan.index, 1u);
+        shouldEqual(scan.scanNumber, 2);
+        shouldEqual(scan.msLevel, 0);
+        shouldEqual(scan.spectrum.size(), 0u);
+        should(!reader.next(scan));
+    }
+
+    void testNumpress() {
+        // positive integer intensities 10 and 0
+        const std::string document =
+            "<mzML><run><spectrumList count=\"1\"><spectrum index=\"0\" id=\"scan=1\" defaultArrayLength=\"2\"><binaryDataArrayList count=\"2\">"
+            "<binaryDataArray><cvParam accession=\"MS:1000514\" name=\"m/z array\"/><cvParam accession=\"MS:1000521\" name=\"32-bit float\"/><binary>AADIQgCASEM=</binary></binaryDataArray>"
+            "<binaryDataArray><cvParam accession=\"MS:1000515\" name=\"intensity array\"/><cvParam accession=\"MS:1002313\" name=\"MS-Numpress positive integer compression\"/><binary>eoA=</binary></binaryDataArray>"
+            "</binaryDataArrayList></spectrum></spectrumList></run></mzML>";
+        std::istringstream is(document);
+        MzMLReader reader(is);
+        MzMLScan scan;
+        should(reader.next(scan));
+        shouldEqual(scan.spectrum.size(), 2u);
+        shouldEqual(scan.spectrum[1].mz, 200.5);
+        shouldEqual(scan.spectrum[0].intensity, 10.);
+        shouldEqual(scan.spectrum[1].intensity, 0.);
+
+        // written lossy: m/z to about 1e-7, intensities to about 1e-4 relative
+        const std::vector<Spectrum> spectra = scans(5);
+#ifdef PSF_HAVE_ZLIB
+        const int nCompressions = 2;
+#else
+        const int nCompressions = 1;
+#endif
+        for(int compress = 0; compress < nCompressions; ++compress) {
+            std::stringstream plain, numpress;
+            write(plain, spectra, compress == 1);
+            MzMLWriter writer(numpress, spectra.size(), compress == 1, true);
+            for(std::size_t i = 0; i < spectra.size(); ++i) {
+                writer.write(spectra[i], 1.5 * i);
+            }
+            writer.close();
+            should(numpress.str().size() < plain.str().size() / 2);
+
+            MzMLReader numpressReader(numpress, 2);
+            bool close = true;
+            for(std::size_t i = 0; i < spectra.size(); ++i) {
+                should(numpressReader.next(scan));
+                shouldEqual(scan.spectrum.size(), spectra[i].size());
+                for(std::size_t j = 0; j < spectra[i].size(); ++j) {
+                    close = close && std::abs(scan.spectrum[j].mz - spectra[i][j].mz) < 1e-6
+                            && std::abs(scan.spectrum[j].intensity - spectra[i][j].intensity) <= 2e-4 * (spectra[i][j].intensity + 1);
+                }
+            }
+            should(close);
+            should(!numpressReader.next(scan));
+        }
+    }
+
+    void testErrors() {
+        bool thrown = false;
+        try {
+            MzMLReader reader("does-not-exist.mzML");
+        } catch (const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+
+        const std::string begin = "<mzML><run><spectrumList count=\"1\"><spectrum index=\"0\" id=\"scan=1\" defaultArrayLength=\"2\"><binaryDataArrayList count=\"2\">";
+        const std::string mz = "<binaryDataArray><cvParam accession=\"MS:1000514\" name=\"m/z array\"/><cvParam accession=\"MS:1000521\" name=\"32-bit float\"/><binary>AADIQgCASEM=</binary></binaryDataArray>";
+        const std::string end = "</binaryDataArrayList></spectrum></spectrumList></run></mzML>";
+        const std::string documents[] = {
+            // truncated
+            begin + mz,
+            // no intensity array
+            begin + mz + end,
+            // integers
+            begin + mz + "<binaryDataArray><cvParam accession=\"MS:1000515\" name=\"intensity array\"/><cvParam accession=\"MS:1000519\" name=\"32-bit integer\"/><binary>AAAgQQAAAAA=</binary></binaryDataArray>" + end,
+            // too short
+            begin + mz + "<binaryDataArray><cvParam accession=\"MS:1000515\" name=\"intensity array\"/><cvParam accession=\"MS:1000521\" name=\"32-bit float\"/><binary>AAAgQQ==</binary></binaryDataArray>" + end,
+            // not base64
+            begin + mz + "<binaryDataArray><cvParam accession=\"MS:1000515\" name=\"intensity array\"/><cvParam accession=\"MS:1000521\" name=\"32-bit float\"/><binary>AAAg*QAAAAA=</binary></binaryDataArray>" + end
+        };
+        for(int i = 0; i < 5; ++i) {
+            for(unsigned nThreads = 1; nThreads <= 2; ++nThreads) {
+                std::istringstream is(documents[i]);
+                MzMLReader reader(is, nThreads);
+                MzMLScan scan;
+                thrown = false;
+                try {
+                    reader.next(scan);
+                } catch (const RuntimeError& e) {
+                    PSF_UNUSED(e);
+                    thrown = true;
+                }
+                should(thrown);
+            }
+        }
+
+        std::ostringstream os;
+        MzMLWriter writer(os, 2, false);
+        writer.write(Spectrum(), 0.);
+        thrown = false;
+        try {
+            writer.close();
+        } catch (const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+private:
+    std::string filename_;
+};
+
+int main() {
+    MzMLTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
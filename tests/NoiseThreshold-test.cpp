@@ -0,0 +1,182 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Error.h>
+#include <psf/NoiseThreshold.h>
+#include <psf/PeakParameter.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumAlgorithm.h>
+
+#include "testdata.h"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct NoiseThresholdTestSuite : vigra::test_suite {
+    NoiseThresholdTestSuite() : vigra::test_suite("NoiseThreshold") {
+        add( testCase(&NoiseThresholdTestSuite::testInterpolation));
+        add( testCase(&NoiseThresholdTestSuite::testGaussianNoise));
+        add( testCase(&NoiseThresholdTestSuite::testMeasureFullWidths));
+        add( testCase(&NoiseThresholdTestSuite::testLearnFrom));
+        add( testCase(&NoiseThresholdTestSuite::testPreconditions));
+    }
+
+    void testInterpolation() {
+        // three windows of constant intensity; the trailing element joins the last one
+        Spectrum s;
+        for(int i = 0; i < 13; ++i) {
+            s.push_back(SpectrumElement(i, 1. + i / 4 - i / 12));
+        }
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        NoiseThreshold threshold;
+        shouldEqual(threshold.numberOfWindows(), 0u);
+        shouldEqual(threshold.at(100.), 0.);
+
+        threshold.estimate(get_mz, get_int, s.begin(), s.end(), 3., 4);
+        shouldEqual(threshold.numberOfWindows(), 3u);
+        // window centres at 1.5, 5.5 and 10
+        shouldEqualTolerance(threshold.at(0.), 1., 1e-12);
+        shouldEqualTolerance(threshold.at(1.5), 1., 1e-12);
+        shouldEqualTolerance(threshold.at(3.5), 1.5, 1e-12);
+        shouldEqualTolerance(threshold.at(5.5), 2., 1e-12);
+        shouldEqualTolerance(threshold.at(7.75), 2.5, 1e-12);
+        shouldEqualTolerance(threshold.at(20.), 3., 1e-12);
+
+        threshold.setMinimum(2.2);
+        shouldEqual(threshold.getMinimum(), 2.2);
+        shouldEqualTolerance(threshold.at(0.), 2.2, 1e-12);
+        shouldEqualTolerance(threshold.at(20.), 3., 1e-12);
+
+        // an empty spectrum removes the previous windows
+        threshold.estimate(get_mz, get_int, s.begin(), s.begin());
+        shouldEqual(threshold.numberOfWindows(), 0u);
+        shouldEqual(threshold.at(5.), 2.2);
+    }
+
+    void testGaussianNoise() {
+        // sigma 10 around 100 below m/z 1000 and sigma 40 around 500 above; sparse peaks
+        std::mt19937 rng(7);
+        std::normal_distribution<double> quiet(100., 10.);
+        std::normal_distribution<double> loud(500., 40.);
+        Spectrum s;
+        for(int i = 0; i < 20000; ++i) {
+            const double mz = 500. + i * 0.05;
+            double intensity = (mz < 1000.) ? quiet(rng) : loud(rng);
+            if(i % 100 == 50) {
+                intensity += 10000.;
+            }
+            s.push_back(SpectrumElement(mz, intensity));
+        }
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        NoiseThreshold threshold;
+        threshold.estimate(get_mz, get_int, s.begin(), s.end(), 3., 500);
+        shouldEqual(threshold.numberOfWindows(), 40u);
+        shouldEqualTolerance(threshold.at(700.), 130., 0.05);
+        shouldEqualTolerance(threshold.at(1300.), 620., 0.05);
+    }
+
+    void testMeasureFullWidths() {
+        // Gaussian peaks of height 1000 every 10 Th on half-normal noise
+        std::mt19937 rng(11);
+        std::normal_distribution<double> noise(0., 20.);
+        Spectrum s;
+        for(int i = 0; i < 20000; ++i) {
+            const double mz = 400. + i * 0.01;
+            const double offset = std::fmod(mz - 400., 10.) - 5.;
+            s.push_back(SpectrumElement(mz, std::abs(noise(rng)) + 1000. * std::exp(-offset * offset / (2. * 0.02 * 0.02))));
+        }
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        NoiseThreshold threshold;
+        // far above the largest of the 20000 noise values
+        threshold.estimate(get_mz, get_int, s.begin(), s.end(), 8.);
+
+        typedef std::vector<std::pair<double, double> > Pairs;
+        const Pairs all = measureFullWidths(get_mz, get_int, s.begin(), s.end(), 0.5);
+        const Pairs aboveNoise = measureFullWidths(get_mz, get_int, s.begin(), s.end(), 0.5, threshold);
+        should(all.size() > 100u);
+        shouldEqual(aboveNoise.size(), 20u);
+        for(Pairs::const_iterator pair = aboveNoise.begin(); pair != aboveNoise.end(); ++pair) {
+            const double offset = std::fmod(pair->first - 400., 10.) - 5.;
+            should(std::abs(offset) < 0.02);
+        }
+
+        // a minimum above the peaks leaves nothing
+        threshold.setMinimum(2000.);
+        shouldEqual(measureFullWidths(get_mz, get_int, s.begin(), s.end(), 0.5, threshold).size(), 0u);
+    }
+
+    void testLearnFrom() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        Spectrum spectrum;
+        loadSpectrumElements(spectrum, dirTestdata + "/shared_data/orbi_ms1.wsv");
+
+        OrbitrapWithOriginFwhm fixed;
+        shouldEqual(fixed.getNoiseFactorToLearnFrom(), 0.);
+        fixed.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+
+        OrbitrapWithOriginFwhm adaptive;
+        adaptive.setNoiseFactorToLearnFrom(3.);
+        shouldEqual(adaptive.getNoiseFactorToLearnFrom(), 3.);
+        adaptive.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+        should(adaptive.getA() > 0.);
+
+        NoiseThreshold threshold;
+        threshold.estimate(get_mz, get_int, spectrum.begin(), spectrum.end(), 3.);
+        const std::size_t nAll = measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5).size();
+        const std::size_t nAboveNoise = measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, threshold).size();
+        should(nAboveNoise > 0u);
+        should(nAboveNoise < nAll);
+    }
+
+    void testPreconditions() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        Spectrum s;
+        NoiseThreshold threshold;
+
+        bool thrown = false;
+        try {
+            threshold.estimate(get_mz, get_int, s.begin(), s.end(), -1.);
+        } catch (const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+
+        thrown = false;
+        try {
+            threshold.estimate(get_mz, get_int, s.begin(), s.end(), 3., 2);
+        } catch (const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+
+        thrown = false;
+        try {
+            OrbitrapWithOriginFwhm fwhm;
+            fwhm.setNoiseFactorToLearnFrom(-0.5);
+        } catch (const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+};
+
+int main() {
+    NoiseThresholdTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
@@ -0,0 +1,167 @@
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Error.h>
+#include <psf/Numpress.h>
+#include <psf/Spectrum.h>
+
+#include "testdata.h"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct NumpressTestSuite : vigra::test_suite {
+    NumpressTestSuite() : vigra::test_suite("Numpress") {
+        add( testCase(&NumpressTestSuite::testLinear));
+        add( testCase(&NumpressTestSuite::testSlof));
+        add( testCase(&NumpressTestSuite::testPic));
+        add( testCase(&NumpressTestSuite::testErrors));
+    }
+
+    static void orbi(std::vector<double>& mz, std::vector<double>& intensity) {
+        Spectrum s;
+        loadSpectrumElements(s, dirTestdata + "/shared_data/orbi_ms1.wsv");
+        for(std::size_t i = 0; i < s.size(); ++i) {
+            mz.push_back(s[i].mz);
+            intensity.push_back(s[i].intensity);
+        }
+    }
+
+    void testLinear() {
+        std::vector<double> mz, intensity;
+        orbi(mz, intensity);
+        const double fixedPoint = optimalNumpressLinearFixedPoint(&mz[0], mz.size());
+        should(fixedPoint > 1e6);
+        std::string bytes;
+        encodeNumpressLinear(&mz[0], mz.size(), fixedPoint, bytes);
+        // a profile spectrum needs about 2 to 3 bytes per value instead of 8
+        should(bytes.size() < mz.size() * 3);
+        std::vector<double> decoded;
+        decodeNumpressLinear(bytes, decoded);
+        shouldEqual(decoded.size(), mz.size());
+        double maxError = 0.;
+        for(std::size_t i = 0; i < mz.size(); ++i) {
+            maxError = std::max(maxError, std::abs(decoded[i] - mz[i]));
+        }
+        should(maxError <= 0.5 / fixedPoint + 1e-12);
+
+        // short arrays, including a residual needing all eight half bytes and negative ones
+        const double values[] = {100., 200., 100., 1e5, 99., 0.5};
+        for(std::size_t n = 0; n <= 6; ++n) {
+            encodeNumpressLinear(values, n, 1000., bytes);
+            decodeNumpressLinear(bytes, decoded);
+            shouldEqual(decoded.size(), n);
+            for(std::size_t i = 0; i < n; ++i) {
+                shouldEqualTolerance(decoded[i], values[i], 1e-9);
+            }
+        }
+        shouldEqual(optimalNumpressLinearFixedPoint(values, 0), 0.);
+    }
+
+    void testSlof() {
+        std::vector<double> mz, intensity;
+        orbi(mz, intensity);
+        const double fixedPoint = optimalNumpressSlofFixedPoint(&intensity[0], intensity.size());
+        std::string bytes;
+        encodeNumpressSlof(&intensity[0], intensity.size(), fixedPoint, bytes);
+        shouldEqual(bytes.size(), 8 + 2 * intensity.size());
+        std::vector<double> decoded;
+        decodeNumpressSlof(bytes, decoded);
+        shouldEqual(decoded.size(), intensity.size());
+        const double bound = std::exp(0.5 / fixedPoint) - 1;
+        bool close = true;
+        for(std::size_t i = 0; i < intensity.size(); ++i) {
+            close = close && std::abs(decoded[i] - intensity[i]) <= bound * (intensity[i] + 1) * 1.000001;
+        }
+        should(close);
+
+        encodeNumpressSlof(0, 0, 0., bytes);
+        decodeNumpressSlof(bytes, decoded);
+        shouldEqual(decoded.size(), 0u);
+    }
+
+    void testPic() {
+        const double values[] = {0., 1., 15., 16., 255.4, 65536., 4294967295.};
+        std::string bytes;
+        encodeNumpressPic(values, 7, bytes);
+        std::vector<double> decoded;
+        decodeNumpressPic(bytes, decoded);
+        shouldEqual(decoded.size(), 7u);
+        shouldEqual(decoded[4], 255.);
+        shouldEqual(decoded[6], 4294967295.);
+        for(std::size_t n = 0; n <= 7; ++n) {
+            encodeNumpressPic(values, n, bytes);
+            decodeNumpressPic(bytes, decoded);
+            shouldEqual(decoded.size(), n);
+        }
+
+        // 10 and 0: half bytes 7 A 8 and a padding 0
+        const double tenAndZero[] = {10., 0.};
+        encodeNumpressPic(tenAndZero, 2, bytes);
+        shouldEqual(bytes, std::string("\x7A\x80"));
+    }
+
+    void testErrors() {
+        std::vector<double> decoded;
+        const std::string corrupt[] = {std::string("\x05", 1), std::string(10, '\0'), std::string(14, '\0')};
+        bool thrown = false;
+        try {
+            decodeNumpressPic(corrupt[0], decoded);
+        } catch(const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        for(int i = 1; i < 3; ++i) {
+            thrown = false;
+            try {
+                decodeNumpressLinear(corrupt[i], decoded);
+            } catch(const RuntimeError& e) {
+                PSF_UNUSED(e);
+                thrown = true;
+            }
+            should(thrown);
+        }
+        thrown = false;
+        try {
+            decodeNumpressSlof(std::string(9, '\0'), decoded);
+        } catch(const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+
+        const double negative = -3.;
+        std::string bytes;
+        thrown = false;
+        try {
+            encodeNumpressPic(&negative, 1, bytes);
+        } catch(const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        thrown = false;
+        try {
+            const double values[] = {1., 2., 1e9};
+            encodeNumpressLinear(values, 3, 1e6, bytes);
+        } catch(const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+};
+
+int main() {
+    NumpressTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
@@ -1,4 +1,7 @@
+#include <cmath>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #include <psf/config.h>
 #include <psf/Error.h>
@@ -20,6 +23,59 @@ struct PeakParameterTestSuite : vigra::test_suite {
         add( testCase(&PeakParameterTestSuite::testOrbitrapFwhmLearnFrom));
         add( testCase(&PeakParameterTestSuite::testFtIcrFwhmLearnFrom));
         add( testCase(&PeakParameterTestSuite::testTofFwhmLearnFrom));
+        add( testCase(&PeakParameterTestSuite::testWarp));
+        add( testCase(&PeakParameterTestSuite::testRegressionMethod));
+        add( testCase(&PeakParameterTestSuite::testRobustLearnFrom));
+        add( testCase(&PeakParameterTestSuite::testLearnFromSample));
+        add( testCase(&PeakParameterTestSuite::testLearnFromWithWorkspace));
+    }
+
+    // Gaussian peaks with Orbitrap widths between 400 and 1000 Th. Every fourth peak gets
+    // a close neighbour, so that both merge into one wide bump: an outlier width.
+    psf::Spectrum spectrumWithOverlaps(const double a) {
+        psf::OrbitrapWithOriginFwhm truth;
+        truth.setA(a);
+        std::vector<std::pair<double, double> > peaks;
+        for(int i = 0; i < 200; ++i) {
+            const double mz = 400. + 3. * i + 0.37 * (i % 7);
+            peaks.push_back(std::make_pair(mz, 1000. + 37. * (i % 11)));
+            if(i % 4 == 0) {
+                peaks.push_back(std::make_pair(mz + 0.7 * truth.at(mz), 1000. + 37. * (i % 11)));
+            }
+        }
+        psf::Spectrum spectrum;
+        for(std::size_t p = 0; p < peaks.size(); ++p) {
+            const double mz = peaks[p].first;
+            if(p > 0 && mz - peaks[p - 1].first < 1.) {
+                continue; // sampled together with the previous peak
+            }
+            const double step = truth.at(mz) / 20.;
+            for(double x = mz - 3 * truth.at(mz); x < mz + 4 * truth.at(mz); x += step) {
+                double intensity = 0.;
+                for(std::size_t q = p; q < peaks.size() && q < p + 2; ++q) {
+                    const double sigma = truth.at(peaks[q].first) / 2.3548;
+                    const double d = x - peaks[q].first;
+                    intensity += peaks[q].second * std::exp(-d * d / (2 * sigma * sigma));
+                }
+                spectrum.push_back(psf::SpectrumElement(x, intensity));
+            }
+        }
+        return spectrum;
+    }
+
+    // The derivative of warp() has to be 1/fwhm and unwarp() has to invert warp().
+    template< typename Fwhm >
+    void checkWarp(const Fwhm& fwhm) {
+        const double mzs[] = {50., 200., 400., 999.9, 1800.};
+        for(int i = 0; i < 5; ++i) {
+            const double mz = mzs[i];
+            const double h = 1e-4 * mz;
+            const double derivative = (fwhm.warp(mz + h) - fwhm.warp(mz - h)) / (2 * h);
+            shouldEqualTolerance(derivative * fwhm.at(mz), 1., 1e-6);
+            shouldEqualTolerance(fwhm.unwarp(fwhm.warp(mz)), mz, 1e-9);
+            shouldEqualTolerance(fwhm.unwarp(fwhm.warp(mz), 3 * mz), mz, 1e-9);
+            shouldEqualTolerance(fwhm.unwarp(fwhm.warp(mz), 0.5 * mz), mz, 1e-9);
+        }
     }
 
     void testSet_GetMinimalPeakHeightToLearnFrom() {
@@ -468,6 +524,196 @@ struct PeakParameterTestSuite : vigra::test_suite {
         shouldEqualTolerance(fwhm.getA(), 0., 0.00001);
         shouldEqualTolerance(fwhm.getB(), 0.031325, 0.0001);
     }
+
+    void testWarp() {
+        psf::ConstantFwhm constant;
+        constant.setA(0.3);
+        checkWarp(constant);
+        shouldEqualTolerance(constant.warp(3.), 10., 1e-12);
+
+        psf::OrbitrapWithOriginFwhm orbiOrigin;
+        orbiOrigin.setA(1.19781e-05);
+        checkWarp(orbiOrigin);
+
+        psf::OrbitrapFwhm orbi;
+        orbi.setA(1.2e-05);
+        orbi.setB(0.002);
+        checkWarp(orbi);
+        orbi.setB(-0.0001);
+        checkWarp(orbi);
+        orbi.setA(0.);
+        orbi.setB(0.01);
+        checkWarp(orbi);
+
+        psf::TofFwhm tof;
+        tof.setA(0.001);
+        tof.setB(0.05);
+        checkWarp(tof);
+        tof.setB(0.);
+        checkWarp(tof);
+
+        psf::FtIcrFwhm ftIcr;
+        ftIcr.setA(2e-7);
+        ftIcr.setB(0.001);
+        checkWarp(ftIcr);
+        ftIcr.setB(-0.0001);
+        checkWarp(ftIcr);
+        ftIcr.setB(0.);
+        checkWarp(ftIcr);
+
+        // no masses <= 0
+        bool thrown = false;
+        try {
+            constant.warp(0.);
+        } catch (const psf::PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+
+        // out of range: the warped coordinate of this model is always negative
+        thrown = false;
+        try {
+            orbiOrigin.unwarp(1.);
+        } catch (const psf::NumericalInstability& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testRegressionMethod() {
+        psf::OrbitrapFwhm fwhm;
+        shouldEqual(fwhm.getRegressionMethod(), psf::leastSquaresRegression);
+        fwhm.setRegressionMethod(psf::tukeyRegression);
+        shouldEqual(fwhm.getRegressionMethod(), psf::tukeyRegression);
+    }
+
+    void testRobustLearnFrom() {
+        using namespace psf;
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        const double a = 1.19781e-05;
+        Spectrum spectrum = spectrumWithOverlaps(a);
+
+        OrbitrapWithOriginFwhm leastSquares;
+        leastSquares.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+
+        OrbitrapWithOriginFwhm huber;
+        huber.setRegressionMethod(huberRegression);
+        huber.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+
+        OrbitrapWithOriginFwhm tukey;
+        tukey.setRegressionMethod(tukeyRegression);
+        tukey.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+
+        // the overlapping peaks bias the least squares fit
+        should(leastSquares.getA() > 1.05 * a);
+        should(std::abs(huber.getA() - a) < std::abs(leastSquares.getA() - a));
+        shouldEqualTolerance(tukey.getA(), a, 0.01);
+
+        // two parameters
+        OrbitrapFwhm tukey2;
+        tukey2.setRegressionMethod(tukeyRegression);
+        tukey2.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+        shouldEqualTolerance(tukey2.at(700.), a * 700. * std::sqrt(700.), 0.01);
+    }
+
+    void testLearnFromSample() {
+        using namespace psf;
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        Spectrum spectrum;
+        loadSpectrumElements(spectrum, dirTestdata + "/shared_data/orbi_ms1.wsv");
+        const std::size_t nPeaks = measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5).size();
+
+        OrbitrapWithOriginFwhm full;
+        full.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+
+        // an unreachable tolerance visits every peak exactly once
+        OrbitrapWithOriginFwhm everything;
+        shouldEqual(everything.learnFromSample(get_mz, get_int, spectrum.begin(), spectrum.end(), 1e-9), nPeaks);
+        shouldEqualTolerance(everything.getA(), full.getA(), 1e-9);
+
+        // The widths in this spectrum contain gross outliers, so only a robust fit
+        // converges early.
+        OrbitrapWithOriginFwhm fullTukey;
+        fullTukey.setRegressionMethod(tukeyRegression);
+        fullTukey.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+        OrbitrapWithOriginFwhm sampled;
+        sampled.setRegressionMethod(tukeyRegression);
+        const std::size_t used = sampled.learnFromSample(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.01);
+        should(used >= 30);
+        should(used < nPeaks);
+        shouldEqualTolerance(sampled.getA(), fullTukey.getA(), 0.01);
+
+        // the visiting order depends on the seed only
+        OrbitrapWithOriginFwhm again;
+        again.setRegressionMethod(tukeyRegression);
+        shouldEqual(again.learnFromSample(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.01), used);
+        shouldEqual(again.getA(), sampled.getA());
+
+        bool thrown = false;
+        try {
+            sampled.learnFromSample(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.);
+        } catch (const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+
+        thrown = false;
+        try {
+            sampled.learnFromSample(get_mz, get_int, spectrum.begin(), spectrum.begin());
+        } catch (const Starvation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testLearnFromWithWorkspace() {
+        using namespace psf;
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        Spectrum spectrum;
+        loadSpectrumElements(spectrum, dirTestdata + "/shared_data/orbi_ms1.wsv");
+        CalibrationWorkspace workspace;
+
+        const RegressionMethod methods[] = {leastSquaresRegression, huberRegression, tukeyRegression};
+        for(int m = 0; m < 3; ++m) {
+            OrbitrapFwhm expected;
+            expected.setRegressionMethod(methods[m]);
+            expected.setMinimalPeakHeightToLearnFrom(100.);
+            expected.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+
+            OrbitrapFwhm fwhm;
+            fwhm.setRegressionMethod(methods[m]);
+            fwhm.setMinimalPeakHeightToLearnFrom(100.);
+            fwhm.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end(), workspace);
+            shouldEqualTolerance(fwhm.getA(), expected.getA(), 1e-6);
+            shouldEqualTolerance(fwhm.getB(), expected.getB(), 1e-6);
+            shouldEqual(workspace.widthPairs().size(), measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 100.).size());
+        }
+
+        // a workspace may be shared by models with a different number of parameters
+        OrbitrapWithOriginFwhm expectedOrigin;
+        expectedOrigin.setNoiseFactorToLearnFrom(3.);
+        expectedOrigin.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end());
+        OrbitrapWithOriginFwhm origin;
+        origin.setNoiseFactorToLearnFrom(3.);
+        origin.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.end(), workspace);
+        shouldEqualTolerance(origin.getA(), expectedOrigin.getA(), 1e-6);
+
+        bool thrown = false;
+        try {
+            origin.learnFrom(get_mz, get_int, spectrum.begin(), spectrum.begin(), workspace);
+        } catch (const Starvation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
 };
 
 int main()
@@ -1,3 +1,5 @@
+#include <limits>
+
 #include <psf/config.h>
 
 #include "unittest.hxx"
@@ -16,6 +18,7 @@ struct PsfTestSuite : vigra::test_suite {
         add( testCase(&PsfTestSuite::testOrbitrapPeakShapeFunction) );
         add( testCase(&PsfTestSuite::testGaussianPeakShapeFunction) );
         add( testCase(&PsfTestSuite::testOperator));
+        add( testCase(&PsfTestSuite::testEvaluate));
         add( testCase(&PsfTestSuite::testGetSupportThreshold));
         add( testCase(&PsfTestSuite::testSet_GetMinimalPeakHeightForCalibration));
         add( testCase(&PsfTestSuite::testOrbiFwhmLinearSqrtPeakShape));
@@ -175,6 +178,29 @@ struct PsfTestSuite : vigra::test_suite {
         shouldEqual(gen(400., 400. - (threshold + delta)), 0.0);       
     }
 
+    void testEvaluate() {
+        psf::PeakShapeFunctionTemplate<psf::GaussianPeakShape, psf::TofFwhm, psf::tof> gen;
+        gen.setA(0.43);
+        gen.setB(0.76);
+
+        // observed masses inside and outside of the support around 400 Th
+        double observed[] = {385., 397.2, 399.99, 400., 400.01, 404.5, 415.};
+        double values[7];
+        double* end = gen.evaluate(400., observed, observed + 7, values);
+        should(end == values + 7);
+
+        // has to agree with the scalar operator()
+        for(int i = 0; i < 7; ++i) {
+            shouldEqual(values[i], gen(400., observed[i]));
+        }
+        shouldEqual(values[0], 0.0);
+        shouldEqual(values[6], 0.0);
+        shouldEqual(values[3], 1.0);
+
+        // empty range
+        should(gen.evaluate(400., observed, observed, values) == values);
+    }
+
     void testGetSupportThreshold() {
         psf::PeakShapeFunctionTemplate<psf::GaussianPeakShape, psf::TofFwhm, psf::tof> gen;
         psf::TofFwhm fwhm;
@@ -202,6 +228,10 @@ struct PsfTestSuite : vigra::test_suite {
 
         psf.setMinimalPeakHeightForCalibration(-0.87);
         shouldEqual(psf.getMinimalPeakHeightForCalibration(), -0.87);
+
+        shouldEqual(psf.getNoiseFactorForCalibration(), 0.);
+        psf.setNoiseFactorForCalibration(3.5);
+        shouldEqual(psf.getNoiseFactorForCalibration(), 3.5);
     }
 
     void testOrbiFwhmLinearSqrtPeakShape() {
@@ -0,0 +1,261 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/BoundedQueue.h>
+#include <psf/Error.h>
+#include <psf/Pipeline.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumAlgorithm.h>
+
+#include "testdata.h"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct Job {
+    Job() : value(-1), result(0) {}
+    int value;
+    long result;
+    std::vector<int> seen; // by the serial stages
+};
+
+struct PipelineTestSuite : vigra::test_suite {
+    PipelineTestSuite() : vigra::test_suite("Pipeline") {
+        add( testCase(&PipelineTestSuite::testQueue));
+        add( testCase(&PipelineTestSuite::testConcurrentQueue));
+        add( testCase(&PipelineTestSuite::testOrder));
+        add( testCase(&PipelineTestSuite::testBackPressure));
+        add( testCase(&PipelineTestSuite::testExceptions));
+        add( testCase(&PipelineTestSuite::testSleepingThreads));
+        add( testCase(&PipelineTestSuite::testSpectra));
+    }
+
+    void testQueue() {
+        BoundedQueue<int> queue(5);
+        shouldEqual(queue.capacity(), 8u);
+        int value = 0;
+        should(!queue.tryPop(value));
+        for(int i = 0; i < 8; ++i) {
+            should(queue.tryPush(i));
+        }
+        should(!queue.tryPush(8));
+        for(int round = 0; round < 20; ++round) {
+            should(queue.tryPop(value));
+            shouldEqual(value, round);
+            should(queue.tryPush(round + 8));
+        }
+    }
+
+    void testConcurrentQueue() {
+        BoundedQueue<int> queue(16);
+        const int nProducers = 3, nPerProducer = 20000;
+        std::atomic<long> sum(0);
+        std::atomic<int> popped(0);
+        std::vector<std::thread> threads;
+        for(int p = 0; p < nProducers; ++p) {
+            threads.push_back(std::thread([&queue, p]() {
+                for(int i = 1; i <= nPerProducer; ++i) {
+                    while(!queue.tryPush(p * nPerProducer + i)) {
+                        std::this_thread::yield();
+                    }
+                }
+            }));
+        }
+        for(int c = 0; c < 2; ++c) {
+            threads.push_back(std::thread([&]() {
+                int value;
+                while(popped.load() < nProducers * nPerProducer) {
+                    if(queue.tryPop(value)) {
+                        sum += value;
+                        ++popped;
+                    }
+                    else {
+                        std::this_thread::yield();
+                    }
+                }
+            }));
+        }
+        for(std::size_t t = 0; t < threads.size(); ++t) {
+            threads[t].join();
+        }
+        const long n = static_cast<long>(nProducers) * nPerProducer;
+        shouldEqual(sum.load(), n * (n + 1) / 2);
+    }
+
+    void testOrder() {
+        for(int concurrent = 0; concurrent < 2; ++concurrent) {
+            checkOrder(concurrent == 1);
+        }
+    }
+
+    void checkOrder(const bool concurrent) {
+        const int n = 2000;
+        std::vector<int> firstSerial, secondSerial, sunk;
+        Pipeline<Job> pipeline;
+        pipeline.setConcurrent(concurrent);
+        shouldEqual(pipeline.isConcurrent(), concurrent);
+        pipeline.addStage([&firstSerial](Job& job) { firstSerial.push_back(job.value); job.result = 0; })
+                .addStage([](Job& job) {
+                    for(int i = 0; i <= job.value % 100; ++i) {
+                        job.result += i;
+                    }
+                    if(job.value % 7 == 0) {
+                        std::this_thread::yield();
+                    }
+                }, 4)
+                .addStage([&secondSerial](Job& job) { secondSerial.push_back(job.value); });
+        shouldEqual(pipeline.numberOfStages(), 3u);
+
+        for(int round = 0; round < 2; ++round) {
+            firstSerial.clear();
+            secondSerial.clear();
+            sunk.clear();
+            int next = 0;
+            bool correct = true;
+            const std::size_t count = pipeline.run([&next, n](Job& job) { job.value = next; return next++ < n; },
+                                                   [&sunk, &correct](Job& job) {
+                                                       const int m = job.value % 100;
+                                                       correct = correct && job.result == m * (m + 1) / 2;
+                                                       sunk.push_back(job.value);
+                                                   });
+            shouldEqual(count, static_cast<std::size_t>(n));
+            should(correct);
+            shouldEqual(sunk.size(), static_cast<std::size_t>(n));
+            bool ordered = true;
+            for(int i = 0; i < n; ++i) {
+                ordered = ordered && firstSerial[i] == i && secondSerial[i] == i && sunk[i] == i;
+            }
+            should(ordered);
+        }
+
+        // without stages and without items
+        Pipeline<Job> empty;
+        empty.setConcurrent(concurrent);
+        shouldEqual(empty.run([](Job&) { return false; }, [](Job&) {}), 0u);
+        int next = 0;
+        shouldEqual(empty.run([&next](Job& job) { job.value = next; return next++ < 10; }, [](Job&) {}), 10u);
+    }
+
+    void testBackPressure() {
+        const std::size_t inFlight = 3;
+        std::atomic<int> produced(0), consumed(0), maximal(0);
+        Pipeline<Job> pipeline(inFlight);
+        pipeline.setConcurrent(true);
+        pipeline.addStage([](Job& job) { job.result = job.value; }, 2)
+                .addStage([](Job&) { std::this_thread::yield(); });
+        int next = 0;
+        pipeline.run([&](Job& job) {
+                         const int current = ++produced - consumed.load();
+                         if(current > maximal.load()) {
+                             maximal.store(current);
+                         }
+                         job.value = next;
+                         return next++ < 500;
+                     },
+                     [&](Job&) { ++consumed; });
+        shouldEqual(consumed.load(), 500);
+        should(maximal.load() <= static_cast<int>(inFlight));
+    }
+
+    void testExceptions() {
+        for(int where = 0; where < 6; ++where) {
+            Pipeline<Job> pipeline(4);
+            pipeline.setConcurrent(where < 3);
+            pipeline.addStage([where](Job& job) {
+                if(where % 3 == 1 && job.value == 50) {
+                    psf_fail("stage");
+                }
+            }, 2);
+            int next = 0;
+            bool thrown = false;
+            try {
+                pipeline.run([&next, where](Job& job) {
+                                 if(where % 3 == 0 && next == 50) {
+                                     psf_fail("source");
+                                 }
+                                 job.value = next;
+                                 return next++ < 1000;
+                             },
+                             [where](Job& job) {
+                                 if(where % 3 == 2 && job.value == 50) {
+                                     psf_fail("sink");
+                                 }
+                             });
+            } catch (const RuntimeError& e) {
+                PSF_UNUSED(e);
+                thrown = true;
+            }
+            should(thrown);
+        }
+    }
+
+    void testSleepingThreads() {
+        // a slow source: the stage threads and the sink go to sleep on empty queues
+        for(int fail = 0; fail < 2; ++fail) {
+            Pipeline<Job> pipeline;
+            pipeline.setConcurrent(true);
+            pipeline.addStage([](Job& job) { job.result = 2 * job.value; }, 3);
+            int next = 0;
+            int consumed = 0;
+            bool thrown = false;
+            try {
+                pipeline.run([&next, fail](Job& job) {
+                                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                                 if(fail && next == 20) {
+                                     psf_fail("source");
+                                 }
+                                 job.value = next;
+                                 return next++ < 40;
+                             },
+                             [&consumed](Job& job) { consumed += job.result == 2 * job.value; });
+            } catch (const RuntimeError& e) {
+                PSF_UNUSED(e);
+                thrown = true;
+            }
+            shouldEqual(thrown, fail == 1);
+            if(!fail) {
+                shouldEqual(consumed, 40);
+            }
+        }
+    }
+
+    void testSpectra() {
+        typedef std::vector<std::pair<double, double> > MzWidthPairs;
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        const std::string filename = dirTestdata + "/shared_data/orbi_ms1.wsv";
+        Spectrum orbi;
+        loadSpectrumElements(orbi, filename);
+        const MzWidthPairs expected = measureFullWidths(get_mz, get_int, orbi.begin(), orbi.end(), 0.5);
+
+        struct Scan {
+            Spectrum spectrum;
+            MzWidthPairs widths;
+        };
+        SpectrumLoader loader;
+        int loaded = 0;
+        bool equal = true;
+        Pipeline<Scan> pipeline;
+        pipeline.addStage([&](Scan& scan) { measureFullWidths(get_mz, get_int, scan.spectrum.begin(), scan.spectrum.end(), 0.5, 0., scan.widths); }, 2);
+        const std::size_t count = pipeline.run([&](Scan& scan) { return loaded++ < 20 && loader.load(filename, scan.spectrum); },
+                                               [&](Scan& scan) { equal = equal && scan.widths == expected; });
+        shouldEqual(count, 20u);
+        should(equal);
+    }
+};
+
+int main() {
+    PipelineTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
@@ -0,0 +1,196 @@
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/Regression.h>
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct RegressionTestSuite : vigra::test_suite {
+    RegressionTestSuite() : vigra::test_suite("Regression") {
+        add( testCase(&RegressionTestSuite::testWeights));
+        add( testCase(&RegressionTestSuite::testNormalEquations));
+        add( testCase(&RegressionTestSuite::testSolveNonnegative));
+        add( testCase(&RegressionTestSuite::testWeightedObservations));
+        add( testCase(&RegressionTestSuite::testCovariance));
+    }
+
+    void testWeights() {
+        shouldEqual(huberWeight(0.), 1.);
+        shouldEqual(huberWeight(-1.), 1.);
+        shouldEqualTolerance(huberWeight(2.69), 0.5, 1e-12);
+        shouldEqualTolerance(huberWeight(-2.69), 0.5, 1e-12);
+        shouldEqual(tukeyWeight(0.), 1.);
+        shouldEqualTolerance(tukeyWeight(4.685 / std::sqrt(2.)), 0.25, 1e-12);
+        shouldEqual(tukeyWeight(4.685), 0.);
+        shouldEqual(tukeyWeight(-10.), 0.);
+    }
+
+    void testNormalEquations() {
+        NormalEquations equations(2);
+        shouldEqual(equations.numberOfParameters(), 2u);
+        shouldEqual(equations.count(), 0u);
+
+        // y = 2x + 3, the trailing bias element of the slope is ignored
+        for(int i = 0; i < 10; ++i) {
+            std::vector<double> row(3);
+            row[0] = i;
+            row[1] = 1.;
+            row[2] = 0.;
+            equations.add(row, 2. * i + 3.);
+        }
+        shouldEqual(equations.count(), 10u);
+        std::vector<double> x;
+        equations.solveNonnegative(x);
+        shouldEqual(x.size(), 2u);
+        shouldEqualTolerance(x[0], 2., 1e-10);
+        shouldEqualTolerance(x[1], 3., 1e-10);
+        shouldEqualTolerance(equations.residualSumOfSquares(x), 0., 1e-8);
+
+        equations.clear();
+        shouldEqual(equations.count(), 0u);
+        equations.solveNonnegative(x);
+        shouldEqual(x[0], 0.);
+        shouldEqual(x[1], 0.);
+
+        bool thrown = false;
+        try {
+            NormalEquations invalid(0);
+        }
+        catch(const PreconditionViolation& e) {
+            thrown = true;
+            PSF_UNUSED(e);
+        }
+        should(thrown);
+
+        thrown = false;
+        try {
+            std::vector<double> shortRow(1, 1.);
+            NormalEquations equations2(2);
+            equations2.add(shortRow, 1.);
+        }
+        catch(const PreconditionViolation& e) {
+            thrown = true;
+            PSF_UNUSED(e);
+        }
+        should(thrown);
+    }
+
+    void testSolveNonnegative() {
+        // y = 2x - 3: the intercept is clamped to zero and the slope refitted
+        NormalEquations equations(2);
+        std::vector<double> row(2, 1.);
+        double sxy = 0., sxx = 0.;
+        for(int i = 1; i <= 10; ++i) {
+            row[0] = i;
+            equations.add(row, 2. * i - 3.);
+            sxy += i * (2. * i - 3.);
+            sxx += i * i;
+        }
+        std::vector<double> x;
+        equations.solveNonnegative(x);
+        shouldEqualTolerance(x[0], sxy / sxx, 1e-10);
+        shouldEqual(x[1], 0.);
+
+        // everything negative: the zero solution
+        NormalEquations negative(1);
+        std::vector<double> one(1, 1.);
+        negative.add(one, -1.);
+        negative.add(one, -2.);
+        negative.solveNonnegative(x);
+        shouldEqual(x[0], 0.);
+        shouldEqualTolerance(negative.residualSumOfSquares(x), 5., 1e-12);
+    }
+
+    void testWeightedObservations() {
+        // a zero weight removes an observation
+        NormalEquations equations(1);
+        std::vector<double> one(1, 1.);
+        equations.add(one, 1.);
+        equations.add(one, 3.);
+        equations.add(one, 100., 0.);
+        std::vector<double> x;
+        equations.solveNonnegative(x);
+        shouldEqualTolerance(x[0], 2., 1e-12);
+
+        equations.add(one, 5., 2.);
+        equations.solveNonnegative(x);
+        shouldEqualTolerance(x[0], 3.5, 1e-12);
+
+        bool thrown = false;
+        try {
+            equations.add(one, 1., -1.);
+        }
+        catch(const PreconditionViolation& e) {
+            thrown = true;
+            PSF_UNUSED(e);
+        }
+        should(thrown);
+    }
+
+    void testCovariance() {
+        // y = 2x + 1 + e with e = +-0.5
+        NormalEquations equations(2);
+        std::vector<double> row(2, 1.);
+        for(int i = 0; i < 8; ++i) {
+            row[0] = i;
+            equations.add(row, 2. * i + 1. + ((i % 2) ? 0.5 : -0.5));
+        }
+        std::vector<double> x, covariance;
+        equations.solveNonnegative(x);
+        equations.covariance(x, covariance);
+        shouldEqual(covariance.size(), 4u);
+
+        // textbook formulas for simple linear regression
+        const double n = 8., meanX = 3.5;
+        double sxx = 0.;
+        for(int i = 0; i < 8; ++i) {
+            sxx += (i - meanX) * (i - meanX);
+        }
+        const double variance = equations.residualSumOfSquares(x) / (n - 2);
+        shouldEqualTolerance(covariance[0], variance / sxx, 1e-10);
+        shouldEqualTolerance(covariance[3], variance * (1. / n + meanX * meanX / sxx), 1e-10);
+        shouldEqualTolerance(covariance[1], -variance * meanX / sxx, 1e-10);
+        shouldEqualTolerance(covariance[1], covariance[2], 1e-12);
+
+        // too few observations
+        NormalEquations few(2);
+        few.add(row, 1.);
+        bool thrown = false;
+        try {
+            few.covariance(x, covariance);
+        }
+        catch(const Starvation& e) {
+            thrown = true;
+            PSF_UNUSED(e);
+        }
+        should(thrown);
+
+        // singular
+        NormalEquations singular(2);
+        row[0] = 1.;
+        for(int i = 0; i < 4; ++i) {
+            singular.add(row, i);
+        }
+        thrown = false;
+        try {
+            singular.covariance(x, covariance);
+        }
+        catch(const NumericalInstability& e) {
+            thrown = true;
+            PSF_UNUSED(e);
+        }
+        should(thrown);
+    }
+};
+
+int main()
+{
+    RegressionTestSuite test;
+    int failed = test.run();
+    std::cout << test.report() << std::endl;
+    return failed;
+}
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/Log.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/Render.h>
+#include <psf/Spectrum.h>
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct RenderTestSuite : vigra::test_suite {
+    RenderTestSuite() : vigra::test_suite("Render") {
+        add( testCase(&RenderTestSuite::testRenderProfile));
+        add( testCase(&RenderTestSuite::testRenderProfileOnUniformGrid));
+        add( testCase(&RenderTestSuite::testRenderEmpty));
+    }
+
+    // brute force reference: every stick at every grid point
+    template< typename PeakShapeFunction >
+    std::vector<double> renderNaively(const PeakShapeFunction& function, const Spectrum& sticks, const std::vector<double>& grid) {
+        std::vector<double> profile(grid.size(), 0.);
+        for(std::size_t i = 0; i < grid.size(); ++i) {
+            for(std::size_t s = 0; s < sticks.size(); ++s) {
+                profile[i] += sticks[s].intensity * function(sticks[s].mz, grid[i]);
+            }
+        }
+        return profile;
+    }
+
+    Spectrum someSticks() {
+        Spectrum sticks;
+        sticks.push_back(SpectrumElement(400.1, 100.));
+        sticks.push_back(SpectrumElement(400.6, 55.));
+        sticks.push_back(SpectrumElement(400.62, 20.));
+        sticks.push_back(SpectrumElement(401.1, 12.));
+        sticks.push_back(SpectrumElement(403.7, 80.));
+        return sticks;
+    }
+
+    void testRenderProfile() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        OrbitrapPeakShapeFunction orbi(1.19781e-05);
+        Spectrum sticks = someSticks();
+
+        // a non-uniform grid
+        std::vector<double> grid;
+        for(double mz = 399.; mz < 405.; mz += 0.003 + 0.001 * (grid.size() % 3)) {
+            grid.push_back(mz);
+        }
+        std::vector<double> expected = renderNaively(orbi, sticks, grid);
+
+        for(unsigned nThreads = 1; nThreads <= 4; ++nThreads) {
+            std::vector<double> profile(grid.size(), -1.);
+            renderProfile(orbi, get_mz, get_int, sticks.begin(), sticks.end(), grid.begin(), grid.end(), profile.begin(), nThreads);
+            shouldEqualSequenceTolerance(profile.begin(), profile.end(), expected.begin(), 1e-12);
+        }
+
+        // the maximum of an isolated stick is its abundance
+        GaussianPeakShapeFunction gauss(0.02);
+        Spectrum single;
+        single.push_back(SpectrumElement(500., 42.));
+        double onStick[] = {499.9, 500., 500.1};
+        double profile[3];
+        renderProfile(gauss, get_mz, get_int, single.begin(), single.end(), onStick, onStick + 3, profile);
+        shouldEqualTolerance(profile[1], 42., 1e-12);
+        shouldEqual(profile[0], 0.);
+        shouldEqual(profile[2], 0.);
+    }
+
+    void testRenderProfileOnUniformGrid() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        OrbitrapPeakShapeFunction orbi(1.19781e-05);
+        Spectrum sticks = someSticks();
+
+        const double firstMz = 399.5;
+        const double mzStep = 0.0025;
+        const std::size_t nPoints = 2000;
+        std::vector<double> grid;
+        for(std::size_t i = 0; i < nPoints; ++i) {
+            grid.push_back(firstMz + i * mzStep);
+        }
+        std::vector<double> expected = renderNaively(orbi, sticks, grid);
+
+        for(unsigned nThreads = 1; nThreads <= 3; ++nThreads) {
+            std::vector<double> profile(nPoints, -1.);
+            renderProfileOnUniformGrid(orbi, get_mz, get_int, sticks.begin(), sticks.end(), firstMz, mzStep, nPoints, profile.begin(), nThreads);
+            shouldEqualSequenceTolerance(profile.begin(), profile.end(), expected.begin(), 1e-12);
+        }
+
+        // illegal step
+        bool thrown = false;
+        std::vector<double> profile(nPoints);
+        try {
+            renderProfileOnUniformGrid(orbi, get_mz, get_int, sticks.begin(), sticks.end(), firstMz, 0., nPoints, profile.begin());
+        }
+        catch(const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testRenderEmpty() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        GaussianPeakShapeFunction gauss(0.02);
+        Spectrum noSticks;
+
+        // no sticks: the profile is zeroed
+        std::vector<double> grid(10, 0.);
+        for(std::size_t i = 0; i < grid.size(); ++i) {
+            grid[i] = 400. + i * 0.01;
+        }
+        std::vector<double> profile(10, 3.);
+        renderProfile(gauss, get_mz, get_int, noSticks.begin(), noSticks.end(), grid.begin(), grid.end(), profile.begin(), 2);
+        for(std::size_t i = 0; i < profile.size(); ++i) {
+            shouldEqual(profile[i], 0.);
+        }
+
+        // no grid points: nothing is written
+        Spectrum sticks = someSticks();
+        renderProfile(gauss, get_mz, get_int, sticks.begin(), sticks.end(), grid.begin(), grid.begin(), profile.begin());
+        renderProfileOnUniformGrid(gauss, get_mz, get_int, sticks.begin(), sticks.end(), 400., 0.01, 0, profile.begin());
+    }
+};
+
+int main()
+{
+    RenderTestSuite test;
+    int failed = test.run();
+    std::cout << test.report() << std::endl;
+    return failed;
+}
@@ -0,0 +1,316 @@
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <psf/Error.h>
+#include <psf/PeakParameter.h>
+#include <psf/Resample.h>
+#include <psf/Spectrum.h>
+
+#include "unittest.hxx"
+#include "testdata.h"
+
+using namespace psf;
+
+struct ResampleTestSuite : vigra::test_suite {
+    ResampleTestSuite() : vigra::test_suite("Resample") {
+        add( testCase(&ResampleTestSuite::testScales));
+        add( testCase(&ResampleTestSuite::testResamplingGrid));
+        add( testCase(&ResampleTestSuite::testMakeResamplingGrid));
+        add( testCase(&ResampleTestSuite::testResampleLinear));
+        add( testCase(&ResampleTestSuite::testResampleGaps));
+        add( testCase(&ResampleTestSuite::testResampleEmpty));
+        add( testCase(&ResampleTestSuite::testResampleOrbitrapSpectrum));
+        add( testCase(&ResampleTestSuite::testWarpedScale));
+        add( testCase(&ResampleTestSuite::testResampleFromGrid));
+    }
+
+    void testScales() {
+        LinearScale linear;
+        SqrtScale sqrtScale;
+        LogScale logScale;
+        const double mzs[] = {0.5, 1., 400., 1234.5678};
+        for(int i = 0; i < 4; ++i) {
+            shouldEqualTolerance(linear.inverse(linear.forward(mzs[i])), mzs[i], 1e-12);
+            shouldEqualTolerance(sqrtScale.inverse(sqrtScale.forward(mzs[i])), mzs[i], 1e-12);
+            shouldEqualTolerance(logScale.inverse(logScale.forward(mzs[i])), mzs[i], 1e-12);
+        }
+        shouldEqualTolerance(sqrtScale.forward(400.), 20., 1e-12);
+        shouldEqualTolerance(logScale.forward(1.), 0., 1e-12);
+    }
+
+    void testResamplingGrid() {
+        ResamplingGrid<LinearScale> linear(LinearScale(), 100., 200., 11);
+        shouldEqual(linear.size(), 11u);
+        shouldEqualTolerance(linear.mz(0), 100., 1e-12);
+        shouldEqualTolerance(linear.mz(3), 130., 1e-12);
+        shouldEqualTolerance(linear.mz(10), 200., 1e-12);
+        shouldEqualTolerance(linear.getStep(), 10., 1e-12);
+
+        ResamplingGrid<SqrtScale> sqrtGrid(SqrtScale(), 100., 400., 11);
+        shouldEqualTolerance(sqrtGrid.mz(0), 100., 1e-12);
+        shouldEqualTolerance(sqrtGrid.mz(5), 225., 1e-12);
+        shouldEqualTolerance(sqrtGrid.mz(10), 400., 1e-12);
+
+        ResamplingGrid<LogScale> logGrid(LogScale(), 100., 400., 3);
+        shouldEqualTolerance(logGrid.mz(1), 200., 1e-12);
+        shouldEqualTolerance(logGrid.mz(2), 400., 1e-12);
+
+        bool thrown = false;
+        try {
+            ResamplingGrid<LinearScale> invalid(LinearScale(), 200., 100., 10);
+        }
+        catch(const PreconditionViolation& e) {
+            thrown = true;
+            PSF_UNUSED(e);
+        }
+        should(thrown);
+
+        thrown = false;
+        try {
+            ResamplingGrid<LinearScale> invalid(LinearScale(), 100., 200., 1);
+        }
+        catch(const PreconditionViolation& e) {
+            thrown = true;
+            PSF_UNUSED(e);
+        }
+        should(thrown);
+    }
+
+    void testMakeResamplingGrid() {
+        // a constant fwhm on a linear scale
+        ConstantFwhm constant;
+        constant.setA(0.1);
+        ResamplingGrid<LinearScale> linear = makeResamplingGrid(LinearScale(), constant, 100., 200., 5.);
+        should(linear.getStep() <= 0.02 + 1e-12);
+        should(linear.getStep() > 0.0199);
+        shouldEqualTolerance(linear.mz(linear.size() - 1), 200., 1e-9);
+
+        // a fwhm proportional to sqrt(mz) on a sqrt scale: every peak gets the same number
+        // of points
+        TofFwhm tof;
+        tof.setA(0.01);
+        tof.setB(0.);
+        ResamplingGrid<SqrtScale> sqrtGrid = makeResamplingGrid(SqrtScale(), tof, 100., 1600., 8.);
+        const double mzs[] = {100., 400., 900., 1500.};
+        for(int i = 0; i < 4; ++i) {
+            const double mz = mzs[i];
+            const double width = sqrtGrid.getScale().forward(mz + 0.5 * tof.at(mz)) - sqrtGrid.getScale().forward(mz - 0.5 * tof.at(mz));
+            shouldEqualTolerance(width / sqrtGrid.getStep(), 8., 1e-3);
+        }
+
+        bool thrown = false;
+        try {
+            makeResamplingGrid(LinearScale(), constant, 100., 200., 0.);
+        }
+        catch(const PreconditionViolation& e) {
+            thrown = true;
+            PSF_UNUSED(e);
+        }
+        should(thrown);
+    }
+
+    void testResampleLinear() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        ConstantFwhm fwhm;
+        fwhm.setA(1.);
+
+        // a linear function is reproduced exactly inside the spectrum
+        Spectrum spectrum;
+        for(int i = 0; i <= 10; ++i) {
+            const double mz = 100. + i / 10.;
+            spectrum.push_back(SpectrumElement(mz, 3 * mz - 200.));
+        }
+        ResamplingGrid<LinearScale> grid(LinearScale(), 99.5, 101.5, 81);
+        std::vector<double> result(grid.size(), -1.);
+        std::vector<double>::iterator end = resampleOnGrid(fwhm, grid, get_mz, get_int, spectrum.begin(), spectrum.end(), result.begin());
+        should(end == result.end());
+        for(std::size_t i = 0; i < grid.size(); ++i) {
+            const double mz = grid.mz(i);
+            if(mz < spectrum.front().mz || mz > spectrum.back().mz) {
+                shouldEqual(result[i], 0.);
+            }
+            else {
+                shouldEqualTolerance(result[i], 3 * mz - 200., 1e-9);
+            }
+        }
+
+        // the same on a log scale
+        ResamplingGrid<LogScale> logGrid(LogScale(), 100., 101., 33);
+        std::vector<double> logResult(logGrid.size(), -1.);
+        resampleOnGrid(fwhm, logGrid, get_mz, get_int, spectrum.begin(), spectrum.end(), logResult.begin());
+        for(std::size_t i = 0; i < logGrid.size(); ++i) {
+            shouldEqualTolerance(logResult[i], 3 * logGrid.mz(i) - 200., 1e-9);
+        }
+    }
+
+    void testResampleGaps() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        ConstantFwhm fwhm;
+        fwhm.setA(0.05);
+
+        // two peaks; the zero intensities between them are missing
+        Spectrum spectrum;
+        spectrum.push_back(SpectrumElement(100.00, 1.));
+        spectrum.push_back(SpectrumElement(100.02, 3.));
+        spectrum.push_back(SpectrumElement(100.04, 1.));
+        spectrum.push_back(SpectrumElement(101.00, 2.));
+        spectrum.push_back(SpectrumElement(101.02, 4.));
+
+        ResamplingGrid<LinearScale> grid(LinearScale(), 99.99, 101.03, 105);
+        std::vector<double> result(grid.size(), -1.);
+        resampleOnGrid(fwhm, grid, get_mz, get_int, spectrum.begin(), spectrum.end(), result.begin());
+        for(std::size_t i = 0; i < grid.size(); ++i) {
+            const double mz = grid.mz(i);
+            if(mz < 99.999 || (mz > 100.041 && mz < 100.999) || mz > 101.021) {
+                shouldEqual(result[i], 0.);
+            }
+            else if((mz > 100.001 && mz < 100.039) || (mz > 101.001 && mz < 101.019)) {
+                should(result[i] > 0.);
+            }
+        }
+        shouldEqualTolerance(result[1], 1., 1e-9);
+        shouldEqualTolerance(result[2], 2., 1e-9);
+        shouldEqualTolerance(result[3], 3., 1e-9);
+
+        // a wider gap tolerance interpolates across
+        std::vector<double> bridged(grid.size(), -1.);
+        resampleOnGrid(fwhm, grid, get_mz, get_int, spectrum.begin(), spectrum.end(), bridged.begin(), 100.);
+        shouldEqualTolerance(bridged[53], 1.5, 1e-6);
+
+        bool thrown = false;
+        try {
+            resampleOnGrid(fwhm, grid, get_mz, get_int, spectrum.begin(), spectrum.end(), bridged.begin(), 0.);
+        }
+        catch(const PreconditionViolation& e) {
+            thrown = true;
+            PSF_UNUSED(e);
+        }
+        should(thrown);
+    }
+
+    void testResampleEmpty() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        ConstantFwhm fwhm;
+        fwhm.setA(0.05);
+        ResamplingGrid<LinearScale> grid(LinearScale(), 100., 101., 5);
+
+        Spectrum empty;
+        std::vector<double> result(grid.size(), -1.);
+        resampleOnGrid(fwhm, grid, get_mz, get_int, empty.begin(), empty.end(), result.begin());
+        for(std::size_t i = 0; i < result.size(); ++i) {
+            shouldEqual(result[i], 0.);
+        }
+
+        // a single element on a grid point
+        Spectrum single;
+        single.push_back(SpectrumElement(100.5, 7.));
+        resampleOnGrid(fwhm, grid, get_mz, get_int, single.begin(), single.end(), result.begin());
+        shouldEqual(result[1], 0.);
+        shouldEqual(result[2], 7.);
+        shouldEqual(result[3], 0.);
+    }
+
+    void testResampleOrbitrapSpectrum() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        Spectrum spectrum;
+        loadSpectrumElements(spectrum, dirTestdata + "/shared_data/orbi_ms1.wsv");
+        OrbitrapWithOriginFwhm fwhm;
+        fwhm.setA(1.19781e-05);
+
+        // resampling onto the original positions reproduces the spectrum
+        std::vector<double> result(spectrum.size());
+        ResamplingGrid<LinearScale> grid(LinearScale(), spectrum.front().mz, spectrum.back().mz, 2);
+        resampleOnGrid(fwhm, grid, get_mz, get_int, spectrum.begin(), spectrum.end(), result.begin());
+        shouldEqualTolerance(result[0], spectrum.front().intensity, 1e-9);
+        shouldEqualTolerance(result[1], spectrum.back().intensity, 1e-9);
+
+        // the maximum survives resampling with enough points per fwhm
+        ResamplingGrid<LogScale> logGrid = makeResamplingGrid(LogScale(), fwhm, spectrum.front().mz, spectrum.back().mz, 10.);
+        std::vector<double> profile(logGrid.size());
+        resampleOnGrid(fwhm, logGrid, get_mz, get_int, spectrum.begin(), spectrum.end(), profile.begin(), 2.);
+        double maximum = 0.;
+        for(std::size_t i = 0; i < spectrum.size(); ++i) {
+            maximum = std::max(maximum, spectrum[i].intensity);
+        }
+        double resampledMaximum = 0.;
+        for(std::size_t i = 0; i < profile.size(); ++i) {
+            should(profile[i] >= 0.);
+            resampledMaximum = std::max(resampledMaximum, profile[i]);
+        }
+        should(resampledMaximum <= maximum);
+        should(resampledMaximum > 0.9 * maximum);
+    }
+
+    void testWarpedScale() {
+        OrbitrapWithOriginFwhm fwhm;
+        fwhm.setA(1.19781e-05);
+        WarpedScale<OrbitrapWithOriginFwhm> scale(fwhm);
+        shouldEqualTolerance(scale.inverse(scale.forward(321.)), 321., 1e-9);
+
+        // in warped coordinates the fwhm is one everywhere, so the grid spacing follows
+        // directly from the number of points per fwhm
+        ResamplingGrid<WarpedScale<OrbitrapWithOriginFwhm> > grid = makeResamplingGrid(scale, fwhm, 300., 2000., 4.);
+        shouldEqualTolerance(grid.getStep(), 0.25, 1e-3);
+        for(std::size_t i = 1; i < grid.size(); i += grid.size() / 10) {
+            const double spacing = grid.mz(i) - grid.mz(i - 1);
+            shouldEqualTolerance(spacing / fwhm.at(grid.mz(i)), grid.getStep(), 1e-3);
+        }
+        shouldEqualTolerance(grid.mz(grid.size() - 1), 2000., 1e-9);
+    }
+
+    void testResampleFromGrid() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        OrbitrapWithOriginFwhm fwhm;
+        fwhm.setA(1.19781e-05);
+
+        // a smooth spectrum survives the round trip through warped coordinates
+        Spectrum spectrum;
+        for(int i = 0; i <= 2000; ++i) {
+            const double mz = 400. + i * 0.001;
+            spectrum.push_back(SpectrumElement(mz, 2. + std::sin(mz * 10.)));
+        }
+        WarpedScale<OrbitrapWithOriginFwhm> scale(fwhm);
+        ResamplingGrid<WarpedScale<OrbitrapWithOriginFwhm> > grid = makeResamplingGrid(scale, fwhm, 400., 402., 20.);
+        std::vector<double> warped(grid.size());
+        resampleOnGrid(fwhm, grid, get_mz, get_int, spectrum.begin(), spectrum.end(), warped.begin());
+
+        std::vector<double> mzs;
+        for(std::size_t i = 0; i < spectrum.size(); ++i) {
+            mzs.push_back(spectrum[i].mz);
+        }
+        mzs.push_back(403.);
+        std::vector<double> restored(mzs.size(), -1.);
+        std::vector<double>::iterator end = resampleFromGrid(grid, warped.begin(), mzs.begin(), mzs.end(), restored.begin());
+        should(end == restored.end());
+        for(std::size_t i = 0; i < spectrum.size(); ++i) {
+            shouldEqualTolerance(restored[i], spectrum[i].intensity, 1e-3);
+        }
+        shouldEqual(restored.back(), 0.);
+
+        // on a linear grid the interpolation is exact for linear functions
+        ResamplingGrid<LinearScale> linear(LinearScale(), 10., 20., 11);
+        std::vector<double> line;
+        for(std::size_t i = 0; i < linear.size(); ++i) {
+            line.push_back(2. * linear.mz(i));
+        }
+        const double positions[] = {9., 10., 12.5, 19.99, 20., 21.};
+        const double expected[] = {0., 20., 25., 39.98, 40., 0.};
+        double values[6];
+        resampleFromGrid(linear, line.begin(), positions, positions + 6, values);
+        shouldEqualSequenceTolerance(values, values + 6, expected, 1e-9);
+    }
+};
+
+int main()
+{
+    ResampleTestSuite test;
+    int failed = test.run();
+    std::cout << test.report() << std::endl;
+    return failed;
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Error.h>
+#include <psf/SaxParser.h>
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+// Records the events as lines like 'start a x=1', 'end a', 'text abc'; adjacent text
+// pieces are joined.
+class RecordingHandler : public SaxHandler {
+public:
+    virtual void startElement(const std::string& name, const SaxAttributes& attributes) {
+        std::string event = "start " + name;
+        for(std::size_t i = 0; i < attributes.size(); ++i) {
+            event += " " + attributes.name(i) + "=" + attributes.value(i);
+        }
+        events.push_back(event);
+    }
+
+    virtual void endElement(const std::string& name) {
+        events.push_back("end " + name);
+    }
+
+    virtual void characters(const char* text, std::size_t length) {
+        if(!events.empty() && events.back().compare(0, 5, "text ") == 0) {
+            events.back().append(text, length);
+        }
+        else {
+            events.push_back("text " + std::string(text, length));
+        }
+    }
+
+    std::vector<std::string> events;
+};
+
+struct SaxParserTestSuite : vigra::test_suite {
+    SaxParserTestSuite() : vigra::test_suite("SaxParser") {
+        add( testCase(&SaxParserTestSuite::testParse));
+        add( testCase(&SaxParserTestSuite::testSmallChunks));
+        add( testCase(&SaxParserTestSuite::testOffset));
+        add( testCase(&SaxParserTestSuite::testMalformed));
+    }
+
+    static std::vector<std::string> parse(const std::string& document, const std::size_t chunkSize) {
+        std::istringstream is(document);
+        SaxParser parser(is, chunkSize);
+        RecordingHandler handler;
+        while(parser.parseNext(handler)) {
+        }
+        return handler.events;
+    }
+
+    static std::string document() {
+        return "<?xml version=\"1.0\"?>\n"
+               "<!DOCTYPE root>"
+               "<root a=\"1\" b = 'x &amp; &lt;y&gt; &#65;&#x42;'>"
+               "<!-- a comment with <tags> -->"
+               "<empty/><item c=\"a>b\">text</item>"
+               "<![CDATA[<raw>]]>"
+               "</root>";
+    }
+
+    void testParse() {
+        const std::vector<std::string> events = parse(document(), 1 << 16);
+        shouldEqual(events.size(), 9u);
+        shouldEqual(events[0], std::string("text \n"));
+        shouldEqual(events[1], std::string("start root a=1 b=x & <y> AB"));
+        shouldEqual(events[2], std::string("start empty"));
+        shouldEqual(events[3], std::string("end empty"));
+        shouldEqual(events[4], std::string("start item c=a>b"));
+        shouldEqual(events[5], std::string("text text"));
+        shouldEqual(events[6], std::string("end item"));
+        shouldEqual(events[7], std::string("text <raw>"));
+        shouldEqual(events[8], std::string("end root"));
+    }
+
+    void testSmallChunks() {
+        // constructs straddle the chunk boundaries
+        const std::vector<std::string> expected = parse(document(), 1 << 16);
+        for(std::size_t chunkSize = 16; chunkSize < 64; ++chunkSize) {
+            should(parse(document(), chunkSize) == expected);
+        }
+
+        std::string long_text(100000, 'A');
+        const std::vector<std::string> events = parse("<a>" + long_text + "</a>", 1000);
+        shouldEqual(events.size(), 3u);
+        shouldEqual(events[1], "text " + long_text);
+    }
+
+    void testOffset() {
+        const std::string document = "<a>\n  <b x=\"1\"/>\n</a>";
+        std::istringstream is(document);
+        SaxParser parser(is, 16);
+        RecordingHandler handler;
+        std::vector<unsigned long long> offsets;
+        while(parser.parseNext(handler)) {
+            offsets.push_back(parser.offset());
+        }
+        // <a>, text, <b/>, text, </a>
+        shouldEqual(offsets.size(), 5u);
+        shouldEqual(offsets[0], 0u);
+        shouldEqual(offsets[2], document.find("<b"));
+        shouldEqual(offsets[4], document.find("</a>"));
+    }
+
+    void testMalformed() {
+        const char* documents[] = {"<a><b x=\"1\"", "<a x=1/>", "<a x/>", "<a><!-- unterminated", "< x=\"1\"/>", "<a x=\"&unknown;\"/>"};
+        for(int i = 0; i < 6; ++i) {
+            bool thrown = false;
+            try {
+                parse(documents[i], 4);
+            } catch (const RuntimeError& e) {
+                PSF_UNUSED(e);
+                thrown = true;
+            }
+            should(thrown);
+        }
+    }
+};
+
+int main() {
+    SaxParserTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
@@ -0,0 +1,165 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Error.h>
+#include <psf/ScanCache.h>
+#include <psf/ScanIndex.h>
+#include <psf/Spectrum.h>
+
+#include "testhelpers.hxx"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct ScanCacheTestSuite : vigra::test_suite {
+    ScanCacheTestSuite() : vigra::test_suite("ScanCache"), wsv_("ScanCache-test.wsv") {
+        add( testCase(&ScanCacheTestSuite::testBudget));
+        add( testCase(&ScanCacheTestSuite::testReadAhead));
+        add( testCase(&ScanCacheTestSuite::testErrors));
+    }
+
+    // 40 scans with every (1 + i % 4)th element of orbi_ms1.wsv.
+    void writeRun() const {
+        const std::vector<Spectrum> spectra = psftest::scans(40, 4);
+        std::ofstream ofs(wsv_.c_str());
+        ofs.precision(17);
+        for(std::size_t i = 0; i < spectra.size(); ++i) {
+            ofs << "# scan=" << i + 1 << " rt=" << 2. * i << " level=1\n";
+            for(std::size_t j = 0; j < spectra[i].size(); ++j) {
+                ofs << spectra[i][j].mz << " " << spectra[i][j].intensity << "\n";
+            }
+        }
+    }
+
+    void removeRun() const {
+        std::remove(wsv_.c_str());
+        std::remove(ScanIndex::sidecarFilename(wsv_).c_str());
+    }
+
+    void testBudget() {
+        writeRun();
+        IndexedRun run(wsv_);
+        const std::size_t budget = 200000;
+        {
+            ScanCache cache(wsv_, budget);
+            shouldEqual(cache.size(), 40u);
+            shouldEqual(cache.memoryBudget(), budget);
+            Spectrum expected;
+            bool same = true;
+            bool bounded = true;
+            for(int pass = 0; pass < 2; ++pass) {
+                for(std::size_t i = 0; i < cache.size(); ++i) {
+                    ScanCache::ScanPtr scan = cache.scan(i);
+                    run.read(i, expected);
+                    same = same && psftest::equal(*scan, expected);
+                    bounded = bounded && cache.bytesCached() <= budget;
+                }
+            }
+            should(same);
+            should(bounded);
+            shouldEqual(cache.hits() + cache.misses(), 80u);
+
+            // a scan held by the caller outlives its eviction
+            ScanCache::ScanPtr first = cache.scan(0);
+            for(std::size_t i = 1; i < cache.size(); ++i) {
+                cache.scan(i);
+            }
+            should(!cache.cached(0));
+            run.read(0, expected);
+            should(psftest::equal(*first, expected));
+
+            // a cached scan is a hit
+            cache.scan(7);
+            const std::size_t hits = cache.hits();
+            cache.scan(7);
+            shouldEqual(cache.hits(), hits + 1);
+        }
+        removeRun();
+    }
+
+    void testReadAhead() {
+        writeRun();
+        {
+            ScanCache cache(wsv_, 4 << 20);
+            cache.scan(0);
+            cache.waitForReadAhead();
+            should(cache.cached(1));
+            should(cache.cached(5));
+
+            // backwards
+            std::vector<std::size_t> order;
+            for(std::size_t i = cache.size(); i > 0; --i) {
+                order.push_back(i - 1);
+            }
+            cache.setProcessingOrder(order);
+            cache.scan(39);
+            cache.waitForReadAhead();
+            should(cache.cached(38));
+            should(cache.cached(35));
+
+            // processing in order is served from the read ahead
+            std::vector<std::size_t> even;
+            for(std::size_t i = 0; i < cache.size(); i += 2) {
+                even.push_back(i);
+            }
+            cache.setProcessingOrder(even);
+            ScanCache::ScanPtr scan = cache.scan(0);
+            cache.waitForReadAhead();
+            should(cache.cached(20));
+            const std::size_t misses = cache.misses();
+            for(std::size_t i = 2; i <= 20; i += 2) {
+                scan = cache.scan(i);
+            }
+            shouldEqual(cache.misses(), misses);
+        }
+        removeRun();
+    }
+
+    void testErrors() {
+        bool thrown = false;
+        try {
+            ScanCache cache("ScanCache-test-missing.wsv");
+        } catch(const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+
+        writeRun();
+        {
+            ScanCache cache(wsv_);
+            thrown = false;
+            try {
+                cache.scan(40);
+            } catch(const PreconditionViolation& e) {
+                PSF_UNUSED(e);
+                thrown = true;
+            }
+            should(thrown);
+            thrown = false;
+            try {
+                cache.setProcessingOrder(std::vector<std::size_t>(1, 40));
+            } catch(const PreconditionViolation& e) {
+                PSF_UNUSED(e);
+                thrown = true;
+            }
+            should(thrown);
+        }
+        removeRun();
+    }
+
+    const std::string wsv_;
+};
+
+int main() {
+    ScanCacheTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
@@ -0,0 +1,228 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Error.h>
+#include <psf/MzML.h>
+#include <psf/ScanIndex.h>
+#include <psf/Spectrum.h>
+
+#include "testdata.h"
+#include "testhelpers.hxx"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct ScanIndexTestSuite : vigra::test_suite {
+    ScanIndexTestSuite() : vigra::test_suite("ScanIndex"), wsv_("ScanIndex-test.wsv"), mzml_("ScanIndex-test.mzML") {
+        add( testCase(&ScanIndexTestSuite::testWsv));
+        add( testCase(&ScanIndexTestSuite::testSingleWsv));
+        add( testCase(&ScanIndexTestSuite::testMzML));
+        add( testCase(&ScanIndexTestSuite::testSidecar));
+    }
+
+    // Scan numbers 100, 101, ... and descending retention times 10 * (n - i).
+    void writeWsv(const std::vector<Spectrum>& spectra) const {
+        std::ofstream ofs(wsv_.c_str());
+        ofs.precision(17);
+        for(std::size_t i = 0; i < spectra.size(); ++i) {
+            ofs << "# scan=" << 100 + i << " rt=" << 10. * (spectra.size() - i) << " level=" << 1 + i % 2 << "\n";
+            for(std::size_t j = 0; j < spectra[i].size(); ++j) {
+                ofs << spectra[i][j].mz << " " << spectra[i][j].intensity << "\n";
+            }
+            // zero intensities count neither for the m/z range nor the spectrum
+            ofs << spectra[i].back().mz + 1. << " 0.0\n";
+        }
+    }
+
+    void testWsv() {
+        const std::vector<Spectrum> spectra = psftest::scans(4);
+        writeWsv(spectra);
+        const ScanIndex index = ScanIndex::build(wsv_);
+        shouldEqual(index.format(), wsvRun);
+        shouldEqual(index.size(), 4u);
+        for(std::size_t i = 0; i < 4; ++i) {
+            shouldEqual(index[i].scanNumber, static_cast<int>(100 + i));
+            shouldEqual(index[i].retentionTime, 10. * (4 - i));
+            shouldEqual(index[i].msLevel, static_cast<int>(1 + i % 2));
+            shouldEqual(index[i].firstMz, spectra[i].front().mz);
+            shouldEqual(index[i].lastMz, spectra[i].back().mz);
+        }
+        shouldEqual(index[3].offset + index[3].length, index.runSize());
+
+        shouldEqual(index.findScan(102), 2u);
+        shouldEqual(index.findScan(99), 4u);
+        shouldEqual(index.findScan(104), 4u);
+        std::vector<std::size_t> found;
+        index.findRetentionTimeRange(15., 30., found);
+        shouldEqual(found.size(), 2u);
+        shouldEqual(found[0], 2u);
+        shouldEqual(found[1], 1u);
+        index.findRetentionTimeRange(50., 60., found);
+        shouldEqual(found.size(), 0u);
+
+        IndexedRun run(wsv_);
+        Spectrum spectrum;
+        for(std::size_t i = 4; i-- > 0;) {
+            run.read(i, spectrum);
+            should(psftest::equal(spectrum, spectra[i]));
+        }
+        should(run.readScan(101, spectrum));
+        should(psftest::equal(spectrum, spectra[1]));
+        should(!run.readScan(7, spectrum));
+        shouldEqual(spectrum.size(), 0u);
+
+        bool thrown = false;
+        try {
+            run.read(4, spectrum);
+        } catch (const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        std::remove(wsv_.c_str());
+        std::remove(ScanIndex::sidecarFilename(wsv_).c_str());
+    }
+
+    void testSingleWsv() {
+        const std::string filename = dirTestdata + "/shared_data/orbi_ms1.wsv";
+        Spectrum expected;
+        loadSpectrumElements(expected, filename);
+        const ScanIndex index = ScanIndex::build(filename);
+        shouldEqual(index.size(), 1u);
+        shouldEqual(index[0].offset, 0u);
+        shouldEqual(index[0].length, index.runSize());
+        shouldEqual(index[0].scanNumber, 1);
+        shouldEqual(index[0].firstMz, expected.front().mz);
+        shouldEqual(index[0].lastMz, expected.back().mz);
+    }
+
+    void testMzML() {
+        const std::vector<Spectrum> spectra = psftest::scans(5);
+        {
+            std::ofstream ofs(mzml_.c_str(), std::ios::binary);
+#ifdef PSF_HAVE_ZLIB
+            MzMLWriter writer(ofs, spectra.size(), true);
+#else
+            MzMLWriter writer(ofs, spectra.size(), false);
+#endif
+            for(std::size_t i = 0; i < spectra.size(); ++i) {
+                writer.write(spectra[i], 2. * i);
+            }
+            writer.close();
+        }
+        const ScanIndex index = ScanIndex::build(mzml_, 2);
+        shouldEqual(index.format(), mzmlRun);
+        shouldEqual(index.size(), 5u);
+
+        std::ifstream ifs(mzml_.c_str(), std::ios::binary);
+        for(std::size_t i = 0; i < 5; ++i) {
+            shouldEqual(index[i].scanNumber, static_cast<int>(i) + 1);
+            shouldEqual(index[i].retentionTime, 2. * i);
+            shouldEqual(index[i].msLevel, 1);
+            shouldEqual(index[i].firstMz, spectra[i].front().mz);
+            shouldEqual(index[i].lastMz, spectra[i].back().mz);
+            std::string element(index[i].length, ' ');
+            ifs.seekg(index[i].offset);
+            ifs.read(&element[0], index[i].length);
+            shouldEqual(element.substr(0, 10), std::string("<spectrum "));
+            shouldEqual(element.substr(element.size() - 11), std::string("</spectrum>"));
+        }
+
+        IndexedRun run(mzml_);
+        Spectrum spectrum;
+        for(std::size_t i = 5; i-- > 0;) {
+            run.read(i, spectrum);
+            should(psftest::equal(spectrum, spectra[i]));
+        }
+        std::vector<std::size_t> found;
+        run.index().findRetentionTimeRange(3., 100., found);
+        shouldEqual(found.size(), 3u);
+        shouldEqual(found[0], 2u);
+        std::remove(mzml_.c_str());
+        std::remove(ScanIndex::sidecarFilename(mzml_).c_str());
+    }
+
+    void testSidecar() {
+        const std::vector<Spectrum> spectra = psftest::scans(3);
+        writeWsv(spectra);
+        const std::string sidecar = ScanIndex::sidecarFilename(wsv_);
+        std::remove(sidecar.c_str());
+
+        ScanIndex loaded;
+        should(!loaded.load(sidecar));
+        const ScanIndex opened = ScanIndex::open(wsv_);
+        should(loaded.load(sidecar));
+        shouldEqual(loaded.size(), opened.size());
+        shouldEqual(loaded.runSize(), opened.runSize());
+        shouldEqual(loaded.runModified(), opened.runModified());
+        shouldEqual(loaded.runChecksum(), opened.runChecksum());
+        for(std::size_t i = 0; i < loaded.size(); ++i) {
+            shouldEqual(loaded[i].offset, opened[i].offset);
+            shouldEqual(loaded[i].length, opened[i].length);
+            shouldEqual(loaded[i].scanNumber, opened[i].scanNumber);
+            shouldEqual(loaded[i].retentionTime, opened[i].retentionTime);
+            shouldEqual(loaded[i].firstMz, opened[i].firstMz);
+            shouldEqual(loaded[i].lastMz, opened[i].lastMz);
+        }
+        shouldEqual(loaded.findScan(101), 1u);
+
+        // a sidecar of another run size is rebuilt
+        writeWsv(psftest::scans(2));
+        shouldEqual(ScanIndex::open(wsv_).size(), 2u);
+        should(loaded.load(sidecar));
+        shouldEqual(loaded.size(), 2u);
+
+        // as is one of a run rewritten with the same size
+        std::string text;
+        {
+            std::ifstream ifs(wsv_.c_str(), std::ios::binary);
+            std::ostringstream oss;
+            oss << ifs.rdbuf();
+            text = oss.str();
+        }
+        text.replace(text.find("scan=100"), 8, "scan=900");
+        {
+            std::ofstream ofs(wsv_.c_str(), std::ios::binary);
+            ofs << text;
+        }
+        shouldEqual(ScanIndex::open(wsv_).findScan(900), 0u);
+        should(loaded.load(sidecar));
+        shouldEqual(loaded.findScan(900), 0u);
+
+        // as is a broken one
+        {
+            std::ofstream ofs(sidecar.c_str());
+            ofs << "garbage\n";
+        }
+        bool thrown = false;
+        try {
+            loaded.load(sidecar);
+        } catch (const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        shouldEqual(ScanIndex::open(wsv_).size(), 2u);
+        should(loaded.load(sidecar));
+        std::remove(wsv_.c_str());
+        std::remove(sidecar.c_str());
+    }
+
+private:
+    std::string wsv_;
+    std::string mzml_;
+};
+
+int main() {
+    ScanIndexTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
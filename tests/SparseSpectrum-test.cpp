@@ -0,0 +1,94 @@
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Error.h>
+#include <psf/SparseSpectrum.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumAlgorithm.h>
+
+#include "testdata.h"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+struct SparseSpectrumTestSuite : vigra::test_suite {
+    SparseSpectrumTestSuite() : vigra::test_suite("SparseSpectrum") {
+        add( testCase(&SparseSpectrumTestSuite::testCompression));
+        add( testCase(&SparseSpectrumTestSuite::testMeasureFullWidths));
+    }
+
+    void testCompression() {
+        // runs of one, two and five zeros
+        const double intensities[] = {0., 3., 5., 0., 0., 4., 0., 0., 0., 0., 0., 2.};
+        Spectrum dense;
+        for(int i = 0; i < 12; ++i) {
+            dense.push_back(SpectrumElement(100. + i, intensities[i]));
+        }
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        SparseSpectrum sparse;
+        sparse.assign(get_mz, get_int, dense.begin(), dense.end());
+
+        shouldEqual(sparse.denseSize(), 12u);
+        shouldEqual(sparse.size(), 9u);
+        const double expectedMzs[] = {100., 101., 102., 103., 104., 105., 106., 110., 111.};
+        for(std::size_t i = 0; i < sparse.size(); ++i) {
+            shouldEqual(sparse[i].mz, expectedMzs[i]);
+        }
+        shouldEqual(sparse.end() - sparse.begin(), 9);
+
+        const std::vector<SparseSpectrum::ZeroRun>& runs = sparse.zeroRuns();
+        shouldEqual(runs.size(), 3u);
+        shouldEqual(runs[0].position, 0u);
+        shouldEqual(runs[0].length, 1u);
+        shouldEqual(runs[1].position, 3u);
+        shouldEqual(runs[1].length, 2u);
+        shouldEqual(runs[2].position, 6u);
+        shouldEqual(runs[2].length, 5u);
+
+        sparse.clear();
+        should(sparse.empty());
+        shouldEqual(sparse.denseSize(), 0u);
+        shouldEqual(sparse.zeroRuns().size(), 0u);
+    }
+
+    void testMeasureFullWidths() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        const std::string filename = dirTestdata + "/shared_data/orbi_ms1.wsv";
+
+        // the dense spectrum with every zero
+        Spectrum dense;
+        std::ifstream ifs(filename.c_str());
+        double mz, intensity;
+        while(ifs >> mz >> intensity) {
+            dense.push_back(SpectrumElement(mz, intensity));
+        }
+        SparseSpectrum sparse;
+        loadSpectrumElements(sparse, filename);
+        shouldEqual(sparse.denseSize(), dense.size());
+        should(sparse.size() < dense.size());
+
+        // same widths as with every zero; different from the ones without zeros
+        const double fractions[] = {0.1, 0.5, 0.9};
+        for(int f = 0; f < 3; ++f) {
+            should(measureFullWidths(get_mz, get_int, sparse.begin(), sparse.end(), fractions[f]) ==
+                   measureFullWidths(get_mz, get_int, dense.begin(), dense.end(), fractions[f]));
+        }
+        Spectrum withoutZeros;
+        loadSpectrumElements(withoutZeros, filename);
+        should(measureFullWidths(get_mz, get_int, sparse.begin(), sparse.end(), 0.1) !=
+               measureFullWidths(get_mz, get_int, withoutZeros.begin(), withoutZeros.end(), 0.1));
+    }
+};
+
+int main()
+{
+    SparseSpectrumTestSuite test;
+    int failed = test.run();
+    std::cout << test.report() << std::endl;
+    return failed;
+}
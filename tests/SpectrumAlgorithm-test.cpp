@@ -1,5 +1,6 @@
 #include <functional>
 #include <iostream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -40,6 +41,10 @@ struct SpectrumAlgorithmTestSuite : vigra::test_suite {
     SpectrumAlgorithmTestSuite() : vigra::test_suite("SpectrumAlgorithm") {
         add( testCase(&SpectrumAlgorithmTestSuite::testFindBump));
         add( testCase(&SpectrumAlgorithmTestSuite::testMeasureFullWidths));
+        add( testCase(&SpectrumAlgorithmTestSuite::testFindBumps));
+        add( testCase(&SpectrumAlgorithmTestSuite::testMeasureFullWidthsInParallel));
+        add( testCase(&SpectrumAlgorithmTestSuite::testMeasureFullWidthsIntoVector));
+        add( testCase(&SpectrumAlgorithmTestSuite::testSpectrumLoader));
     }
 
     void testFindBump() {
@@ -284,6 +289,128 @@ struct SpectrumAlgorithmTestSuite : vigra::test_suite {
         shouldEqual(result.at(9).first, 881.68);
         shouldEqualTolerance(result.at(9).second, 0.0195845, 0.00001);   
     }
+
+    // all bumps found by repeated calls of findBump()
+    static std::vector<std::pair<int*, int*> > sequentialBumps(int* first, int* last) {
+        std::vector<std::pair<int*, int*> > bumps;
+        while(first < last) {
+            std::pair<int*, int*> bump = psf::findBump(first, last, std::less<int>());
+            if(bump.first == last) {
+                break;
+            }
+            bumps.push_back(bump);
+            first = bump.second;
+        }
+        return bumps;
+    }
+
+    void testFindBumps() {
+        int twoBumps[] = {100, 81, 56, 56, 57, 69, 40, 13, 13, 9, 18, 21, 19, 15, 16, 19, 19, 18, 12, 11, 17, 22, 47};
+        for(unsigned nThreads = 1; nThreads <= 24; ++nThreads) {
+            shouldEqual(psf::findBumps(twoBumps, twoBumps + 23, std::less<int>(), nThreads).size(), 2u);
+            should(psf::findBumps(twoBumps, twoBumps + 23, std::less<int>(), nThreads) == sequentialBumps(twoBumps, twoBumps + 23));
+        }
+
+        // few distinct values: many plateaus and bumps straddling the chunk borders
+        std::vector<int> values;
+        unsigned state = 7;
+        for(int i = 0; i < 5000; ++i) {
+            state = state * 1103515245u + 12345u;
+            values.push_back(static_cast<int>((state >> 16) % 4));
+        }
+        int* first = &values[0];
+        int* last = first + values.size();
+        const std::vector<std::pair<int*, int*> > expected = sequentialBumps(first, last);
+        should(expected.size() > 100);
+        for(unsigned nThreads = 1; nThreads <= 64; ++nThreads) {
+            should(psf::findBumps(first, last, std::less<int>(), nThreads) == expected);
+        }
+
+        // empty sequence
+        shouldEqual(psf::findBumps(first, first, std::less<int>(), 4).size(), 0u);
+    }
+
+    void testMeasureFullWidthsInParallel() {
+        using namespace psf;
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        Spectrum spectrum;
+        loadSpectrumElements(spectrum, dirTestdata + "/shared_data/orbi_ms1.wsv");
+
+        typedef std::vector<std::pair<MzExtractor::result_type, MzExtractor::result_type> > MzWidthPairs;
+        const MzWidthPairs expected = measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 100.);
+        should(expected.size() > 100);
+        for(unsigned nThreads = 0; nThreads <= 16; ++nThreads) {
+            should(measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 100., nThreads) == expected);
+        }
+        shouldEqual(measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.begin(), 0.5, 0., 4).size(), 0u);
+
+        bool thrown = false;
+        try {
+            measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 1.5, 0., 4);
+        } catch(const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testMeasureFullWidthsIntoVector() {
+        using namespace psf;
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        Spectrum spectrum;
+        loadSpectrumElements(spectrum, dirTestdata + "/shared_data/orbi_ms1.wsv");
+
+        typedef std::vector<std::pair<MzExtractor::result_type, MzExtractor::result_type> > MzWidthPairs;
+        const MzWidthPairs expected = measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 100.);
+        MzWidthPairs widths(3, std::make_pair(1., 1.));
+        measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.end(), 0.5, 100., widths);
+        should(widths == expected);
+
+        // the memory is reused
+        const MzWidthPairs::size_type capacity = widths.capacity();
+        const std::pair<double, double>* data = &widths[0];
+        measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.begin() + spectrum.size() / 2, 0.5, 100., widths);
+        should(widths.size() < expected.size());
+        shouldEqual(widths.capacity(), capacity);
+        should(&widths[0] == data);
+
+        measureFullWidths(get_mz, get_int, spectrum.begin(), spectrum.begin(), 0.5, 100., widths);
+        shouldEqual(widths.size(), 0u);
+    }
+
+    void testSpectrumLoader() {
+        using namespace psf;
+        const std::string filename = dirTestdata + "/shared_data/orbi_ms1.wsv";
+        Spectrum expected;
+        loadSpectrumElements(expected, filename);
+
+        SpectrumLoader loader;
+        Spectrum spectrum(2, SpectrumElement(1., 1.));
+        should(loader.load(filename, spectrum));
+        shouldEqual(spectrum.size(), expected.size());
+        for(Spectrum::size_type i = 0; i < spectrum.size(); ++i) {
+            shouldEqual(spectrum[i].mz, expected[i].mz);
+            shouldEqual(spectrum[i].intensity, expected[i].intensity);
+        }
+        const SpectrumElement* data = &spectrum[0];
+        should(loader.load(filename, spectrum));
+        shouldEqual(spectrum.size(), expected.size());
+        should(&spectrum[0] == data);
+
+        should(!loader.load(dirTestdata + "/does/not/exist.wsv", spectrum));
+        shouldEqual(spectrum.size(), 0u);
+
+        // zero intensities are dropped and a malformed pair ends the input
+        Spectrum parsed;
+        SpectrumLoader::parse("100.5 3\n101 0\n 102.25\t1e2\n103 x 104 5", parsed);
+        shouldEqual(parsed.size(), 2u);
+        shouldEqual(parsed[0].mz, 100.5);
+        shouldEqual(parsed[0].intensity, 3.);
+        shouldEqual(parsed[1].mz, 102.25);
+        shouldEqual(parsed[1].intensity, 100.);
+    }
 };
 
 struct SpectralPeakTestSuite : vigra::test_suite {
@@ -0,0 +1,180 @@
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Error.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumBatch.h>
+
+#include "testdata.h"
+#include "testhelpers.hxx"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+namespace {
+    bool equal(const SpectrumBatch& batch, const std::size_t i, const Spectrum& expected) {
+        return psftest::equal(batch.begin(i), batch.end(i), expected);
+    }
+}
+
+struct SpectrumBatchTestSuite : vigra::test_suite {
+    SpectrumBatchTestSuite() : vigra::test_suite("SpectrumBatch") {
+        add( testCase(&SpectrumBatchTestSuite::testListDirectory));
+        add( testCase(&SpectrumBatchTestSuite::testLoad));
+        add( testCase(&SpectrumBatchTestSuite::testChunks));
+        add( testCase(&SpectrumBatchTestSuite::testMalformed));
+        add( testCase(&SpectrumBatchTestSuite::testPairsOnOneLine));
+        add( testCase(&SpectrumBatchTestSuite::testErrors));
+    }
+
+    void testListDirectory() {
+        const std::vector<std::string> files = SpectrumBatch::listDirectory(dirTestdata);
+        shouldEqual(files.size(), 5u);
+        shouldEqual(files[0], dirTestdata + "/PeakParameter/realistic_ms1.wsv");
+        shouldEqual(files[3], dirTestdata + "/SpectrumAlgorithm/realistic_ms1.wsv");
+        shouldEqual(files[4], dirTestdata + "/shared_data/orbi_ms1.wsv");
+        shouldEqual(SpectrumBatch::listDirectory(dirTestdata + "/shared_data", ".mzML").size(), 0u);
+    }
+
+    void testLoad() {
+        const std::vector<std::string> files = SpectrumBatch::listDirectory(dirTestdata);
+        std::vector<Spectrum> expected(files.size());
+        std::size_t n = 0;
+        for(std::size_t i = 0; i < files.size(); ++i) {
+            loadSpectrumElements(expected[i], files[i]);
+            n += expected[i].size();
+        }
+        shouldEqual(expected[4].size(), 5179u);
+
+        SpectrumBatch batch;
+        shouldEqual(batch.size(), 0u);
+        shouldEqual(batch.numberOfElements(), 0u);
+        const unsigned threads[] = {1, 3};
+        for(int t = 0; t < 2; ++t) {
+            batch.load(files, threads[t]);
+            shouldEqual(batch.size(), files.size());
+            shouldEqual(batch.numberOfElements(), n);
+            std::size_t offset = 0;
+            for(std::size_t i = 0; i < files.size(); ++i) {
+                shouldEqual(batch.filename(i), files[i]);
+                shouldEqual(batch.offset(i), offset);
+                should(equal(batch, i, expected[i]));
+                offset += expected[i].size();
+            }
+            should(batch.bytesLoaded() > 0);
+        }
+
+        batch.clear();
+        shouldEqual(batch.size(), 0u);
+        batch.load(std::vector<std::string>());
+        shouldEqual(batch.numberOfElements(), 0u);
+    }
+
+    void testChunks() {
+        const std::string filename = dirTestdata + "/shared_data/orbi_ms1.wsv";
+        Spectrum expected;
+        loadSpectrumElements(expected, filename);
+        std::vector<std::string> files(2, filename);
+
+        // chunks smaller than a line, about a line and larger ones
+        const std::size_t sizes[] = {9, 31, 1000, 65536};
+        SpectrumBatch batch;
+        for(int s = 0; s < 4; ++s) {
+            batch.load(files, 3, sizes[s]);
+            shouldEqual(batch.size(), 2u);
+            for(std::size_t i = 0; i < 2; ++i) {
+                should(equal(batch, i, expected));
+            }
+        }
+    }
+
+    void testMalformed() {
+        // parsing stops at the first text that isn't a pair, also in a later chunk
+        const std::string filename = "SpectrumBatch-test.wsv";
+        {
+            std::ofstream ofs(filename.c_str());
+            ofs << "100.5 10\n101.5 0\n102.5 20\n103.5 30\n# comment\n104.5 40\n105.5 50\n";
+        }
+        Spectrum expected;
+        loadSpectrumElements(expected, filename);
+        shouldEqual(expected.size(), 3u);
+
+        SpectrumBatch batch;
+        const std::size_t sizes[] = {5, 11, 1000};
+        for(int s = 0; s < 3; ++s) {
+            batch.load(std::vector<std::string>(2, filename), 2, sizes[s]);
+            should(equal(batch, 0, expected));
+            should(equal(batch, 1, expected));
+        }
+        std::remove(filename.c_str());
+    }
+
+    void testPairsOnOneLine() {
+        // more pairs than lines don't fit into the room of a chunk
+        const std::string filename = "SpectrumBatch-test-line.wsv";
+        {
+            std::ofstream ofs(filename.c_str());
+            ofs << "100.5 10 101.5 20 102.5 30\n103.5 0\n104.5 40 105.5 50 106.5 60\n";
+        }
+        Spectrum expected;
+        loadSpectrumElements(expected, filename);
+        shouldEqual(expected.size(), 6u);
+
+        const std::string other = dirTestdata + "/PeakParameter/realistic_ms1.wsv";
+        Spectrum expectedOther;
+        loadSpectrumElements(expectedOther, other);
+        std::vector<std::string> files(1, other);
+        files.push_back(filename);
+        files.push_back(other);
+
+        SpectrumBatch batch;
+        const std::size_t sizes[] = {7, 30, 1 << 22};
+        for(int s = 0; s < 3; ++s) {
+            batch.load(files, 2, sizes[s]);
+            should(equal(batch, 0, expectedOther));
+            should(equal(batch, 1, expected));
+            should(equal(batch, 2, expectedOther));
+            shouldEqual(batch.numberOfElements(), 2 * expectedOther.size() + expected.size());
+        }
+        std::remove(filename.c_str());
+    }
+
+    void testErrors() {
+        SpectrumBatch batch;
+        batch.load(std::vector<std::string>(1, dirTestdata + "/shared_data/orbi_ms1.wsv"));
+        std::vector<std::string> files(1, dirTestdata + "/shared_data/orbi_ms1.wsv");
+        files.push_back("SpectrumBatch-test-missing.wsv");
+        bool thrown = false;
+        try {
+            batch.load(files, 2);
+        } catch(const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+        shouldEqual(batch.size(), 0u);
+
+        thrown = false;
+        try {
+            SpectrumBatch::listDirectory("SpectrumBatch-test-missing");
+        } catch(const RuntimeError& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+};
+
+int main() {
+    SpectrumBatchTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
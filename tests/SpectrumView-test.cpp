@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <psf/config.h>
+#include <psf/Centroid.h>
+#include <psf/Error.h>
+#include <psf/PeakShapeFunction.h>
+#include <psf/Spectrum.h>
+#include <psf/SpectrumAlgorithm.h>
+#include <psf/SpectrumView.h>
+
+#include "testdata.h"
+
+#include "unittest.hxx"
+
+using namespace psf;
+
+namespace
+{
+    // like the records of a vendor library
+    struct VendorPeak
+    {
+        double mz;
+        float intensity;
+        int flags;
+    };
+}
+
+struct SpectrumViewTestSuite : vigra::test_suite {
+    SpectrumViewTestSuite() : vigra::test_suite("SpectrumView") {
+        loadSpectrumElements(orbi_, dirTestdata + "/shared_data/orbi_ms1.wsv");
+        for(std::size_t i = 0; i < orbi_.size(); ++i) {
+            interleaved_.push_back(orbi_[i].mz);
+            interleaved_.push_back(orbi_[i].intensity);
+            VendorPeak peak = {orbi_[i].mz, static_cast<float>(orbi_[i].intensity), 0};
+            records_.push_back(peak);
+            rounded_.push_back(SpectrumElement(orbi_[i].mz, peak.intensity));
+        }
+
+        add( testCase(&SpectrumViewTestSuite::testAccess));
+        add( testCase(&SpectrumViewTestSuite::testMeasureFullWidths));
+        add( testCase(&SpectrumViewTestSuite::testCalibrateFor));
+        add( testCase(&SpectrumViewTestSuite::testEvaluate));
+        add( testCase(&SpectrumViewTestSuite::testCentroid));
+    }
+
+    static bool equal(const std::vector<std::pair<double, double> >& a, const std::vector<std::pair<double, double> >& b) {
+        if(a.size() != b.size()) {
+            return false;
+        }
+        for(std::size_t i = 0; i < a.size(); ++i) {
+            if(a[i] != b[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    BasicSpectrumView<double, float> recordView() const {
+        return BasicSpectrumView<double, float>(&records_[0].mz, &records_[0].intensity, records_.size(), sizeof(VendorPeak), sizeof(VendorPeak));
+    }
+
+    void testAccess() {
+        const SpectrumView empty;
+        should(empty.empty());
+        should(empty.begin() == empty.end());
+
+        const double mzs[] = {100., 101., 102.};
+        const double intensities[] = {1., 5., 2.};
+        const SpectrumView separate(mzs, intensities, 3);
+        shouldEqual(separate.size(), 3u);
+        shouldEqual(separate[1].mz, 101.);
+        shouldEqual(separate[1].intensity, 5.);
+        shouldEqual(separate.end() - separate.begin(), 3);
+        shouldEqual((*(separate.begin() + 2)).intensity, 2.);
+        shouldEqual(separate.begin()[2].mz, 102.);
+        SpectrumView::const_iterator it = separate.end();
+        --it;
+        shouldEqual((*it).mz, 102.);
+        shouldEqual(it->intensity, 2.);
+        shouldEqual(std::lower_bound(separate.begin(), separate.end(), 101.5, LessThanValue<SpectrumElement, MzExtractor>(MzExtractor())) - separate.begin(), 2);
+        shouldEqual(*(separate.intensityEnd() - 1), 2.);
+        shouldEqual(std::max_element(separate.intensityBegin(), separate.intensityEnd()) - separate.intensityBegin(), 1);
+
+        // negative strides read backwards
+        const SpectrumView reversed(mzs + 2, intensities + 2, 3, -static_cast<std::ptrdiff_t>(sizeof(double)), -static_cast<std::ptrdiff_t>(sizeof(double)));
+        shouldEqual(reversed[0].mz, 102.);
+        shouldEqual(reversed[2].intensity, 1.);
+
+        const SpectrumView interleaved = makeInterleavedSpectrumView(&interleaved_[0], interleaved_.size() / 2);
+        const SpectrumView elements = makeSpectrumView(orbi_);
+        const BasicSpectrumView<double, float> records = recordView();
+        shouldEqual(interleaved.size(), orbi_.size());
+        bool same = true;
+        for(std::size_t i = 0; i < orbi_.size(); ++i) {
+            same = same && interleaved[i].mz == orbi_[i].mz && interleaved[i].intensity == orbi_[i].intensity;
+            same = same && elements[i].mz == orbi_[i].mz && elements[i].intensity == orbi_[i].intensity;
+            same = same && records[i].mz == rounded_[i].mz && records[i].intensity == rounded_[i].intensity;
+        }
+        should(same);
+    }
+
+    void testMeasureFullWidths() {
+        MzExtractor get_mz;
+        IntensityExtractor get_int;
+        const std::vector<std::pair<double, double> > expected = measureFullWidths(get_mz, get_int, orbi_.begin(), orbi_.end(), 0.5);
+        should(!expected.empty());
+        should(equal(measureFullWidths(makeInterleavedSpectrumView(&interleaved_[0], interleaved_.size() / 2), 0.5), expected));
+        should(equal(measureFullWidths(makeSpectrumView(orbi_), 0.5, 0., 3u), expected));
+        std::vector<std::pair<double, double> > widths(1);
+        measureFullWidths(recordView(), 0.5, 0., widths);
+        should(equal(widths, measureFullWidths(get_mz, get_int, rounded_.begin(), rounded_.end(), 0.5)));
+
+        bool thrown = false;
+        try {
+            measureFullWidths(recordView(), 1.5);
+        } catch(const PreconditionViolation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testCalibrateFor() {
+        OrbitrapPeakShapeFunction expected;
+        expected.calibrateFor(MzExtractor(), IntensityExtractor(), orbi_.begin(), orbi_.end());
+        OrbitrapPeakShapeFunction viewed;
+        viewed.calibrateFor(makeInterleavedSpectrumView(&interleaved_[0], interleaved_.size() / 2));
+        shouldEqual(viewed.getA(), expected.getA());
+
+        OrbitrapPeakShapeFunction expectedRounded;
+        expectedRounded.calibrateFor(MzExtractor(), IntensityExtractor(), rounded_.begin(), rounded_.end());
+        OrbitrapPeakShapeFunction records;
+        records.calibrateFor(recordView());
+        shouldEqual(records.getA(), expectedRounded.getA());
+
+        bool thrown = false;
+        try {
+            OrbitrapPeakShapeFunction starved;
+            starved.calibrateFor(SpectrumView());
+        } catch(const Starvation& e) {
+            PSF_UNUSED(e);
+            thrown = true;
+        }
+        should(thrown);
+    }
+
+    void testEvaluate() {
+        OrbitrapPeakShapeFunction orbi(1.19781e-06);
+        const std::size_t n = 200;
+        should(orbi_.size() > n);
+        std::vector<double> mzs;
+        for(std::size_t i = 0; i < n; ++i) {
+            mzs.push_back(orbi_[i].mz);
+        }
+        const double referenceMass = orbi_[n / 2].mz;
+        std::vector<double> expected(n);
+        orbi.evaluate(referenceMass, mzs.begin(), mzs.end(), expected.begin());
+        std::vector<double> values(n);
+        const BasicSpectrumView<double, float> records(&records_[0].mz, &records_[0].intensity, n, sizeof(VendorPeak), sizeof(VendorPeak));
+        std::vector<double>::iterator last = orbi.evaluate(referenceMass, records, values.begin());
+        should(last == values.end());
+        bool same = true;
+        for(std::size_t i = 0; i < n; ++i) {
+            same = same && values[i] == expected[i];
+        }
+        should(same);
+    }
+
+    void testCentroid() {
+        OrbitrapPeakShapeFunction orbi(1.19781e-06);
+        std::vector<Centroid> expected(maximalNumberOfCentroids(orbi_.size()));
+        expected.resize(centroid(orbi, MzExtractor(), IntensityExtractor(), orbi_.begin(), orbi_.end(), expected.begin()) - expected.begin());
+        const SpectrumView view = makeInterleavedSpectrumView(&interleaved_[0], interleaved_.size() / 2);
+        std::vector<Centroid> centroids(maximalNumberOfCentroids(view.size()));
+        centroids.resize(centroid(orbi, MzExtractor(), IntensityExtractor(), view.begin(), view.end(), centroids.begin()) - centroids.begin());
+        shouldEqual(centroids.size(), expected.size());
+        bool same = true;
+        for(std::size_t i = 0; i < expected.size() && i < centroids.size(); ++i) {
+            same = same && centroids[i].mz == expected[i].mz && centroids[i].intensity == expected[i].intensity && centroids[i].area == expected[i].area;
+        }
+        should(same);
+    }
+
+    Spectrum orbi_;
+    Spectrum rounded_;
+    std::vector<double> interleaved_;
+    std::vector<VendorPeak> records_;
+};
+
+int main() {
+    SpectrumViewTestSuite test;
+    int success = test.run();
+    std::cout << test.report() << std::endl;
+
+    return success;
+}
@@ -0,0 +1,5 @@
+#ifndef __TESTDATA_H__
+#define __TESTDATA_H__
+#include <string>
+static const std::string dirTestdata = "/root/repo/tests/testdata";
+#endif /*__TESTDATA_H__*/
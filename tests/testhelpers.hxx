@@ -0,0 +1,55 @@
+#ifndef __TESTHELPERS_HXX__
+#define __TESTHELPERS_HXX__
+
+#include <cstddef>
+#include <vector>
+
+#include <psf/Spectrum.h>
+
+#include "testdata.h"
+
+/**
+ * Helpers shared by the psf unit tests that read and write runs.
+ */
+namespace psftest
+{
+
+// equal()
+/**
+ * True, if [first, last) holds exactly the elements of expected, compared bit for bit.
+ */
+template< typename Iterator >
+bool equal(Iterator first, const Iterator last, const psf::Spectrum& expected) {
+    std::size_t i = 0;
+    for(; first != last; ++first, ++i) {
+        if(i == expected.size() || first->mz != expected[i].mz || first->intensity != expected[i].intensity) {
+            return false;
+        }
+    }
+    return i == expected.size();
+}
+
+inline bool equal(const psf::Spectrum& a, const psf::Spectrum& b) {
+    return equal(a.begin(), a.end(), b);
+}
+
+// scans()
+/**
+ * n scans thinned out from orbi_ms1.wsv: scan i has every (1 + i % period)th element,
+ * starting at element i % period.
+ */
+inline std::vector<psf::Spectrum> scans(const std::size_t n, const std::size_t period = static_cast<std::size_t>(-1)) {
+    psf::Spectrum orbi;
+    psf::loadSpectrumElements(orbi, dirTestdata + "/shared_data/orbi_ms1.wsv");
+    std::vector<psf::Spectrum> result(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        for(std::size_t j = i % period; j < orbi.size(); j += 1 + i % period) {
+            result[i].push_back(orbi[j]);
+        }
+    }
+    return result;
+}
+
+} /* namespace psftest */
+
+#endif /*__TESTHELPERS_HXX__*/